@@ -6,7 +6,6 @@
 #include <FTGunFinalTickResolver.h>
 #include <FTJumpTimer.h>
 
-#include "FTApplyForceOnExpire.h"
 #include "LocomotionParams.h"
 #include "FTProjectileFinalTickResolver.h"
 #include "ModularGameplayTags.h"
@@ -108,11 +107,17 @@ void UArtilleryDispatch::INITIATE_JUMP_TIMER(const FSkeletonKey& Self)
 	this->RequestAddTicklite(Ticklite, Normal);
 }
 
-//TODO: switch bop to use a deadliner!!!!
+//bop used to be a ticklite that counted down and then pushed. the wheel does the counting now.
 void UArtilleryDispatch::Bop(FSkeletonKey Target, uint16 TicksFromNow, FVector ForceAppliedOnce, PhysicsInputType ForceType)
 {
-	StructureFullTL(Ticklite, TL_Bop, FTDelayedForce, Target, ForceAppliedOnce, TicksFromNow, ForceType);
-	this->RequestAddTicklite(Ticklite, Normal);
+	ScheduleTimer(TicksFromNow, [this, Target, ForceAppliedOnce, ForceType]()
+	{
+		FBLet GameSimPhysicsObject = GetFBLetByObjectKey(Target, GetShadowNow());
+		if (FBarragePrimitive::IsNotNull(GameSimPhysicsObject))
+		{
+			FBarragePrimitive::ApplyForce(ForceAppliedOnce, GameSimPhysicsObject, ForceType);
+		}
+	});
 }
 
 //allows you to get tombstoned fibs.
@@ -122,6 +127,20 @@ FBLet UArtilleryDispatch::GetFBLetByObjectKey(FSkeletonKey Target, ArtilleryTime
 	return PhysicsECSPillar ? PhysicsECSPillar->GetShapeRef(Target) : FBLet();
 }
 
+//tombstoned primitives come back as nullptr here, unlike GetFBLetByObjectKey.
+int32 UArtilleryDispatch::ResolveFBLets(TConstArrayView<FSkeletonKey> Targets, TArrayView<FBarragePrimitive*> OutPrimitives) const
+{
+	if (BarrageDispatch)
+	{
+		return BarrageDispatch->ResolveFBLets(Targets, OutPrimitives);
+	}
+	for (FBarragePrimitive*& Primitive : OutPrimitives)
+	{
+		Primitive = nullptr;
+	}
+	return 0;
+}
+
 void UArtilleryDispatch::ThreadSetup()
 {
 	UBarrageDispatch* PhysicsECSPillar = GetWorld()->GetSubsystem<UBarrageDispatch>();
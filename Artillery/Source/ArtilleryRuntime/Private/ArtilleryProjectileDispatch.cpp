@@ -5,13 +5,25 @@
 #include "ArtilleryBPLibs.h"
 #include "BarrageDispatch.h"
 #include "FArtilleryGun.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
 
 void UArtilleryProjectileDispatch::ArtilleryTick()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(UArtilleryProjectileDispatch::ArtilleryTick)
 
+	GuidanceSwarm.Tick(MyDispatch);
+
 	//On Tick, we see if anybody needs to go.
 	++ExpirationCounter;
+	TArray<FSkeletonKey> Shells;
+	ArcSwarm.Tick(UBarrageDispatch::SelfPtr, ExpirationCounter, Shells);
+	for (FSkeletonKey Shell : Shells)
+	{
+		//same cleanup TL_ArcingProjectile does on expiry. if the body's still a projectile, the tombstone repeats the
+		//delete, and that's a no-op once the mesh mapping is gone.
+		DeleteProjectile(Shell);
+		UArtilleryLibrary::TombstonePrimitive(Shell);
+	}
 	auto Ref = Deadliner.UpdateAndConsume();
 
 	for (FSkeletonKey Goner : Ref)
@@ -82,7 +94,10 @@ bool UArtilleryProjectileDispatch::RegistrationImplementation()
 	MyDispatch = GetWorld()->GetSubsystem<UArtilleryDispatch>();
 	check(MyDispatch);
 	UBarrageDispatch* BarrageDispatch = GetWorld()->GetSubsystem<UBarrageDispatch>();
-	BarrageDispatch->OnBarrageContactAddedDelegate.AddUObject(this, &UArtilleryProjectileDispatch::OnBarrageContactAdded);
+	BarrageDispatch->OnBarrageContactBatchDelegate.AddUObject(this, &UArtilleryProjectileDispatch::OnBarrageContactBatch);
+	//we only ever look at contacts where one side is a projectile.
+	BarrageDispatch->SubscribeToContacts(Layers::PROJECTILE);
+	BarrageDispatch->SubscribeToContacts(Layers::ENEMYPROJECTILE);
 	UArtilleryDispatch::SelfPtr->SetProjectileDispatch(this);
 	SelfPtr = this;
 	return true;
@@ -112,6 +127,8 @@ void UArtilleryProjectileDispatch::Deinitialize()
 	ProjectileNameToMeshManagerMapping->Empty();
 	ProjectileToGunMapping->clear();
 	Deadliner.Reset();
+	GuidanceSwarm.Reset();
+	ArcSwarm.Reset();
 	ExpirationCounter = 0;
 	if (HoldOpen)
 	{
@@ -219,8 +236,12 @@ FSkeletonKey UArtilleryProjectileDispatch::CreateProjectileInstance(FSkeletonKey
 			TStrongObjectPtr<AInstancedMeshManager> MeshManager = MeshManagerPtr->Pin();
 			if (MeshManager.IsValid())
 			{
-				FSkeletonKey NewProjectileKey = MeshManager->CreateNewInstance(
-					WorldTransform, MuzzleVelocity, Layer, Scale, ProjectileKey, IsSensor, IsDynamic);
+				int ExpireTicks = LifeInTicks == -1 || LifeInTicks == 0 ? DEFAULT_LIFE_OF_PROJECTILE : LifeInTicks;
+				//a swept projectile is retired by barrage at the same point the deadliner would tombstone it.
+				const bool Swept = CanExpire && CanSweepOnLayer(Layer) && MuzzleVelocity.SizeSquared() >= FMath::Square(SweptProjectileMinSpeed);
+				FSkeletonKey NewProjectileKey = Swept
+					? MeshManager->CreateNewSweptInstance(WorldTransform, MuzzleVelocity, Layer, Scale, ProjectileKey, static_cast<float>(ExpireTicks) / ArtilleryTickHertz)
+					: MeshManager->CreateNewInstance(WorldTransform, MuzzleVelocity, Layer, Scale, ProjectileKey, IsSensor, IsDynamic);
 				ProjectileKeyToMeshManagerMapping->insert_or_assign(NewProjectileKey, *MeshManagerPtr);
 				ProjectileToGunMapping->insert_or_assign(NewProjectileKey, Gun);
 				
@@ -234,7 +255,6 @@ FSkeletonKey UArtilleryProjectileDispatch::CreateProjectileInstance(FSkeletonKey
 				if (CanExpire)
 				{
 					//TODO: revisit to provide rollback support. it'll be exactly like tombstones.
-					int ExpireTicks = LifeInTicks == -1 || LifeInTicks == 0 ? DEFAULT_LIFE_OF_PROJECTILE : LifeInTicks;
 					Deadliner.Add(ExpirationCounter+ExpireTicks, NewProjectileKey);
 				}
 				return NewProjectileKey;
@@ -244,6 +264,18 @@ FSkeletonKey UArtilleryProjectileDispatch::CreateProjectileInstance(FSkeletonKey
 	return FSkeletonKey();
 }
 
+bool UArtilleryProjectileDispatch::CanSweepOnLayer(Layers::EJoltPhysicsLayer Layer)
+{
+	for (Layers::EJoltPhysicsLayer Projectiles : {Layers::PROJECTILE, Layers::ENEMYPROJECTILE})
+	{
+		if (Layers::ShouldLayersCollide(Layer, Projectiles) || Layers::ShouldLayersCollide(Projectiles, Layer))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 bool UArtilleryProjectileDispatch::IsArtilleryProjectile(const FSkeletonKey MaybeProjectile)
 {
 	return ProjectileKeyToMeshManagerMapping->contains(MaybeProjectile);
@@ -264,9 +296,24 @@ void UArtilleryProjectileDispatch::DeleteProjectile(const FSkeletonKey Target)
 			ProjectileToGunMapping->erase(Target);
 		}
 		UNiagaraParticleDispatch::SelfPtr->CleanupKey(Target);
+		//if it was never swept, or already hit something, this is a no-op.
+		if (UBarrageDispatch::SelfPtr)
+		{
+			UBarrageDispatch::SelfPtr->StopSweepingProjectile(Target);
+		}
 	}
 }
 
+void UArtilleryProjectileDispatch::GuideProjectile(FGuidedProjectileParams&& Params)
+{
+	GuidanceSwarm.Enqueue(MoveTemp(Params));
+}
+
+void UArtilleryProjectileDispatch::LaunchArc(FAnalyticArcParams&& Params)
+{
+	ArcSwarm.Enqueue(MoveTemp(Params));
+}
+
 TWeakObjectPtr<AInstancedMeshManager> UArtilleryProjectileDispatch::GetProjectileMeshManagerByManagerKey(
 	const FSkeletonKey ManagerKey)
 {
@@ -291,6 +338,28 @@ TWeakObjectPtr<USceneComponent> UArtilleryProjectileDispatch::GetSceneComponentF
 	return ManagerRef.IsValid() ? ManagerRef->GetSceneComponentForInstance(ProjectileKey) : nullptr;
 }
 
+void UArtilleryProjectileDispatch::OnBarrageContactBatch(const FBarrageContactBatch& Batch)
+{
+	if (Batch.Type != EBarrageContactEventType::ADDED)
+	{
+		return;
+	}
+	for (const FBarrageContactPartition& Partition : Batch.Partitions)
+	{
+		const bool bHasProjectile = Partition.Layer1 == Layers::PROJECTILE || Partition.Layer1 == Layers::ENEMYPROJECTILE
+			|| Partition.Layer2 == Layers::PROJECTILE || Partition.Layer2 == Layers::ENEMYPROJECTILE;
+		//a whole pair of layers gets skipped at once, instead of checking each hit.
+		if (!bHasProjectile || Partition.Layer1 == Layers::CAST_QUERY || Partition.Layer2 == Layers::CAST_QUERY)
+		{
+			continue;
+		}
+		for (const BarrageContactEvent& ContactEvent : Partition.Events)
+		{
+			OnBarrageContactAdded(ContactEvent);
+		}
+	}
+}
+
 void UArtilleryProjectileDispatch::OnBarrageContactAdded(const BarrageContactEvent& ContactEvent)
 {
 	// We only care if one of the entities is a projectile
@@ -324,11 +393,13 @@ void UArtilleryProjectileDispatch::OnBarrageContactAdded(const BarrageContactEve
 
 			//we defer this as late as we can to minimize contention during the sim step.
 			//don't make this a ref unless you want a very bad time.
-			FBLet quickfib = UBarrageDispatch::SelfPtr->GetShapeRef(ProjectileKey);
-			bool ProbablyValid = FBarragePrimitive::IsNotNull(quickfib);
+			//swept projectiles have no body to look up. their contact key is already the artillery key.
+			const bool Swept = Body1_IsBullet ? ContactEvent.ContactEntity1.bIsSwept : ContactEvent.ContactEntity2.bIsSwept;
+			FBLet quickfib = Swept ? FBLet() : UBarrageDispatch::SelfPtr->GetShapeRef(ProjectileKey);
+			bool ProbablyValid = Swept || FBarragePrimitive::IsNotNull(quickfib);
 			if (ProbablyValid)
 			{
-				FSkeletonKey KeyIntoArtillery = quickfib->KeyOutOfBarrage;
+				FSkeletonKey KeyIntoArtillery = Swept ? FSkeletonKey(ProjectileKey.KeyIntoBarrage) : quickfib->KeyOutOfBarrage;
 				quickfib.Reset();
 				if (KeyIntoArtillery.IsValid())
 				{
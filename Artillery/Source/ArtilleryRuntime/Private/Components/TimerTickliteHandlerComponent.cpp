@@ -1,4 +1,5 @@
 ﻿#include "Components/TimerTickliteHandlerComponent.h"
+#include "ArtilleryDispatch.h"
 
 const FName UTimerTickliteHandlerComponent::NAME_ActorFeatureName("TimerTickliteHandler");
 
@@ -18,12 +19,54 @@ void UTimerTickliteHandlerComponent::TickliteExpired()
 	OnTickliteTick.Clear();
 }
 
+void UTimerTickliteHandlerComponent::StartTimer(int32 LifetimeInTicks)
+{
+	UArtilleryDispatch* Dispatch = UArtilleryDispatch::SelfPtr;
+	if (Dispatch == nullptr)
+	{
+		return;
+	}
+	if (TimerId != 0)
+	{
+		Dispatch->CancelTimer(TimerId);
+	}
+	const uint32 Lifetime = FMath::Max(LifetimeInTicks, 1);
+	TimerFired = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+	ExpiresAt = Dispatch->GetTimerNow() + Lifetime;
+	TicksRemaining = Lifetime;
+	TimerId = Dispatch->ScheduleTimer(Lifetime, [Fired = TimerFired]()
+	{
+		Fired->store(true, std::memory_order_release);
+	});
+}
+
+void UTimerTickliteHandlerComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	if (TimerId != 0 && UArtilleryDispatch::SelfPtr)
+	{
+		UArtilleryDispatch::SelfPtr->CancelTimer(TimerId);
+	}
+	TimerId = 0;
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
+}
+
 void UTimerTickliteHandlerComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	if (TimerFired.IsValid())
+	{
+		const uint64 Now = UArtilleryDispatch::SelfPtr ? UArtilleryDispatch::SelfPtr->GetTimerNow() : ExpiresAt;
+		TicksRemaining = Now >= ExpiresAt ? 0 : static_cast<int32>(ExpiresAt - Now);
+	}
 	OnTickliteTick.Broadcast(TicksRemaining);
 
+	if (TimerFired.IsValid() && TimerFired->load(std::memory_order_acquire) && !FlaggedForDelete)
+	{
+		TimerId = 0;
+		TickliteExpired();
+	}
+
 	if (FlaggedForDelete)
 	{
 		DestroyComponent();
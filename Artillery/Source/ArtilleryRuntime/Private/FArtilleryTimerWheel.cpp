@@ -0,0 +1,172 @@
+﻿#include "FArtilleryTimerWheel.h"
+
+FArtilleryTimerWheel::FArtilleryTimerWheel()
+{
+	for (int32& Head : Heads)
+	{
+		Head = INDEX_NONE;
+	}
+}
+
+FArtilleryTimerId FArtilleryTimerWheel::Schedule(uint32 TicksFromNow, TFunction<void()>&& OnExpire)
+{
+	const FArtilleryTimerId Id = NextId.fetch_add(1, std::memory_order_relaxed);
+	Requests.Enqueue({Id, FMath::Max(TicksFromNow, 1u), MoveTemp(OnExpire)});
+	return Id;
+}
+
+void FArtilleryTimerWheel::Cancel(FArtilleryTimerId Timer)
+{
+	if (Timer != 0)
+	{
+		Cancels.Enqueue(Timer);
+	}
+}
+
+void FArtilleryTimerWheel::Reset()
+{
+	Requests.Empty();
+	Cancels.Empty();
+	for (int32& Head : Heads)
+	{
+		Head = INDEX_NONE;
+	}
+	Nodes.Empty();
+	FreeNodes.Empty();
+	Live.Empty();
+	Firing.Empty();
+	Current.store(0, std::memory_order_release);
+}
+
+void FArtilleryTimerWheel::Insert(int32 Node)
+{
+	FTimerNode& Timer = Nodes[Node];
+	const uint64 Now = Current.load(std::memory_order_relaxed);
+	const uint64 Delta = FMath::Min(Timer.Expiry - Now, MaxDelay);
+	uint32 Level = 0;
+	while (Level + 1 < LevelCount && Delta >= (1ull << (SlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+	//for long delays the slot is computed from the clamped expiry, which just means it cascades a little early.
+	const uint64 Placed = Now + Delta;
+	Timer.Slot = Level * SlotCount + ((Placed >> (SlotBits * Level)) & SlotMask);
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = Heads[Timer.Slot];
+	if (Timer.Next != INDEX_NONE)
+	{
+		Nodes[Timer.Next].Prev = Node;
+	}
+	Heads[Timer.Slot] = Node;
+}
+
+void FArtilleryTimerWheel::Unlink(int32 Node)
+{
+	FTimerNode& Timer = Nodes[Node];
+	if (Timer.Prev != INDEX_NONE)
+	{
+		Nodes[Timer.Prev].Next = Timer.Next;
+	}
+	else if (Timer.Slot != INDEX_NONE)
+	{
+		Heads[Timer.Slot] = Timer.Next;
+	}
+	if (Timer.Next != INDEX_NONE)
+	{
+		Nodes[Timer.Next].Prev = Timer.Prev;
+	}
+	Timer.Prev = Timer.Next = Timer.Slot = INDEX_NONE;
+}
+
+void FArtilleryTimerWheel::Release(int32 Node)
+{
+	FTimerNode& Timer = Nodes[Node];
+	Live.Remove(Timer.Id);
+	Timer.OnExpire.Reset();
+	Timer.Id = 0;
+	FreeNodes.Add(Node);
+}
+
+uint32 FArtilleryTimerWheel::Cascade(uint32 Level)
+{
+	const uint64 Now = Current.load(std::memory_order_relaxed);
+	const uint32 Index = (Now >> (SlotBits * Level)) & SlotMask;
+	const uint32 Slot = Level * SlotCount + Index;
+	int32 Node = Heads[Slot];
+	Heads[Slot] = INDEX_NONE;
+	while (Node != INDEX_NONE)
+	{
+		const int32 Next = Nodes[Node].Next;
+		Insert(Node);
+		Node = Next;
+	}
+	return Index;
+}
+
+void FArtilleryTimerWheel::DrainRequests()
+{
+	FTimerRequest Request;
+	while (Requests.Dequeue(Request))
+	{
+		int32 Node;
+		if (!FreeNodes.IsEmpty())
+		{
+			Node = FreeNodes.Pop(EAllowShrinking::No);
+		}
+		else
+		{
+			Node = Nodes.AddDefaulted();
+		}
+		FTimerNode& Timer = Nodes[Node];
+		Timer.Id = Request.Id;
+		Timer.Expiry = Current.load(std::memory_order_relaxed) + Request.Ticks;
+		Timer.OnExpire = MoveTemp(Request.OnExpire);
+		Live.Add(Timer.Id, Node);
+		Insert(Node);
+	}
+
+	FArtilleryTimerId Cancelled;
+	while (Cancels.Dequeue(Cancelled))
+	{
+		if (const int32* Node = Live.Find(Cancelled))
+		{
+			const int32 Found = *Node;
+			Unlink(Found);
+			Release(Found);
+		}
+	}
+}
+
+void FArtilleryTimerWheel::Advance()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FArtilleryTimerWheel::Advance)
+	DrainRequests();
+	const uint64 Now = Current.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+	//when a level wraps, pull the next level's slot down into it. the same way an odometer rolls over.
+	if ((Now & SlotMask) == 0)
+	{
+		for (uint32 Level = 1; Level < LevelCount && Cascade(Level) == 0; ++Level)
+		{
+		}
+	}
+
+	//everything in the level 0 slot for now is due now. copy out first, callbacks are allowed to schedule and cancel.
+	const uint32 Slot = Now & SlotMask;
+	Firing.Reset();
+	for (int32 Node = Heads[Slot]; Node != INDEX_NONE; Node = Nodes[Node].Next)
+	{
+		Firing.Add(Node);
+	}
+	Heads[Slot] = INDEX_NONE;
+	for (const int32 Node : Firing)
+	{
+		Nodes[Node].Prev = Nodes[Node].Next = Nodes[Node].Slot = INDEX_NONE;
+		TFunction<void()> OnExpire = MoveTemp(Nodes[Node].OnExpire);
+		Release(Node);
+		if (OnExpire)
+		{
+			OnExpire();
+		}
+	}
+}
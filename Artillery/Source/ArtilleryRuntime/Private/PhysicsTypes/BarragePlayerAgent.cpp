@@ -237,6 +237,11 @@ void UBarragePlayerAgent::SetCharacterGravity(FVector3d NewGravity)
 // Called when the game starts
 void UBarragePlayerAgent::BeginPlay()
 {
+	//registration can wait on a key for a few ticks. the shapes don't have to, and every agent this size after us gets them free.
+	if (UBarrageDispatch* Physics = GetWorld()->GetSubsystem<UBarrageDispatch>())
+	{
+		Physics->PrewarmCharacterShapes(FBarrageBounder::GenerateCharacterBounds(FVector3d::ZeroVector, radius, extent, HardMaxVelocity));
+	}
 	Super::BeginPlay();
 	RegistrationImplementation();
 }
@@ -68,11 +68,13 @@ bool UBarrageStaticAutoMesh::RegistrationImplementation()
 			if (USkeletalMeshComponent* SkeletalMeshComp = Actor->GetComponentByClass<USkeletalMeshComponent>()) {
 				auto SkeletalMesh = SkeletalMeshComp->GetSkeletalMeshAsset();
 				auto PhysicsAsset = SkeletalMeshComp->GetPhysicsAsset();
-				if (SkeletalMesh && PhysicsAsset) {
+				//registration retries every tick until there's a static mesh body, and one ragdoll is plenty.
+				if (SkeletalMesh && PhysicsAsset && !MyRagdoll) {
 					UBarrageDispatch* Physics = GetWorld()->GetSubsystem<UBarrageDispatch>();
 					if (ensure(Physics->JoltGameSim) && ensure(Physics->JoltGameSim->physics_system)) {
-						auto Ragdoll = Barrage::Conversion::ExampleCreateJoltRagdollFromUnrealSkeleton(
+						MyRagdoll = Barrage::Conversion::ExampleCreateJoltRagdollFromUnrealSkeleton(
 							*Physics->JoltGameSim->physics_system,
+							Physics->JoltGameSim->RagdollPool,
 							SkeletalMeshComp,
 							SkeletalMesh->GetSkeleton(),
 							PhysicsAsset);
@@ -94,4 +96,23 @@ bool UBarrageStaticAutoMesh::RegistrationImplementation()
 		return true;
 	}
 	return false;
-}
\ No newline at end of file
+}
+
+void UBarrageStaticAutoMesh::OnDestroyPhysicsState()
+{
+	if (MyRagdoll)
+	{
+		UBarrageDispatch* Physics = GetWorld() ? GetWorld()->GetSubsystem<UBarrageDispatch>() : nullptr;
+		if (Physics && Physics->JoltGameSim)
+		{
+			Barrage::Conversion::ReleaseJoltRagdoll(Physics->JoltGameSim->RagdollPool, MyRagdoll);
+		}
+		else
+		{
+			//the sim went first. freeing the ragdoll now would reach into a physics system that isn't there anymore.
+			MyRagdoll->AddRef();
+		}
+		MyRagdoll = nullptr;
+	}
+	Super::OnDestroyPhysicsState();
+}
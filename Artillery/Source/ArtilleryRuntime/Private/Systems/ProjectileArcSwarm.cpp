@@ -0,0 +1,138 @@
+﻿// Copyright 2024 Oversized Sun Inc. All Rights Reserved.
+
+#include "ProjectileArcSwarm.h"
+#include "BarrageDispatch.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
+
+void FProjectileArcSwarm::Enqueue(FAnalyticArcParams&& Params)
+{
+	if (Params.Projectile.IsValid() && Params.TicksToTarget > 0)
+	{
+		Pending.Enqueue(MoveTemp(Params));
+	}
+}
+
+void FProjectileArcSwarm::Reset()
+{
+	Pending.Empty();
+	Arcs.Empty();
+}
+
+int32 FProjectileArcSwarm::KnotTick(const FAnalyticArc& Arc, int32 Knot)
+{
+	return FMath::Min(Knot * SegmentTicks, Arc.Params.TicksToTarget);
+}
+
+void FProjectileArcSwarm::Tick(UBarrageDispatch* Physics, int32 ExpirationCounter, TArray<FSkeletonKey>& OutImpacted)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FProjectileArcSwarm::Tick)
+	FAnalyticArcParams Params;
+	while (Pending.Dequeue(Params))
+	{
+		//this is the whole trajectory. everything after this is bookkeeping.
+		FAnalyticArc& Arc = Arcs.AddDefaulted_GetRef();
+		Arc.Curve = FSimpleArcShot(Params.StartPosition, Params.ApogeeHeight, Params.TargetPosition, Params.TicksToTarget);
+		Arc.Params = MoveTemp(Params);
+		const int32 KnotCount = FMath::DivideAndRoundUp(Arc.Params.TicksToTarget, SegmentTicks) + 1;
+		Arc.Knots.SetNumUninitialized(KnotCount);
+		for (int32 Knot = 0; Knot < KnotCount; ++Knot)
+		{
+			Arc.Knots[Knot] = Arc.Curve.Get(KnotTick(Arc, Knot));
+		}
+	}
+
+	if (Physics == nullptr)
+	{
+		return;
+	}
+
+	for (int32 Index = Arcs.Num() - 1; Index >= 0; --Index)
+	{
+		FAnalyticArc& Arc = Arcs[Index];
+		if (Arc.LaunchCounter != INDEX_NONE && ExpirationCounter >= Arc.ImpactCounter)
+		{
+			if (Arc.Params.DeleteAtImpact)
+			{
+				OutImpacted.Add(Arc.Params.Projectile);
+			}
+			if (Arc.Params.OnImpact)
+			{
+				Arc.Params.OnImpact();
+			}
+			Arcs.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+
+		//the only per-tick cost for an arc in flight is the two compares above and this one.
+		const bool Launching = Arc.LaunchCounter == INDEX_NONE;
+		if (!Launching && ExpirationCounter - Arc.LaunchCounter < KnotTick(Arc, Arc.NextSegment))
+		{
+			continue;
+		}
+
+		FBLet Body = Physics->GetShapeRef(Arc.Params.Projectile);
+		if (!FBarragePrimitive::IsNotNull(Body))
+		{
+			//either it hasn't been built yet, or something else already killed it. either way, it's not ours anymore.
+			if (!Launching || ++Arc.TicksWaited > MaxTicksToWaitForBody)
+			{
+				Arcs.RemoveAtSwap(Index, EAllowShrinking::No);
+			}
+			continue;
+		}
+
+		if (Launching)
+		{
+			Arc.LaunchCounter = ExpirationCounter;
+			Arc.ImpactCounter = ExpirationCounter + Arc.Params.TicksToTarget;
+			FBarragePrimitive::SetGravityFactor(0, Body);
+		}
+
+		//a hit just pulls ImpactCounter in, and the compare at the top of the loop picks it up when it comes due.
+		StartSegment(Physics, Body, Arc);
+		++Arc.NextSegment;
+	}
+}
+
+bool FProjectileArcSwarm::StartSegment(UBarrageDispatch* Physics, const FBLet& Body, FAnalyticArc& Arc)
+{
+	const int32 Segment = Arc.NextSegment;
+	if (Segment + 1 >= Arc.Knots.Num())
+	{
+		return false;
+	}
+
+	const int32 SegmentStart = KnotTick(Arc, Segment);
+	const int32 SegmentLength = KnotTick(Arc, Segment + 1) - SegmentStart;
+	const FVector3d From = Arc.Knots[Segment];
+	const FVector3d Chord = Arc.Knots[Segment + 1] - From;
+
+	//snapping to the knot keeps chord error from accumulating across segments.
+	FBarragePrimitive::SetPosition(From, Body);
+	FBarragePrimitive::ApplyRotation(Arc.Curve.GetCurveTangent(SegmentStart).ToOrientationQuat(), Body);
+	FBarragePrimitive::SetVelocity(Chord / (SegmentLength * UBarrageDispatch::TickRateInDelta), Body);
+
+	const double ChordLength = Chord.Length();
+	if (ChordLength <= UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+	const Layers::FQueryLayerProfile& ArcLayer = Layers::QueryProfile(Arc.Params.Layer);
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter = ArcLayer.BroadPhase;
+	const JPH::ObjectLayerFilter& ObjectLayerFilter = ArcLayer.Objects;
+	const JPH::IgnoreSingleBodyFilter BodyFilter = Physics->GetFilterToIgnoreSingleBody(Body);
+	Physics->SphereCast(Arc.Params.SweepRadius, ChordLength, From, Chord / ChordLength, SweepHit, BroadPhaseFilter,
+	                    ObjectLayerFilter, BodyFilter);
+
+	if (SweepHit->MyItem != JPH::BodyID::cInvalidBodyID)
+	{
+		const double Fraction = FMath::Clamp(SweepHit->Distance / ChordLength, 0.0, 1.0);
+		const int32 HitCounter = Arc.LaunchCounter + SegmentStart + FMath::CeilToInt32(Fraction * SegmentLength);
+		if (HitCounter < Arc.ImpactCounter)
+		{
+			Arc.ImpactCounter = HitCounter;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,318 @@
+﻿// Copyright 2024 Oversized Sun Inc. All Rights Reserved.
+
+#include "ProjectileGuidanceSwarm.h"
+#include "ArtilleryDispatch.h"
+#include "ArtilleryBPLibs.h"
+#include "BarrageDispatch.h"
+#include "FBarragePrimitive.h"
+
+void FProjectileGuidanceSwarm::Enqueue(FGuidedProjectileParams&& Params)
+{
+	if (Params.Missile.IsValid())
+	{
+		Pending.Enqueue(MoveTemp(Params));
+	}
+}
+
+void FProjectileGuidanceSwarm::Reset()
+{
+	Pending.Empty();
+	MissileKeys.Empty();
+	TargetKeys.Empty();
+	FixedTargets.Empty();
+	NavConstants.Empty();
+	MaxSpeeds.Empty();
+	Accelerations.Empty();
+	FuseRadiusSq.Empty();
+	LockOnTicks.Empty();
+	TicksElapsed.Empty();
+	TicksAlive.Empty();
+	InvalidTicks.Empty();
+	Resolved.Empty();
+	ResetOnLockOn.Empty();
+	LockOnCompleted.Empty();
+	LockOnCallbacks.Empty();
+	for (TArray<float>& Lane : Lanes)
+	{
+		Lane.Empty();
+	}
+}
+
+void FProjectileGuidanceSwarm::DrainPending()
+{
+	FGuidedProjectileParams Params;
+	while (Pending.Dequeue(Params))
+	{
+		MissileKeys.Add(Params.Missile);
+		TargetKeys.Add(Params.Target);
+		FixedTargets.Add(Params.TargetPosition);
+		NavConstants.Add(Params.NavigationConstant);
+		MaxSpeeds.Add(Params.MaxSpeed);
+		Accelerations.Add(Params.Acceleration);
+		FuseRadiusSq.Add(Params.ProximityFuseRadius * Params.ProximityFuseRadius);
+		LockOnTicks.Add(Params.LockOnTicks);
+		TicksElapsed.Add(0);
+		TicksAlive.Add(Params.TicksAliveTime);
+		InvalidTicks.Add(0);
+		Resolved.Add(false);
+		ResetOnLockOn.Add(Params.ResetVelocityOnLockOn);
+		LockOnCompleted.Add(false);
+		LockOnCallbacks.Add(MoveTemp(Params.LockOnCompleteCallback));
+	}
+}
+
+void FProjectileGuidanceSwarm::RemoveAtSwap(int32 Index)
+{
+	MissileKeys.RemoveAtSwap(Index, EAllowShrinking::No);
+	TargetKeys.RemoveAtSwap(Index, EAllowShrinking::No);
+	FixedTargets.RemoveAtSwap(Index, EAllowShrinking::No);
+	NavConstants.RemoveAtSwap(Index, EAllowShrinking::No);
+	MaxSpeeds.RemoveAtSwap(Index, EAllowShrinking::No);
+	Accelerations.RemoveAtSwap(Index, EAllowShrinking::No);
+	FuseRadiusSq.RemoveAtSwap(Index, EAllowShrinking::No);
+	LockOnTicks.RemoveAtSwap(Index, EAllowShrinking::No);
+	TicksElapsed.RemoveAtSwap(Index, EAllowShrinking::No);
+	TicksAlive.RemoveAtSwap(Index, EAllowShrinking::No);
+	InvalidTicks.RemoveAtSwap(Index, EAllowShrinking::No);
+	Resolved.RemoveAtSwap(Index, EAllowShrinking::No);
+	ResetOnLockOn.RemoveAtSwap(Index, EAllowShrinking::No);
+	LockOnCompleted.RemoveAtSwap(Index, EAllowShrinking::No);
+	LockOnCallbacks.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+void FProjectileGuidanceSwarm::Tick(UArtilleryDispatch* Dispatch)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FProjectileGuidanceSwarm::Tick)
+	DrainPending();
+	if (Dispatch == nullptr || MissileKeys.IsEmpty())
+	{
+		return;
+	}
+	const int32 Padded = Align(MissileKeys.Num(), LaneBlock);
+	Gather(Dispatch, Padded);
+	Solve(Lanes, Padded);
+	Emit();
+}
+
+//one resolve for the missiles, one for the targets, then one read per body. this is the only part of the tick that
+//touches jolt on the way in, and it's the part that used to be four lookups per missile.
+void FProjectileGuidanceSwarm::Gather(UArtilleryDispatch* Dispatch, int32 Padded)
+{
+	const int32 Count = MissileKeys.Num();
+	ResolvedMissiles.SetNumUninitialized(Count, EAllowShrinking::No);
+	ResolvedTargets.SetNumUninitialized(Count, EAllowShrinking::No);
+	Dispatch->ResolveFBLets(MissileKeys, ResolvedMissiles);
+	Dispatch->ResolveFBLets(TargetKeys, ResolvedTargets);
+
+	for (TArray<float>& Lane : Lanes)
+	{
+		Lane.SetNumUninitialized(Padded, EAllowShrinking::No);
+		//the tail is all zeroes, which the solver is happy to chew on and emit never reads.
+		FMemory::Memzero(Lane.GetData() + Count, (Padded - Count) * sizeof(float));
+	}
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FBarragePrimitive* Missile = ResolvedMissiles[Index];
+		if (Missile == nullptr)
+		{
+			for (TArray<float>& Lane : Lanes)
+			{
+				Lane[Index] = 0.f;
+			}
+			continue;
+		}
+
+		const FVector3f Position = FBarragePrimitive::GetPosition(Missile);
+		const FVector3f Velocity = FBarragePrimitive::GetVelocity(Missile);
+		bool Guiding = TicksElapsed[Index] >= LockOnTicks[Index];
+		if (Guiding && LockOnCallbacks[Index] != nullptr)
+		{
+			LockOnCallbacks[Index](MissileKeys[Index]);
+			LockOnCallbacks[Index] = nullptr;
+		}
+
+		FVector3f TargetLocation = FixedTargets[Index];
+		FVector3f TargetVelocity = FVector3f::ZeroVector;
+		if (TargetKeys[Index].IsValid())
+		{
+			if (const FBarragePrimitive* Target = ResolvedTargets[Index])
+			{
+				TargetLocation = FBarragePrimitive::GetPosition(Target);
+				TargetVelocity = FBarragePrimitive::GetVelocity(Target);
+			}
+			else
+			{
+				//target's gone. fly straight rather than chase a NaN.
+				TargetLocation = Position;
+				TargetVelocity = Velocity;
+				Guiding = false;
+			}
+		}
+
+		float KeepVelocity = 1.f;
+		if (TicksElapsed[Index] > LockOnTicks[Index] && !LockOnCompleted[Index])
+		{
+			KeepVelocity = ResetOnLockOn[Index] ? 0.f : 1.f;
+			LockOnCompleted[Index] = true;
+		}
+
+		Lanes[PX][Index] = Position.X;
+		Lanes[PY][Index] = Position.Y;
+		Lanes[PZ][Index] = Position.Z;
+		Lanes[VX][Index] = Velocity.X;
+		Lanes[VY][Index] = Velocity.Y;
+		Lanes[VZ][Index] = Velocity.Z;
+		Lanes[TX][Index] = TargetLocation.X;
+		Lanes[TY][Index] = TargetLocation.Y;
+		Lanes[TZ][Index] = TargetLocation.Z;
+		Lanes[TVX][Index] = TargetVelocity.X;
+		Lanes[TVY][Index] = TargetVelocity.Y;
+		Lanes[TVZ][Index] = TargetVelocity.Z;
+		Lanes[Nav][Index] = Guiding ? NavConstants[Index] : 0.f;
+		Lanes[Speed][Index] = MaxSpeeds[Index];
+		Lanes[Accel][Index] = Accelerations[Index];
+		Lanes[Keep][Index] = KeepVelocity;
+	}
+}
+
+//the same math as FTProportionalNavigation, calculate and apply both, just in lanes.
+//a LaneBlock is two quads of the engine's 4-wide registers, so this runs on SSE and NEON alike.
+void FProjectileGuidanceSwarm::Solve(TArray<float> (&Lanes)[LaneCount], int32 Padded)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FProjectileGuidanceSwarm::Solve)
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Epsilon = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+	const VectorRegister4Float Dt = VectorSetFloat1(UBarrageDispatch::TickRateInDelta);
+
+	for (int32 Block = 0; Block < Padded; Block += LaneBlock)
+	{
+		for (int32 I = Block; I < Block + LaneBlock; I += 4)
+		{
+			auto Load = [&Lanes, I](ELane Lane) { return VectorLoad(Lanes[Lane].GetData() + I); };
+			const VectorRegister4Float Px = Load(PX), Py = Load(PY), Pz = Load(PZ);
+			const VectorRegister4Float Vx = Load(VX), Vy = Load(VY), Vz = Load(VZ);
+
+			const VectorRegister4Float Rx = VectorSubtract(Load(TX), Px);
+			const VectorRegister4Float Ry = VectorSubtract(Load(TY), Py);
+			const VectorRegister4Float Rz = VectorSubtract(Load(TZ), Pz);
+			const VectorRegister4Float RelX = VectorSubtract(Load(TVX), Vx);
+			const VectorRegister4Float RelY = VectorSubtract(Load(TVY), Vy);
+			const VectorRegister4Float RelZ = VectorSubtract(Load(TVZ), Vz);
+
+			const VectorRegister4Float RangeSquared = VectorMultiplyAdd(Rz, Rz, VectorMultiplyAdd(Ry, Ry, VectorMultiply(Rx, Rx)));
+			const VectorRegister4Float InvRange = VectorDivide(One, VectorMax(RangeSquared, Epsilon));
+
+			//line of sight rotation: (r x v_rel) / |r|^2
+			const VectorRegister4Float RotX = VectorMultiply(VectorNegateMultiplyAdd(Rz, RelY, VectorMultiply(Ry, RelZ)), InvRange);
+			const VectorRegister4Float RotY = VectorMultiply(VectorNegateMultiplyAdd(Rx, RelZ, VectorMultiply(Rz, RelX)), InvRange);
+			const VectorRegister4Float RotZ = VectorMultiply(VectorNegateMultiplyAdd(Ry, RelX, VectorMultiply(Rx, RelY)), InvRange);
+
+			//commanded acceleration: N * (v_rel x rot). Nav is zeroed for lanes that aren't locked on yet.
+			const VectorRegister4Float N = Load(Nav);
+			const VectorRegister4Float Ax = VectorMultiply(N, VectorNegateMultiplyAdd(RelZ, RotY, VectorMultiply(RelY, RotZ)));
+			const VectorRegister4Float Ay = VectorMultiply(N, VectorNegateMultiplyAdd(RelX, RotZ, VectorMultiply(RelZ, RotX)));
+			const VectorRegister4Float Az = VectorMultiply(N, VectorNegateMultiplyAdd(RelY, RotX, VectorMultiply(RelX, RotY)));
+
+			const VectorRegister4Float KeepMask = Load(Keep);
+			const VectorRegister4Float Cx = VectorMultiply(Vx, KeepMask);
+			const VectorRegister4Float Cy = VectorMultiply(Vy, KeepMask);
+			const VectorRegister4Float Cz = VectorMultiply(Vz, KeepMask);
+
+			//thrust along the current heading, GetSafeNormal style: zero velocity means zero thrust.
+			const VectorRegister4Float CurrentSpeed = VectorSqrt(VectorMultiplyAdd(Cz, Cz, VectorMultiplyAdd(Cy, Cy, VectorMultiply(Cx, Cx))));
+			const VectorRegister4Float Thrust = VectorSelect(
+				VectorCompareGT(CurrentSpeed, Epsilon),
+				VectorDivide(Load(Accel), VectorMax(CurrentSpeed, Epsilon)),
+				Zero);
+
+			VectorRegister4Float Nx = VectorMultiplyAdd(VectorMultiplyAdd(Cx, Thrust, Ax), Dt, Cx);
+			VectorRegister4Float Ny = VectorMultiplyAdd(VectorMultiplyAdd(Cy, Thrust, Ay), Dt, Cy);
+			VectorRegister4Float Nz = VectorMultiplyAdd(VectorMultiplyAdd(Cz, Thrust, Az), Dt, Cz);
+
+			//GetClampedToSize(0, MaxSpeed)
+			const VectorRegister4Float MaxSpeed = Load(Speed);
+			const VectorRegister4Float NewSpeed = VectorSqrt(VectorMultiplyAdd(Nz, Nz, VectorMultiplyAdd(Ny, Ny, VectorMultiply(Nx, Nx))));
+			const VectorRegister4Float Clamp = VectorSelect(
+				VectorCompareGT(NewSpeed, MaxSpeed),
+				VectorDivide(MaxSpeed, VectorMax(NewSpeed, Epsilon)),
+				One);
+			Nx = VectorMultiply(Nx, Clamp);
+			Ny = VectorMultiply(Ny, Clamp);
+			Nz = VectorMultiply(Nz, Clamp);
+
+			VectorStore(Nx, Lanes[NVX].GetData() + I);
+			VectorStore(Ny, Lanes[NVY].GetData() + I);
+			VectorStore(Nz, Lanes[NVZ].GetData() + I);
+			VectorStore(RangeSquared, Lanes[RangeSq].GetData() + I);
+		}
+	}
+}
+
+void FProjectileGuidanceSwarm::Emit()
+{
+	const int32 Count = MissileKeys.Num();
+	VelocityTargets.Reset();
+	Velocities.Reset();
+	FacingTargets.Reset();
+	Facings.Reset();
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FBarragePrimitive* Missile = ResolvedMissiles[Index];
+		if (Missile == nullptr)
+		{
+			++InvalidTicks[Index];
+			++TicksElapsed[Index];
+			continue;
+		}
+		InvalidTicks[Index] = 0;
+		Resolved[Index] = true;
+
+		const bool HasTarget = TargetKeys[Index].IsValid();
+		const bool Guiding = TicksElapsed[Index] >= LockOnTicks[Index] && (!HasTarget || ResolvedTargets[Index] != nullptr);
+		if (Guiding && Lanes[RangeSq][Index] < FuseRadiusSq[Index])
+		{
+			if (HasTarget)
+			{
+				//begin collision nudge
+				VelocityTargets.Add(Missile);
+				Velocities.Add(FVector3d(
+					Lanes[TX][Index] - Lanes[PX][Index] + Lanes[TVX][Index],
+					Lanes[TY][Index] - Lanes[PY][Index] + Lanes[TVY][Index],
+					Lanes[TZ][Index] - Lanes[PZ][Index] + Lanes[TVZ][Index]));
+			}
+		}
+		else
+		{
+			// Only apply velocity changes for nav if lock on time is elapsed
+			if (TicksElapsed[Index] > LockOnTicks[Index])
+			{
+				VelocityTargets.Add(Missile);
+				Velocities.Add(FVector3d(Lanes[NVX][Index], Lanes[NVY][Index], Lanes[NVZ][Index]));
+			}
+			const FVector3d Heading(
+				Lanes[VX][Index] * Lanes[Keep][Index],
+				Lanes[VY][Index] * Lanes[Keep][Index],
+				Lanes[VZ][Index] * Lanes[Keep][Index]);
+			FacingTargets.Add(Missile);
+			Facings.Add(Heading.ToOrientationQuat());
+		}
+		++TicksElapsed[Index];
+	}
+
+	FBarragePrimitive::SetVelocities(VelocityTargets, Velocities);
+	FBarragePrimitive::ApplyRotations(FacingTargets, Facings);
+
+	//backwards, so the swap doesn't skip anyone.
+	for (int32 Index = Count - 1; Index >= 0; --Index)
+	{
+		if (TicksElapsed[Index] > TicksAlive[Index]
+			|| InvalidTicks[Index] > (Resolved[Index] ? MaxConsecutiveInvalidTicks : MaxTicksToWaitForBody))
+		{
+			UArtilleryLibrary::TombstonePrimitive(MissileKeys[Index]);
+			RemoveAtSwap(Index);
+		}
+	}
+}
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include "FArtilleryTimerWheel.h"
+#include <atomic>
 #include "TimerTickliteHandlerComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTickliteTick, int32, TicksRemaining);
@@ -15,6 +17,10 @@ public:
 	
 	
 	void TickliteExpired();
+	//puts the countdown on the artillery timer wheel. the wheel only flags expiry, and we broadcast it from our own tick,
+	//so the delegates stay on the game thread.
+	void StartTimer(int32 LifetimeInTicks);
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
@@ -31,4 +37,7 @@ private:
 	
 	int32 TicksRemaining;
 	bool FlaggedForDelete;
+	uint64 ExpiresAt = 0;
+	FArtilleryTimerId TimerId = 0;
+	TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> TimerFired;
 };
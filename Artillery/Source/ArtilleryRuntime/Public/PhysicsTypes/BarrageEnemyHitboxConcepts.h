@@ -24,54 +24,19 @@
 #define UNSAFE_GET_MESH_PTR auto MeshPtr = StaticMeshRef ? StaticMeshRef : Cast<UStaticMeshComponent, USceneComponent>(GetChildComponent(0));
 
 /////////////////////////////////////////////////////////////////////////////
-//////// Hitbox ticklites
+//////// Hitbox movement
 //////////////////////////////////////////////////////////////////////////
 ///
-// these all are basically actually ticklites that guarantee they will only interact with sim state.
-struct FTickHitbox : public FTickECSOnly
-{
-	FSkeletonKey MyParentObjectKey;
-	FVector MyRelativePosition = FVector::ZeroVector;
-	//relative position is unused while debugging.
-	explicit FTickHitbox(FSkeletonKey TargetIn, FSkeletonKey Parent, FVector RelPos = {0, 0, 0})
-		: FTickECSOnly(TargetIn)
-	{
-		MyParentObjectKey = Parent;
-		MyRelativePosition = RelPos;
-	}
-
-	FTickHitbox() = default;
-
-	//hi so look, this is gonna LOOK bugged. you might wonder why we aren't actually using any offsets here, and why we rotate
-	// the shape itself. We actually perform a translation and rotation during SHAPE CREATION that moves the mesh around.
-	// Because we didn't then do our correct rotations HERE, we were basically trailing our collision underground and stuff got SUPER
-	// SUPER dorked up since we double applied translation. among other things.
-
-	//so what we do is translate and rotate at creation. THEN we reposition the hitmesh to the absolute pos and rot of the parent.
-	//the rotatedandtranslated shape that we're using in jolt preserves our initial offsets, effectively, our relative position.
-	virtual void ArtilleryTick(uint64_t TicksSoFar) override
-	{
-		if (ADispatch)
-		{
-			FBLet ParentPhysicsObject = ADispatch->GetFBLetByObjectKey(MyParentObjectKey, ADispatch->GetShadowNow());
-			FBLet PhysicsObject = ADispatch->GetFBLetByObjectKey(Target, ADispatch->GetShadowNow());
-
-			if (ParentPhysicsObject && PhysicsObject)
-			{
-				auto ParentPosition = FBarragePrimitive::GetPosition(ParentPhysicsObject);
-
-				auto TempRot = FBarragePrimitive::OptimisticGetAbsoluteRotation(ParentPhysicsObject);
-				FBarragePrimitive::SetPosition(
-					FVector(ParentPosition), // so many unnecessary copies, god, sorry.
-					PhysicsObject
-				);
-				FBarragePrimitive::ApplyRotation(TempRot, PhysicsObject);
-			}
-		}
-	}
-};
-
-typedef Ticklites::Ticklite<FTickHitbox> StartHitboxMovement;
+// hitboxes used to drive themselves with one ticklite apiece. now they register with barrage's follower set,
+// which copies the parent pose onto every child in one batch during StackUp. see FBarrageHitboxFollowers.
+//
+// hi so look, this is gonna LOOK bugged. you might wonder why we pass zero offsets, and why we rotate
+// the shape itself. We actually perform a translation and rotation during SHAPE CREATION that moves the mesh around.
+// Because we didn't then do our correct rotations afterwards, we were basically trailing our collision underground and stuff got SUPER
+// SUPER dorked up since we double applied translation. among other things.
+//
+// so what we do is translate and rotate at creation. THEN we reposition the hitmesh to the absolute pos and rot of the parent.
+// the rotatedandtranslated shape that we're using in jolt preserves our initial offsets, effectively, our relative position.
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -372,10 +337,9 @@ inline bool UBarrageSimpleEnemyHitbox::RegistrationImplementation()
 	if (IKeyedConstruct::IsReady)
 	{
 		PrimaryComponentTick.SetTickFunctionEnable(false);
-		//This starts a ticklite that lives as long as the key of the collider.
+		//This follows the parent for as long as the key of the collider lives.
 		//these colliders can actually have different lifespans compared to the parent entity
-		StructureFullTL(HBTl, StartHitboxMovement, FTickHitbox, GetMyKey(), MyParentObjectKey, {0, 0, 0});
-		this->ADispatch->RequestAddTicklite(HBTl, Early);
+		GetWorld()->GetSubsystem<UBarrageDispatch>()->FollowParent(GetMyKey(), MyParentObjectKey);
 		ADispatch->AddTagToEntity(GetMyKey(), FGameplayTag::RequestGameplayTag("Enemy"));
 		return true;
 	}
@@ -530,8 +494,8 @@ inline bool UBarrageDependentEnemyHitbox::RegistrationImplementation()
 
 	if (IKeyedConstruct::IsReady)
 	{
-		StructureFullTL(TickLaunchable, StartHitboxMovement,FTickHitbox, GetMyKey(), MyParentObjectKey, MyRelativePosition);
-		this->ADispatch->RequestAddTicklite( TickLaunchable, Early);
+		//the relative position went into the shape, so no offset here.
+		GetWorld()->GetSubsystem<UBarrageDispatch>()->FollowParent(GetMyKey(), MyParentObjectKey);
 		ADispatch->AddTagToEntity(GetMyKey(), FGameplayTag::RequestGameplayTag("Enemy"));
 		return true;
 	}
@@ -7,6 +7,8 @@
 #include "BarrageDispatch.h"
 #include "SkeletonTypes.h"
 #include "KeyCarry.h"
+#include "IsolatedJoltIncludes.h"
+#include "Jolt/Physics/Ragdoll/Ragdoll.h"
 #include "Components/ActorComponent.h"
 #include "BarrageStaticAutoMesh.generated.h"
 
@@ -19,4 +21,9 @@ public:
 	// Sets default values for this component's properties
 	UBarrageStaticAutoMesh(const FObjectInitializer& ObjectInitializer);
 	virtual bool RegistrationImplementation() override;
+	virtual void OnDestroyPhysicsState() override;
+
+private:
+	//from the sim's ragdoll pool, and back into it when we go.
+	JPH::Ref<JPH::Ragdoll> MyRagdoll;
 };
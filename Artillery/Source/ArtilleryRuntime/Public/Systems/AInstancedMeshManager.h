@@ -122,6 +122,29 @@ public:
 		return NewInstanceKey;
 	}
 
+	//no body at all. barrage sweeps it after every step, the instance is drawn wherever the sweep says it is, and hits
+	//come back as swept contacts. it's retired after LifetimeSeconds if it hasn't hit anything.
+	FSkeletonKey CreateNewSweptInstance(const FTransform& WorldTransform, const FVector3d& MuzzleVelocity, const uint16_t Layer, float Scale, FSkeletonKey ExistingKey, float LifetimeSeconds)
+	{
+		FSkeletonKey NewInstanceKey = (ExistingKey == FSkeletonKey::Invalid()) ? GenerateNewProjectileKey() : ExistingKey;
+		FTransform ScaledTransform(MuzzleVelocity.GetSafeNormal().Rotation(),WorldTransform.GetLocation(), FVector3d(Scale, Scale, Scale));
+		FPrimitiveInstanceId NewInstanceId = SwarmKineManager->AddInstanceById(ScaledTransform, true);
+		SwarmKineManager->AddToMapDbg(NewInstanceId, NewInstanceKey);
+		TransformDispatch->RegisterObjectToShadowTransform(NewInstanceKey, SwarmKineManager);
+
+		//the same box CreateNewInstanceWithKeyInternal builds, swept as a sphere as wide as its thinnest side.
+		FVector extents = SwarmKineManager->GetStaticMesh()->GetBounds().GetBox().GetExtent() * 2 * Scale;
+		FBarrageSweptProjectileParams Params;
+		Params.Projectile = NewInstanceKey;
+		Params.Origin = WorldTransform.GetLocation();
+		Params.Velocity = MuzzleVelocity;
+		Params.Radius = CoordinateUtils::RadiusToJolt(extents.GetMin() / 2);
+		Params.Layer = static_cast<Layers::EJoltPhysicsLayer>(Layer);
+		Params.MaxLifetime = LifetimeSeconds;
+		GetWorld()->GetSubsystem<UBarrageDispatch>()->SweepProjectile(Params);
+		return NewInstanceKey;
+	}
+
 	//TODO: this really really really should return a fblet or a kine OR make it impossible to get a FBlet or kine for that scene component.
 	//we do not ever want scene components that are managed in two or more ways.
 	TWeakObjectPtr<USceneComponent> GetSceneComponentForInstance(const FSkeletonKey InstanceKey)
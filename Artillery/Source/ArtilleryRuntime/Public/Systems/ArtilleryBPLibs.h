@@ -540,7 +540,9 @@ public:
 			ArtilleryTime Now = UArtilleryDispatch::SelfPtr->GetShadowNow();
 			FBLet Prim = UArtilleryDispatch::SelfPtr->GetFBLetByObjectKey(Target, Now);
 			UArtilleryDispatch::SelfPtr->DeregisterGameplayTags(Target); //release tags if any.
-			if (Prim && Prim->Me == FBShape::Projectile)
+			//swept projectiles have no primitive at all.
+			if ((Prim && Prim->Me == FBShape::Projectile)
+				|| (!Prim && UArtilleryProjectileDispatch::SelfPtr && UArtilleryProjectileDispatch::SelfPtr->IsArtilleryProjectile(Target)))
 			{
 				UArtilleryProjectileDispatch::SelfPtr->DeleteProjectile(Target); // quite a bit extra has to happen, but it does all happen.
 			}
@@ -569,8 +571,7 @@ public:
 		}
 
 		UTimerTickliteHandlerComponent* TimerComponent = Cast<UTimerTickliteHandlerComponent>(NewTimerTickliteComponent);
-		StructureFullTL(TimerTicklite, TL_Timer, FTTimer, TimerComponent, LifetimeInTicks);
-		UArtilleryDispatch::SelfPtr->RequestAddTicklite(TimerTicklite, Early);
+		TimerComponent->StartTimer(LifetimeInTicks);
 		return TimerComponent;
 	}
 
@@ -137,6 +137,22 @@ public:
 	void REGISTER_GUN_FINAL_TICK_RESOLVER(const FGunKey& Self, const FArtilleryGun* ExistCheck);
 	void INITIATE_JUMP_TIMER(const FSkeletonKey& Self);
 	void Bop(FSkeletonKey Target, uint16 TicksFromNow, FVector ForceAppliedOnce, PhysicsInputType ForceType = PhysicsInputType::OtherForce);
+
+	//one-shot callbacks on the artillery tick, run at the top of the ticklite apply phase. prefer these to a ticklite
+	//that does nothing but count down. safe from any thread. the callback runs on the ticklite worker.
+	FArtilleryTimerId ScheduleTimer(uint32 TicksFromNow, TFunction<void()>&& OnExpire)
+	{
+		return ArtilleryTicklitesWorker_LockstepToWorldSim.Timers.Schedule(TicksFromNow, MoveTemp(OnExpire));
+	}
+	void CancelTimer(FArtilleryTimerId Timer)
+	{
+		ArtilleryTicklitesWorker_LockstepToWorldSim.Timers.Cancel(Timer);
+	}
+	//apply phases the wheel has seen. this is the clock ScheduleTimer counts against.
+	uint64 GetTimerNow() const
+	{
+		return ArtilleryTicklitesWorker_LockstepToWorldSim.Timers.Now();
+	}
 	
 	//Forwarding for the TickliteThread.
 	TOptional<FTransform> GetTransformShadowByObjectKey(const FSkeletonKey& Target, ArtilleryTime Now) const
@@ -166,6 +182,8 @@ public:
 	}
 	
 	FBLet GetFBLetByObjectKey(FSkeletonKey Target, ArtilleryTime Now);
+	//non-owning, tick-scoped batch variant. see UBarrageDispatch::ResolveFBLets for the rules.
+	int32 ResolveFBLets(TConstArrayView<FSkeletonKey> Targets, TArrayView<FBarragePrimitive*> OutPrimitives) const;
 
 	//Executes necessary preconfiguration for threads owned by this dispatch. Likely going to be factored into the
 	//dispatch API so that we can use stronger type guarantees throughout our codebase.
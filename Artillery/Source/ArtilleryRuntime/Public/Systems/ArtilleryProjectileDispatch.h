@@ -7,6 +7,8 @@
 #include "AInstancedMeshManager.h"
 #include "FProjectileDefinitionRow.h"
 #include "Structures/ParallelFixedQueueTypes.h"
+#include "ProjectileGuidanceSwarm.h"
+#include "ProjectileArcSwarm.h"
 //look, it's important that you wrap both your typedefs and your lib include in these, and that the lib include always be explicit.
 //lbc is a header only lib. this has some pretty stark implications. we probably need to move ALL type defs and ALL
 //includes into a Lbc module, isolate them, and compile them.
@@ -54,6 +56,13 @@ public:
 	friend class UArtilleryLibrary;
 	static inline UArtilleryProjectileDispatch* SelfPtr = nullptr;
 	int DEFAULT_LIFE_OF_PROJECTILE = ArtilleryTickHertz * 20.0; //20 seconds.
+	//UE units a second. past this, a projectile that can expire gets swept by barrage instead of getting a body.
+	//200m/s is well over a meter a tick, which a body would need a LinearCast to not tunnel through anyway.
+	static constexpr double SweptProjectileMinSpeed = 20000.0;
+	//a swept shot has no body, so nothing can run into it, and it only finds what its own layer looks for. antimissile is
+	//two projectiles colliding, so a shot on any layer that touches a projectile layer, either way around, keeps its body
+	//no matter how fast it is. that's ENEMY today; PROJECTILE and ENEMYPROJECTILE don't touch each other.
+	static bool CanSweepOnLayer(Layers::EJoltPhysicsLayer Layer);
 	constexpr static int OrdinateSeqKey = ORDIN::E_D_C::ProjectileSystem;
 	
 	virtual void ArtilleryTick() override;
@@ -79,6 +88,8 @@ protected:
 	TSharedPtr<TMap<FName, TWeakObjectPtr<AInstancedMeshManager>>> ProjectileNameToMeshManagerMapping;
 	TSharedPtr<TMap<FString, TWeakObjectPtr<AInstancedMeshManager>>> MeshAssetToMeshManagerMapping;
 	TSharedPtr<KeyToGunMap> ProjectileToGunMapping;
+	FProjectileGuidanceSwarm GuidanceSwarm;
+	FProjectileArcSwarm ArcSwarm;
 
 public:
 	virtual void PostInitialize() override;
@@ -94,10 +105,18 @@ public:
 	FSkeletonKey CreateProjectileInstance(FSkeletonKey ProjectileKey,  FGunKey Gun, const FName ProjectileDefinitionId, const FTransform& WorldTransform, const FVector3d& MuzzleVelocity, const float Scale = 1.0f, const bool IsSensor = true, const bool IsDynamic = false, Layers::EJoltPhysicsLayer Layer = Layers::PROJECTILE, const bool CanExpire = true, const int LifeInTicks = -1);
 	bool IsArtilleryProjectile(const FSkeletonKey MaybeProjectile);
 	void DeleteProjectile(const FSkeletonKey Target);
+	//hands a projectile to the batched PN solver. prefer this over a TL_ProportionalNavigation per rocket for volleys.
+	//safe from any thread; picked up on the next ArtilleryTick. the projectile is tombstoned when guidance expires.
+	void GuideProjectile(FGuidedProjectileParams&& Params);
+	//analytic alternative to TL_ArcingProjectile. solved once, swept per segment, deleted at impact.
+	//safe from any thread; the projectile may still be in the request router when you call this.
+	void LaunchArc(FAnalyticArcParams&& Params);
 	TWeakObjectPtr<AInstancedMeshManager> GetProjectileMeshManagerByManagerKey(const FSkeletonKey ManagerKey);
 	TWeakObjectPtr<AInstancedMeshManager> GetProjectileMeshManagerByProjectileKey(const FSkeletonKey ProjectileKey);
 	TWeakObjectPtr<USceneComponent> GetSceneComponentForProjectile(const FSkeletonKey ProjectileKey);
 
+	//bound to the batch delegate. hands each projectile hit in the batch to OnBarrageContactAdded.
+	void OnBarrageContactBatch(const FBarrageContactBatch& Batch);
 	void OnBarrageContactAdded(const BarrageContactEvent& ContactEvent);
 
 private:
@@ -0,0 +1,76 @@
+﻿// Copyright 2024 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkeletonTypes.h"
+#include "FArcShot.h"
+#include "EPhysicsLayer.h"
+#include "FBarragePrimitive.h"
+#include "Containers/Queue.h"
+#include <functional>
+
+class UBarrageDispatch;
+
+struct FAnalyticArcParams
+{
+	FSkeletonKey Projectile;
+	FVector3d StartPosition = FVector3d::ZeroVector;
+	FVector3d TargetPosition = FVector3d::ZeroVector;
+	int32 TicksToTarget = 0;
+	double ApogeeHeight = 0.0;
+	//jolt units, same as FTSphereCast.
+	float SweepRadius = 0.1f;
+	Layers::EJoltPhysicsLayer Layer = Layers::ENEMYPROJECTILE;
+	bool DeleteAtImpact = true;
+	std::function<void()> OnImpact = nullptr;
+};
+
+//FTArcingProjectile, minus the ticklite. That one evaluates the curve and pushes a SetPosition and a rotation every
+//single tick for every single shell, which is a lot of applies for a mortar barrage that's fully determined at launch.
+//
+//Here the arc is solved once when the shell is first seen, into knots every SegmentTicks along the curve.
+//At each knot we snap the body onto the curve, point it along the tangent, give it the chord velocity with gravity off,
+//and sweep the chord for anything in the way. Between knots, nobody touches it. The impact tick is the end of the arc,
+//or wherever the first sweep hit lands. On that tick the shell is handed back to the projectile dispatch, which deletes it
+//the same way the ticklite does, instanced mesh and particles included.
+//
+//Enqueue is safe from any thread. Tick belongs to the projectile dispatch's ArtilleryTick, which is the busy worker.
+class ARTILLERYRUNTIME_API FProjectileArcSwarm
+{
+public:
+	//8 ticks at 120hz is ~66ms of chord. short enough that the chord hugs a mortar arc, long enough to matter.
+	static constexpr int32 SegmentTicks = 8;
+	//projectile bodies are created through the request router, so the key may not resolve for a few ticks.
+	static constexpr int32 MaxTicksToWaitForBody = 16;
+
+	void Enqueue(FAnalyticArcParams&& Params);
+	//shells that reached their impact tick with DeleteAtImpact set are appended to OutImpacted. deleting them is on the caller.
+	void Tick(UBarrageDispatch* Physics, int32 ExpirationCounter, TArray<FSkeletonKey>& OutImpacted);
+	void Reset();
+	int32 Num() const
+	{
+		return Arcs.Num();
+	}
+
+private:
+	struct FAnalyticArc
+	{
+		FAnalyticArcParams Params;
+		FSimpleArcShot Curve;
+		//Knots[i] is the curve at i * SegmentTicks, with the last knot clamped to the target tick.
+		TArray<FVector3d, TInlineAllocator<24>> Knots;
+		int32 LaunchCounter = INDEX_NONE;
+		int32 ImpactCounter = INDEX_NONE;
+		int32 NextSegment = 0;
+		int32 TicksWaited = 0;
+	};
+
+	static int32 KnotTick(const FAnalyticArc& Arc, int32 Knot);
+	//returns true if the sweep found something, in which case the impact tick has moved up.
+	bool StartSegment(UBarrageDispatch* Physics, const FBLet& Body, FAnalyticArc& Arc);
+
+	TQueue<FAnalyticArcParams, EQueueMode::Mpsc> Pending;
+	TArray<FAnalyticArc> Arcs;
+	TSharedPtr<FHitResult> SweepHit = MakeShared<FHitResult>();
+};
@@ -0,0 +1,107 @@
+﻿// Copyright 2024 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkeletonTypes.h"
+#include "Containers/Queue.h"
+#include <functional>
+
+class UArtilleryDispatch;
+class FBarragePrimitive;
+
+//same knobs as FTProportionalNavigation, so moving a gun from one to the other is a copy-paste job.
+struct FGuidedProjectileParams
+{
+	FSkeletonKey Missile;
+	// If Target is invalid, TargetPosition is used instead as a fixed point
+	FSkeletonKey Target;
+	FVector3f TargetPosition = FVector3f::ZeroVector;
+	float MaxSpeed = 0.f;
+	float Acceleration = 0.f;
+	float NavigationConstant = 3.f; // Usually 3
+	float ProximityFuseRadius = 0.25f;
+	int32 LockOnTicks = 1; // # of ticks to wait before starting nav
+	int32 TicksAliveTime = 900;
+	bool ResetVelocityOnLockOn = false;
+	std::function<void(FSkeletonKey)> LockOnCompleteCallback = nullptr;
+};
+
+//Proportional navigation for the whole volley at once. FTProportionalNavigation is fine for a handful of missiles,
+//but every instance does its own lookups, its own scalar math, and its own enqueues, and a launcher that dumps 200
+//tracking rockets turns that into milliseconds. This keeps every live guided projectile in SoA lanes, resolves all
+//the keys in two batch calls, runs the PN math eight lanes at a time on the engine's vector registers,
+//and emits the whole volley's velocity and facing changes as one batched input group.
+//
+//Enqueue is safe from any thread. Everything else belongs to whoever ticks it, which is currently the busy worker
+//by way of UArtilleryProjectileDispatch::ArtilleryTick. Results land in the next StackUp, same as the ticklite.
+class ARTILLERYRUNTIME_API FProjectileGuidanceSwarm
+{
+public:
+	static constexpr int32 LaneBlock = 8;
+	//matches FTProportionalNavigation's tolerance for the missile key going dark before we give up on it.
+	static constexpr uint8 MaxConsecutiveInvalidTicks = 4;
+	//projectile bodies are created through the request router, so a fresh key may not resolve for a few ticks.
+	static constexpr uint8 MaxTicksToWaitForBody = 16;
+
+	void Enqueue(FGuidedProjectileParams&& Params);
+	void Tick(UArtilleryDispatch* Dispatch);
+	void Reset();
+	int32 Num() const
+	{
+		return MissileKeys.Num();
+	}
+
+	//one float per projectile per lane, rebuilt every tick and padded to LaneBlock so the solver never needs a scalar
+	//tail. the state lanes go in, the NV and RangeSq lanes come out.
+	enum ELane : uint8
+	{
+		PX, PY, PZ,
+		VX, VY, VZ,
+		TX, TY, TZ,
+		TVX, TVY, TVZ,
+		Nav,
+		Speed,
+		Accel,
+		Keep,
+		NVX, NVY, NVZ,
+		RangeSq,
+		LaneCount
+	};
+	//one PN step for every lane. touches nothing but the lanes, so it can be driven without a world.
+	static void Solve(TArray<float> (&Lanes)[LaneCount], int32 Padded);
+
+private:
+	void DrainPending();
+	void Gather(UArtilleryDispatch* Dispatch, int32 Padded);
+	void Emit();
+	void RemoveAtSwap(int32 Index);
+
+	TQueue<FGuidedProjectileParams, EQueueMode::Mpsc> Pending;
+
+	//persistent lanes, one entry per live guided projectile.
+	TArray<FSkeletonKey> MissileKeys;
+	TArray<FSkeletonKey> TargetKeys;
+	TArray<FVector3f> FixedTargets;
+	TArray<float> NavConstants;
+	TArray<float> MaxSpeeds;
+	TArray<float> Accelerations;
+	TArray<float> FuseRadiusSq;
+	TArray<int32> LockOnTicks;
+	TArray<int32> TicksElapsed;
+	TArray<int32> TicksAlive;
+	TArray<uint8> InvalidTicks;
+	TArray<bool> Resolved;
+	TArray<bool> ResetOnLockOn;
+	TArray<bool> LockOnCompleted;
+	TArray<std::function<void(FSkeletonKey)>> LockOnCallbacks;
+
+	//scratch, kept around so a steady state allocates nothing.
+	TArray<float> Lanes[LaneCount];
+	TArray<FBarragePrimitive*> ResolvedMissiles;
+	TArray<FBarragePrimitive*> ResolvedTargets;
+	TArray<FBarragePrimitive*> VelocityTargets;
+	TArray<FVector3d> Velocities;
+	TArray<FBarragePrimitive*> FacingTargets;
+	TArray<FQuat4d> Facings;
+};
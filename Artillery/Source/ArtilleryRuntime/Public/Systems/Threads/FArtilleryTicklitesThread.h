@@ -6,6 +6,7 @@
 
 #include <timeapi.h>
 #include "LowLogTimeAndRate.h"
+#include "FArtilleryTimerWheel.h"
 
 //this is a busy-style thread, which runs preset bodies of work in a specified order. Generally, the goal is that it never
 //actually sleeps. In fact, it only ever waits on the Artillery busy thread.
@@ -114,6 +115,8 @@ public:
 	UDispatch* DispatchOwner;
 	
 	TSharedPtr<F_INeedA> RequestRouter;
+	//advanced once per apply phase, before the groups. timers that would otherwise be ticklites counting down live here.
+	FArtilleryTimerWheel Timers;
 	TOptional<FTransform> GetCopyOfShadowTransform(FSkeletonKey Target, ArtilleryTime Now)
 	{
 		return DispatchOwner->GetTransformShadowByObjectKey(Target,  Now);
@@ -124,6 +127,12 @@ public:
 		auto temp = DispatchOwner->GetFBLetByObjectKey(Target,  Now);
 		return FBarragePrimitive::IsNotNull(temp) ? temp : nullptr;
 	}
+
+	//prefer this when a ticklite needs more than one key per tick. resolve once in calculate, use through apply.
+	int32 ResolveFBLets(TConstArrayView<FSkeletonKey> Targets, TArrayView<FBarragePrimitive*> OutPrimitives)
+	{
+		return DispatchOwner->ResolveFBLets(Targets, OutPrimitives);
+	}
 	
 	FArtilleryTicklitesWorker(): LocalNow(0), DispatchOwner(nullptr), running(false)
 	{
@@ -296,6 +305,7 @@ public:
 				StartTicklitesApply->Wait();
 				StartTicklitesApply->Reset(); // we can run long on sim, not on apply.
 			}
+			Timers.Advance();
 				CustomTimer<"TicklitesWorkerApply"> TimerPostWait;
 			
 			TRACE_CPUPROFILER_EVENT_SCOPE(FArtilleryTicklitesWorker: apply groups) 
@@ -336,6 +346,7 @@ public:
 			}
 		}
 		
+		Timers.Reset();
 		// Delete remaining tickables
 		for(TickliteGroup& Group : ExecutionGroups)
 		{
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include <atomic>
+
+//0 is never handed out, so a zeroed id is safe to cancel.
+using FArtilleryTimerId = uint64;
+
+//Hierarchical timing wheel on the artillery tick. Timer ticklites spend nearly all of their lives being visited just to
+//decrement a counter and say "not yet." this lets them skip the visit entirely: four levels of 128 slots, each level
+//covering 128x the span of the one below. a timer sits in the coarsest slot that can hold it and cascades down as
+//the wheel turns, so it gets touched at most once per level before it fires, and then only on its tick.
+//
+//Schedule and Cancel can be called from any thread; they're queued and picked up at the next Advance. Advance belongs
+//to the ticklite worker, which calls it at the top of the apply phase, so callbacks run where ticklite expirations do.
+//Insert and cancel are O(1). Cancel goes through a hash from id to node, so that's O(1) in the hashmap sense.
+class ARTILLERYRUNTIME_API FArtilleryTimerWheel
+{
+public:
+	static constexpr uint32 SlotBits = 7;
+	static constexpr uint32 SlotCount = 1 << SlotBits;
+	static constexpr uint32 SlotMask = SlotCount - 1;
+	static constexpr uint32 LevelCount = 4;
+	//~26 days at 120hz. longer than that and you want a different tool.
+	static constexpr uint64 MaxDelay = (1ull << (SlotBits * LevelCount)) - 1;
+
+	FArtilleryTimerWheel();
+
+	//fires in the apply phase TicksFromNow advances after this is picked up. zero is treated as one.
+	FArtilleryTimerId Schedule(uint32 TicksFromNow, TFunction<void()>&& OnExpire);
+	void Cancel(FArtilleryTimerId Timer);
+
+	void Advance();
+	void Reset();
+
+	uint64 Now() const
+	{
+		return Current.load(std::memory_order_acquire);
+	}
+	int32 Num() const
+	{
+		return Live.Num();
+	}
+
+private:
+	struct FTimerNode
+	{
+		TFunction<void()> OnExpire;
+		uint64 Expiry = 0;
+		FArtilleryTimerId Id = 0;
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		int32 Slot = INDEX_NONE;
+	};
+
+	struct FTimerRequest
+	{
+		FArtilleryTimerId Id = 0;
+		uint32 Ticks = 0;
+		TFunction<void()> OnExpire;
+	};
+
+	void Insert(int32 Node);
+	void Unlink(int32 Node);
+	void Release(int32 Node);
+	//empties a slot and reinserts everything in it against the current tick. returns the slot's index in its level.
+	uint32 Cascade(uint32 Level);
+	void DrainRequests();
+
+	std::atomic<uint64> Current = 0;
+	std::atomic<FArtilleryTimerId> NextId = 1;
+	TQueue<FTimerRequest, EQueueMode::Mpsc> Requests;
+	TQueue<FArtilleryTimerId, EQueueMode::Mpsc> Cancels;
+
+	int32 Heads[LevelCount * SlotCount];
+	TArray<FTimerNode> Nodes;
+	TArray<int32> FreeNodes;
+	TMap<FArtilleryTimerId, int32> Live;
+	TArray<int32> Firing;
+};
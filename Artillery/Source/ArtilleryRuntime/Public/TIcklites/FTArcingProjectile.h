@@ -6,6 +6,7 @@
 #include "ArtilleryDispatch.h"
 #include "FArcShot.h"
 
+//moves the shell every tick. for barrages, prefer UArtilleryProjectileDispatch::LaunchArc, which solves once and sweeps per segment.
 class FTArcingProjectile : public UArtilleryDispatch::TL_ThreadedImpl
 {
 public:
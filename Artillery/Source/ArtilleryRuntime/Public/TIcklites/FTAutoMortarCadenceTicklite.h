@@ -2,6 +2,9 @@
 
 #include "TL_Automation.h"
 
+//stays a ticklite rather than going on the timer wheel. the wheel only holds one-shots, and this repeats for the life
+//of the gun. as a timer it would reschedule itself from its own callback and get a new id every shot, so nothing
+//could keep a handle to stop it, which is exactly what the expiration TODO below needs.
 class FTAutoMortarCadenceTicklite : public CadencedTicklite
 {
 	uint32_t CadenceOverride = 120;
@@ -2,6 +2,8 @@
 
 #include "TL_Automation.h"
 
+//stays a ticklite rather than going on the timer wheel. the default cadence is 1, so it fires every tick and there's
+//no idle visit for the wheel to skip. it also repeats forever, and the wheel only holds one-shots.
 class FTFireCadenceTicklite : public CadencedTicklite
 {
 public:
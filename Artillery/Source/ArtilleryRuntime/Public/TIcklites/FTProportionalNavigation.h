@@ -37,6 +37,11 @@ public:
 	bool ResetVelocityOnLockon;
 	bool LockOnCompleted;
 	bool ProxmityFuseTriggered = false;
+
+	//missile, then target. resolved once in calculate and reused in apply, so we stop paying for four lookups a tick.
+	//these are non-owning and die with the tick. see UBarrageDispatch::ResolveFBLets.
+	FBarragePrimitive* Resolved[2] = {nullptr, nullptr};
+	bool ResolvedThisTick = false;
 	FTProportionalNavigation()
 	{
 		MissileKey = FSkeletonKey::Invalid();
@@ -106,10 +111,17 @@ public:
 	{
 	}
 
+	void ResolveKeys()
+	{
+		const FSkeletonKey Keys[2] = {MissileKey, TargetKey};
+		this->ADispatch->ResolveFBLets(Keys, Resolved);
+		ResolvedThisTick = true;
+	}
+
 	void TICKLITE_Calculate()
 	{
-		ArtilleryTime Now = this->GetShadowNow();
-		FBLet MissilePhysicsObject = this->ADispatch->GetFBLetByObjectKey(MissileKey, Now);
+		ResolveKeys();
+		const FBarragePrimitive* MissilePhysicsObject = Resolved[0];
 		if (FBarragePrimitive::IsNotNull(MissilePhysicsObject))
 		{
 			if (TicksElapsed >= LockOnTime)
@@ -125,7 +137,7 @@ public:
 				FVector3f TargetVelocity;
 				if (TargetKey.IsValid())
 				{
-					FBLet TargetPhysicsObject = this->ADispatch->GetFBLetByObjectKey(TargetKey, Now);
+					const FBarragePrimitive* TargetPhysicsObject = Resolved[1];
 					TargetLocation = FBarragePrimitive::GetPosition(TargetPhysicsObject);
 					TargetVelocity = FBarragePrimitive::GetVelocity(TargetPhysicsObject);
 				}
@@ -160,8 +172,12 @@ public:
 	//but for now, this is good enough for testing.
 	void TICKLITE_Apply()
 	{
-		ArtilleryTime Now = this->GetShadowNow();
-		FBLet MissilePhysicsObject = this->ADispatch->GetFBLetByObjectKey(MissileKey, Now);
+		//ticklites added this tick get apply without calculate, so resolve here if calculate didn't.
+		if (!ResolvedThisTick)
+		{
+			ResolveKeys();
+		}
+		const FBarragePrimitive* MissilePhysicsObject = Resolved[0];
 		if (FBarragePrimitive::IsNotNull(MissilePhysicsObject))
 		{
 			ConsecutiveTicksKeysAreInvalid = 0;
@@ -170,7 +186,7 @@ public:
 				if (TargetKey.Obj != 0)
 				{
 					//begin collision nudge
-					FBLet TargetPhysicsObject = this->ADispatch->GetFBLetByObjectKey(TargetKey, Now);
+					const FBarragePrimitive* TargetPhysicsObject = Resolved[1];
 					auto A = FBarragePrimitive::GetPosition(TargetPhysicsObject);
 					auto B = FBarragePrimitive::GetPosition(MissilePhysicsObject);
 					auto C = FBarragePrimitive::GetVelocity(TargetPhysicsObject);
@@ -210,20 +226,21 @@ public:
 			++ConsecutiveTicksKeysAreInvalid;
 		}
 
+		Resolved[0] = Resolved[1] = nullptr;
+		ResolvedThisTick = false;
 		TicksElapsed++;
 	}
 
 	void TICKLITE_CoreReset()
 	{
 		ProxmityFuseTriggered = false;
+		Resolved[0] = Resolved[1] = nullptr;
+		ResolvedThisTick = false;
 	}
 
 	bool TICKLITE_CheckForExpiration()
 	{
 		const bool TimeIsUp = TicksElapsed > TicksAliveTime;
-		FBLet MissilePhysicsObject = this->ADispatch->GetFBLetByObjectKey(MissileKey, ADispatch->GetShadowNow());
-
-		// IsNotNull performs a nullity check and does not require an n-coalescing because the invoke is static & currying
 		return
 			TimeIsUp
 			|| ConsecutiveTicksKeysAreInvalid > 4; // why does this need to be 3?
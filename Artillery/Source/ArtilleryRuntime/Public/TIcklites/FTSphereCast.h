@@ -5,6 +5,7 @@
 #include "ArtilleryDispatch.h"
 #include "FArtilleryTicklitesThread.h"
 #include "FWorldSimOwner.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
 
 class FTSphereCast : public UArtilleryDispatch::TL_ThreadedImpl
 {
@@ -71,9 +72,9 @@ public:
 		UBarrageDispatch* Physics = this->ADispatch->DispatchOwner->GetWorld()->GetSubsystem<UBarrageDispatch>();
 		if (Physics)
 		{
-			const JPH::DefaultBroadPhaseLayerFilter BroadPhaseFilter = Physics->GetDefaultBroadPhaseLayerFilter(
-				Layers::CAST_QUERY);
-			const JPH::DefaultObjectLayerFilter ObjectLayerFilter = Physics->GetDefaultLayerFilter(Layers::CAST_QUERY);
+			const Layers::FQueryLayerProfile& CastQuery = Layers::QueryProfile(Layers::CAST_QUERY);
+			const JPH::BroadPhaseLayerFilter& BroadPhaseFilter = CastQuery.BroadPhase;
+			const JPH::ObjectLayerFilter& ObjectLayerFilter = CastQuery.Objects;
 			const JPH::IgnoreSingleBodyFilter BodyFilter = Physics->GetFilterToIgnoreSingleBody(ShapeCastSourceObject);
 
 			Physics->SphereCast(Radius, Distance, RayStart, RayDirection, HitResultPtr, BroadPhaseFilter,
@@ -172,9 +173,9 @@ public:
 		if (Physics)
 		{
 			InLayer = Layers::CAST_QUERY;
-			const JPH::DefaultBroadPhaseLayerFilter BroadPhaseFilter = Physics->
-				GetDefaultBroadPhaseLayerFilter(InLayer);
-			const JPH::DefaultObjectLayerFilter ObjectLayerFilter = Physics->GetDefaultLayerFilter(InLayer);
+			const Layers::FQueryLayerProfile& QueryLayer = Layers::QueryProfile(InLayer);
+			const JPH::BroadPhaseLayerFilter& BroadPhaseFilter = QueryLayer.BroadPhase;
+			const JPH::ObjectLayerFilter& ObjectLayerFilter = QueryLayer.Objects;
 			const JPH::IgnoreSingleBodyFilter BodyFilter = Physics->GetFilterToIgnoreSingleBody(ShapeCastSourceObject);
 
 			Physics->SphereSearch(0, RayStart, JoltRadius, BroadPhaseFilter, ObjectLayerFilter, BodyFilter,
@@ -4,6 +4,7 @@
 
 #include "ArtilleryDispatch.h"
 #include "ThistleBehavioralist.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
 
 struct TargetGroupingInfo
 {
@@ -64,8 +65,6 @@ public:
 		check(TransformDispatch);
 
 		// Query potential targets
-		TArray<uint32> BodyIDsFound;
-		BodyIDsFound.Reserve(MAX_FOUND_OBJECTS);
 		for (uint32 ActorIndex = 0; ActorIndex < NumberOfActors; ++ActorIndex)
 		{
 			const ActorKey& CurrentKey = (*ActorsToSearch)[ActorIndex];
@@ -79,29 +78,27 @@ public:
 				{
 					continue;
 				}
-				const JPH::DefaultBroadPhaseLayerFilter BroadPhaseFilter = Physics->GetDefaultBroadPhaseLayerFilter(Layers::CAST_QUERY);
-				const auto ObjectLayerFilter = Physics->GetDefaultLayerFilter(Layers::CAST_QUERY);
+				const Layers::FQueryLayerProfile& CastQuery = Layers::QueryProfile(Layers::CAST_QUERY);
+				const JPH::BroadPhaseLayerFilter& BroadPhaseFilter = CastQuery.BroadPhase;
+				const JPH::ObjectLayerFilter& ObjectLayerFilter = CastQuery.Objects;
 				const JPH::IgnoreSingleBodyFilter BodyFilter = Physics->GetFilterToIgnoreSingleBody(ActorFiblet);
 			
-				uint32 BodiesFoundNearTarget = 0;
-				Physics->SphereSearch(SourceObject, ActorLocation, this->ImpactRadius, BroadPhaseFilter, ObjectLayerFilter, BodyFilter, &BodiesFoundNearTarget, BodyIDsFound);
-
-				// Process bodies we found to count enemies
-				uint32 EnemyCounter = 0;
-				for (uint32 BodyCounterIndex = 0; BodyCounterIndex < BodiesFoundNearTarget; ++BodyCounterIndex)
-				{
-					const uint32 BodyID = BodyIDsFound[BodyCounterIndex];
-
-					// If the other body isn't in the map, we need to check if it's an enemy
-					if (!EnemyBodyIDs.Contains(BodyID))
+				// Count enemies without ever building the list of bodies found
+				const uint32 EnemyCounter = Physics->SphereCount(ActorLocation, this->ImpactRadius, BroadPhaseFilter, ObjectLayerFilter, BodyFilter,
+					[this, Physics](uint32 BodyID)
 					{
+						// If the other body isn't in the map, we need to check if it's an enemy
+						if (EnemyBodyIDs.Contains(BodyID))
+						{
+							return false;
+						}
 						bool IsEnemy = true;
 						FBarrageKey BodyBarrageKey = Physics->GenerateBarrageKeyFromBodyId(BodyID);
 						FBLet BodyObjectFiblet = Physics->GetShapeRef(BodyBarrageKey);
 						if (BodyObjectFiblet)
 						{
 							FSkeletonKey BodyObjectKey = BodyObjectFiblet->KeyOutOfBarrage;
-					
+
 							if (ADispatch->DispatchOwner->DoesEntityHaveTag(BodyObjectKey, FGameplayTag::RequestGameplayTag("Enemy")))
 							{
 								EnemyBodyIDs.Add(BodyID);
@@ -111,10 +108,8 @@ public:
 								IsEnemy = false;
 							}
 						}
-
-						EnemyCounter += IsEnemy;
-					}
-				}
+						return IsEnemy;
+					});
 
 				TargetGroupingInfo& NewGroupingInfo = BodyIDToGroupingInfo.Add(CurrentKey, TargetGroupingInfo{});
 				NewGroupingInfo.TargetLocation = ActorLocation;
@@ -0,0 +1,12 @@
+// Copyright Radaway Software LLC. 2025. All rights reserved.
+
+#include "ArtilleryTests.h"
+
+#define LOCTEXT_NAMESPACE "ArtilleryTests"
+
+struct FArtilleryTestsModule : public IArtilleryTestsModule
+{};
+
+IMPLEMENT_MODULE (FArtilleryTestsModule, ArtilleryTests)
+
+#undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "Misc/AutomationTest.h"
+#include "FArtilleryTimerWheel.h"
+
+//the wheel is only worth having if a timer fires on its tick, not the one before or after, no matter which level it
+//was parked in. schedules are picked up at the next advance, so N ticks from now is N advances from now.
+BEGIN_DEFINE_SPEC(FArtilleryTimerWheelTests, "Artillery.Ticklites.Timer Wheel Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TUniquePtr<FArtilleryTimerWheel> Wheel;
+
+void Advance(uint32 Ticks)
+{
+	for (uint32 Tick = 0; Tick < Ticks; ++Tick)
+	{
+		Wheel->Advance();
+	}
+}
+
+//schedules a timer that writes down the tick it fired on. MAX_uint64 means it never did.
+FArtilleryTimerId Watch(uint32 TicksFromNow, uint64& FiredAt)
+{
+	FiredAt = MAX_uint64;
+	return Wheel->Schedule(TicksFromNow, [this, &FiredAt]()
+		{
+			FiredAt = Wheel->Now();
+		});
+}
+END_DEFINE_SPEC(FArtilleryTimerWheelTests)
+void FArtilleryTimerWheelTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Wheel = MakeUnique<FArtilleryTimerWheel>();
+		});
+
+	AfterEach([this]()
+		{
+			Wheel.Reset();
+		});
+
+	Describe("A Timer Wheel", [this]()
+		{
+			It("should fire on exactly the expiry tick", [this]()
+				{
+					uint64 One, Five, Last, Zero;
+					Watch(1, One);
+					Watch(5, Five);
+					Watch(FArtilleryTimerWheel::SlotCount - 1, Last);
+					Watch(0, Zero);
+					Advance(4);
+					TestEqual("Nothing due at four has fired early", Five, MAX_uint64);
+					Advance(FArtilleryTimerWheel::SlotCount);
+					TestEqual("One tick", One, 1ull);
+					TestEqual("Five ticks", Five, 5ull);
+					TestEqual("The last level 0 slot", Last, static_cast<uint64>(FArtilleryTimerWheel::SlotCount - 1));
+					TestEqual("Zero is treated as one", Zero, 1ull);
+					TestEqual("Nothing is left on the wheel", Wheel->Num(), 0);
+				});
+
+			It("should fire on exactly the expiry tick across the level 0 to level 1 cascade", [this]()
+				{
+					constexpr uint64 Boundary = FArtilleryTimerWheel::SlotCount;
+					uint64 OnBoundary, Parked, PastBoundary, Straddling;
+					//lands in level 1 and has to cascade down on the very tick it's due.
+					Watch(Boundary, OnBoundary);
+					//lands in level 1 and sits in level 0 for a while after the cascade.
+					Watch(Boundary + 37, Parked);
+					Advance(100);
+					//level 0 from here, but its slot is on the far side of the wrap.
+					Watch(Boundary - 100 + 3, PastBoundary);
+					//level 1 from here, and its slot is two wraps out.
+					Watch(Boundary * 2 - 100, Straddling);
+					Advance(Boundary - 101);
+					TestEqual("Nothing has fired one tick short of the boundary", OnBoundary, MAX_uint64);
+					Advance(1);
+					TestEqual("On the boundary", OnBoundary, Boundary);
+					TestEqual("Not the one just past it", PastBoundary, MAX_uint64);
+					Advance(Boundary * 2);
+					TestEqual("Just past the boundary", PastBoundary, Boundary + 3);
+					TestEqual("Parked in level 1", Parked, Boundary + 37);
+					TestEqual("Straddling a wrap", Straddling, Boundary * 2);
+					TestEqual("Nothing is left on the wheel", Wheel->Num(), 0);
+				});
+
+			It("should fire on exactly the expiry tick from the upper levels", [this]()
+				{
+					constexpr uint64 LevelTwo = 1ull << (FArtilleryTimerWheel::SlotBits * 2);
+					uint64 OnLevelTwo, PastLevelTwo;
+					Watch(LevelTwo, OnLevelTwo);
+					Watch(LevelTwo + FArtilleryTimerWheel::SlotCount + 1, PastLevelTwo);
+					Advance(LevelTwo - 1);
+					TestEqual("Nothing has fired one tick short", OnLevelTwo, MAX_uint64);
+					Advance(FArtilleryTimerWheel::SlotCount * 2);
+					TestEqual("On the level 2 boundary", OnLevelTwo, LevelTwo);
+					TestEqual("Past it", PastLevelTwo, LevelTwo + FArtilleryTimerWheel::SlotCount + 1);
+				});
+
+			It("should never fire a timer cancelled before it was due", [this]()
+				{
+					uint64 Cancelled, Kept, Upper;
+					const FArtilleryTimerId Doomed = Watch(10, Cancelled);
+					const FArtilleryTimerId DoomedUpper = Watch(FArtilleryTimerWheel::SlotCount * 3, Upper);
+					Watch(10, Kept);
+					//cancel before the schedule's even been picked up.
+					Wheel->Cancel(DoomedUpper);
+					Advance(5);
+					//and after it's been sitting in a slot for a while.
+					Wheel->Cancel(Doomed);
+					Advance(FArtilleryTimerWheel::SlotCount * 4);
+					TestEqual("The cancelled timer never fired", Cancelled, MAX_uint64);
+					TestEqual("Nor did the one cancelled straight away", Upper, MAX_uint64);
+					TestEqual("Its neighbor in the slot did", Kept, 10ull);
+					TestEqual("Nothing is left on the wheel", Wheel->Num(), 0);
+				});
+
+			It("should shrug off a cancel that comes after the timer fired", [this]()
+				{
+					uint64 Fired, Later;
+					const FArtilleryTimerId Spent = Watch(3, Fired);
+					Advance(3);
+					TestEqual("It fired", Fired, 3ull);
+					//the node it lived in goes straight back to the pool, so the next schedule is likely to reuse it.
+					Watch(4, Later);
+					Wheel->Cancel(Spent);
+					Wheel->Cancel(0);
+					Advance(4);
+					TestEqual("Cancelling a spent id leaves whoever has its node alone", Later, 7ull);
+					TestEqual("And it only ever fired the once", Fired, 3ull);
+				});
+		});
+}
@@ -0,0 +1,113 @@
+#include "Misc/AutomationTest.h"
+#include "BarrageDispatch.h"
+#include "FBShapeParams.h"
+#include "ProjectileArcSwarm.h"
+
+//one mortar shell over open ground, so nothing cuts the arc short and it lands right when it was told to.
+BEGIN_DEFINE_SPEC(FProjectileArcSwarmTests, "Artillery.Projectiles.Arc Swarm Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+static constexpr int32 TicksToTarget = 40;
+UBarrageDispatch* BarrageDispatch;
+UWorld* DummyWorldOuter;
+FProjectileArcSwarm Swarm;
+const FSkeletonKey Shell = FSkeletonKey(0x5e11ull);
+
+void Fire(bool bDeleteAtImpact, int32* Impacts)
+{
+	FAnalyticArcParams Arc;
+	Arc.Projectile = Shell;
+	Arc.StartPosition = FVector3d::ZeroVector;
+	Arc.TargetPosition = FVector3d(4000, 0, 0);
+	Arc.TicksToTarget = TicksToTarget;
+	Arc.ApogeeHeight = 1000;
+	Arc.DeleteAtImpact = bDeleteAtImpact;
+	Arc.OnImpact = [Impacts]() { ++*Impacts; };
+	Swarm.Enqueue(MoveTemp(Arc));
+}
+
+void SpawnShell()
+{
+	FBBoxParams BoxParams = FBarrageBounder::GenerateBoxBounds(FVector3d::ZeroVector, 20.0, 20.0, 20.0);
+	BarrageDispatch->CreateProjectile(BoxParams, Shell, Layers::ENEMYPROJECTILE);
+}
+END_DEFINE_SPEC(FProjectileArcSwarmTests)
+void FProjectileArcSwarmTests::Define()
+{
+	BeforeEach([this]()
+		{
+			DummyWorldOuter = NewObject<UWorld>();
+			BarrageDispatch = NewObject<UBarrageDispatch>(DummyWorldOuter);
+			BarrageDispatch->RegistrationImplementation();
+			BarrageDispatch->GrantWorkerFeed(0);
+			BarrageDispatch->GrantClientFeed();
+		});
+
+	AfterEach([this]()
+		{
+			Swarm.Reset();
+			BarrageDispatch->ConditionalBeginDestroy();
+			BarrageDispatch = nullptr;
+			DummyWorldOuter->ConditionalBeginDestroy();
+			DummyWorldOuter = nullptr;
+		});
+
+	Describe("An Arc Swarm", [this]()
+		{
+			It("should launch a shell once its body shows up, and hand it back for deletion at impact", [this]()
+				{
+					int32 Impacts = 0;
+					Fire(true, &Impacts);
+					TArray<FSkeletonKey> Impacted;
+					//still in the request router.
+					Swarm.Tick(BarrageDispatch, 1, Impacted);
+					TestEqual("Waiting on the body", Swarm.Num(), 1);
+
+					SpawnShell();
+					//launches on tick 2, so it's due on tick 2 + TicksToTarget.
+					for (int32 Counter = 2; Counter < 2 + TicksToTarget; ++Counter)
+					{
+						Swarm.Tick(BarrageDispatch, Counter, Impacted);
+					}
+					TestTrue("Nothing lands early", Impacted.IsEmpty());
+					TestEqual("No early impact callback", Impacts, 0);
+					TestEqual("Still in flight", Swarm.Num(), 1);
+
+					Swarm.Tick(BarrageDispatch, 2 + TicksToTarget, Impacted);
+					TestEqual("Lands on time", Impacted.Num(), 1);
+					TestTrue("And it's the shell", Impacted.Num() == 1 && Impacted[0] == Shell);
+					TestEqual("The impact callback runs once", Impacts, 1);
+					TestEqual("And the swarm lets go of it", Swarm.Num(), 0);
+
+					Impacted.Reset();
+					Swarm.Tick(BarrageDispatch, 3 + TicksToTarget, Impacted);
+					TestTrue("Only ever handed back once", Impacted.IsEmpty());
+				});
+
+			It("should keep a shell that isn't meant to be deleted at impact", [this]()
+				{
+					int32 Impacts = 0;
+					SpawnShell();
+					Fire(false, &Impacts);
+					TArray<FSkeletonKey> Impacted;
+					for (int32 Counter = 1; Counter <= 1 + TicksToTarget; ++Counter)
+					{
+						Swarm.Tick(BarrageDispatch, Counter, Impacted);
+					}
+					TestTrue("Not handed back", Impacted.IsEmpty());
+					TestEqual("But the callback still runs", Impacts, 1);
+					TestEqual("And the arc is done", Swarm.Num(), 0);
+				});
+
+			It("should give up on a shell whose body never shows up", [this]()
+				{
+					int32 Impacts = 0;
+					Fire(true, &Impacts);
+					TArray<FSkeletonKey> Impacted;
+					for (int32 Counter = 1; Counter <= FProjectileArcSwarm::MaxTicksToWaitForBody + 1; ++Counter)
+					{
+						Swarm.Tick(BarrageDispatch, Counter, Impacted);
+					}
+					TestEqual("Dropped", Swarm.Num(), 0);
+					TestTrue("Without an impact", Impacted.IsEmpty() && Impacts == 0);
+				});
+		});
+}
@@ -0,0 +1,153 @@
+#include "Misc/AutomationTest.h"
+#include "BarrageDispatch.h"
+#include "ProjectileGuidanceSwarm.h"
+
+//a fan of missiles, side by side and each pointed a little off, all guiding on one fixed point two hundred-odd meters
+//out. the solver runs on its own lanes, and the test does the integrating the physics would.
+BEGIN_DEFINE_SPEC(FProjectileGuidanceSwarmTests, "Artillery.Projectiles.Guidance Swarm Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+using FSwarm = FProjectileGuidanceSwarm;
+//not a multiple of LaneBlock, so the padded tail gets solved too.
+static constexpr int32 Count = 12;
+static constexpr float Spacing = 1000.f;
+TArray<float> Lanes[FSwarm::LaneCount];
+TArray<FVector3f> Positions;
+TArray<FVector3f> Velocities;
+const FVector3f Target = FVector3f(30000.f, 5500.f, 2000.f);
+
+void Launch()
+{
+	Positions.Reset();
+	Velocities.Reset();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const float Heading = FMath::DegreesToRadians(-30.f + 60.f * Index / (Count - 1));
+		Positions.Emplace(0.f, Index * Spacing, 0.f);
+		Velocities.Emplace(3000.f * FMath::Cos(Heading), 3000.f * FMath::Sin(Heading), 0.f);
+	}
+}
+
+void Step()
+{
+	const int32 Padded = Align(Count, FSwarm::LaneBlock);
+	for (TArray<float>& Lane : Lanes)
+	{
+		Lane.Init(0.f, Padded);
+	}
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Lanes[FSwarm::PX][Index] = Positions[Index].X;
+		Lanes[FSwarm::PY][Index] = Positions[Index].Y;
+		Lanes[FSwarm::PZ][Index] = Positions[Index].Z;
+		Lanes[FSwarm::VX][Index] = Velocities[Index].X;
+		Lanes[FSwarm::VY][Index] = Velocities[Index].Y;
+		Lanes[FSwarm::VZ][Index] = Velocities[Index].Z;
+		Lanes[FSwarm::TX][Index] = Target.X;
+		Lanes[FSwarm::TY][Index] = Target.Y;
+		Lanes[FSwarm::TZ][Index] = Target.Z;
+		Lanes[FSwarm::Nav][Index] = 4.f;
+		Lanes[FSwarm::Speed][Index] = 4000.f;
+		Lanes[FSwarm::Accel][Index] = 500.f;
+		Lanes[FSwarm::Keep][Index] = 1.f;
+	}
+	FSwarm::Solve(Lanes, Padded);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Velocities[Index] = FVector3f(Lanes[FSwarm::NVX][Index], Lanes[FSwarm::NVY][Index], Lanes[FSwarm::NVZ][Index]);
+		Positions[Index] += Velocities[Index] * UBarrageDispatch::TickRateInDelta;
+	}
+}
+
+//degrees between where a missile is headed and where the target is. zero is a collision course.
+float WorstHeadingError() const
+{
+	float Worst = 0.f;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector3f LineOfSight = (Target - Positions[Index]).GetSafeNormal();
+		const float Cosine = FMath::Clamp(FVector3f::DotProduct(LineOfSight, Velocities[Index].GetSafeNormal()), -1.f, 1.f);
+		Worst = FMath::Max(Worst, FMath::RadiansToDegrees(FMath::Acos(Cosine)));
+	}
+	return Worst;
+}
+
+float ClosestPair() const
+{
+	float Closest = MAX_flt;
+	for (int32 First = 0; First < Count; ++First)
+	{
+		for (int32 Second = First + 1; Second < Count; ++Second)
+		{
+			Closest = FMath::Min(Closest, FVector3f::Dist(Positions[First], Positions[Second]));
+		}
+	}
+	return Closest;
+}
+END_DEFINE_SPEC(FProjectileGuidanceSwarmTests)
+void FProjectileGuidanceSwarmTests::Define()
+{
+	Describe("A Guidance Swarm", [this]()
+		{
+			It("should bring every heading onto the target without collapsing the volley", [this]()
+				{
+					Launch();
+					const float Initial = WorstHeadingError();
+					TArray<float> StartRange;
+					for (const FVector3f& Position : Positions)
+					{
+						StartRange.Add(FVector3f::Dist(Target, Position));
+					}
+
+					float Closest = ClosestPair();
+					float Midway = MAX_flt;
+					for (int32 Tick = 1; Tick <= 768; ++Tick)
+					{
+						Step();
+						bool bAllFar = true;
+						for (int32 Index = 0; Index < Count; ++Index)
+						{
+							bAllFar &= FVector3f::Dist(Target, Positions[Index]) > StartRange[Index] / 2;
+						}
+						if (bAllFar)
+						{
+							Closest = FMath::Min(Closest, ClosestPair());
+						}
+						if (Tick == 384)
+						{
+							Midway = WorstHeadingError();
+						}
+					}
+
+					TestTrue("Every missile starts well off its collision course", Initial > 30.f);
+					TestTrue("Halfway there, the worst heading has come in", Midway < Initial / 2);
+					TestTrue("And by the end, every heading is within two degrees", WorstHeadingError() < 2.f);
+					//aiming at one point pulls them together eventually. until they're halfway in, it shouldn't.
+					TestTrue("The volley keeps its spacing on the way in", Closest > Spacing / 2);
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						TestTrue(FString::Printf(TEXT("Missile %d is closing"), Index), FVector3f::Dist(Target, Positions[Index]) < StartRange[Index] / 2);
+						TestTrue(FString::Printf(TEXT("Missile %d is under its max speed"), Index), Velocities[Index].Size() <= 4000.f * 1.001f);
+					}
+				});
+
+			It("should leave a missile that hasn't locked on flying straight", [this]()
+				{
+					Launch();
+					const FVector3f Before = Velocities[0];
+					const int32 Padded = Align(Count, FSwarm::LaneBlock);
+					for (TArray<float>& Lane : Lanes)
+					{
+						Lane.Init(0.f, Padded);
+					}
+					//a zeroed nav constant is what Gather hands the solver before lock-on.
+					Lanes[FSwarm::VX][0] = Before.X;
+					Lanes[FSwarm::VY][0] = Before.Y;
+					Lanes[FSwarm::TX][0] = Target.X;
+					Lanes[FSwarm::TY][0] = Target.Y;
+					Lanes[FSwarm::Speed][0] = 4000.f;
+					Lanes[FSwarm::Keep][0] = 1.f;
+					FSwarm::Solve(Lanes, Padded);
+					const FVector3f After(Lanes[FSwarm::NVX][0], Lanes[FSwarm::NVY][0], Lanes[FSwarm::NVZ][0]);
+					TestTrue("Same direction", After.Equals(Before, 0.01f));
+				});
+		});
+}
@@ -0,0 +1,102 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageBodyTracker.h"
+
+void FBarrageBodyTracker::OnBodyActivated(const JPH::BodyID& inBodyID, uint64 inBodyUserData)
+{
+	Pending.Enqueue({inBodyID, true});
+}
+
+void FBarrageBodyTracker::OnBodyDeactivated(const JPH::BodyID& inBodyID, uint64 inBodyUserData)
+{
+	Pending.Enqueue({inBodyID, false});
+}
+
+void FBarrageBodyTracker::Grow(uint32 Index)
+{
+	if (!AwakeSlot.IsValidIndex(Index))
+	{
+		const int32 Size = FMath::Max<int32>(Index + 1, AwakeSlot.Num() * 2);
+		AwakeSlot.Reserve(Size);
+		while (AwakeSlot.Num() < Size)
+		{
+			AwakeSlot.Add(INDEX_NONE);
+		}
+		MovedStamp.SetNumZeroed(Size);
+		MovedIDs.SetNum(Size);
+	}
+}
+
+void FBarrageBodyTracker::Update()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageBodyTracker::Update)
+	FellAsleep.Reset();
+	FActivation Change;
+	while (Pending.Dequeue(Change))
+	{
+		const uint32 Index = Change.Body.GetIndex();
+		Grow(Index);
+		int32& Slot = AwakeSlot[Index];
+		if (Change.bAwake)
+		{
+			if (Slot == INDEX_NONE)
+			{
+				Slot = Awake.Add(Change.Body);
+			}
+			else
+			{
+				//the index was recycled while we weren't looking.
+				Awake[Slot] = Change.Body;
+			}
+		}
+		else if (Slot != INDEX_NONE)
+		{
+			FellAsleep.Add(Awake[Slot]);
+			const int32 Last = Awake.Num() - 1;
+			if (Slot != Last)
+			{
+				Awake[Slot] = Awake[Last];
+				AwakeSlot[Awake[Slot].GetIndex()] = Slot;
+			}
+			Awake.Pop(EAllowShrinking::No);
+			Slot = INDEX_NONE;
+		}
+	}
+
+	++Stamp;
+	MovedBodies.Reset();
+	for (const JPH::BodyID& Body : Awake)
+	{
+		MovedStamp[Body.GetIndex()] = Stamp;
+		MovedIDs[Body.GetIndex()] = Body;
+		MovedBodies.Add(Body);
+	}
+	//a body can fall asleep and wake again in one step, and a removed body's index can go to a new one that's awake.
+	//either way, whoever is awake at that index is the one that counts.
+	for (const JPH::BodyID& Body : FellAsleep)
+	{
+		const uint32 Index = Body.GetIndex();
+		if (AwakeSlot[Index] == INDEX_NONE && MovedStamp[Index] != Stamp)
+		{
+			MovedStamp[Index] = Stamp;
+			MovedIDs[Index] = Body;
+			MovedBodies.Add(Body);
+		}
+	}
+	MovedBodies.Sort([](const JPH::BodyID& A, const JPH::BodyID& B)
+	{
+		return A.GetIndex() < B.GetIndex();
+	});
+}
+
+void FBarrageBodyTracker::Reset()
+{
+	Pending.Empty();
+	Awake.Empty();
+	AwakeSlot.Empty();
+	FellAsleep.Empty();
+	MovedBodies.Empty();
+	MovedStamp.Empty();
+	MovedIDs.Empty();
+	Stamp = 0;
+}
@@ -0,0 +1,334 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageCharacterGrid.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+#include "Jolt/Geometry/RayAABox.h"
+#include "Jolt/Physics/Collision/CollisionDispatch.h"
+#include "Jolt/Physics/Collision/ShapeCast.h"
+
+using namespace JPH;
+
+void FBarrageCharacterGrid::Add(CharacterVirtual* Character, FBCharacterBase* Owner)
+{
+	if (Character)
+	{
+		Pending.Enqueue({Character, Owner});
+	}
+}
+
+void FBarrageCharacterGrid::TakePending()
+{
+	TPair<CharacterVirtual*, FBCharacterBase*> Incoming;
+	while (Pending.Dequeue(Incoming))
+	{
+		Characters.Add(Incoming.Key);
+		Owners.Add(Incoming.Value);
+		Poses.Add({Incoming.Key->GetCenterOfMassTransform(), Incoming.Key->GetShape(), Incoming.Key->GetCharacterPadding()});
+		bStale = true;
+	}
+}
+
+void FBarrageCharacterGrid::Remove(const CharacterVirtual* Character)
+{
+	//anything still in the queue has to land first, or it'd come back after we removed it.
+	TakePending();
+	//keeps order, so query results keep the same order as the simple version's.
+	const int32 Index = Characters.Find(const_cast<CharacterVirtual*>(Character));
+	if (Index != INDEX_NONE)
+	{
+		Characters.RemoveAt(Index);
+		Owners.RemoveAt(Index);
+		Poses.RemoveAt(Index);
+		bStale = true;
+	}
+}
+
+void FBarrageCharacterGrid::Reset()
+{
+	Pending.Empty();
+	Characters.Empty();
+	Owners.Empty();
+	Poses.Empty();
+	Bounds.Empty();
+	Cells.Empty();
+	CellMembers.Empty();
+	MaxPadding = 0;
+	bStale = true;
+}
+
+void FBarrageCharacterGrid::Rebuild()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageCharacterGrid::Rebuild)
+	TakePending();
+	Cells.Reset();
+	CellMembers.Reset();
+	MaxPadding = 0;
+
+	RefreshPoses();
+	Bounds.Reset();
+	Bounds.Reserve(Poses.Num());
+	float Largest = 0;
+	for (const FPose& Pose : Poses)
+	{
+		AABox Box = Pose.Shape->GetWorldSpaceBounds(Pose.CenterOfMass.ToMat44(), Vec3::sOne());
+		Box.ExpandBy(Vec3::sReplicate(Pose.Padding + Slack));
+		Largest = FMath::Max(Largest, Box.GetSize().ReduceMax());
+		MaxPadding = FMath::Max(MaxPadding, Pose.Padding);
+		Bounds.Add(Box);
+	}
+	//a character should never span more than two cells an axis.
+	InverseCellSize = 1.0f / FMath::Max(CellSize, Largest);
+
+	//two passes, count then fill, so every cell's members are one contiguous run.
+	TArray<uint64, TInlineAllocator<256>> Keys;
+	TArray<TPair<uint64, int32>, TInlineAllocator<1024>> Placements;
+	for (int32 Index = 0; Index < Bounds.Num(); ++Index)
+	{
+		const FIntVector Min = ToCell(Bounds[Index].mMin);
+		const FIntVector Max = ToCell(Bounds[Index].mMax);
+		for (int32 X = Min.X; X <= Max.X; ++X)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			{
+				for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+				{
+					Placements.Add({CellKey(X, Y, Z), Index});
+				}
+			}
+		}
+	}
+	//by cell, then by character, which keeps members in registration order inside each cell.
+	Placements.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B)
+	{
+		return A.Key == B.Key ? A.Value < B.Value : A.Key < B.Key;
+	});
+	CellMembers.Reserve(Placements.Num());
+	for (int32 Index = 0; Index < Placements.Num(); ++Index)
+	{
+		if (Index == 0 || Placements[Index - 1].Key != Placements[Index].Key)
+		{
+			Cells.Add(Placements[Index].Key, {Index, 0});
+		}
+		++Cells.FindChecked(Placements[Index].Key).Value;
+		CellMembers.Add(Placements[Index].Value);
+	}
+	bStale = false;
+}
+
+void FBarrageCharacterGrid::RefreshPoses()
+{
+	Poses.SetNum(Characters.Num(), EAllowShrinking::No);
+	for (int32 Index = 0; Index < Characters.Num(); ++Index)
+	{
+		const CharacterVirtual* Character = Characters[Index];
+		Poses[Index] = {Character->GetCenterOfMassTransform(), Character->GetShape(), Character->GetCharacterPadding()};
+	}
+}
+
+void FBarrageCharacterGrid::BuildIslands(TArray<int32>& Order, TArray<int32>& Starts) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageCharacterGrid::BuildIslands)
+	Order.Reset();
+	Starts.Reset();
+	const int32 Count = Bounds.Num();
+	if (bStale || Count == 0)
+	{
+		//no cells to go on, so everyone is one island.
+		for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		{
+			Order.Add(Index);
+		}
+		Starts.Add(0);
+		Starts.Add(Order.Num());
+		return;
+	}
+
+	//union find, always rooting at the lower index so the roots come out the same no matter the cell order.
+	TArray<int32, TInlineAllocator<256>> Parent;
+	Parent.SetNumUninitialized(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Parent[Index] = Index;
+	}
+	auto Find = [&Parent](int32 Index)
+	{
+		while (Parent[Index] != Index)
+		{
+			Parent[Index] = Parent[Parent[Index]];
+			Index = Parent[Index];
+		}
+		return Index;
+	};
+	//anyone who could touch shares at least one cell, so pairs inside a cell are all we need to check.
+	for (const TPair<uint64, TPair<int32, int32>>& Cell : Cells)
+	{
+		const int32 First = Cell.Value.Key;
+		const int32 End = First + Cell.Value.Value;
+		for (int32 A = First; A < End; ++A)
+		{
+			for (int32 B = A + 1; B < End; ++B)
+			{
+				const int32 Left = CellMembers[A];
+				const int32 Right = CellMembers[B];
+				if (Bounds[Left].Overlaps(Bounds[Right]))
+				{
+					const int32 RootLeft = Find(Left);
+					const int32 RootRight = Find(Right);
+					if (RootLeft != RootRight)
+					{
+						Parent[FMath::Max(RootLeft, RootRight)] = FMath::Min(RootLeft, RootRight);
+					}
+				}
+			}
+		}
+	}
+
+	//counting sort by root. a root is always the island's lowest index, so islands land in order of their lowest member.
+	TArray<int32, TInlineAllocator<256>> IslandOf;
+	IslandOf.SetNumUninitialized(Count);
+	TArray<int32, TInlineAllocator<256>> Sizes;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const int32 Root = Find(Index);
+		if (Root == Index)
+		{
+			IslandOf[Index] = Sizes.Add(0);
+		}
+		else
+		{
+			IslandOf[Index] = IslandOf[Root];
+		}
+		++Sizes[IslandOf[Index]];
+	}
+	Starts.SetNumUninitialized(Sizes.Num() + 1);
+	Starts[0] = 0;
+	for (int32 Island = 0; Island < Sizes.Num(); ++Island)
+	{
+		Starts[Island + 1] = Starts[Island] + Sizes[Island];
+	}
+	Order.SetNumUninitialized(Count);
+	TArray<int32, TInlineAllocator<256>> Cursor(Starts.GetData(), Sizes.Num());
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Order[Cursor[IslandOf[Index]]++] = Index;
+	}
+}
+
+void FBarrageCharacterGrid::Gather(const AABox& Query, FCandidates& Out) const
+{
+	Out.Reset();
+	const FIntVector Min = ToCell(Query.mMin);
+	const FIntVector Max = ToCell(Query.mMax);
+	const double Span = (static_cast<double>(Max.X) - Min.X + 1)
+		* (static_cast<double>(Max.Y) - Min.Y + 1)
+		* (static_cast<double>(Max.Z) - Min.Z + 1);
+	//long casts can cover more cells than there are characters. at that point the list is the cheaper walk.
+	if (bStale || Span > Characters.Num())
+	{
+		for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		{
+			Out.Add(Index);
+		}
+		return;
+	}
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+			{
+				if (const TPair<int32, int32>* Run = Cells.Find(CellKey(X, Y, Z)))
+				{
+					Out.Append(&CellMembers[Run->Key], Run->Value);
+				}
+			}
+		}
+	}
+	//a character in several cells shows up once per cell. sorting also gives us registration order back.
+	Algo::Sort(Out);
+	Out.SetNum(Algo::Unique(Out), EAllowShrinking::No);
+}
+
+//mirrors CharacterVsCharacterCollisionSimple::CollideCharacter, over the candidates instead of everyone, and against
+//their poses as of the last Rebuild or RefreshPoses instead of live.
+void FBarrageCharacterGrid::CollideCharacter(const CharacterVirtual* inCharacter, RMat44Arg inCenterOfMassTransform,
+                                             const CollideShapeSettings& inCollideShapeSettings, RVec3Arg inBaseOffset,
+                                             CollideShapeCollector& ioCollector) const
+{
+	Mat44 Transform1 = inCenterOfMassTransform.PostTranslated(-inBaseOffset).ToMat44();
+	const Shape* Shape1 = inCharacter->GetShape();
+	CollideShapeSettings Settings = inCollideShapeSettings;
+	AABox Bounds1 = Shape1->GetWorldSpaceBounds(Transform1, Vec3::sOne());
+
+	//the cells are in world space, the shapes here are relative to the base offset.
+	AABox Query = Shape1->GetWorldSpaceBounds(inCenterOfMassTransform.ToMat44(), Vec3::sOne());
+	Query.ExpandBy(Vec3::sReplicate(inCollideShapeSettings.mMaxSeparationDistance + MaxPadding));
+	FCandidates Candidates;
+	Gather(Query, Candidates);
+
+	for (int32 Index : Candidates)
+	{
+		const CharacterVirtual* Other = Characters[Index];
+		if (Other == inCharacter || ioCollector.ShouldEarlyOut())
+		{
+			continue;
+		}
+		const FPose& Pose = Poses[Index];
+		Mat44 Transform2 = Pose.CenterOfMass.PostTranslated(-inBaseOffset).ToMat44();
+		Settings.mMaxSeparationDistance = inCollideShapeSettings.mMaxSeparationDistance + Pose.Padding;
+		const Shape* Shape2 = Pose.Shape;
+		AABox Bounds2 = Shape2->GetWorldSpaceBounds(Transform2, Vec3::sOne());
+		Bounds2.ExpandBy(Vec3::sReplicate(Settings.mMaxSeparationDistance));
+		if (!Bounds1.Overlaps(Bounds2))
+		{
+			continue;
+		}
+		ioCollector.SetUserData(reinterpret_cast<uint64>(Other));
+		CollisionDispatch::sCollideShapeVsShape(Shape1, Shape2, Vec3::sOne(), Vec3::sOne(), Transform1, Transform2,
+		                                        SubShapeIDCreator(), SubShapeIDCreator(), Settings, ioCollector);
+	}
+	ioCollector.SetUserData(0);
+}
+
+//mirrors CharacterVsCharacterCollisionSimple::CastCharacter, against the same poses as CollideCharacter.
+void FBarrageCharacterGrid::CastCharacter(const CharacterVirtual* inCharacter, RMat44Arg inCenterOfMassTransform,
+                                          Vec3Arg inDirection, const ShapeCastSettings& inShapeCastSettings,
+                                          RVec3Arg inBaseOffset, CastShapeCollector& ioCollector) const
+{
+	Mat44 Transform1 = inCenterOfMassTransform.PostTranslated(-inBaseOffset).ToMat44();
+	ShapeCast Cast(inCharacter->GetShape(), Vec3::sOne(), Transform1, inDirection);
+	Vec3 Origin = Cast.mShapeWorldBounds.GetCenter();
+	Vec3 Extents = Cast.mShapeWorldBounds.GetExtent();
+
+	//start and end of the sweep, in world space, padded for the other side's shell.
+	AABox Query = inCharacter->GetShape()->GetWorldSpaceBounds(inCenterOfMassTransform.ToMat44(), Vec3::sOne());
+	AABox End = Query;
+	End.Translate(inDirection);
+	Query.Encapsulate(End);
+	Query.ExpandBy(Vec3::sReplicate(MaxPadding));
+	FCandidates Candidates;
+	Gather(Query, Candidates);
+
+	for (int32 Index : Candidates)
+	{
+		const CharacterVirtual* Other = Characters[Index];
+		if (Other == inCharacter || ioCollector.ShouldEarlyOut())
+		{
+			continue;
+		}
+		const FPose& Pose = Poses[Index];
+		Mat44 Transform2 = Pose.CenterOfMass.PostTranslated(-inBaseOffset).ToMat44();
+		const Shape* Shape2 = Pose.Shape;
+		AABox Bounds2 = Shape2->GetWorldSpaceBounds(Transform2, Vec3::sOne());
+		Bounds2.ExpandBy(Extents);
+		if (!RayAABoxHits(Origin, inDirection, Bounds2.mMin, Bounds2.mMax))
+		{
+			continue;
+		}
+		ioCollector.SetUserData(reinterpret_cast<uint64>(Other));
+		CollisionDispatch::sCastShapeVsShapeWorldSpace(Cast, inShapeCastSettings, Shape2, Vec3::sOne(), {}, Transform2,
+		                                               SubShapeIDCreator(), SubShapeIDCreator(), ioCollector);
+	}
+	ioCollector.SetUserData(0);
+}
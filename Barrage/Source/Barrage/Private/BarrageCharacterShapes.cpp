@@ -0,0 +1,35 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageCharacterShapes.h"
+
+FBarrageCharacterShapes::FShapes FBarrageCharacterShapes::Get(float HeightStanding, float RadiusStanding)
+{
+	const uint64 SizeKey = Key(HeightStanding, RadiusStanding);
+	FScopeLock ScopeLock(&Lock);
+	if (const FShapes* Found = Shapes.Find(SizeKey))
+	{
+		return *Found;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageCharacterShapes::Build)
+	//same construction FBCharacter::Create always used: a capsule stood up on its bottom.
+	const JPH::Vec3 Offset(0, 0.5f * HeightStanding + RadiusStanding, 0);
+	FShapes Built;
+	Built.Outer = JPH::RotatedTranslatedShapeSettings(
+		Offset, JPH::Quat::sIdentity(), new JPH::CapsuleShape(0.5f * HeightStanding, RadiusStanding)).Create().Get();
+	Built.Inner = JPH::RotatedTranslatedShapeSettings(
+		Offset, JPH::Quat::sIdentity(), new JPH::CapsuleShape(0.5f * HeightStanding, RadiusStanding)).Create().Get();
+	return Shapes.Add(SizeKey, MoveTemp(Built));
+}
+
+int32 FBarrageCharacterShapes::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Shapes.Num();
+}
+
+void FBarrageCharacterShapes::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Shapes.Empty();
+}
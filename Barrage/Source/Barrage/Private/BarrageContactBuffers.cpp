@@ -0,0 +1,208 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageContactBuffers.h"
+
+void FBarrageContactBuffers::Record(int32 WorkerIndex, const FBarrageRawContact& Contact)
+{
+	if (WorkerIndex >= 0 && WorkerIndex < WorkerLanes)
+	{
+		Lanes[WorkerIndex].Contacts.Add(Contact);
+		return;
+	}
+	FScopeLock Lock(&SharedLaneLock);
+	SharedLane.Contacts.Add(Contact);
+}
+
+void FBarrageContactBuffers::Reset()
+{
+	for (FLane& Lane : Lanes)
+	{
+		Lane.Contacts.Empty();
+	}
+	{
+		FScopeLock Lock(&SharedLaneLock);
+		SharedLane.Contacts.Empty();
+	}
+	Gathered.Empty();
+	Resolved.Empty();
+	Merged.Empty();
+	Delivered = 0;
+	Batched.Empty();
+	Partitions.Empty();
+	FMemory::Memzero(TypePartitions);
+}
+
+FBarrageContactBatch FBarrageContactBuffers::Batch(EBarrageContactEventType Type) const
+{
+	FBarrageContactBatch Out;
+	Out.Type = Type;
+	const int32 TypeIndex = static_cast<int32>(Type);
+	if (TypeIndex < 0 || TypeIndex >= BatchedTypes)
+	{
+		return Out;
+	}
+	const int32 First = TypePartitions[TypeIndex];
+	const int32 Last = TypePartitions[TypeIndex + 1];
+	if (First == Last)
+	{
+		return Out;
+	}
+	Out.Partitions = TConstArrayView<FBarrageContactPartition>(Partitions).Slice(First, Last - First);
+	//partitions of one type are contiguous in Batched, so the whole type is one view too.
+	const BarrageContactEvent* Start = Out.Partitions[0].Events.GetData();
+	const BarrageContactEvent* End = Out.Partitions.Last().Events.GetData() + Out.Partitions.Last().Events.Num();
+	Out.Events = TConstArrayView<BarrageContactEvent>(Start, static_cast<int32>(End - Start));
+	return Out;
+}
+
+void FBarrageContactBuffers::BuildBatches(int32 FirstNew)
+{
+	Batched.Reset();
+	Partitions.Reset();
+	Batched.Append(TConstArrayView<BarrageContactEvent>(Merged).RightChop(FirstNew));
+	for (BarrageContactEvent& Event : Batched)
+	{
+		const BarrageContactEntity& One = Event.ContactEntity1;
+		const BarrageContactEntity& Two = Event.ContactEntity2;
+		if (One.MyLayer > Two.MyLayer
+			|| (One.MyLayer == Two.MyLayer && Two.ContactKey.KeyIntoBarrage < One.ContactKey.KeyIntoBarrage))
+		{
+			Swap(Event.ContactEntity1, Event.ContactEntity2);
+		}
+	}
+	Batched.Sort([](const BarrageContactEvent& A, const BarrageContactEvent& B)
+	{
+		if (A.ContactEventType != B.ContactEventType)
+		{
+			return A.ContactEventType < B.ContactEventType;
+		}
+		if (A.ContactEntity1.MyLayer != B.ContactEntity1.MyLayer)
+		{
+			return A.ContactEntity1.MyLayer < B.ContactEntity1.MyLayer;
+		}
+		if (A.ContactEntity2.MyLayer != B.ContactEntity2.MyLayer)
+		{
+			return A.ContactEntity2.MyLayer < B.ContactEntity2.MyLayer;
+		}
+		if (A.ContactEntity1.ContactKey.KeyIntoBarrage != B.ContactEntity1.ContactKey.KeyIntoBarrage)
+		{
+			return A.ContactEntity1.ContactKey.KeyIntoBarrage < B.ContactEntity1.ContactKey.KeyIntoBarrage;
+		}
+		return A.ContactEntity2.ContactKey.KeyIntoBarrage < B.ContactEntity2.ContactKey.KeyIntoBarrage;
+	});
+
+	//runs of (type, layer, layer). the sort put the types in order, so each type's runs are contiguous.
+	int32 RunStart = 0;
+	for (int32 Index = 1; Index <= Batched.Num(); ++Index)
+	{
+		const BarrageContactEvent& Head = Batched[RunStart];
+		if (Index < Batched.Num()
+			&& Batched[Index].ContactEventType == Head.ContactEventType
+			&& Batched[Index].ContactEntity1.MyLayer == Head.ContactEntity1.MyLayer
+			&& Batched[Index].ContactEntity2.MyLayer == Head.ContactEntity2.MyLayer)
+		{
+			continue;
+		}
+		Partitions.Add({Head.ContactEntity1.MyLayer, Head.ContactEntity2.MyLayer,
+		                TConstArrayView<BarrageContactEvent>(Batched).Slice(RunStart, Index - RunStart)});
+		RunStart = Index;
+	}
+
+	int32 Cursor = 0;
+	for (int32 TypeIndex = 0; TypeIndex < BatchedTypes; ++TypeIndex)
+	{
+		TypePartitions[TypeIndex] = Cursor;
+		while (Cursor < Partitions.Num()
+			&& static_cast<int32>(Partitions[Cursor].Events[0].ContactEventType) == TypeIndex)
+		{
+			++Cursor;
+		}
+	}
+	TypePartitions[BatchedTypes] = Cursor;
+}
+
+void FBarrageContactBuffers::Merge(TFunctionRef<FBarrageKey(uint32)> ToBarrageKey)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageContactBuffers::Merge)
+	if (Delivered > 0)
+	{
+		Merged.RemoveAt(0, Delivered, EAllowShrinking::No);
+		Delivered = 0;
+	}
+
+	Gathered.Reset();
+	for (FLane& Lane : Lanes)
+	{
+		Gathered.Append(Lane.Contacts);
+		Lane.Contacts.Reset();
+	}
+	{
+		FScopeLock Lock(&SharedLaneLock);
+		Gathered.Append(SharedLane.Contacts);
+		SharedLane.Contacts.Reset();
+	}
+	const int32 FirstNew = Merged.Num();
+	if (Gathered.IsEmpty())
+	{
+		Merged.Append(Resolved);
+		Resolved.Reset();
+		BuildBatches(FirstNew);
+		return;
+	}
+
+	//lanes fill in whatever order the job system felt like, so sort on the contents alone.
+	//type first, then the unordered pair, then the point so that even duplicates land in a fixed order.
+	Gathered.Sort([](const FBarrageRawContact& A, const FBarrageRawContact& B)
+	{
+		if (A.Type != B.Type)
+		{
+			return A.Type < B.Type;
+		}
+		const uint32 ALow = FMath::Min(A.Body1, A.Body2);
+		const uint32 BLow = FMath::Min(B.Body1, B.Body2);
+		if (ALow != BLow)
+		{
+			return ALow < BLow;
+		}
+		const uint32 AHigh = FMath::Max(A.Body1, A.Body2);
+		const uint32 BHigh = FMath::Max(B.Body1, B.Body2);
+		if (AHigh != BHigh)
+		{
+			return AHigh < BHigh;
+		}
+		if (A.Body1 != B.Body1)
+		{
+			return A.Body1 < B.Body1;
+		}
+		if (A.Point.X != B.Point.X)
+		{
+			return A.Point.X < B.Point.X;
+		}
+		if (A.Point.Y != B.Point.Y)
+		{
+			return A.Point.Y < B.Point.Y;
+		}
+		return A.Point.Z < B.Point.Z;
+	});
+
+	//one event per pair per type per step. multiple sub-shape pairs between the same two bodies used to each get their own.
+	Merged.Reserve(Merged.Num() + Gathered.Num() + Resolved.Num());
+	const FBarrageRawContact* Previous = nullptr;
+	for (const FBarrageRawContact& Contact : Gathered)
+	{
+		if (Previous && Previous->Type == Contact.Type
+			&& FMath::Min(Previous->Body1, Previous->Body2) == FMath::Min(Contact.Body1, Contact.Body2)
+			&& FMath::Max(Previous->Body1, Previous->Body2) == FMath::Max(Contact.Body1, Contact.Body2))
+		{
+			continue;
+		}
+		Previous = &Contact;
+		Merged.Emplace(Contact.Type,
+		               BarrageContactEntity(ToBarrageKey(Contact.Body1), Contact.Layer1),
+		               BarrageContactEntity(ToBarrageKey(Contact.Body2), Contact.Layer2),
+		               FVector(Contact.Point));
+	}
+	Merged.Append(Resolved);
+	Resolved.Reset();
+	BuildBatches(FirstNew);
+}
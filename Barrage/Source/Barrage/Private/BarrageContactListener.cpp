@@ -9,13 +9,18 @@ using namespace JPH;
 												 const CollideShapeResult& inCollisionResult)
 	{
 		// Allows you to ignore a contact before it is created (using layers to not make objects collide is cheaper!)
+		// this is about physics, not events. contact event filtering is in OnContactAdded, since rejecting here
+		// would stop the bodies from touching at all.
 		return ValidateResult::AcceptAllContactsForThisBodyPair;
 	}
 
 	void BarrageContactListener::OnContactAdded(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold,
 								ContactSettings& ioSettings)
 	{
-		if (UBarrageDispatch::SelfPtr)
+		//nobody listening for this pair means no lane traffic, no merge work, and no broadcast.
+		if (UBarrageDispatch::SelfPtr && UBarrageDispatch::SelfPtr->WantsContact(EBarrageContactEventType::ADDED,
+			static_cast<Layers::EJoltPhysicsLayer>(inBody1.GetObjectLayer()),
+			static_cast<Layers::EJoltPhysicsLayer>(inBody2.GetObjectLayer())))
 		{
 			UBarrageDispatch::SelfPtr->HandleContactAdded(inBody1, inBody2, inManifold, ioSettings);
 		}
@@ -6,7 +6,15 @@
 #include "CoordinateUtils.h"
 #include "FBPhysicsInput.h"
 #include "LandscapeProxy.h"
+#include "KeyCarry.h"
+#include "Skeletonize.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
 #include "LowLogTimeAndRate.h"
+#include "Conversion/BarrageCookedShapeCache.h"
+
+static_assert(FBarrageContactBuffers::WorkerLanes == ALLOWED_THREADS_FOR_BARRAGE_PHYSICS,
+	"every barrage worker needs its own contact lane.");
 
 //https://github.com/GaijinEntertainment/DagorEngine/blob/71a26585082f16df80011e06e7a4e95302f5bb7f/prog/engine/phys/physJolt/joltPhysics.cpp#L800
 //this is how gaijin uses jolt, and war thunder's honestly a pretty strong comp to our use case.
@@ -24,7 +32,7 @@ bool UBarrageDispatch::RegistrationImplementation()
 
 	UE_LOG(LogTemp, Warning, TEXT("Barrage:TransformUpdateQueue: Online"));
 	GameTransformPump = MakeShareable(new TransformUpdatesForGameThread());
-	ContactEventPump = MakeShareable(new TCircularQueue<BarrageContactEvent>(8192));
+	ContactEventPump = MakeShareable(new FBarrageContactBuffers());
 	FBarragePrimitive::GlobalBarrage = this;
 	//this approach may actually be too slow. it is pleasingly lockless, but it allocs 16megs
 	//and just iterating through that could be Rough for the gamethread.
@@ -89,6 +97,12 @@ void UBarrageDispatch::Deinitialize()
 {
 	SelfPtr = nullptr;
 	Super::Deinitialize();
+	HitboxFollowers.Reset();
+	ProjectileSweep.Reset();
+	StateHash.Reset();
+	PendingTombs.Empty();
+	//bodies hang on to their own shapes, so this only drops the ones nothing is using. the disk copies stay.
+	Barrage::Conversion::FCookedShapeCache::Get().Reset();
 	JoltBodyLifecycleMapping = nullptr;
 	TranslationMapping = nullptr;
 	for (TSharedPtr<TArray<FBLet>>& TombFibletArray : Tombs)
@@ -110,7 +124,7 @@ void UBarrageDispatch::Deinitialize()
 	}
 	HoldOpen = nullptr;
 
-	TSharedPtr<TCircularQueue<BarrageContactEvent>> EventPumpHoldOpen = ContactEventPump;
+	TSharedPtr<FBarrageContactBuffers> EventPumpHoldOpen = ContactEventPump;
 	ContactEventPump = nullptr;
 	if (EventPumpHoldOpen)
 	{
@@ -121,7 +135,7 @@ void UBarrageDispatch::Deinitialize()
 				       "Hey, so something's holding live references to the contact queue. Maybe. Shared Ref Count is not reliable."
 			       ));
 		}
-		EventPumpHoldOpen->Empty();
+		EventPumpHoldOpen->Reset();
 	}
 	EventPumpHoldOpen = nullptr;
 }
@@ -165,6 +179,37 @@ void UBarrageDispatch::SphereSearch(
 	                          OutFoundObjectCount, OutFoundObjects);
 }
 
+uint32 UBarrageDispatch::SphereCount(
+	FVector3d Location,
+	double Radius,
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+	const JPH::ObjectLayerFilter& ObjectFilter,
+	const JPH::BodyFilter& BodiesFilter,
+	TFunctionRef<bool(uint32)> Predicate,
+	uint32 StopAt,
+	TArray<uint32>* OutFirstFound) const
+{
+	if (Location.ContainsNaN())
+	{
+		return 0;
+	}
+	return JoltGameSim->SphereCount(Location, Radius, BroadPhaseFilter, ObjectFilter, BodiesFilter, Predicate, StopAt, OutFirstFound);
+}
+
+void UBarrageDispatch::SphereCountMany(
+	TConstArrayView<FVector3d> Locations,
+	double Radius,
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+	const JPH::ObjectLayerFilter& ObjectFilter,
+	const JPH::BodyFilter& BodiesFilter,
+	TFunctionRef<bool(uint32)> Predicate,
+	TArrayView<uint32> OutCounts,
+	uint32 StopAt) const
+{
+	//same as SphereCount, a NaN center counts 0. the sim drops it from the walk rather than failing the whole batch.
+	JoltGameSim->SphereCountMany(Locations, Radius, BroadPhaseFilter, ObjectFilter, BodiesFilter, Predicate, OutCounts, StopAt);
+}
+
 void UBarrageDispatch::CastRay(
 	FVector3d CastFrom,
 	FVector3d Direction,
@@ -179,6 +224,18 @@ void UBarrageDispatch::CastRay(
 	}
 }
 
+void UBarrageDispatch::CastRayPacket(
+	TConstArrayView<FVector3d> CastFrom,
+	TConstArrayView<FVector3d> Directions,
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+	const JPH::ObjectLayerFilter& ObjectFilter,
+	const JPH::BodyFilter& BodiesFilter,
+	TArrayView<FHitResult> OutHits)
+{
+	//a NaN origin only costs its own ray. the sim leaves it out of the packet and hands it back as a miss.
+	JoltGameSim->CastRayPacket(CastFrom, Directions, BroadPhaseFilter, ObjectFilter, BodiesFilter, OutHits);
+}
+
 //Defactoring the pointer management has actually made this much clearer than I expected.
 //these functions are overload polymorphic against our non-polymorphic POD params classes.
 //this is because over time, the needs of these classes may diverge and multiply
@@ -232,6 +289,15 @@ FBLet UBarrageDispatch::CreatePrimitive(FBCharParams& Definition, FSkeletonKey O
 	return nullptr;
 }
 
+void UBarrageDispatch::PrewarmCharacterShapes(const FBCharParams& Definition)
+{
+	if (JoltGameSim)
+	{
+		//matches how CreatePrimitive sizes the character.
+		JoltGameSim->CharacterShapes.Prewarm(2 * Definition.JoltHalfHeightOfCylinder, Definition.JoltRadius);
+	}
+}
+
 FBLet UBarrageDispatch::CreatePrimitive(FBSphereParams& Definition, FSkeletonKey OutKey, uint16_t Layer, bool isSensor)
 {
 	if (JoltGameSim)
@@ -308,6 +374,86 @@ void UBarrageDispatch::CreateHeightfieldLandscapeMesh(const TNotNull<const ALand
 	JoltGameSim->CreateHeightfieldLandscapeMesh(LandscapeActor);
 }
 
+TArray<FBLet> UBarrageDispatch::ImportStaticGeometry(TConstArrayView<FBStaticImport> Meshes,
+                                                     TConstArrayView<const ALandscapeProxy*> Landscapes)
+{
+	TArray<FBLet> Imported;
+	if (JoltGameSim)
+	{
+		JoltGameSim->ImportStaticGeometry(Meshes, Landscapes, Imported);
+		for (FBLet& shared : Imported)
+		{
+			if (shared && shared.IsValid())
+			{
+				shared->Me = FBShape::Static;
+				JoltBodyLifecycleMapping->insert_or_assign(shared->KeyIntoBarrage, shared);
+				TranslationMapping->insert_or_assign(shared->KeyOutOfBarrage, shared->KeyIntoBarrage);
+			}
+		}
+	}
+	return Imported;
+}
+
+void UBarrageDispatch::GatherStaticGeometry(const ULevel* Level,
+                                            TArray<FBStaticImport>& OutMeshes,
+                                            TArray<const ALandscapeProxy*>& OutLandscapes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UBarrageDispatch::GatherStaticGeometry)
+	if (!Level)
+	{
+		return;
+	}
+	for (const AActor* Actor : Level->Actors)
+	{
+		if (!IsValid(Actor))
+		{
+			continue;
+		}
+		if (const ALandscapeProxy* Landscape = Cast<ALandscapeProxy>(Actor))
+		{
+			OutLandscapes.Add(Landscape);
+			continue;
+		}
+
+		//the first mesh gets the same key the auto mesh would have picked.
+		FSkeletonKey ActorSkeletonKey;
+		if (const UKeyCarry* Carry = Actor->GetComponentByClass<UKeyCarry>())
+		{
+			ActorSkeletonKey = Carry->GetMyKey();
+		}
+		if (ActorSkeletonKey == 0)
+		{
+			ActorSkeletonKey = MAKE_ACTORKEY(Actor);
+		}
+
+		TInlineComponentArray<const UStaticMeshComponent*> StaticMeshComponents(Actor);
+		uint64 MeshIndex = 0;
+		for (const UStaticMeshComponent* MeshComponent : StaticMeshComponents)
+		{
+			if (MeshComponent->Mobility == EComponentMobility::Static
+				&& MeshComponent->IsCollisionEnabled()
+				&& MeshComponent->GetStaticMesh())
+			{
+				//the rest need keys of their own, or they'd overwrite each other's mappings. component order comes from
+				//the level, so every peer derives the same ones.
+				const FSkeletonKey MeshKey = MeshIndex == 0
+					? ActorSkeletonKey
+					: FSkeletonKey(FORGE_SKELETON_KEY(FMMM::FastHash64(ActorSkeletonKey + MeshIndex), GET_SK_TYPE(ActorSkeletonKey)));
+				OutMeshes.Add({FBTransform(MeshComponent->GetComponentTransform()), MeshComponent, MeshKey});
+				++MeshIndex;
+			}
+		}
+	}
+}
+
+TArray<FBLet> UBarrageDispatch::ImportLevelStaticGeometry(const ULevel* Level)
+{
+	TArray<FBStaticImport> Meshes;
+	TArray<const ALandscapeProxy*> Landscapes;
+	GatherStaticGeometry(Level, Meshes, Landscapes);
+	return ImportStaticGeometry(Meshes, Landscapes);
+}
+
 //unlike our other ecs components in artillery, barrage dispatch does not maintain the mappings directly.
 //this is because we may have _many_ jolt sims running if we choose to do deterministic rollback in certain ways.
 //This is a copy by value return on purpose, as we want the ref count to rise.
@@ -326,6 +472,31 @@ FBLet UBarrageDispatch::GetShapeRef(FBarrageKey Existing) const
 	return holdopen && holdopen->visit(Existing, [&out](auto& a) { out = a.second; }) ? out : nullptr;
 }
 
+void UBarrageDispatch::FollowParent(FSkeletonKey Child, FSkeletonKey Parent, FVector3d LocalOffset)
+{
+	HitboxFollowers.Follow(Child, Parent, LocalOffset);
+}
+
+void UBarrageDispatch::SweepProjectile(const FBarrageSweptProjectileParams& Params)
+{
+	ProjectileSweep.Launch(Params);
+}
+
+void UBarrageDispatch::StopSweepingProjectile(FSkeletonKey Projectile)
+{
+	ProjectileSweep.Stop(Projectile);
+}
+
+bool UBarrageDispatch::TryGetStateHash(uint64 Tick, uint64& OutHash) const
+{
+	return StateHash.TryGet(Tick, OutHash);
+}
+
+void UBarrageDispatch::ReportRemoteStateHash(uint64 Tick, uint64 Hash)
+{
+	StateHash.ReportRemote(Tick, Hash);
+}
+
 FBLet UBarrageDispatch::GetShapeRef(FSkeletonKey Existing) const
 {
 	//SharedPTR's def val is nullptr. this will return nullptr as soon as entomb succeeds.
@@ -359,6 +530,30 @@ FBLet UBarrageDispatch::GetShapeRef(FSkeletonKey Existing) const
 	return nullptr;
 }
 
+//this is GetShapeRef(FSkeletonKey) with the hold opens hoisted out of the loop and the FBLet copies removed.
+//visit locks the shard per key either way, but the refcount traffic was the actual cost for missile swarms.
+int32 UBarrageDispatch::ResolveFBLets(TConstArrayView<FSkeletonKey> Keys, TArrayView<FBarragePrimitive*> OutPrimitives) const
+{
+	check(OutPrimitives.Num() >= Keys.Num());
+	TSharedPtr<KeyToKey> HoldOpenTranslation = TranslationMapping;
+	TSharedPtr<KeyToFBLet> HoldOpenLifecycle = JoltBodyLifecycleMapping;
+	int32 Resolved = 0;
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		FBarragePrimitive* Found = nullptr;
+		FBarrageKey Into = 0;
+		if (HoldOpenTranslation && HoldOpenLifecycle && Keys[Index].IsValid()
+			&& HoldOpenTranslation->visit(Keys[Index], [&Into](auto& a) { Into = a.second; }))
+		{
+			HoldOpenLifecycle->visit(Into, [&Found](auto& a) { Found = a.second.Get(); });
+		}
+		//same nullity rule as everywhere else: tombstoned counts as null.
+		OutPrimitives[Index] = FBarragePrimitive::IsNotNull(Found) ? Found : nullptr;
+		Resolved += OutPrimitives[Index] != nullptr;
+	}
+	return Resolved;
+}
+
 void UBarrageDispatch::FinalizeReleasePrimitive(FBarrageKey BarrageKey)
 {
 	if (JoltGameSim)
@@ -480,6 +675,7 @@ void UBarrageDispatch::StackUp()
 				}
 			}
 		}
+		HitboxFollowers.Update(*JoltGameSim, [this](FSkeletonKey Key) { return GetShapeRef(Key); });
 	}
 }
 
@@ -501,10 +697,11 @@ void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount)
 	if (this && JoltGameSim && PinSim)
 	{
 		CustomTimer<"BusyWorkerBarrageStart"> TimerPhysStep;
-		if (TickCount % 64 == 0)
+		//a fresh batch of statics already rebuilds the broadphase.
+		if (!PinSim->AddPendingStaticGeometry())
 		{
 			TRACE_CPUPROFILER_EVENT_SCOPE(Broadphase Optimize);
-			PinSim->OptimizeBroadPhase();
+			PinSim->OptimizeChurnedBroadPhase(TickCount);
 		}
 
 		CleanTombs();
@@ -514,19 +711,22 @@ void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount)
 		TSharedPtr<TMap<FBarrageKey, TSharedPtr<FBCharacterBase>>> HoldOpenCharacters = PinSim->CharacterToJoltMapping;
 		if (HoldOpenCharacters)
 		{
-			for (auto& [CharacterKey, CharacterBase]: *HoldOpenCharacters)
+			PinSim->StepCharacters();
+		}
+		PinSim->BodyTracker.Update();
+		//nothing below moves a body, so this is the state the step left behind.
+		StateHash.Record(*PinSim, TickCount);
+
+		ProjectileSweep.Sweep(*PinSim, PinSim->DeltaTime);
+		TSharedPtr<FBarrageContactBuffers> PinContacts = ContactEventPump;
+		if (PinContacts)
+		{
+			for (const FBarrageSweepHit& Hit : ProjectileSweep.Hits())
 			{
-				if (CharacterBase->mCharacter)
-				{
-					if (CharacterBase->mCharacter->GetPosition().IsNaN())
-					{
-						CharacterBase->mCharacter->SetLinearVelocity(
-							CharacterBase->World->GetGravity());
-						CharacterBase->mCharacter->SetPosition(CharacterBase->mInitialPosition);
-						CharacterBase->mForcesUpdate = CharacterBase->World->GetGravity();
-					}
-					CharacterBase->StepCharacter();
-				}
+				BarrageContactEntity Projectile(FBarrageKey(Hit.Projectile.Obj), Hit.ProjectileLayer);
+				Projectile.bIsSwept = true;
+				PinContacts->RecordResolved(BarrageContactEvent(EBarrageContactEventType::ADDED, Projectile,
+					BarrageContactEntity(PinSim->GenerateBarrageKeyFromBodyId(Hit.Body), Hit.BodyLayer), FVector(Hit.Point)));
 			}
 		}
 
@@ -534,7 +734,16 @@ void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount)
 		{
 			CustomTimer<"BusyWorkerBarragePreLifeUpdate"> PreUpdate;
 			TRACE_CPUPROFILER_EVENT_SCOPE(Jolt Body Lifecycle Update);
-			//maintain tombstones
+			//maintain tombstones. SuggestTombstone queues them, so there's no need to go looking.
+			FBLet Goner;
+			while (PendingTombs.Dequeue(Goner))
+			{
+				if (Tombs[TombOffset])
+				{
+					Tombs[TombOffset]->Push(Goner);
+				}
+			}
+
 			TSharedPtr<KeyToFBLet> HoldCuckooLifecycle = JoltBodyLifecycleMapping;
 			TSharedPtr<FWorldSimOwner> GameSimHoldOpen = JoltGameSim;
 			//this costs basically nothing unless you smash into the lock. gonna have to figure that out soon...
@@ -542,38 +751,43 @@ void UBarrageDispatch::StepWorld(uint64 Time, uint64_t TickCount)
 			if (GameSimHoldOpen && HoldCuckooLifecycle && HoldCuckooLifecycle.Get() && !HoldCuckooLifecycle.Get()->
 				empty() && PinQueue)
 			{
-				FWorldSimOwner::BodyIDVector bodies;
-				GameSimHoldOpen->GetBodiesList(bodies);
-
+				//only what moved this step. statics and sleepers have nothing new to say.
 				FBarragePrimitive* FBP;
-				for (JPH::BodyID CanonAvailableBody : bodies)
+				for (JPH::BodyID MovedBody : GameSimHoldOpen->BodyTracker.Moved())
 				{
-					auto key = GenerateBarrageKeyFromBodyId(CanonAvailableBody);
-
-					//this can only be done here, really.
+					auto key = GenerateBarrageKeyFromBodyId(MovedBody);
 					auto found = HoldCuckooLifecycle->visit(key, [&FBP](auto& a) { FBP = a.second.Get(); });
-					if (found && key != 0 && FBP)
+					//characters are handled below, off their virtual character rather than the inner body.
+					if (found && key != 0 && FBP && FBP->tombstone == 0 && FBP->Me != FBShape::Character)
 					{
-						//NOTE: nullity check here includes tombstone check. Hence the odd form of the SECOND check.
-						//in other words, this checks != null && !tombstoned
-						if (FBP != nullptr && FBP->tombstone == 0)
+						FBarragePrimitive::TryUpdateTransformFromJolt(
+							FBP, MovedBody, GameSimHoldOpen, PinQueue, Time);
+					}
+				}
+
+				//atm, characters cannot be inactive, and the tracker never sees them.
+				if (HoldOpenCharacters)
+				{
+					for (const TPair<FBarrageKey, TSharedPtr<FBCharacterBase>>& Character : *HoldOpenCharacters)
+					{
+						auto found = HoldCuckooLifecycle->visit(Character.Key, [&FBP](auto& a) { FBP = a.second.Get(); });
+						if (found && FBP && FBP->tombstone == 0)
 						{
 							FBarragePrimitive::TryUpdateTransformFromJolt(
-								FBP, CanonAvailableBody, GameSimHoldOpen, PinQueue, Time);
-							//returns a bool that can be used for debug.
-						} //This checks for != null && tombstoned
-						else if (FBP && FBP->tombstone != 0 && Tombs[TombOffset])
-						{
-							FBLet HoldOpenFBP;
-							[[maybe_unused]] auto f = HoldCuckooLifecycle->visit(key, [&HoldOpenFBP](auto& a)
-							{
-								HoldOpenFBP = a.second;
-							});
-							Tombs[TombOffset]->Push(HoldOpenFBP);
+								FBP, JPH::BodyID(), GameSimHoldOpen, PinQueue, Time);
 						}
 					}
 				}
 			}
+
+			//swept projectiles have no body, so neither the tracker nor the lifecycle map knows they moved.
+			if (PinQueue)
+			{
+				ProjectileSweep.VisitInFlight([&PinQueue, Time](FSkeletonKey Projectile, const FVector3f& Position, const FVector3f& Velocity)
+				{
+					PinQueue->AddMove(Projectile, Time, Velocity.ToOrientationQuat(), Position);
+				});
+			}
 		}
 	}
 }
@@ -582,35 +796,58 @@ bool UBarrageDispatch::BroadcastContactEvents() const
 {
 	if (GetWorld())
 	{
-		TSharedPtr<TCircularQueue<BarrageContactEvent>> HoldOpen = ContactEventPump;
-		while (HoldOpen && !HoldOpen->IsEmpty())
+		TSharedPtr<FBarrageContactBuffers> HoldOpen = ContactEventPump;
+		TSharedPtr<FWorldSimOwner> SimHoldOpen = JoltGameSim;
+		if (HoldOpen && SimHoldOpen)
 		{
-			const BarrageContactEvent* Update = HoldOpen->Peek();
-			if (Update)
+			HoldOpen->Merge([&SimHoldOpen](uint32 Body) { return SimHoldOpen->GenerateBarrageKeyFromBodyId(Body); });
+			//one call per type, not per hit. batches are this step's contacts only, so a throw here loses them.
+			if (OnBarrageContactBatchDelegate.IsBound())
 			{
-				try
+				for (EBarrageContactEventType Type : {EBarrageContactEventType::ADDED,
+				                                      EBarrageContactEventType::PERSISTED,
+				                                      EBarrageContactEventType::REMOVED})
 				{
-					switch (Update->ContactEventType)
+					const FBarrageContactBatch Batch = HoldOpen->Batch(Type);
+					if (!Batch.IsEmpty())
 					{
-					case EBarrageContactEventType::ADDED:
-						OnBarrageContactAddedDelegate.Broadcast(*Update);
-						break;
-					case EBarrageContactEventType::PERSISTED:
-						OnBarrageContactPersistedDelegate.Broadcast(*Update);
-						break;
-					case EBarrageContactEventType::REMOVED:
-						// REMOVE EVENTS REQUIRE ADDITIONAL SPECIAL HANDLING AS THEY DO NOT HAVE ALL DATA SET
-						OnBarrageContactRemovedDelegate.Broadcast(*Update);
-						break;
-					default:
-						break;
+						try
+						{
+							OnBarrageContactBatchDelegate.Broadcast(Batch);
+						}
+						catch (...)
+						{
+							return false;
+						}
 					}
-					HoldOpen->Dequeue();
 				}
-				catch (...)
+			}
+		}
+		while (HoldOpen && !HoldOpen->IsEmpty())
+		{
+			const BarrageContactEvent* Update = HoldOpen->Ready().GetData();
+			try
+			{
+				switch (Update->ContactEventType)
 				{
-					return false; //we'll be back! we'll be back!!!!
+				case EBarrageContactEventType::ADDED:
+					OnBarrageContactAddedDelegate.Broadcast(*Update);
+					break;
+				case EBarrageContactEventType::PERSISTED:
+					OnBarrageContactPersistedDelegate.Broadcast(*Update);
+					break;
+				case EBarrageContactEventType::REMOVED:
+					// REMOVE EVENTS REQUIRE ADDITIONAL SPECIAL HANDLING AS THEY DO NOT HAVE ALL DATA SET
+					OnBarrageContactRemovedDelegate.Broadcast(*Update);
+					break;
+				default:
+					break;
 				}
+				HoldOpen->MarkDelivered(1);
+			}
+			catch (...)
+			{
+				return false; //we'll be back! we'll be back!!!!
 			}
 		}
 		return true;
@@ -618,13 +855,18 @@ bool UBarrageDispatch::BroadcastContactEvents() const
 	return false;
 }
 
-inline BarrageContactEvent ConstructContactEvent(EBarrageContactEventType EventType, UBarrageDispatch* BarrageDispatch,
-                                                 const JPH::Body& inBody1, const JPH::Body& inBody2,
-                                                 JPH::ContactSettings& ioSettings, FVector point = {0, 0, 0})
+//these run inside the solver. write down ids and layers only; keys get resolved in the merge after the step.
+inline FBarrageRawContact ConstructRawContact(EBarrageContactEventType EventType, const JPH::Body& inBody1,
+                                              const JPH::Body& inBody2, FVector point = {0, 0, 0})
 {
-	return BarrageContactEvent(
-		EventType, BarrageContactEntity(BarrageDispatch->GenerateBarrageKeyFromBodyId(inBody1.GetID()), inBody1),
-		BarrageContactEntity(BarrageDispatch->GenerateBarrageKeyFromBodyId(inBody2.GetID()), inBody2), point);
+	FBarrageRawContact Raw;
+	Raw.Type = EventType;
+	Raw.Body1 = inBody1.GetID().GetIndexAndSequenceNumber();
+	Raw.Body2 = inBody2.GetID().GetIndexAndSequenceNumber();
+	Raw.Layer1 = static_cast<Layers::EJoltPhysicsLayer>(inBody1.GetObjectLayer());
+	Raw.Layer2 = static_cast<Layers::EJoltPhysicsLayer>(inBody2.GetObjectLayer());
+	Raw.Point = FVector3f(point);
+	return Raw;
 }
 
 //retains the presence of the contact manifold, as we will eventually need to use this.
@@ -639,37 +881,36 @@ void UBarrageDispatch::HandleContactAdded(const JPH::Body& inBody1, const JPH::B
 
 void UBarrageDispatch::HandleContactAdded(const BarrageContactEntity Ent1, const BarrageContactEntity Ent2)
 {
-	BarrageContactEvent ContactEventToEnqueue = BarrageContactEvent(
-		EBarrageContactEventType::ADDED, Ent1, Ent2);
-	ContactEventPump->Enqueue(ContactEventToEnqueue);
+	//barrage keys carry the body id in their low bits, so this round trips through the merge.
+	FBarrageRawContact Raw;
+	Raw.Type = EBarrageContactEventType::ADDED;
+	Raw.Body1 = static_cast<uint32>(Ent1.ContactKey.KeyIntoBarrage & UINT32_MAX);
+	Raw.Body2 = static_cast<uint32>(Ent2.ContactKey.KeyIntoBarrage & UINT32_MAX);
+	Raw.Layer1 = Ent1.MyLayer;
+	Raw.Layer2 = Ent2.MyLayer;
+	ContactEventPump->Record(MyWORKERIndex, Raw);
 }
 
 void UBarrageDispatch::HandleContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2,
                                           JPH::ContactSettings& ioSettings, FVector point)
 {
-	BarrageContactEvent ContactEventToEnqueue = ConstructContactEvent(EBarrageContactEventType::ADDED, this, inBody1,
-	                                                                  inBody2, ioSettings, point);
-	ContactEventPump->Enqueue(ContactEventToEnqueue);
+	ContactEventPump->Record(MyWORKERIndex, ConstructRawContact(EBarrageContactEventType::ADDED, inBody1, inBody2, point));
 }
 
 void UBarrageDispatch::HandleContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2,
                                               const JPH::ContactManifold& inManifold,
                                               JPH::ContactSettings& ioSettings)
 {
-	BarrageContactEvent ContactEventToEnqueue = ConstructContactEvent(EBarrageContactEventType::PERSISTED, this,
-	                                                                  inBody1, inBody2, ioSettings);
-	ContactEventPump->Enqueue(ContactEventToEnqueue);
+	ContactEventPump->Record(MyWORKERIndex, ConstructRawContact(EBarrageContactEventType::PERSISTED, inBody1, inBody2));
 }
 
 void UBarrageDispatch::HandleContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) const
 {
-	FBarrageKey BK1 = this->GenerateBarrageKeyFromBodyId(inSubShapePair.GetBody1ID());
-	FBarrageKey BK2 = this->GenerateBarrageKeyFromBodyId(inSubShapePair.GetBody2ID());
-	BarrageContactEvent ContactEventToEnqueue(
-		EBarrageContactEventType::REMOVED,
-		BarrageContactEntity(BK1),
-		BarrageContactEntity(BK2));
-	ContactEventPump->Enqueue(ContactEventToEnqueue);
+	FBarrageRawContact Raw;
+	Raw.Type = EBarrageContactEventType::REMOVED;
+	Raw.Body1 = inSubShapePair.GetBody1ID().GetIndexAndSequenceNumber();
+	Raw.Body2 = inSubShapePair.GetBody2ID().GetIndexAndSequenceNumber();
+	ContactEventPump->Record(MyWORKERIndex, Raw);
 }
 
 FBarrageKey UBarrageDispatch::GenerateBarrageKeyFromBodyId(const JPH::BodyID& Input) const
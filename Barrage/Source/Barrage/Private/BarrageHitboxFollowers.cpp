@@ -0,0 +1,169 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageHitboxFollowers.h"
+#include "CoordinateUtils.h"
+#include "FWorldSimOwner.h"
+#include "Jolt/Physics/Body/BodyLockMulti.h"
+
+void FBarrageHitboxFollowers::Follow(FSkeletonKey Child, FSkeletonKey Parent, FVector3d LocalOffset)
+{
+	Pending.Enqueue({Child, Parent, CoordinateUtils::ToJoltCoordinates(LocalOffset)});
+}
+
+void FBarrageHitboxFollowers::Reset()
+{
+	Pending.Empty();
+	Unresolved.Empty();
+	Followers.Empty();
+	Live.Empty();
+	LockSet.Empty();
+	ParentLockIndex.Empty();
+	Unsorted = false;
+}
+
+void FBarrageHitboxFollowers::ResolvePending(TFunctionRef<FBLet(FSkeletonKey)> Resolve)
+{
+	FPendingFollow Incoming;
+	while (Pending.Dequeue(Incoming))
+	{
+		Unresolved.Add(Incoming);
+	}
+	for (int32 Index = Unresolved.Num() - 1; Index >= 0; --Index)
+	{
+		const FPendingFollow& Waiting = Unresolved[Index];
+		FBLet Child = Resolve(Waiting.Child);
+		//hitboxes are bodies. characters don't have one to write to.
+		if (!FBarragePrimitive::IsNotNull(Child) || Child->Me == FBShape::Character)
+		{
+			Unresolved.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+		FBLet Parent = Resolve(Waiting.Parent);
+		if (FBarragePrimitive::IsNotNull(Parent))
+		{
+			Followers.Add({Parent, Child, Waiting.LocalOffset});
+			Unresolved.RemoveAtSwap(Index, EAllowShrinking::No);
+			Unsorted = true;
+		}
+	}
+}
+
+void FBarrageHitboxFollowers::Update(FWorldSimOwner& Sim, TFunctionRef<FBLet(FSkeletonKey)> Resolve)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageHitboxFollowers::Update)
+	ResolvePending(Resolve);
+
+	//RemoveAll keeps order, so we only pay for a sort when something new shows up.
+	Followers.RemoveAll([](const FFollower& Follower)
+	{
+		return !FBarragePrimitive::IsNotNull(Follower.Parent) || !FBarragePrimitive::IsNotNull(Follower.Child);
+	});
+	if (Followers.IsEmpty() || !Sim.physics_system)
+	{
+		return;
+	}
+	if (Unsorted)
+	{
+		Followers.Sort([](const FFollower& A, const FFollower& B)
+		{
+			return A.Parent->KeyIntoBarrage == B.Parent->KeyIntoBarrage
+				       ? A.Child->KeyIntoBarrage.KeyIntoBarrage < B.Child->KeyIntoBarrage.KeyIntoBarrage
+				       : A.Parent->KeyIntoBarrage.KeyIntoBarrage < B.Parent->KeyIntoBarrage.KeyIntoBarrage;
+		});
+		Unsorted = false;
+	}
+
+	//the tracker's Moved is from the step that just ran, which is the last time a body could have gone anywhere. a
+	//parent woken by this tick's inputs shows up there after the next step, so its children trail it by a tick.
+	const FBarrageBodyTracker& Tracker = Sim.BodyTracker;
+	Live.Reset();
+	for (int32 Index = 0; Index < Followers.Num(); ++Index)
+	{
+		const FFollower& Follower = Followers[Index];
+		if (!Follower.bPlaced
+			|| Follower.Parent->Me == FBShape::Character
+			|| Tracker.HasMoved(JPH::BodyID(Follower.Parent->KeyIntoBarrage.KeyIntoBarrage & UINT32_MAX))
+			|| Tracker.HasMoved(JPH::BodyID(Follower.Child->KeyIntoBarrage.KeyIntoBarrage & UINT32_MAX)))
+		{
+			Live.Add(Index);
+		}
+	}
+	if (Live.IsEmpty())
+	{
+		return;
+	}
+
+	//children occupy [0, Num), parents go after them, once per run.
+	const int32 Count = Live.Num();
+	LockSet.Reset();
+	ParentLockIndex.Reset();
+	for (int32 Follower : Live)
+	{
+		LockSet.Add(JPH::BodyID(Followers[Follower].Child->KeyIntoBarrage.KeyIntoBarrage & UINT32_MAX));
+	}
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FBLet& Parent = Followers[Live[Index]].Parent;
+		if (Parent->Me == FBShape::Character)
+		{
+			ParentLockIndex.Add(INDEX_NONE);
+		}
+		else if (Index > 0 && Followers[Live[Index - 1]].Parent == Parent)
+		{
+			ParentLockIndex.Add(ParentLockIndex.Last());
+		}
+		else
+		{
+			ParentLockIndex.Add(LockSet.Add(JPH::BodyID(Parent->KeyIntoBarrage.KeyIntoBarrage & UINT32_MAX)));
+		}
+	}
+
+	//one acquisition for the whole set. under it, the no-lock interface is safe to use for these bodies.
+	JPH::BodyLockMultiWrite Lock(Sim.physics_system->GetBodyLockInterface(), LockSet.GetData(), LockSet.Num());
+	JPH::BodyInterface& NoLock = Sim.physics_system->GetBodyInterfaceNoLock();
+	JPH::RVec3 ParentPosition = JPH::RVec3::sZero();
+	JPH::Quat ParentRotation = JPH::Quat::sIdentity();
+	bool ParentValid = false;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FFollower& Follower = Followers[Live[Index]];
+		if (Index == 0 || Followers[Live[Index - 1]].Parent != Follower.Parent)
+		{
+			ParentValid = false;
+			if (ParentLockIndex[Index] != INDEX_NONE)
+			{
+				if (const JPH::Body* ParentBody = Lock.GetBody(ParentLockIndex[Index]))
+				{
+					ParentPosition = ParentBody->GetPosition();
+					ParentRotation = ParentBody->GetRotation();
+					ParentValid = true;
+				}
+			}
+			else if (Sim.CharacterToJoltMapping)
+			{
+				const TSharedPtr<FBCharacterBase>* Character = Sim.CharacterToJoltMapping->Find(Follower.Parent->KeyIntoBarrage);
+				if (Character && *Character && (*Character)->mCharacter)
+				{
+					ParentPosition = (*Character)->mCharacter->GetPosition();
+					ParentRotation = (*Character)->mCharacter->GetRotation();
+					ParentValid = true;
+				}
+			}
+		}
+
+		const JPH::Body* ChildBody = Lock.GetBody(Index);
+		if (!ParentValid || ChildBody == nullptr)
+		{
+			continue;
+		}
+		Follower.bPlaced = true;
+		const JPH::RVec3 Target = ParentPosition + ParentRotation * Follower.LocalOffset;
+		//rewriting a child that's already in place would wake it every tick, and it would never get to sleep. this
+		//catches the parent moving and the child being knocked about alike. a millimeter, because the pose doesn't
+		//read back bit exact far from the origin.
+		if (!ChildBody->GetPosition().IsClose(Target, 1.0e-6f) || !ChildBody->GetRotation().IsClose(ParentRotation, 1.0e-6f))
+		{
+			NoLock.SetPositionAndRotation(LockSet[Index], Target, ParentRotation, JPH::EActivation::Activate);
+		}
+	}
+}
@@ -0,0 +1,219 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageProjectileSweep.h"
+#include "CoordinateUtils.h"
+#include "FWorldSimOwner.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
+#include "Jolt/Physics/Body/BodyLock.h"
+#include "Jolt/Physics/Collision/CollisionCollectorImpl.h"
+
+void FBarrageProjectileSweep::Launch(const FBarrageSweptProjectileParams& Params)
+{
+	if (Params.Projectile.IsValid())
+	{
+		PendingLaunches.Enqueue(Params);
+	}
+}
+
+void FBarrageProjectileSweep::Stop(FSkeletonKey Projectile)
+{
+	PendingStops.Enqueue(Projectile);
+}
+
+void FBarrageProjectileSweep::Reset()
+{
+	PendingLaunches.Empty();
+	PendingStops.Empty();
+	Keys.Empty();
+	Origins.Empty();
+	Velocities.Empty();
+	Radii.Empty();
+	ProjectileLayers.Empty();
+	LifeLeft.Empty();
+	RangeLeft.Empty();
+	RowHits.Empty();
+	SweepHits.Empty();
+	Stopping.Empty();
+}
+
+void FBarrageProjectileSweep::ApplyPending()
+{
+	FBarrageSweptProjectileParams Params;
+	while (PendingLaunches.Dequeue(Params))
+	{
+		Keys.Add(Params.Projectile);
+		Origins.Add(CoordinateUtils::ToJoltCoordinates(Params.Origin));
+		Velocities.Add(CoordinateUtils::ToJoltCoordinates(Params.Velocity));
+		Radii.Add(FMath::Max(Params.Radius, 0.f));
+		ProjectileLayers.Add(Params.Layer);
+		LifeLeft.Add(FMath::Max(Params.MaxLifetime, 0.f));
+		RangeLeft.Add(Params.MaxRange > 0 ? CoordinateUtils::RadiusToJolt(Params.MaxRange) : MAX_flt);
+	}
+
+	FSkeletonKey Goner;
+	while (PendingStops.Dequeue(Goner))
+	{
+		Stopping.Add(Goner);
+	}
+	if (Stopping.IsEmpty())
+	{
+		return;
+	}
+	for (int32 Row = Keys.Num() - 1; Row >= 0; --Row)
+	{
+		if (Stopping.Contains(Keys[Row]))
+		{
+			RemoveRow(Row);
+		}
+	}
+	Stopping.Reset();
+}
+
+void FBarrageProjectileSweep::RemoveRow(int32 Row)
+{
+	Keys.RemoveAtSwap(Row, EAllowShrinking::No);
+	Origins.RemoveAtSwap(Row, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Row, EAllowShrinking::No);
+	Radii.RemoveAtSwap(Row, EAllowShrinking::No);
+	ProjectileLayers.RemoveAtSwap(Row, EAllowShrinking::No);
+	LifeLeft.RemoveAtSwap(Row, EAllowShrinking::No);
+	RangeLeft.RemoveAtSwap(Row, EAllowShrinking::No);
+}
+
+bool FBarrageProjectileSweep::SegmentOf(int32 Row, float DeltaTime, JPH::Vec3& OutSegment) const
+{
+	const bool bOutOfLife = LifeLeft[Row] <= DeltaTime;
+	OutSegment = Velocities[Row] * (bOutOfLife ? LifeLeft[Row] : DeltaTime);
+	const float Length = OutSegment.Length();
+	if (Length >= RangeLeft[Row])
+	{
+		OutSegment *= RangeLeft[Row] / Length;
+		return true;
+	}
+	return bOutOfLife;
+}
+
+void FBarrageProjectileSweep::SweepRange(const FWorldSimOwner& Sim, float DeltaTime, int32 First, int32 Last)
+{
+	const JPH::NarrowPhaseQuery& Query = Sim.physics_system->GetNarrowPhaseQueryNoLock();
+	const JPH::BodyLockInterface& Locks = Sim.physics_system->GetBodyLockInterfaceNoLock();
+	JPH::ShapeCastSettings Settings;
+	Settings.mUseShrunkenShapeAndConvexRadius = true;
+	Settings.mReturnDeepestPoint = true;
+
+	for (int32 Row = First; Row < Last; ++Row)
+	{
+		FBarrageSweepHit& Hit = RowHits[Row];
+		Hit = FBarrageSweepHit();
+		JPH::Vec3 Segment;
+		SegmentOf(Row, DeltaTime, Segment);
+		if (Segment.IsNearZero())
+		{
+			continue;
+		}
+		const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(ProjectileLayers[Row]);
+
+		JPH::BodyID HitBody;
+		JPH::RVec3 Point;
+		if (Radii[Row] <= 0.f)
+		{
+			const JPH::RRayCast Ray(Origins[Row], Segment);
+			JPH::RayCastResult Result;
+			if (!Query.CastRay(Ray, Result, Profile.BroadPhase, Profile.Objects))
+			{
+				continue;
+			}
+			HitBody = Result.mBodyID;
+			Hit.Fraction = Result.mFraction;
+			Point = Ray.GetPointOnRay(Result.mFraction);
+		}
+		else
+		{
+			//same cast FWorldSimOwner::SphereCast does, minus the FHitResult.
+			const JPH::SphereShape Sphere(Radii[Row]);
+			const JPH::RShapeCast Cast(&Sphere, JPH::Vec3::sReplicate(1.0f), JPH::RMat44::sTranslation(Origins[Row]), Segment);
+			JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> Collector;
+			Query.CastShape(Cast, Settings, Cast.mCenterOfMassStart.GetTranslation(), Collector, Profile.BroadPhase, Profile.Objects);
+			if (!Collector.HadHit())
+			{
+				continue;
+			}
+			HitBody = Collector.mHit.mBodyID2;
+			Hit.Fraction = Collector.mHit.mFraction;
+			Point = Cast.mCenterOfMassStart.GetTranslation() + Collector.mHit.mContactPointOn2;
+		}
+
+		JPH::BodyLockRead Lock(Locks, HitBody);
+		if (!Lock.Succeeded())
+		{
+			continue;
+		}
+		Hit.Projectile = Keys[Row];
+		Hit.Body = HitBody.GetIndexAndSequenceNumber();
+		Hit.ProjectileLayer = ProjectileLayers[Row];
+		Hit.BodyLayer = static_cast<Layers::EJoltPhysicsLayer>(Lock.GetBody().GetObjectLayer());
+		Hit.Point = CoordinateUtils::FromJoltCoordinates(Point);
+	}
+}
+
+void FBarrageProjectileSweep::Sweep(FWorldSimOwner& Sim, float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageProjectileSweep::Sweep)
+	ApplyPending();
+	SweepHits.Reset();
+	const int32 Count = Keys.Num();
+	if (Count == 0 || !Sim.physics_system)
+	{
+		return;
+	}
+	RowHits.SetNum(Count, EAllowShrinking::No);
+
+	const int32 JobCount = FMath::Min(FMath::DivideAndRoundUp(Count, ProjectilesPerJob), Sim.job_system ? Sim.job_system->GetMaxConcurrency() : 1);
+	if (JobCount <= 1)
+	{
+		SweepRange(Sim, DeltaTime, 0, Count);
+	}
+	else
+	{
+		//contiguous chunks, so each job's rows share cache lines with nobody else's.
+		const int32 RowsPerJob = FMath::DivideAndRoundUp(Count, JobCount);
+		JPH::JobSystem::Barrier* SweepBarrier = Sim.job_system->CreateBarrier();
+		for (int32 Job = 0; Job < JobCount; ++Job)
+		{
+			const int32 First = Job * RowsPerJob;
+			const int32 Last = FMath::Min(First + RowsPerJob, Count);
+			JPH::JobHandle Handle = Sim.job_system->CreateJob("SweepProjectiles", JPH::Color::sOrange, [this, &Sim, DeltaTime, First, Last]()
+			{
+				SweepRange(Sim, DeltaTime, First, Last);
+			});
+			SweepBarrier->AddJob(Handle);
+		}
+		Sim.job_system->WaitForJobs(SweepBarrier);
+		Sim.job_system->DestroyBarrier(SweepBarrier);
+	}
+
+	//hits leave, and so does anything that ran out this tick. everything else moves up to the end of its segment.
+	for (int32 Row = Count - 1; Row >= 0; --Row)
+	{
+		if (RowHits[Row].Body != JPH::BodyID::cInvalidBodyID)
+		{
+			SweepHits.Add(RowHits[Row]);
+			RemoveRow(Row);
+			continue;
+		}
+		JPH::Vec3 Step;
+		if (SegmentOf(Row, DeltaTime, Step))
+		{
+			RemoveRow(Row);
+			continue;
+		}
+		Origins[Row] += Step;
+		LifeLeft[Row] -= DeltaTime;
+		RangeLeft[Row] -= Step.Length();
+	}
+	//launches arrive in whatever order the threads managed, so the rows aren't in a fixed order. the hits are.
+	SweepHits.Sort([](const FBarrageSweepHit& A, const FBarrageSweepHit& B)
+	{
+		return A.Projectile.Obj < B.Projectile.Obj;
+	});
+}
@@ -0,0 +1,59 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageRagdollPool.h"
+
+JPH::Ref<JPH::Ragdoll> FBarrageRagdollPool::Acquire(JPH::PhysicsSystem& PhysicsSystem, const JPH::RagdollSettings& Settings,
+                                                    const JPH::SkeletonPose& Pose, JPH::CollisionGroup::GroupID GroupID)
+{
+	JPH::Ref<JPH::Ragdoll> Ragdoll;
+	TArray<JPH::Ref<JPH::Ragdoll>>* Spares = Free.Find(&Settings);
+	if (Spares && !Spares->IsEmpty())
+	{
+		Ragdoll = Spares->Pop(EAllowShrinking::No);
+		Ragdoll->SetGroupID(GroupID);
+		//out of the system, so no locks to fight over. whatever it was doing when it died is not our problem anymore.
+		Ragdoll->SetLinearAndAngularVelocity(JPH::Vec3::sZero(), JPH::Vec3::sZero(), false);
+		Ragdoll->ResetWarmStart();
+	}
+	else
+	{
+		Ragdoll = Settings.CreateRagdoll(GroupID, 0, &PhysicsSystem);
+		if (Ragdoll == nullptr)
+		{
+			//out of bodies.
+			return nullptr;
+		}
+	}
+	Ragdoll->SetPose(Pose, false);
+	Ragdoll->AddToPhysicsSystem(JPH::EActivation::Activate);
+	return Ragdoll;
+}
+
+void FBarrageRagdollPool::Release(JPH::Ragdoll* Ragdoll)
+{
+	if (Ragdoll == nullptr)
+	{
+		return;
+	}
+	Ragdoll->RemoveFromPhysicsSystem();
+	TArray<JPH::Ref<JPH::Ragdoll>>& Spares = Free.FindOrAdd(Ragdoll->GetRagdollSettings());
+	if (Spares.Num() < MaxFreePerSettings)
+	{
+		Spares.Emplace(Ragdoll);
+	}
+}
+
+int32 FBarrageRagdollPool::NumFree() const
+{
+	int32 Count = 0;
+	for (const TPair<const JPH::RagdollSettings*, TArray<JPH::Ref<JPH::Ragdoll>>>& Spares : Free)
+	{
+		Count += Spares.Value.Num();
+	}
+	return Count;
+}
+
+void FBarrageRagdollPool::Reset()
+{
+	Free.Empty();
+}
@@ -0,0 +1,185 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#include "BarrageStateHash.h"
+#include "FWorldSimOwner.h"
+#include "MashFunctions.h"
+
+namespace
+{
+	uint64 Pack(int32 High, int32 Low)
+	{
+		return static_cast<uint64>(static_cast<uint32>(High)) << 32 | static_cast<uint32>(Low);
+	}
+
+	int32 Quantize(double Value, double Quanta)
+	{
+		return FMath::RoundToInt32(Value * Quanta);
+	}
+
+	//each word is hashed on its own, under its own salt, so the hashes can overlap in flight and two words that happen
+	//to be equal don't cancel. only the fold of each body into the running hash is serial.
+	uint64 Word(uint64 Value, uint64 Lane)
+	{
+		return FMMM::FastHash64(Value ^ Lane * 0x9E3779B97F4A7C15ull);
+	}
+}
+
+uint64 FBarrageStateHash::HashBody(const JPH::BodyLockInterfaceNoLock& Bodies, const JPH::BodyID& ID)
+{
+	const JPH::Body* Body = Bodies.TryGetBody(ID);
+	if (!Body)
+	{
+		return 0;
+	}
+	const JPH::RVec3 Position = Body->GetCenterOfMassPosition();
+	//q and -q are the same rotation, and the solver is free to hand back either.
+	JPH::Quat Rotation = Body->GetRotation();
+	if (Rotation.GetW() < 0)
+	{
+		Rotation = -Rotation;
+	}
+	uint64 BodyHash = Word(Pack(ID.GetIndexAndSequenceNumber(), Quantize(Position.GetX(), PositionQuanta)), 1)
+		+ Word(Pack(Quantize(Position.GetY(), PositionQuanta), Quantize(Position.GetZ(), PositionQuanta)), 2)
+		+ Word(Pack(Quantize(Rotation.GetX(), RotationQuanta) << 16 | (Quantize(Rotation.GetY(), RotationQuanta) & 0xFFFF),
+			Quantize(Rotation.GetZ(), RotationQuanta) << 16 | (Quantize(Rotation.GetW(), RotationQuanta) & 0xFFFF)), 3);
+	//statics have no motion properties to read, and would hash zeroes.
+	if (!Body->IsStatic())
+	{
+		const JPH::Vec3 Linear = Body->GetLinearVelocity();
+		const JPH::Vec3 Angular = Body->GetAngularVelocity();
+		BodyHash += Word(Pack(Quantize(Linear.GetX(), VelocityQuanta), Quantize(Linear.GetY(), VelocityQuanta)), 4)
+			+ Word(Pack(Quantize(Linear.GetZ(), VelocityQuanta), Quantize(Angular.GetX(), VelocityQuanta)), 5)
+			+ Word(Pack(Quantize(Angular.GetY(), VelocityQuanta), Quantize(Angular.GetZ(), VelocityQuanta)), 6);
+	}
+	return BodyHash;
+}
+
+uint64 FBarrageStateHash::HashRange(const FWorldSimOwner& Sim, int32 First, int32 Last) const
+{
+	const JPH::BodyLockInterfaceNoLock& Bodies = Sim.physics_system->GetBodyLockInterfaceNoLock();
+	uint64 Hash = FMMM::FastHash64(First);
+	for (int32 Index = First; Index < Last; ++Index)
+	{
+		Hash = FMMM::FastHash64(Hash ^ HashBody(Bodies, BodyIDs[Index]));
+	}
+	return Hash;
+}
+
+uint64 FBarrageStateHash::Record(const FWorldSimOwner& Sim, uint64 Tick)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FBarrageStateHash::Record)
+	if (!Sim.physics_system)
+	{
+		return 0;
+	}
+	//sorted by index, which is what makes this BodyID order.
+	Sim.physics_system->GetBodies(BodyIDs);
+	const int32 Count = static_cast<int32>(BodyIDs.size());
+	const int32 Chunks = FMath::DivideAndRoundUp(Count, BodiesPerJob);
+	ChunkHashes.SetNum(Chunks, EAllowShrinking::No);
+
+	if (Chunks <= 1 || !Sim.job_system)
+	{
+		for (int32 Chunk = 0; Chunk < Chunks; ++Chunk)
+		{
+			ChunkHashes[Chunk] = HashRange(Sim, Chunk * BodiesPerJob, FMath::Min((Chunk + 1) * BodiesPerJob, Count));
+		}
+	}
+	else
+	{
+		//the chunking is fixed by BodiesPerJob, never by the worker count, or the hash would be too.
+		JPH::JobSystem::Barrier* HashBarrier = Sim.job_system->CreateBarrier();
+		for (int32 Chunk = 0; Chunk < Chunks; ++Chunk)
+		{
+			const int32 First = Chunk * BodiesPerJob;
+			const int32 Last = FMath::Min(First + BodiesPerJob, Count);
+			JPH::JobHandle Handle = Sim.job_system->CreateJob("HashWorldState", JPH::Color::sGrey, [this, &Sim, Chunk, First, Last]()
+			{
+				ChunkHashes[Chunk] = HashRange(Sim, First, Last);
+			});
+			HashBarrier->AddJob(Handle);
+		}
+		Sim.job_system->WaitForJobs(HashBarrier);
+		Sim.job_system->DestroyBarrier(HashBarrier);
+	}
+
+	uint64 Hash = FMMM::FastHash64(Count);
+	for (uint64 ChunkHash : ChunkHashes)
+	{
+		Hash = FMMM::FastHash64(Hash ^ ChunkHash);
+	}
+
+	FHistorySlot& Slot = History[Tick % HistoryLength];
+	Slot.Tick.store(MAX_uint64, std::memory_order_release);
+	Slot.Hash.store(Hash, std::memory_order_release);
+	Slot.Tick.store(Tick, std::memory_order_release);
+	CompareRemotes(Tick);
+	return Hash;
+}
+
+bool FBarrageStateHash::TryGet(uint64 Tick, uint64& OutHash) const
+{
+	const FHistorySlot& Slot = History[Tick % HistoryLength];
+	if (Slot.Tick.load(std::memory_order_acquire) != Tick)
+	{
+		return false;
+	}
+	OutHash = Slot.Hash.load(std::memory_order_acquire);
+	//if the step thread lapped us while we read, the hash may be from another tick.
+	return Slot.Tick.load(std::memory_order_acquire) == Tick;
+}
+
+void FBarrageStateHash::ReportRemote(uint64 Tick, uint64 Hash)
+{
+	PendingRemotes.Enqueue({Tick, Hash});
+}
+
+void FBarrageStateHash::CompareRemotes(uint64 Tick)
+{
+	FRemoteHash Remote;
+	while (PendingRemotes.Dequeue(Remote))
+	{
+		Waiting.Add(Remote);
+	}
+	for (int32 Index = Waiting.Num() - 1; Index >= 0; --Index)
+	{
+		const FRemoteHash& Report = Waiting[Index];
+		if (Report.Tick > Tick)
+		{
+			continue;
+		}
+		uint64 Ours;
+		if (Tick - Report.Tick < HistoryLength && TryGet(Report.Tick, Ours))
+		{
+			if (Ours == Report.Hash)
+			{
+				Matches.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				Desyncs.fetch_add(1, std::memory_order_relaxed);
+				if (Report.Tick < FirstDesync.load(std::memory_order_relaxed))
+				{
+					FirstDesync.store(Report.Tick, std::memory_order_relaxed);
+				}
+				UE_LOG(LogTemp, Error, TEXT("Barrage: desync at tick %llu, ours %016llx, theirs %016llx"), Report.Tick, Ours, Report.Hash);
+			}
+		}
+		Waiting.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+}
+
+void FBarrageStateHash::Reset()
+{
+	for (FHistorySlot& Slot : History)
+	{
+		Slot.Tick.store(MAX_uint64, std::memory_order_relaxed);
+		Slot.Hash.store(0, std::memory_order_relaxed);
+	}
+	PendingRemotes.Empty();
+	Waiting.Empty();
+	ChunkHashes.Empty();
+	FirstDesync.store(MAX_uint64, std::memory_order_relaxed);
+	Desyncs.store(0, std::memory_order_relaxed);
+	Matches.store(0, std::memory_order_relaxed);
+}
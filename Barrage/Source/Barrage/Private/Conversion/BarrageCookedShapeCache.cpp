@@ -0,0 +1,493 @@
+﻿// Copyright 2026 Oversized Sun Inc. All Rights Reserved.
+
+#include "Conversion/BarrageCookedShapeCache.h"
+
+#include "Conversion/BarrageChaosToJoltConversion.h"
+#include "Chaos/CastingUtilities.h"
+#include "Chaos/HeightField.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "HAL/FileManager.h"
+#include "Logging/StructuredLog.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PhysicsEngine/BodySetup.h"
+
+using namespace Chaos;
+
+static int32 GBarrageCookedShapeCache = 2;
+FAutoConsoleVariableRef CVarBarrageCookedShapeCache(
+	TEXT("barrage.CookedShapeCache"),
+	GBarrageCookedShapeCache,
+	TEXT("0: convert collision every time. 1: share converted shapes in memory. 2: also keep them on disk between runs."));
+
+// Bump this whenever the conversion itself changes what it builds, or old files will keep coming back.
+static constexpr uint32 CookedShapeFormatVersion = 1;
+
+namespace
+{
+	// Jolt reads and writes through these. Ours just sit on a byte array instead of a std stream.
+	class FJoltBytesOut final : public JPH::StreamOut
+	{
+	public:
+		explicit FJoltBytesOut(TArray<uint8>& InBytes) : Bytes(InBytes) {}
+
+		virtual void WriteBytes(const void* inData, size_t inNumBytes) override
+		{
+			Bytes.Append(static_cast<const uint8*>(inData), static_cast<int64>(inNumBytes));
+		}
+
+		virtual bool IsFailed() const override
+		{
+			return false;
+		}
+
+	private:
+		TArray<uint8>& Bytes;
+	};
+
+	class FJoltBytesIn final : public JPH::StreamIn
+	{
+	public:
+		explicit FJoltBytesIn(TConstArrayView<uint8> InBytes) : Bytes(InBytes) {}
+
+		virtual void ReadBytes(void* outData, size_t inNumBytes) override
+		{
+			if (Cursor + static_cast<int64>(inNumBytes) > Bytes.Num())
+			{
+				// like a std stream, eof only shows up once you've tried to read past the end
+				FMemory::Memzero(outData, inNumBytes);
+				Cursor = Bytes.Num();
+				bEOF = true;
+				return;
+			}
+			FMemory::Memcpy(outData, Bytes.GetData() + Cursor, inNumBytes);
+			Cursor += static_cast<int64>(inNumBytes);
+		}
+
+		virtual bool IsEOF() const override
+		{
+			return bEOF;
+		}
+
+		virtual bool IsFailed() const override
+		{
+			return bEOF;
+		}
+
+		bool IsFullyRead() const
+		{
+			return !bEOF && Cursor == Bytes.Num();
+		}
+
+	private:
+		TConstArrayView<uint8> Bytes;
+		int64 Cursor = 0;
+		bool bEOF = false;
+	};
+
+	struct FShapeKeyBuilder
+	{
+		FXxHash128Builder Builder;
+
+		FShapeKeyBuilder()
+		{
+			Add(CookedShapeFormatVersion);
+			Add(static_cast<uint32>(JPH_VERSION_MAJOR));
+			Add(static_cast<uint32>(JPH_VERSION_MINOR));
+			Add(static_cast<uint32>(JPH_VERSION_PATCH));
+			Add(static_cast<uint32>(sizeof(JPH::Real)));
+			// the conversion cvars live with the conversion, so we go through the console manager for them
+			static IConsoleVariable* UseChaosTriIndex = IConsoleManager::Get().FindConsoleVariable(TEXT("barrage.JoltTriMeshUseChaosTriIndex"));
+			static IConsoleVariable* MaxTrisPerLeaf = IConsoleManager::Get().FindConsoleVariable(TEXT("barrage.JoltTriMeshMaxTrisPerLeaf"));
+			Add(UseChaosTriIndex ? UseChaosTriIndex->GetBool() : true);
+			Add(MaxTrisPerLeaf ? MaxTrisPerLeaf->GetInt() : 0);
+		}
+
+		template <typename T>
+		void Add(const T& Value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "only plain data goes into a shape key");
+			Builder.Update(&Value, sizeof(T));
+		}
+
+		template <typename ArrayType>
+		void AddArray(const ArrayType& Values)
+		{
+			const int32 Count = Values.Num();
+			Add(Count);
+			if (Count > 0)
+			{
+				Builder.Update(Values.GetData(), static_cast<uint64>(Count) * sizeof(Values[0]));
+			}
+		}
+
+		void AddTransform(const FTransform& Transform)
+		{
+			Add(Transform.GetLocation());
+			Add(Transform.GetRotation());
+			Add(Transform.GetScale3D());
+		}
+
+		void AddTriMesh(const FTriangleMeshImplicitObject& TriMesh)
+		{
+			AddArray(TriMesh.Particles().X());
+			const FTrimeshIndexBuffer& Indices = TriMesh.Elements();
+			Add(Indices.RequiresLargeIndices());
+			if (Indices.RequiresLargeIndices())
+			{
+				AddArray(Indices.GetLargeIndexBuffer());
+			}
+			else
+			{
+				AddArray(Indices.GetSmallIndexBuffer());
+			}
+		}
+
+		// Walks the geometry the same way ConvertChaosGeoToJoltBody does. false if something in there isn't something
+		// it converts, in which case we don't try to cache it.
+		bool AddChaosGeo(const FImplicitObject& ChaosGeo)
+		{
+			const EImplicitObjectType ObjectType = ChaosGeo.GetCollisionType();
+			Add(ObjectType);
+
+			if (IsScaled(ObjectType))
+			{
+				const FImplicitObjectScaled* Scaled = ChaosGeo.AsA<FImplicitObjectScaled>();
+				if (!Scaled)
+				{
+					return false;
+				}
+				Add(Scaled->GetScale());
+				return AddChaosGeo(*Scaled->GetInnerObject());
+			}
+
+			if (IsInstanced(ObjectType))
+			{
+				const FImplicitObjectInstanced* Instanced = ChaosGeo.AsA<FImplicitObjectInstanced>();
+				return Instanced && AddChaosGeo(*Instanced->GetInnerObject());
+			}
+
+			switch (GetInnerType(ObjectType))
+			{
+			case ImplicitObjectType::Transformed:
+				if (const auto* Transformed = ChaosGeo.GetObject<TImplicitObjectTransformed<FReal, 3>>())
+				{
+					AddTransform(Transformed->GetTransform());
+					return AddChaosGeo(*Transformed->GetTransformedObject());
+				}
+				return false;
+			case ImplicitObjectType::Sphere:
+				if (const auto* Sphere = ChaosGeo.GetObject<TSphere<FReal, 3>>())
+				{
+					Add(Sphere->GetRadiusf());
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::Box:
+				if (const auto* Box = ChaosGeo.GetObject<TBox<FReal, 3>>())
+				{
+					Add(Box->Extents());
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::Capsule:
+				if (const auto* Capsule = ChaosGeo.GetObject<FCapsule>())
+				{
+					Add(Capsule->GetRadiusf());
+					Add(Capsule->GetHeightf());
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::Convex:
+				if (const auto* Convex = ChaosGeo.GetObject<FConvex>())
+				{
+					AddArray(Convex->GetVertices());
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::Cylinder:
+				if (const auto* Cylinder = ChaosGeo.AsA<FCylinder>())
+				{
+					Add(Cylinder->GetRadiusf());
+					Add(Cylinder->GetHeight());
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::TriangleMesh:
+				if (const auto* TriMesh = ChaosGeo.AsA<FTriangleMeshImplicitObject>())
+				{
+					AddTriMesh(*TriMesh);
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::Union:
+				if (const auto* Union = ChaosGeo.GetObject<FImplicitObjectUnion>())
+				{
+					Add(Union->GetObjects().Num());
+					for (const FImplicitObjectPtr& Child : Union->GetObjects())
+					{
+						// the conversion skips these too
+						if (Child && !AddChaosGeo(*Child.GetReference()))
+						{
+							return false;
+						}
+					}
+					return true;
+				}
+				return false;
+			case ImplicitObjectType::HeightField:
+				if (const auto* HeightField = ChaosGeo.GetObject<FHeightField>())
+				{
+					const FHeightField::FDataType& Data = HeightField->GeomData;
+					AddArray(Data.Heights);
+					Add(Data.NumRows);
+					Add(Data.NumCols);
+					Add(Data.HeightPerUnit);
+					Add(Data.MinValue);
+					Add(Data.Scale);
+					return true;
+				}
+				return false;
+			default:
+				return false;
+			}
+		}
+
+		void AddBodySetup(const UBodySetup& BodySetup, bool bSimpleCollision, bool bComplexCollision, bool bIgnoreTransform)
+		{
+			Add(bSimpleCollision);
+			Add(bComplexCollision);
+			Add(bIgnoreTransform);
+
+			const FKAggregateGeom& AggGeom = BodySetup.AggGeom;
+			if (bSimpleCollision)
+			{
+				Add(AggGeom.BoxElems.Num());
+				for (const FKBoxElem& Box : AggGeom.BoxElems)
+				{
+					Add(Box.X);
+					Add(Box.Y);
+					Add(Box.Z);
+					AddTransform(Box.GetTransform());
+				}
+				Add(AggGeom.SphereElems.Num());
+				for (const FKSphereElem& Sphere : AggGeom.SphereElems)
+				{
+					Add(Sphere.Radius);
+					AddTransform(Sphere.GetTransform());
+				}
+				Add(AggGeom.SphylElems.Num());
+				for (const FKSphylElem& Sphyl : AggGeom.SphylElems)
+				{
+					Add(Sphyl.Radius);
+					Add(Sphyl.Length);
+					AddTransform(Sphyl.GetTransform());
+				}
+				Add(AggGeom.ConvexElems.Num());
+				for (const FKConvexElem& Convex : AggGeom.ConvexElems)
+				{
+					AddArray(Convex.VertexData);
+					Add(Convex.ElemBox.Min);
+					Add(Convex.ElemBox.Max);
+					AddTransform(Convex.GetTransform());
+				}
+			}
+
+			if (bComplexCollision)
+			{
+				Add(BodySetup.TriMeshGeometries.Num());
+				for (const FTriangleMeshImplicitObjectPtr& TriMesh : BodySetup.TriMeshGeometries)
+				{
+					Add(TriMesh.IsValid());
+					if (TriMesh.IsValid())
+					{
+						AddTriMesh(*TriMesh.GetReference());
+					}
+				}
+			}
+
+			Add(BodySetup.DefaultInstance.COMNudge);
+		}
+	};
+
+	FString CachePath(const FString& Directory, const FXxHash128& Key)
+	{
+		return FPaths::Combine(Directory, FString::Printf(TEXT("%016llx%016llx.jshape"), Key.HashHigh, Key.HashLow));
+	}
+}
+
+Barrage::Conversion::FCookedShapeCache& Barrage::Conversion::FCookedShapeCache::Get()
+{
+	static FCookedShapeCache Cache;
+	return Cache;
+}
+
+FString Barrage::Conversion::FCookedShapeCache::CacheDirectory() const
+{
+	return DirectoryOverride.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DerivedDataCache"), TEXT("Barrage")) : DirectoryOverride;
+}
+
+void Barrage::Conversion::FCookedShapeCache::SetCacheDirectory(const FString& Directory)
+{
+	DirectoryOverride = Directory;
+}
+
+JPH::ShapeSettings::ShapeResult Barrage::Conversion::FCookedShapeCache::BodySetupToJoltShape(const UBodySetup* UnrealBodySetup,
+                                                                                             bool bSimpleCollision,
+                                                                                             bool bComplexCollision,
+                                                                                             bool bIgnoreTransform)
+{
+	if (!ensure(IsValid(UnrealBodySetup)))
+	{
+		return {};
+	}
+
+	FShapeKeyBuilder Key;
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FCookedShapeCache::HashBodySetup)
+		Key.Add(TEXT('B'));
+		Key.AddBodySetup(*UnrealBodySetup, bSimpleCollision, bComplexCollision, bIgnoreTransform);
+	}
+	return FindOrBuild(Key.Builder.Finalize(), [&]()
+	{
+		return UnrealBodySetupToJolt(UnrealBodySetup, bSimpleCollision, bComplexCollision, bIgnoreTransform);
+	});
+}
+
+JPH::ShapeSettings::ShapeResult Barrage::Conversion::FCookedShapeCache::ChaosGeoToJoltShape(const FImplicitObject& ChaosGeo)
+{
+	FShapeKeyBuilder Key;
+	bool bHashable;
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FCookedShapeCache::HashChaosGeo)
+		Key.Add(TEXT('G'));
+		bHashable = Key.AddChaosGeo(ChaosGeo);
+	}
+	if (!bHashable)
+	{
+		JPH::ShapeSettings::ShapeResult Result;
+		if (const JPH::Ref<JPH::ShapeSettings> Settings = ConvertChaosGeoToJoltBody(ChaosGeo))
+		{
+			Result = Settings->Create();
+		}
+		return Result;
+	}
+	return FindOrBuild(Key.Builder.Finalize(), [&]()
+	{
+		return ConvertChaosGeoToJoltBody(ChaosGeo);
+	});
+}
+
+JPH::ShapeSettings::ShapeResult Barrage::Conversion::FCookedShapeCache::FindOrBuild(const FXxHash128& Key,
+                                                                                    TFunctionRef<JPH::ShapeSettings*()> Convert)
+{
+	JPH::ShapeSettings::ShapeResult Result;
+	const bool bUseMemory = GBarrageCookedShapeCache > 0;
+	const bool bUseDisk = GBarrageCookedShapeCache > 1;
+
+	if (bUseMemory)
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const JPH::Ref<JPH::Shape>* Found = Shapes.Find(Key))
+		{
+			Result.Set(*Found);
+			return Result;
+		}
+	}
+
+	JPH::Ref<JPH::Shape> Shape = bUseDisk ? LoadFromDisk(Key) : nullptr;
+	bool bBuilt = false;
+	if (!Shape)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FCookedShapeCache::Convert)
+		// the conversion hands over ownership of the settings, and the created shape outlives them
+		const JPH::Ref<JPH::ShapeSettings> Settings = Convert();
+		if (!Settings)
+		{
+			return Result;
+		}
+		Result = Settings->Create();
+		if (Result.HasError())
+		{
+			return Result;
+		}
+		Shape = Result.Get();
+		bBuilt = true;
+	}
+
+	if (bUseMemory)
+	{
+		FWriteScopeLock WriteLock(Lock);
+		if (const JPH::Ref<JPH::Shape>* Found = Shapes.Find(Key))
+		{
+			// somebody beat us to it. theirs is the one everyone else already has.
+			Shape = *Found;
+			bBuilt = false;
+		}
+		else
+		{
+			Shapes.Add(Key, Shape);
+		}
+	}
+
+	if (bBuilt && bUseDisk)
+	{
+		SaveToDisk(Key, *Shape);
+	}
+	Result.Set(Shape);
+	return Result;
+}
+
+JPH::Ref<JPH::Shape> Barrage::Conversion::FCookedShapeCache::LoadFromDisk(const FXxHash128& Key) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCookedShapeCache::LoadFromDisk)
+	const FString Path = CachePath(CacheDirectory(), Key);
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent) || Bytes.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	FJoltBytesIn In(Bytes);
+	JPH::Shape::IDToShapeMap ShapeMap;
+	JPH::Shape::IDToMaterialMap MaterialMap;
+	JPH::Shape::ShapeResult Restored = JPH::Shape::sRestoreWithChildren(In, ShapeMap, MaterialMap);
+	if (Restored.HasError() || !In.IsFullyRead() || !Restored.Get())
+	{
+		UE_LOGFMT(LogTemp, Warning, "Barrage: cooked shape {Path} didn't restore, rebuilding it", Path);
+		IFileManager::Get().Delete(*Path, false, false, true);
+		return nullptr;
+	}
+	return Restored.Get();
+}
+
+void Barrage::Conversion::FCookedShapeCache::SaveToDisk(const FXxHash128& Key, const JPH::Shape& Shape) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCookedShapeCache::SaveToDisk)
+	TArray<uint8> Bytes;
+	FJoltBytesOut Out(Bytes);
+	JPH::Shape::ShapeToIDMap ShapeMap;
+	JPH::Shape::MaterialToIDMap MaterialMap;
+	Shape.SaveWithChildren(Out, ShapeMap, MaterialMap);
+
+	// write beside it and move it into place, so a crash or a second process never leaves half a shape behind
+	const FString Path = CachePath(CacheDirectory(), Key);
+	const FString TempPath = FPaths::CreateTempFilename(*CacheDirectory(), TEXT("Barrage"), TEXT(".tmp"));
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true, false, true))
+	{
+		UE_LOGFMT(LogTemp, Warning, "Barrage: couldn't write cooked shape {Path}", Path);
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+	}
+}
+
+int32 Barrage::Conversion::FCookedShapeCache::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Shapes.Num();
+}
+
+void Barrage::Conversion::FCookedShapeCache::Reset()
+{
+	FWriteScopeLock WriteLock(Lock);
+	Shapes.Empty();
+}
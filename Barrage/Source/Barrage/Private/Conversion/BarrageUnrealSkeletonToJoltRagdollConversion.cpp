@@ -2,9 +2,11 @@
 
 #include "Conversion/BarrageUnrealSkeletonToJoltRagdollConversion.h"
 
+#include "BarrageRagdollPool.h"
 #include "CoordinateUtils.h"
 #include "EPhysicsLayer.h"
 #include "Conversion/BarrageChaosToJoltConversion.h"
+#include "Conversion/BarrageCookedShapeCache.h"
 #include "Jolt/Jolt.h"
 
 #include "Jolt/Physics/Collision/Shape/Shape.h"
@@ -15,16 +17,26 @@
 #include "PhysicsEngine/PhysicsAsset.h"
 #include "PhysicsEngine/PhysicsConstraintTemplate.h"
 #include "PhysicsEngine/SkeletalBodySetup.h"
+#include "UObject/ObjectKey.h"
+
+static JPH::RagdollSettings* CreateJoltRagdollSettings(TNotNull<const USkeleton*> InUnrealSkeleton, TNotNull<const UPhysicsAsset*> InUnrealPhysAsset, TArray<FName>* OutJointBoneNames);
 
 JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSkeleton(TNotNull<const USkeleton*> InUnrealSkeleton, TNotNull<const UPhysicsAsset*> InUnrealPhysAsset) {
+	return CreateJoltRagdollSettings(InUnrealSkeleton, InUnrealPhysAsset, nullptr);
+}
+
+static JPH::RagdollSettings* CreateJoltRagdollSettings(TNotNull<const USkeleton*> InUnrealSkeleton, TNotNull<const UPhysicsAsset*> InUnrealPhysAsset, TArray<FName>* OutJointBoneNames) {
 	
 
 	// maps from jolt bone index to unreal bone setup index
 	struct FBSkeletonConversionHitboxInfo {
 		FTransform ToParentTransform = FTransform::Identity;
 		FName BoneName = NAME_None;
-		JPH::Shape* Shape = nullptr;
-		JPH::Shape* ParentShape = nullptr; // Not always set
+		// reference skeleton index of OriginalConstraint's ConstraintBone1, looked up once. it's what we order by.
+		int32 ConstraintBoneIndex = INDEX_NONE;
+		EPhysicsType PhysicsType = PhysType_Default;
+		JPH::Ref<JPH::Shape> Shape;
+		JPH::Ref<JPH::Shape> ParentShape; // Not always set
 		FConstraintInstance* OriginalConstraint = nullptr; // Not always set
 	};
 
@@ -38,17 +50,31 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 	//LocalToWorld.SetRotation(FRotator(0,-90,0).Quaternion());
 
 	//@todo don't copy this, just walk the original. Are physics assets always connected in one chain?
-	TArray<USkeletalBodySetup*> SortedBodySetups = InUnrealPhysAsset->SkeletalBodySetups;
+	// bone indices get looked up once here, rather than twice per comparison
+	TArray<TPair<int32, USkeletalBodySetup*>, TInlineAllocator<64>> SortedBodySetups;
+	SortedBodySetups.Reserve(InUnrealPhysAsset->SkeletalBodySetups.Num());
+	for (USkeletalBodySetup* SkelBS : InUnrealPhysAsset->SkeletalBodySetups) {
+		if (SkelBS) {
+			SortedBodySetups.Emplace(UnrealRefSkeleton.FindBoneIndex(SkelBS->BoneName), SkelBS);
+		}
+	}
 
-	SortedBodySetups.Sort([&](const USkeletalBodySetup& A, const USkeletalBodySetup& B) {
-		return UnrealRefSkeleton.FindBoneIndex(A.BoneName) < UnrealRefSkeleton.FindBoneIndex(B.BoneName);
+	SortedBodySetups.StableSort([](const TPair<int32, USkeletalBodySetup*>& A, const TPair<int32, USkeletalBodySetup*>& B) {
+		return A.Key < B.Key;
 	});
 	
 	
-	auto JoltSkeleton = new JPH::Skeleton;
-
-	for (USkeletalBodySetup* SkelBS : SortedBodySetups) {
-		int32 BoneIndex = UnrealRefSkeleton.FindBoneIndex(SkelBS->BoneName);
+	JPH::Ref<JPH::Skeleton> JoltSkeleton = new JPH::Skeleton;
+	// the reference skeleton bone behind each joint we add, by joint index
+	TArray<int32, TInlineAllocator<64>> JointBoneIndices;
+	TArray<FName, TInlineAllocator<64>> JointBoneNames;
+
+	for (const TPair<int32, USkeletalBodySetup*>& SortedBodySetup : SortedBodySetups) {
+		USkeletalBodySetup* SkelBS = SortedBodySetup.Value;
+		int32 BoneIndex = SortedBodySetup.Key;
+		if (!ensureMsgf(BoneIndex != INDEX_NONE, TEXT("Barrage: physics asset body %s has no bone in the skeleton"), *SkelBS->BoneName.ToString())) {
+			continue;
+		}
 		FTransform BoneRelativeToParentTransform = UnrealRefSkeleton.GetBoneAbsoluteTransform(BoneIndex);
 		const int32 ParentBoneIndex = UnrealRefSkeleton.GetParentIndex(BoneIndex);
 		const FName BoneName = UnrealRefSkeleton.GetBoneName(BoneIndex);
@@ -81,14 +107,17 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 		else {
 			addedjoint = JoltSkeleton->AddJoint(TCHAR_TO_ANSI(*BoneName.ToString()));
 		}
+		check(static_cast<int32>(addedjoint) == JointBoneIndices.Num());
+		JointBoneIndices.Add(BoneIndex);
+		JointBoneNames.Add(BoneName);
 
 
 		// Create a body setup using simple collision
 		// @todo let this be tweakable in some way?
+		// bodies of the same size across physics assets end up sharing shapes, and the settings don't leak anymore
 		
-		JPH::ShapeSettings* Settings = Barrage::Conversion::UnrealBodySetupToJolt(SkelBS, true, false,false);
-		auto shaperesult = Settings->Create();
-		if (shaperesult.HasError()) {
+		JPH::ShapeSettings::ShapeResult shaperesult = Barrage::Conversion::FCookedShapeCache::Get().BodySetupToJoltShape(SkelBS, true, false, false);
+		if (!shaperesult.IsValid()) {
 			ensure(false);
 			return nullptr;
 		}
@@ -102,9 +131,11 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 		NewHitBoxInfo.BoneName = BoneName;
 		NewHitBoxInfo.Shape = shaperesult.Get();
 		NewHitBoxInfo.ToParentTransform = BoneRelativeToParentTransform;
+		NewHitBoxInfo.PhysicsType = SkelBS->PhysicsType;
 		
 		if (ConstraintInstance) {
 			NewHitBoxInfo.OriginalConstraint = ConstraintInstance;
+			NewHitBoxInfo.ConstraintBoneIndex = UnrealRefSkeleton.FindBoneIndex(ConstraintInstance->ConstraintBone1);
 		}
 		else {
 			NewHitBoxInfo.OriginalConstraint = nullptr;
@@ -122,27 +153,23 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 		return nullptr;
 	}
 
-	HitBoxInfos.StableSort([&](const FBSkeletonConversionHitboxInfo& A, const FBSkeletonConversionHitboxInfo& B) {
-		int32 BoneIndexA = UnrealRefSkeleton.FindBoneIndex(A.OriginalConstraint ? A.OriginalConstraint->ConstraintBone1 : NAME_None);
-		int32 BoneIndexB = UnrealRefSkeleton.FindBoneIndex(B.OriginalConstraint ? B.OriginalConstraint->ConstraintBone1 : NAME_None);
-		return BoneIndexA < BoneIndexB;
+	HitBoxInfos.StableSort([](const FBSkeletonConversionHitboxInfo& A, const FBSkeletonConversionHitboxInfo& B) {
+		return A.ConstraintBoneIndex < B.ConstraintBoneIndex;
 	});
 	
+	TMap<FName, int32, TInlineSetAllocator<64>> HitBoxOfBone;
+	for (int32 Index = 0; Index < HitBoxInfos.Num(); ++Index) {
+		HitBoxOfBone.Add(HitBoxInfos[Index].BoneName, Index);
+	}
 	for (FBSkeletonConversionHitboxInfo& HitBoxInfo : HitBoxInfos) {
 		
-		//@todo absolutely nasty search up the tree
 		if (HitBoxInfo.OriginalConstraint != nullptr) {
 			
-			auto ParentBoneName = HitBoxInfo.OriginalConstraint->ConstraintBone2;
+			const int32* ParentHitboxIndex = HitBoxOfBone.Find(HitBoxInfo.OriginalConstraint->ConstraintBone2);
 			
-			auto ParentHitboxInfo = 
-			HitBoxInfos.FindByPredicate([&](const FBSkeletonConversionHitboxInfo& OtherInfo) {
-				return OtherInfo.BoneName == ParentBoneName;
-			});
-			
-			if (ensure(ParentHitboxInfo)) {
-				if (ensure(ParentHitboxInfo->Shape)) {
-					HitBoxInfo.ParentShape = ParentHitboxInfo->Shape;
+			if (ensure(ParentHitboxIndex)) {
+				if (ensure(HitBoxInfos[*ParentHitboxIndex].Shape)) {
+					HitBoxInfo.ParentShape = HitBoxInfos[*ParentHitboxIndex].Shape;
 				}
 			}
 		}
@@ -156,12 +183,10 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 
 	// Sort the hitboxes to follow the bone array (nasty..)
 	for (int32 i = JoltSkeleton->GetJointCount() - 1; i >= 0; --i) {
-		const JPH::Skeleton::Joint& Joint = JoltSkeleton->GetJoint(i);
+		const int32 JointBoneIndex = JointBoneIndices[i];
 
-		auto OtherIndex = HitBoxInfos.IndexOfByPredicate([&](const FBSkeletonConversionHitboxInfo& Info) {
-			int32 BoneIndex = UnrealRefSkeleton.FindBoneIndex(ANSI_TO_TCHAR(Joint.mName.c_str()));
-			return BoneIndex != INDEX_NONE && BoneIndex == UnrealRefSkeleton.FindBoneIndex(
-				Info.OriginalConstraint ? Info.OriginalConstraint->ConstraintBone1 : NAME_None);
+		auto OtherIndex = HitBoxInfos.IndexOfByPredicate([JointBoneIndex](const FBSkeletonConversionHitboxInfo& Info) {
+			return JointBoneIndex != INDEX_NONE && JointBoneIndex == Info.ConstraintBoneIndex;
 		});
 
 		if (OtherIndex == INDEX_NONE || i == OtherIndex) {
@@ -185,7 +210,8 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 		PartBodyCreationSettings.mPosition = CoordinateUtils::ToJoltCoordinates(ToParentTransform.GetLocation());
 		PartBodyCreationSettings.mRotation = CoordinateUtils::ToJoltRotation(ToParentTransform.GetRotation().GetNormalized());
 
-		const EPhysicsType UnrealPhysType = SortedBodySetups[p]->PhysicsType;
+		// this used to read the body setups in their original order, which stopped lining up with the parts after the sorts above
+		const EPhysicsType UnrealPhysType = HitBoxInfos[p].PhysicsType;
 
 		switch (UnrealPhysType) {
 		default:
@@ -328,55 +354,99 @@ JPH::RagdollSettings* Barrage::Conversion::CreateJoltRagdollSettingsFromUnrealSk
 		ensure(JoltSkeleton->AreJointsCorrectlyOrdered());
 	}
 	
+	if (OutJointBoneNames) {
+		*OutJointBoneNames = JointBoneNames;
+	}
 	return settings;
 }
 
-JPH::Ragdoll* Barrage::Conversion::ExampleCreateJoltRagdollFromUnrealSkeleton(JPH::PhysicsSystem& PhysicsSystem,
+// keyed on object keys, so an asset that gets unloaded and replaced is a different entry rather than a dangling one
+using FRagdollConversionKey = TPair<TObjectKey<USkeleton>, TObjectKey<UPhysicsAsset>>;
+static FCriticalSection GRagdollConversionLock;
+static TMap<FRagdollConversionKey, TSharedPtr<const Barrage::Conversion::FJoltRagdollConversion>> GRagdollConversions;
+
+TSharedPtr<const Barrage::Conversion::FJoltRagdollConversion> Barrage::Conversion::FindOrCreateJoltRagdollSettings(TNotNull<const USkeleton*> InUnrealSkeleton,
+                                                                                                               TNotNull<const UPhysicsAsset*> InUnrealPhysAsset) {
+	const FRagdollConversionKey Key(InUnrealSkeleton.Get(), InUnrealPhysAsset.Get());
+	FScopeLock Lock(&GRagdollConversionLock);
+	if (const TSharedPtr<const FJoltRagdollConversion>* Found = GRagdollConversions.Find(Key)) {
+		return *Found;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(Barrage::Conversion::FindOrCreateJoltRagdollSettings)
+	TSharedRef<FJoltRagdollConversion> Conversion = MakeShared<FJoltRagdollConversion>();
+	Conversion->Settings = CreateJoltRagdollSettings(InUnrealSkeleton, InUnrealPhysAsset, &Conversion->JointBoneNames);
+	if (!Conversion->Settings) {
+		return nullptr;
+	}
+
+	// both of these change the settings, so they happen once here instead of on every ragdoll made from them
+	// Optional: Stabilize the inertia of the limbs
+	Conversion->Settings->Stabilize();
+	// Disable parent child collisions so that we don't get collisions between constrained bodies
+	Conversion->Settings->DisableParentChildCollisions();
+
+	GRagdollConversions.Add(Key, Conversion);
+	return Conversion;
+}
+
+void Barrage::Conversion::ResetJoltRagdollSettingsCache() {
+	FScopeLock Lock(&GRagdollConversionLock);
+	GRagdollConversions.Empty();
+}
+
+void Barrage::Conversion::PruneJoltRagdollSettingsCache() {
+	FScopeLock Lock(&GRagdollConversionLock);
+	for (auto It = GRagdollConversions.CreateIterator(); It; ++It) {
+		if (!It.Key().Key.ResolveObjectPtr() || !It.Key().Value.ResolveObjectPtr()) {
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool Barrage::Conversion::PoseJoltRagdollFromComponent(const FJoltRagdollConversion& Conversion,
+                                                       TNotNull<const USkeletalMeshComponent*> InUnrealSkeletalMeshComponent,
+                                                       JPH::SkeletonPose& OutPose) {
+	const JPH::Skeleton* JoltSkeleton = Conversion.Settings->GetSkeleton();
+	OutPose.SetSkeleton(JoltSkeleton);
+	
+	JPH::Array<JPH::Mat44>& MatricesRef = OutPose.GetJointMatrices();
+	const TArray<FTransform>& ComponentSpaceBoneTransforms = InUnrealSkeletalMeshComponent->GetEditableComponentSpaceTransforms();
+	const FTransform& UnrealTransform = InUnrealSkeletalMeshComponent->GetComponentTransform();
+
+	for (int32 MatIndex = 0; MatIndex < MatricesRef.size(); ++MatIndex) {
+		// the root is bone 0, which the old truthiness test here quietly skipped
+		const int32 BoneIndex = InUnrealSkeletalMeshComponent->GetBoneIndex(Conversion.JointBoneNames[MatIndex]);
+		if (BoneIndex == INDEX_NONE) {
+			continue;
+		}
+		if (!ComponentSpaceBoneTransforms.IsValidIndex(BoneIndex)) {
+			return false;
+		}
+		// should we skip SetRootOffset??
+		//@todo nasty -90 because unreal
+		auto BoneWorldTransform = InUnrealSkeletalMeshComponent->GetBoneTransform(BoneIndex, UnrealTransform);
+		MatricesRef[MatIndex] = CoordinateUtils::ToJoltMat44NoScale(BoneWorldTransform);
+	}
+	return true;
+}
+
+JPH::Ref<JPH::Ragdoll> Barrage::Conversion::ExampleCreateJoltRagdollFromUnrealSkeleton(JPH::PhysicsSystem& PhysicsSystem,
+	FBarrageRagdollPool& Pool,
 	TNotNull<const USkeletalMeshComponent*> InUnrealSkeletalMeshComponent,
 	TNotNull<const USkeleton*> InUnrealSkeleton,
 	TNotNull<const UPhysicsAsset*> InUnrealPhysAsset) {
 	
-	JPH::RagdollSettings* RagdollSettings = CreateJoltRagdollSettingsFromUnrealSkeleton(InUnrealSkeleton, InUnrealPhysAsset);
+	// stabilized and collision filtered already, see FindOrCreateJoltRagdollSettings
+	TSharedPtr<const FJoltRagdollConversion> Conversion = FindOrCreateJoltRagdollSettings(InUnrealSkeleton, InUnrealPhysAsset);
 	
-	if (RagdollSettings) {
+	if (Conversion) {
 		
 		using namespace JPH;
 		// init pose
-		const JPH::Skeleton* JoltSkeleton = RagdollSettings->GetSkeleton();
-		
 		JPH::SkeletonPose JoltPose;
-		JoltPose.SetSkeleton(JoltSkeleton);
-		
-		JPH::Array<JPH::Mat44>& MatricesRef = JoltPose.GetJointMatrices();
-		
-	    	
-		const TArray<FTransform>& ComponentSpaceBoneTransforms = InUnrealSkeletalMeshComponent->GetEditableComponentSpaceTransforms();
-
-
-		const auto Unreal90Quat = FRotator(0, -90, 0).Quaternion(); // unreal 90 quat
-		
-		
-		const auto Rotation = CoordinateUtils::ToJoltRotation(InUnrealSkeletalMeshComponent->GetComponentRotation().Quaternion());
-		const FTransform& UnrealTransform = InUnrealSkeletalMeshComponent->GetComponentTransform();
-
-		for (int32 MatIndex = 0; MatIndex < MatricesRef.size(); ++MatIndex) {
-			const JPH::String& BoneName = JoltSkeleton->GetJoints()[MatIndex].mName;
-
-			if (auto BoneIndex = InUnrealSkeletalMeshComponent->GetBoneIndex(BoneName.data())) {
-				if (!ComponentSpaceBoneTransforms.IsValidIndex(BoneIndex)) {
-					return nullptr;
-				}
-				// should we skip SetRootOffset??
-				//@todo nasty -90 because unreal
-				auto BoneWorldTransform = InUnrealSkeletalMeshComponent->GetBoneTransform(BoneIndex, UnrealTransform);
-				FTransform BoneBoneTransform =  ComponentSpaceBoneTransforms[BoneIndex];
-				// BoneBoneTransform *= Unreal90Quat;
-				// auto Translation = JPH::ToVec3Coord(BoneBoneTransform.GetTranslation());
-				// auto JoltRotation = JPH::ToQuat(BoneBoneTransform.GetRotation());
-				//@todo this is definitely wrong?
-				// auto JoltRotation90 =  Rotation * Quat::sRotation(Vec3(0,1,0), 90);
-				MatricesRef[MatIndex] =  CoordinateUtils::ToJoltMat44NoScale(BoneWorldTransform);
-			}
+		if (!PoseJoltRagdollFromComponent(*Conversion, InUnrealSkeletalMeshComponent, JoltPose)) {
+			return nullptr;
 		}
 
 
@@ -385,27 +455,17 @@ JPH::Ragdoll* Barrage::Conversion::ExampleCreateJoltRagdollFromUnrealSkeleton(JP
 
 		// JoltPose.CalculateJointMatrices();
 
-
-		// Optional: Stabilize the inertia of the limbs
-		RagdollSettings->Stabilize();
-	
-		// Disable parent child collisions so that we don't get collisions between constrained bodies
-		RagdollSettings->DisableParentChildCollisions();
-
-		
-		// Create and alloc ragdoll
-		JPH::Ragdoll* Ragdoll = RagdollSettings->CreateRagdoll(0, 0, &PhysicsSystem);
-		
-		Ragdoll->AddToPhysicsSystem(JPH::EActivation::Activate);
 		
+		// a spare from the pool if there is one, already posed and in the world. nullptr if we're out of bodies.
+		JPH::Ref<JPH::Ragdoll> Ragdoll = Pool.Acquire(PhysicsSystem, *Conversion->Settings, JoltPose);
+		if (!Ragdoll) {
+			return nullptr;
+		}
 		
 		constexpr bool bUseKinematicBones = false;
 		if (bUseKinematicBones) {
 			Ragdoll->DriveToPoseUsingKinematics(JoltPose, 60/128, true);
 		}
-		else {
-			Ragdoll->SetPose(JoltPose, true);
-		}
 		
 		
 		
@@ -417,3 +477,8 @@ JPH::Ragdoll* Barrage::Conversion::ExampleCreateJoltRagdollFromUnrealSkeleton(JP
 
 }
 
+void Barrage::Conversion::ReleaseJoltRagdoll(FBarrageRagdollPool& Pool, JPH::Ragdoll* Ragdoll) {
+	Pool.Release(Ragdoll);
+	// a ragdoll going back is usually one of the last things a level does with an asset, so this is as good a time as any.
+	PruneJoltRagdollSettingsCache();
+}
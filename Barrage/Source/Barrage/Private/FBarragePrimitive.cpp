@@ -30,6 +30,11 @@ FBarragePrimitive::~FBarragePrimitive()
 //-----------------
 
 void FBarragePrimitive::ApplyRotation(FQuat4d Rotator, FBLet Target)
+{
+	ApplyRotation(Rotator, Target.Get());
+}
+
+void FBarragePrimitive::ApplyRotation(FQuat4d Rotator, const FBarragePrimitive* Target)
 {
 	if (GlobalBarrage && IsNotNull(Target))
 	{
@@ -49,6 +54,32 @@ void FBarragePrimitive::ApplyRotation(FQuat4d Rotator, FBLet Target)
 	}
 }
 
+void FBarragePrimitive::ApplyRotations(TConstArrayView<FBarragePrimitive*> Targets, TConstArrayView<FQuat4d> Rotators)
+{
+	check(Targets.Num() == Rotators.Num());
+	if (GlobalBarrage)
+	{
+		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
+		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
+		{
+			auto& Queue = GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue;
+			for (int32 Index = 0; Index < Targets.Num(); ++Index)
+			{
+				const FBarragePrimitive* Target = Targets[Index];
+				if (IsNotNull(Target))
+				{
+#if !UE_BUILD_SHIPPING
+					ensureMsgf(Rotators[Index].IsNormalized(), TEXT("Non-normalized rotation passed in to FBarragePrimitive::ApplyRotations"));
+#endif
+					Queue->Enqueue(
+						FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::Rotation,
+						               CoordinateUtils::ToBarrageRotation(Rotators[Index]), Target->Me));
+				}
+			}
+		}
+	}
+}
+
 //generally, this should be called from the same thread as update.
 //it MUST be called with an existing pinned shared ptr.
 // ReSharper disable once CppRedundantInlineSpecifier
@@ -85,8 +116,9 @@ void FBarragePrimitive::TryUpdateTransformFromJolt(const FBarragePrimitive* Targ
 				Pos);
 		}
 	}
-	else if (!result.IsInvalid() && GameSimHoldOpen->body_interface->IsActive(result))
-	//we should still exclude invalid bIDs other than characters.
+	else if (!result.IsInvalid() && GameSimHoldOpen->body_interface->IsAdded(result))
+	//we should still exclude invalid bIDs other than characters. we're only handed bodies that moved this step, and a
+	//body that just fell asleep still needs its last pose sent, so this can't check IsActive.
 	{
 		// //TODO: figure out how to make this less.... horrid.
 		// //TODO: figure out how to make this less.... horrid.
@@ -118,6 +150,11 @@ FVector3f FBarragePrimitive::GetCentroidPossiblyStale(FBLet Target)
 }
 
 FVector3f FBarragePrimitive::GetPosition(FBLet Target)
+{
+	return GetPosition(Target.Get());
+}
+
+FVector3f FBarragePrimitive::GetPosition(const FBarragePrimitive* Target)
 {
 	if (GlobalBarrage && IsNotNull(Target))
 	{
@@ -174,6 +211,11 @@ FQuat FBarragePrimitive::OptimisticGetAbsoluteRotation(FBLet Target)
 }
 
 FVector3f FBarragePrimitive::GetVelocity(FBLet Target)
+{
+	return GetVelocity(Target.Get());
+}
+
+FVector3f FBarragePrimitive::GetVelocity(const FBarragePrimitive* Target)
 {
 	if (IsNotNull(Target) && GlobalBarrage)
 	{
@@ -203,6 +245,11 @@ FVector3f FBarragePrimitive::GetVelocity(FBLet Target)
 }
 
 void FBarragePrimitive::SetVelocity(FVector3d Velocity, FBLet Target)
+{
+	SetVelocity(Velocity, Target.Get());
+}
+
+void FBarragePrimitive::SetVelocity(FVector3d Velocity, const FBarragePrimitive* Target)
 {
 	if (GlobalBarrage && IsNotNull(Target))
 	{
@@ -217,6 +264,29 @@ void FBarragePrimitive::SetVelocity(FVector3d Velocity, FBLet Target)
 	}
 }
 
+void FBarragePrimitive::SetVelocities(TConstArrayView<FBarragePrimitive*> Targets, TConstArrayView<FVector3d> Velocities)
+{
+	check(Targets.Num() == Velocities.Num());
+	if (GlobalBarrage)
+	{
+		TSharedPtr<FWorldSimOwner> GameSimHoldOpen = GlobalBarrage->JoltGameSim;
+		if (GameSimHoldOpen && MyBARRAGEIndex < ALLOWED_THREADS_FOR_BARRAGE_PHYSICS)
+		{
+			auto& Queue = GameSimHoldOpen->ThreadAcc[MyBARRAGEIndex].Queue;
+			for (int32 Index = 0; Index < Targets.Num(); ++Index)
+			{
+				const FBarragePrimitive* Target = Targets[Index];
+				if (IsNotNull(Target))
+				{
+					JPH::Quat lastchance = CoordinateUtils::ToBarrageVelocity(Velocities[Index]);
+					lastchance = lastchance.IsNaN() ? JPH::Quat::sZero() : lastchance;
+					Queue->Enqueue(FBPhysicsInput(Target->KeyIntoBarrage, 0, PhysicsInputType::Velocity, lastchance, Target->Me));
+				}
+			}
+		}
+	}
+}
+
 void FBarragePrimitive::SetPosition(FVector Position, FBLet Target)
 {
 	if (GlobalBarrage && IsNotNull(Target))
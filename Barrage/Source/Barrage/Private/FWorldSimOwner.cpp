@@ -5,16 +5,20 @@
 #include "CoordinateUtils.h"
 #include "LandscapeComponent.h"
 #include "LandscapeProxy.h"
-#include "Experimental/CollisionGroupUnaware_FleshBroadPhase.h"
+#include "Experimental/FleshBroadPhase.h"
 #include "PhysicsCharacter.h"
 #include "StaticMeshCompiler.h"
 #include "CastShapeCollectors/SphereCastCollector.h"
 #include "CastShapeCollectors/SphereSearchCollector.h"
+#include "CastShapeCollectors/SphereCountCollector.h"
 #include "CollisionDetectionFilters/FirstHitRayCastCollector.h"
+#include "CollisionDetectionFilters/RayPacket.h"
 #include "Chaos/TriangleMeshImplicitObject.h"
 #include "Engine/StaticMesh.h"
 #include "Conversion/BarrageChaosToJoltConversion.h"
+#include "Conversion/BarrageCookedShapeCache.h"
 #include "Jolt/Physics/Collision/BroadPhase/BroadPhaseBruteForce.h"
+#include "Experimental/BPPaddingtonTree.h"
 #include "PhysicsProxy/SingleParticlePhysicsProxy.h"
 
 
@@ -36,6 +40,38 @@ static FAutoConsoleVariableRef CVarCustomBarrageJoltThreadMultipier(
 	ECVF_Default
 );
 
+int32 GBarrageBroadPhase = 0;
+static FAutoConsoleVariableRef CVarBarrageBroadPhase(
+	TEXT("barrage.BroadPhase"),
+	GBarrageBroadPhase,
+	TEXT("Broadphase for worlds that don't ask for a specific one. 0 is Jolt's quadtree, 1 is the Paddington tree, 2 is FLESH. Read when the world is created."),
+	ECVF_Default
+);
+
+float GBarrageBroadPhaseOptimizeChurn = .25f;
+static FAutoConsoleVariableRef CVarBarrageBroadPhaseOptimizeChurn(
+	TEXT("barrage.BroadPhaseOptimizeChurn"),
+	GBarrageBroadPhaseOptimizeChurn,
+	TEXT("How much of a broadphase layer has to churn, as a fraction of the bodies in it, before the layer is rebuilt. See barrage.BroadPhaseOptimizeMovesPerChange."),
+	ECVF_Default
+);
+
+int32 GBarrageBroadPhaseOptimizeMinChurn = 64;
+static FAutoConsoleVariableRef CVarBarrageBroadPhaseOptimizeMinChurn(
+	TEXT("barrage.BroadPhaseOptimizeMinChurn"),
+	GBarrageBroadPhaseOptimizeMinChurn,
+	TEXT("The least churn that will rebuild a broadphase layer, however small the layer is."),
+	ECVF_Default
+);
+
+int32 GBarrageBroadPhaseOptimizeMovesPerChange = 256;
+static FAutoConsoleVariableRef CVarBarrageBroadPhaseOptimizeMovesPerChange(
+	TEXT("barrage.BroadPhaseOptimizeMovesPerChange"),
+	GBarrageBroadPhaseOptimizeMovesPerChange,
+	TEXT("How many bounding box changes count as much churn as one body added or removed."),
+	ECVF_Default
+);
+
 int32 GetDesiredBarrageJobThreadCount() 
 {
 	if (GBarrageJoltThreadCountOverride > 0) 
@@ -54,13 +90,12 @@ int32 GetDesiredBarrageJobThreadCount()
 using namespace JOLT;
 //it's going to be quite tempting to make that initexit a const or a reference. don't.
 // ReSharper disable once CppPassValueParameterByConstReference
-FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadInitializer)
+FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadInitializer, EBarrageBroadPhase BroadPhase)
 {
 	DeltaTime = cDeltaTime;
 
 	BarrageToJoltMapping = MakeShareable(new KeyToBody());
 	CharacterToJoltMapping = MakeShareable(new TMap<FBarrageKey, TSharedPtr<FBCharacterBase>>());
-	//mTestBroadPhase = std::make_shared<CollisionGroupUnaware_FleshBroadPhase>();
 
 	//hey future friend! collision listeners, character collision, and character collision listeners live below. so...
 	//if you are looking for character collision behavior, this is the line that sets it up.
@@ -79,11 +114,29 @@ FWorldSimOwner::FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadIniti
 	job_system->SetThreadInitFunction(JobThreadInitializer);
 
 
+	if (BroadPhase == EBarrageBroadPhase::Default)
+	{
+		BroadPhase = GBarrageBroadPhase == 1 ? EBarrageBroadPhase::PaddingtonTree
+			: GBarrageBroadPhase == 2 ? EBarrageBroadPhase::Flesh
+			: EBarrageBroadPhase::QuadTree;
+	}
+	//jolt owns whatever we hand it and deletes it with the physics system. null means its own quadtree.
+	JPH::BroadPhase* ChosenBroadPhase = nullptr;
+	if (BroadPhase == EBarrageBroadPhase::PaddingtonTree)
+	{
+		ChosenBroadPhase = new MMBP_PaddingtonTree();
+	}
+	else if (BroadPhase == EBarrageBroadPhase::Flesh)
+	{
+		ChosenBroadPhase = new FleshBroadPhase();
+	}
+
 	// Now we can create the actual physics system.
 	physics_system->Init(cMaxBodies, cNumBodyMutexes, cMaxBodyPairs, cMaxContactConstraints,
 		broad_phase_layer_interface, object_vs_broadphase_layer_filter,
-		object_vs_object_layer_filter);  //, mTestBroadPhase.get()); this can be used to experiment with broadphases.
+		object_vs_object_layer_filter, ChosenBroadPhase);
 	physics_system->SetContactListener(contact_listener.Get());
+	physics_system->SetBodyActivationListener(&BodyTracker);
 	// The main way to interact with the bodies in the physics system is through the body interface. There is a locking and a non-locking
 	// variant of this. We're going to use the locking version.
 	body_interface = &physics_system->GetBodyInterface();
@@ -180,6 +233,104 @@ void FWorldSimOwner::SphereSearch(
 	}
 }
 
+uint32 FWorldSimOwner::SphereCount(
+	const FVector3d& Location,
+	double Radius,
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+	const JPH::ObjectLayerFilter& ObjectFilter,
+	const JPH::BodyFilter& BodiesFilter,
+	TFunctionRef<bool(uint32)> Predicate,
+	uint32 StopAt,
+	TArray<uint32>* OutFirstFound) const
+{
+	if (StopAt == 0)
+	{
+		return 0;
+	}
+	SphereCountCollector Collector(physics_system->GetBodyLockInterfaceNoLock(), BodiesFilter, Predicate, StopAt, OutFirstFound);
+	physics_system->GetBroadPhaseQuery().CollideSphere(CoordinateUtils::ToJoltCoordinates(Location), Radius, Collector, BroadPhaseFilter, ObjectFilter);
+	return Collector.mCount;
+}
+
+void FWorldSimOwner::SphereCountMany(
+	TConstArrayView<FVector3d> Locations,
+	double Radius,
+	const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+	const JPH::ObjectLayerFilter& ObjectFilter,
+	const JPH::BodyFilter& BodiesFilter,
+	TFunctionRef<bool(uint32)> Predicate,
+	TArrayView<uint32> OutCounts,
+	uint32 StopAt) const
+{
+	check(OutCounts.Num() >= Locations.Num());
+	TArray<JPH::Vec3, TInlineAllocator<64>> Centers;
+	TArray<int32, TInlineAllocator<64>> Sources;
+	JPH::AABox Everywhere;
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		OutCounts[Index] = 0;
+		//a NaN center counts nothing, and stays out of the box so it can't poison the walk for the rest.
+		if (Locations[Index].ContainsNaN())
+		{
+			continue;
+		}
+		Sources.Add(Index);
+		Centers.Add(CoordinateUtils::ToJoltCoordinates(Locations[Index]));
+		Everywhere.Encapsulate(Centers.Last());
+	}
+	if (Centers.IsEmpty() || StopAt == 0)
+	{
+		return;
+	}
+	Everywhere.ExpandBy(JPH::Vec3::sReplicate(static_cast<float>(Radius)));
+
+	JPH::AllHitCollisionCollector<JPH::CollideShapeBodyCollector> Candidates;
+	physics_system->GetBroadPhaseQuery().CollideAABox(Everywhere, Candidates, BroadPhaseFilter, ObjectFilter);
+
+	//the same bounds against sphere test the broadphase does for a single SphereCount, per center.
+	const float RadiusSq = static_cast<float>(Radius * Radius);
+	const BodyLockInterface& Locks = physics_system->GetBodyLockInterfaceNoLock();
+	int32 Open = Centers.Num();
+	for (const BodyID& Candidate : Candidates.mHits)
+	{
+		if (!BodiesFilter.ShouldCollide(Candidate))
+		{
+			continue;
+		}
+		JPH::AABox Bounds;
+		{
+			BodyLockRead Lock(Locks, Candidate);
+			if (!Lock.SucceededAndIsInBroadPhase() || !BodiesFilter.ShouldCollideLocked(Lock.GetBody()))
+			{
+				continue;
+			}
+			Bounds = Lock.GetBody().GetWorldSpaceBounds();
+		}
+		//the predicate is the expensive part, so it waits until a sphere that still needs counting is touched.
+		int8 Passed = -1;
+		for (int32 Index = 0; Index < Centers.Num(); ++Index)
+		{
+			uint32& Count = OutCounts[Sources[Index]];
+			if (Count >= StopAt || Bounds.GetSqDistanceTo(Centers[Index]) > RadiusSq)
+			{
+				continue;
+			}
+			if (Passed < 0)
+			{
+				Passed = Predicate(Candidate.GetIndexAndSequenceNumber()) ? 1 : 0;
+			}
+			if (Passed == 0)
+			{
+				break;
+			}
+			if (++Count >= StopAt && --Open == 0)
+			{
+				return;
+			}
+		}
+	}
+}
+
 void FWorldSimOwner::CastRay(FVector3d CastFrom, FVector3d Direction, const BroadPhaseLayerFilter& BroadPhaseFilter, const ObjectLayerFilter& ObjectFilter, const BodyFilter& BodiesFilter, TSharedPtr<FHitResult> OutHit) const
 {
 	check(OutHit.IsValid());
@@ -211,6 +362,103 @@ void FWorldSimOwner::CastRay(FVector3d CastFrom, FVector3d Direction, const Broa
 	}
 }
 
+void FWorldSimOwner::CastRayPacket(TConstArrayView<FVector3d> CastFrom, TConstArrayView<FVector3d> Directions, const BroadPhaseLayerFilter& BroadPhaseFilter, const ObjectLayerFilter& ObjectFilter, const BodyFilter& BodiesFilter, TArrayView<FHitResult> OutHits) const
+{
+	check(Directions.Num() == CastFrom.Num() && OutHits.Num() >= CastFrom.Num());
+	const BodyLockInterface& Locks = physics_system->GetBodyLockInterfaceNoLock();
+	//rays are packed with others pointing into the same octant, and otherwise in the order they came in, so rays headed
+	//opposite ways never share a packet whose box spans both. a NaN origin is a miss. it stays out of the packets, so it
+	//can't poison the bounds everyone else is culled by.
+	TArray<TPair<uint32, int32>> Order;
+	Order.Reserve(CastFrom.Num());
+	for (int32 Index = 0; Index < CastFrom.Num(); ++Index)
+	{
+		if (CastFrom[Index].ContainsNaN())
+		{
+			OutHits[Index].Init();
+			OutHits[Index].MyItem = JPH::BodyID::cInvalidBodyID;
+			continue;
+		}
+		const FVector3d& Direction = Directions[Index];
+		Order.Emplace((Direction.X < 0) | (Direction.Y < 0) << 1 | (Direction.Z < 0) << 2, Index);
+	}
+	Order.StableSort([](const TPair<uint32, int32>& A, const TPair<uint32, int32>& B) { return A.Key < B.Key; });
+
+	for (int32 First = 0; First < Order.Num();)
+	{
+		RRayCast Rays[RayPacket::MaxRays];
+		RayCastResult Results[RayPacket::MaxRays];
+		//which of CastFrom each packed ray came from.
+		int32 Sources[RayPacket::MaxRays];
+		int32 Live = 0;
+		const uint32 Octant = Order[First].Key;
+		for (; First < Order.Num() && Live < RayPacket::MaxRays && Order[First].Key == Octant; ++First)
+		{
+			const int32 Index = Order[First].Value;
+			Sources[Live] = Index;
+			Rays[Live++] = RRayCast(CoordinateUtils::ToJoltCoordinates(CastFrom[Index]), CoordinateUtils::ToJoltCoordinates(Directions[Index]));
+		}
+		RayPacket Packet(MakeArrayView(Rays, Live));
+
+		//one walk of the broadphase for the whole packet, with whichever box around it is thinner, so most of what
+		//the axis aligned box would have dragged in never gets looked up. everything after this is leaf work.
+		AllHitCollisionCollector<CollideShapeBodyCollector> Candidates;
+		if (Packet.IsOrientedBoundsTighter())
+		{
+			physics_system->GetBroadPhaseQuery().CollideOrientedBox(Packet.GetOrientedBounds(), Candidates, BroadPhaseFilter, ObjectFilter);
+		}
+		else
+		{
+			physics_system->GetBroadPhaseQuery().CollideAABox(Packet.GetBounds(), Candidates, BroadPhaseFilter, ObjectFilter);
+		}
+		for (const BodyID& Candidate : Candidates.mHits)
+		{
+			if (!BodiesFilter.ShouldCollide(Candidate))
+			{
+				continue;
+			}
+			BodyLockRead Lock(Locks, Candidate);
+			if (!Lock.SucceededAndIsInBroadPhase() || !BodiesFilter.ShouldCollideLocked(Lock.GetBody()))
+			{
+				continue;
+			}
+			uint32 Touching = Packet.Overlaps(Lock.GetBody().GetWorldSpaceBounds());
+			if (Touching == 0)
+			{
+				continue;
+			}
+			const TransformedShape Shape = Lock.GetBody().GetTransformedShape();
+			Lock.ReleaseLock();
+			for (; Touching != 0; Touching &= Touching - 1)
+			{
+				const int32 Ray = FMath::CountTrailingZeros(Touching);
+				//only reports a hit if it's closer than the one we've already got.
+				if (Shape.CastRay(Rays[Ray], Results[Ray]))
+				{
+					Packet.ClampRay(Ray, Results[Ray].mFraction);
+				}
+			}
+		}
+
+		for (int32 Ray = 0; Ray < Live; ++Ray)
+		{
+			FHitResult& Hit = OutHits[Sources[Ray]];
+			Hit.Init();
+			Hit.MyItem = JPH::BodyID::cInvalidBodyID;
+			if (Results[Ray].mBodyID.IsInvalid())
+			{
+				continue;
+			}
+			Hit.MyItem = Results[Ray].mBodyID.GetIndexAndSequenceNumber();
+			Hit.bBlockingHit = true;
+			const FVector3f UnrealContactPos = CoordinateUtils::FromJoltCoordinates(Rays[Ray].GetPointOnRay(Results[Ray].mFraction));
+			Hit.Location.Set(UnrealContactPos.X, UnrealContactPos.Y, UnrealContactPos.Z);
+			Hit.ImpactPoint.Set(UnrealContactPos.X, UnrealContactPos.Y, UnrealContactPos.Z);
+			Hit.Distance = (UnrealContactPos - FVector3f(CastFrom[Sources[Ray]])).Length();
+		}
+	}
+}
+
 EMotionType FWorldSimOwner::LayerToMotionTypeMapping(uint16 Layer)
 {
 	switch (Layer)
@@ -395,7 +643,8 @@ FBarrageKey FWorldSimOwner::CreatePrimitive(FBCharParams& ToCreate, uint16 Layer
 	NewCharacter->mCharacterSettings.mCharacterPadding = 0.08f;
 	NewCharacter->mListener = character_contact_listener;
 	// Create the shape
-	BodyID BodyIDTemp = NewCharacter->Create(&this->CharacterVsCharacterCollisionSimple);
+	BodyID BodyIDTemp = NewCharacter->Create(bCharactersCollide ? &this->CharacterGrid : nullptr, CharacterShapes);
+	CharacterGrid.Add(NewCharacter->mCharacter, NewCharacter.Get());
 	//AddInternalQueuing(BodyIDTemp, 0);// we can't figure this out yet. we'll have to set it later or rearch for data exposure reasons. --JMK, can kicka
 	//Barrage key is unique to WORLD and BODY. This is crushingly important.
 	FBarrageKey FBK = GenerateBarrageKeyFromBodyId(BodyIDTemp);
@@ -450,21 +699,9 @@ void FWorldSimOwner::GetBodiesList(BodyIDVector &outBodyIDs)
 	}
 }
 
-//If you set layer to nonmoving, you should set movement type to nonmoving as well or you're going to have
-//a really terrible time. It's not technically wrong to do this, so we don't throw, but there's no good
-//reason I can think of. At this API level, intended for extremely advanced users,
-//it is our policy to be no-throw wherever possible, and to permit behavior that
-//is not rational so long as it is sane.
-FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
-	const UStaticMeshComponent* StaticMeshComponent,
-	FSkeletonKey Outkey, Layers::EJoltPhysicsLayer Layer, EMotionType Movement, bool IsSensor, bool ForceActualMesh, FVector CenterOfMassTranslation)
+//everything we need to look at before there's a body setup to convert. nullptr if there's no usable collision.
+static UBodySetup* GetCollisionBodySetup(const UStaticMeshComponent* StaticMeshComponent)
 {
-	
-	TRACE_CPUPROFILER_EVENT_SCOPE(FWorldSimOwner::LoadComplexStaticMesh)
-
-	// using ParticlesType = Chaos::TParticles<Chaos::FRealSingle, 3>;
-	// using ParticleVecType = Chaos::TVec3<Chaos::FRealSingle>;
-	using ::CoordinateUtils;
 	//why do we check render data here?
 	if (!StaticMeshComponent || !StaticMeshComponent->GetStaticMesh() || !StaticMeshComponent->GetStaticMesh()->GetRenderData())
 	{
@@ -472,7 +709,6 @@ FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
 		UE_LOG(LogTemp, Warning, TEXT("Can't find body for setup..."));
 		return nullptr;
 	}
-	EMotionQuality MotionQuality = LayerToMotionQualityMapping(Layer);
 	UBodySetup* body = StaticMeshComponent->GetStaticMesh()->GetBodySetup();
 	if (!body)
 	{
@@ -505,40 +741,28 @@ FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
 	}
 #endif
 	
-	UBodySetup* collbody = CollisionMesh->GetBodySetup();
-	if (collbody == nullptr)
-	{
-		return nullptr;
-	}
+	return CollisionMesh->GetBodySetup();
+}
 
-	//Here we go!
-	JPH::ShapeSettings* JoltShapeSetting = Barrage::Conversion::UnrealBodySetupToJolt(collbody, true);
-	if (!JoltShapeSetting)
+//Here we go! every instance of this mesh gets the same shape, and a mesh we've seen before comes off disk.
+//safe from any thread. empty if the body setup had nothing to convert.
+static JPH::ShapeSettings::ShapeResult CookStaticMeshShape(const UBodySetup* collbody)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(Create Shape)
+	Barrage::Conversion::FCookedShapeCache& CookedShapes = Barrage::Conversion::FCookedShapeCache::Get();
+	JPH::ShapeSettings::ShapeResult ShapeCreationResult = CookedShapes.BodySetupToJoltShape(collbody, true);
+	if (ShapeCreationResult.IsEmpty())
 	{
 		// Try again but use complex this time
-		JoltShapeSetting = Barrage::Conversion::UnrealBodySetupToJolt(collbody, false, true);
-	}
-	
-	if (!JoltShapeSetting)
-	{
-		return nullptr;
+		ShapeCreationResult = CookedShapes.BodySetupToJoltShape(collbody, false, true);
 	}
-	
-	JPH::ShapeSettings::ShapeResult ShapeCreationResult;
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(Create Shape)
-		ShapeCreationResult = JoltShapeSetting->Create();
-		if (ShapeCreationResult.HasError())
-		{
-			ensureMsgf(false, TEXT("Jolt body creation failed! Error: %hs"), ShapeCreationResult.GetError().c_str());
-			return nullptr;
-		}
-	}
-
-	//TODO: should we be holding the shape ref in gamesim owner?
-	const Ref<Shape>& CreatedShape = ShapeCreationResult.Get();
+	return ShapeCreationResult;
+}
 
-	BodyCreationSettings creation_settings;
+bool FWorldSimOwner::MakeStaticMeshBodySettings(const JPH::Shape* CreatedShape, const FBTransform& MeshTransform,
+	Layers::EJoltPhysicsLayer Layer, EMotionType Movement, bool IsSensor, FVector CenterOfMassTranslation,
+	BodyCreationSettings& creation_settings) const
+{
 	creation_settings.mMotionType = Movement;
 	creation_settings.mObjectLayer = Layer;
 	creation_settings.mFriction = 0.5f;
@@ -546,14 +770,16 @@ FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
 	creation_settings.mRestitution = 0;
 	creation_settings.mMassPropertiesOverride.SetMassAndInertiaOfSolidBox(CreatedShape->GetLocalBounds().GetExtent() * 2, 1);
 	creation_settings.mMassPropertiesOverride.mMass = EBWeightClasses::HugeEnemy;
-	creation_settings.mMotionQuality = MotionQuality;
+	creation_settings.mMotionQuality = LayerToMotionQualityMapping(Layer);
 	creation_settings.mUseManifoldReduction = true;
 	creation_settings.mIsSensor = IsSensor;
 	creation_settings.mAllowSleeping = false;
 	Shape::ShapeResult result = CreatedShape->ScaleShape(MeshTransform.GetJoltScale());
 	if (result.HasError() || result.IsEmpty())
 	{
-		throw;
+		//this used to be a bare throw, which with nothing in flight is just a terminate. no-throw, remember.
+		ensureMsgf(false, TEXT("Barrage: couldn't scale a static mesh shape. Error: %hs"), result.HasError() ? result.GetError().c_str() : "empty");
+		return false;
 	}
 	//reminder: translation and position do differ.
 	if (CenterOfMassTranslation == FVector::ZeroVector && MeshTransform.GetRotationQuat() == FQuat4f::Identity)
@@ -566,6 +792,44 @@ FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
 		creation_settings.SetShape(OriginAndRotationApplied);
 	}
 	creation_settings.mPosition = CoordinateUtils::ToJoltCoordinates(MeshTransform.GetUnrealLocation());
+	return true;
+}
+
+//If you set layer to nonmoving, you should set movement type to nonmoving as well or you're going to have
+//a really terrible time. It's not technically wrong to do this, so we don't throw, but there's no good
+//reason I can think of. At this API level, intended for extremely advanced users,
+//it is our policy to be no-throw wherever possible, and to permit behavior that
+//is not rational so long as it is sane.
+FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
+	const UStaticMeshComponent* StaticMeshComponent,
+	FSkeletonKey Outkey, Layers::EJoltPhysicsLayer Layer, EMotionType Movement, bool IsSensor, bool ForceActualMesh, FVector CenterOfMassTranslation)
+{
+	
+	TRACE_CPUPROFILER_EVENT_SCOPE(FWorldSimOwner::LoadComplexStaticMesh)
+
+	UBodySetup* collbody = GetCollisionBodySetup(StaticMeshComponent);
+	if (collbody == nullptr)
+	{
+		return nullptr;
+	}
+
+	JPH::ShapeSettings::ShapeResult ShapeCreationResult = CookStaticMeshShape(collbody);
+	if (ShapeCreationResult.IsEmpty())
+	{
+		return nullptr;
+	}
+	if (ShapeCreationResult.HasError())
+	{
+		ensureMsgf(false, TEXT("Jolt body creation failed! Error: %hs"), ShapeCreationResult.GetError().c_str());
+		return nullptr;
+	}
+
+	//TODO: should we be holding the shape ref in gamesim owner?
+	BodyCreationSettings creation_settings;
+	if (!MakeStaticMeshBodySettings(ShapeCreationResult.Get(), MeshTransform, Layer, Movement, IsSensor, CenterOfMassTranslation, creation_settings))
+	{
+		return nullptr;
+	}
 	
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(Create body)
@@ -579,6 +843,191 @@ FBLet FWorldSimOwner::LoadComplexStaticMesh(FBTransform& MeshTransform,
 	}
 }
 
+void FWorldSimOwner::ImportStaticGeometry(TConstArrayView<FBStaticImport> Meshes,
+	TConstArrayView<const ALandscapeProxy*> Landscapes,
+	TArray<FBLet>& OutMeshes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FWorldSimOwner::ImportStaticGeometry)
+	OutMeshes.Reset();
+	OutMeshes.SetNum(Meshes.Num());
+
+	//one conversion per distinct body setup or landscape component, however many instances share it.
+	struct FConversion
+	{
+		const UBodySetup* BodySetup = nullptr;
+		const Chaos::FImplicitObject* Geometry = nullptr;
+		FTransform LandscapeTransform;
+		JPH::ShapeSettings::ShapeResult Result;
+	};
+	TArray<FConversion> Conversions;
+	TMap<const UBodySetup*, int32> ConversionOfBodySetup;
+	TArray<int32> MeshConversion;
+	MeshConversion.Init(INDEX_NONE, Meshes.Num());
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Gather)
+		for (int32 Index = 0; Index < Meshes.Num(); ++Index)
+		{
+			if (const UBodySetup* BodySetup = GetCollisionBodySetup(Meshes[Index].StaticMeshComponent))
+			{
+				int32& Conversion = ConversionOfBodySetup.FindOrAdd(BodySetup, INDEX_NONE);
+				if (Conversion == INDEX_NONE)
+				{
+					Conversion = Conversions.AddDefaulted();
+					Conversions[Conversion].BodySetup = BodySetup;
+				}
+				MeshConversion[Index] = Conversion;
+			}
+		}
+		for (const ALandscapeProxy* Landscape : Landscapes)
+		{
+			if (!Landscape)
+			{
+				continue;
+			}
+			for (const ULandscapeComponent* LandscapeComp : Landscape->LandscapeComponents)
+			{
+				const ULandscapeHeightfieldCollisionComponent* CollisionComp = LandscapeComp ? LandscapeComp->GetCollisionComponent() : nullptr;
+				const FBodyInstance* BodyInstance = CollisionComp ? CollisionComp->GetBodyInstance() : nullptr;
+				if (!BodyInstance || !BodyInstance->ActorHandle)
+				{
+					continue;
+				}
+				FConversion& Conversion = Conversions.AddDefaulted_GetRef();
+				Conversion.Geometry = BodyInstance->ActorHandle->GetGameThreadAPI().GetGeometry();
+				Conversion.LandscapeTransform = CollisionComp->GetComponentTransform();
+			}
+		}
+	}
+
+	//the heavy part. everything here only reads the source geometry, and the cooked shape cache is thread safe.
+	//jobs pull the next conversion as they finish, since one big landscape component is worth a lot of crates.
+	if (!Conversions.IsEmpty())
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Convert)
+		auto Convert = [](FConversion& Conversion)
+		{
+			if (Conversion.BodySetup)
+			{
+				Conversion.Result = CookStaticMeshShape(Conversion.BodySetup);
+			}
+			else if (Conversion.Geometry)
+			{
+				Conversion.Result = Barrage::Conversion::FCookedShapeCache::Get().ChaosGeoToJoltShape(*Conversion.Geometry);
+			}
+		};
+		const int32 JobCount = FMath::Min(Conversions.Num(), job_system ? job_system->GetMaxConcurrency() : 1);
+		if (JobCount <= 1)
+		{
+			for (FConversion& Conversion : Conversions)
+			{
+				Convert(Conversion);
+			}
+		}
+		else
+		{
+			std::atomic<int32> NextConversion = 0;
+			JPH::JobSystem::Barrier* ConvertBarrier = job_system->CreateBarrier();
+			for (int32 Job = 0; Job < JobCount; ++Job)
+			{
+				JPH::JobHandle Handle = job_system->CreateJob("ImportStaticGeometry", JPH::Color::sOrange, [&Conversions, &NextConversion, &Convert]()
+				{
+					for (int32 Index = NextConversion.fetch_add(1, std::memory_order_relaxed); Index < Conversions.Num();
+					     Index = NextConversion.fetch_add(1, std::memory_order_relaxed))
+					{
+						Convert(Conversions[Index]);
+					}
+				});
+				ConvertBarrier->AddJob(Handle);
+			}
+			job_system->WaitForJobs(ConvertBarrier);
+			job_system->DestroyBarrier(ConvertBarrier);
+		}
+	}
+
+	//bodies get made here, in input order, so their ids come out the same every time.
+	JPH::Array<JPH::BodyID> Created;
+	Created.reserve(Conversions.Num());
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Create bodies)
+		auto UsableShape = [](const JPH::ShapeSettings::ShapeResult& Result) -> const JPH::Shape*
+		{
+			if (Result.HasError())
+			{
+				ensureMsgf(false, TEXT("Jolt body creation failed! Error: %hs"), Result.GetError().c_str());
+				return nullptr;
+			}
+			return Result.IsValid() ? Result.Get().GetPtr() : nullptr;
+		};
+
+		for (int32 Index = 0; Index < Meshes.Num(); ++Index)
+		{
+			if (MeshConversion[Index] == INDEX_NONE)
+			{
+				continue;
+			}
+			const JPH::Shape* CookedShape = UsableShape(Conversions[MeshConversion[Index]].Result);
+			BodyCreationSettings creation_settings;
+			if (!CookedShape || !MakeStaticMeshBodySettings(CookedShape, Meshes[Index].Transform, Layers::NON_MOVING,
+			                                                EMotionType::Static, false, FVector::ZeroVector, creation_settings))
+			{
+				continue;
+			}
+			JPH::Body* Body = body_interface->CreateBody(creation_settings);
+			if (!Body)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Barrage: ran out of bodies importing static geometry"));
+				break;
+			}
+			Created.push_back(Body->GetID());
+			FBarrageKey FBK = GenerateBarrageKeyFromBodyId(Body->GetID());
+			BarrageToJoltMapping->insert_or_assign(FBK, Body->GetID());
+			OutMeshes[Index] = MakeShareable(new FBarragePrimitive(FBK, Meshes[Index].OutKey));
+		}
+
+		for (const FConversion& Conversion : Conversions)
+		{
+			const JPH::Shape* CookedShape = Conversion.Geometry ? UsableShape(Conversion.Result) : nullptr;
+			if (!CookedShape)
+			{
+				continue;
+			}
+			JPH::BodyCreationSettings BodyCreationSettings;
+			BodyCreationSettings.SetShape(CookedShape);
+			BodyCreationSettings.mPosition = CoordinateUtils::ToJoltCoordinates(Conversion.LandscapeTransform.GetLocation());
+			BodyCreationSettings.mRotation = CoordinateUtils::ToJoltRotation(Conversion.LandscapeTransform.GetRotation());
+			BodyCreationSettings.mMotionType = EMotionType::Static;
+			BodyCreationSettings.mObjectLayer = Layers::EJoltPhysicsLayer::NON_MOVING;
+			if (JPH::Body* Body = body_interface->CreateBody(BodyCreationSettings))
+			{
+				Created.push_back(Body->GetID());
+			}
+		}
+	}
+
+	//keys are good now, same as a queued add. the bodies join the broadphase at the top of the next step.
+	FScopeLock Lock(&PendingStaticLock);
+	PendingStatics.insert(PendingStatics.end(), Created.begin(), Created.end());
+}
+
+bool FWorldSimOwner::AddPendingStaticGeometry()
+{
+	JPH::Array<JPH::BodyID> Adding;
+	{
+		FScopeLock Lock(&PendingStaticLock);
+		if (PendingStatics.empty())
+		{
+			return false;
+		}
+		Adding.swap(PendingStatics);
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE(FWorldSimOwner::AddPendingStaticGeometry)
+	JPH::BodyInterface::AddState State = body_interface->AddBodiesPrepare(Adding.data(), static_cast<int>(Adding.size()));
+	body_interface->AddBodiesFinalize(Adding.data(), static_cast<int>(Adding.size()), State, JPH::EActivation::DontActivate);
+	//statics by the thousand is exactly the case the broadphase rebuild is for.
+	OptimizeBroadPhase();
+	return true;
+}
+
 void FWorldSimOwner::CreateHeightfieldLandscapeMesh(TNotNull<const ALandscapeProxy*> InLandscapeActor) {
 	
 	for (const ULandscapeComponent* LandscapeComp : InLandscapeActor->LandscapeComponents) {
@@ -593,12 +1042,8 @@ void FWorldSimOwner::CreateHeightfieldLandscapeMesh(TNotNull<const ALandscapePro
 			
 			// Barrage::Conversion::TriMeshToJoltMeshShape()
 
-			if (JPH::ShapeSettings* ShapeSettings = Barrage::Conversion::ConvertChaosGeoToJoltBody(*ActorGameHandle.GetGeometry())) {
-				
-				auto CreationResult = ShapeSettings->Create();
-				if (CreationResult.HasError()) {
-					return;
-				}
+			auto CreationResult = Barrage::Conversion::FCookedShapeCache::Get().ChaosGeoToJoltShape(*ActorGameHandle.GetGeometry());
+			if (CreationResult.IsValid()) {
 				
 				const FTransform& UnrealTransform = CollisionComp->GetComponentTransform();
 				
@@ -632,6 +1077,85 @@ void FWorldSimOwner::StepSimulation()
 	
 }
 
+static void StepOneCharacter(FBCharacterBase* Character, JPH::TempAllocator& StepAllocator)
+{
+	if (Character && Character->mCharacter)
+	{
+		if (Character->mCharacter->GetPosition().IsNaN())
+		{
+			Character->mCharacter->SetLinearVelocity(Character->World->GetGravity());
+			Character->mCharacter->SetPosition(Character->mInitialPosition);
+			Character->mForcesUpdate = Character->World->GetGravity();
+		}
+		Character->StepCharacter(StepAllocator);
+	}
+}
+
+void FWorldSimOwner::StepCharacters()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FWorldSimOwner::StepCharacters);
+	CharacterGrid.Rebuild();
+	CharacterGrid.BuildIslands(CharacterIslandOrder, CharacterIslandStarts);
+	const int32 IslandCount = CharacterIslandStarts.Num() - 1;
+	if (IslandCount <= 0)
+	{
+		return;
+	}
+
+	//a job costs more than a couple of characters do, so small or fully connected crowds just step right here.
+	constexpr int32 MinCharactersForJobs = 8;
+	const int32 JobCount = FMath::Min(IslandCount, job_system ? job_system->GetMaxConcurrency() : 1);
+	if (JobCount <= 1 || CharacterIslandOrder.Num() < MinCharactersForJobs)
+	{
+		for (int32 Index : CharacterIslandOrder)
+		{
+			StepOneCharacter(CharacterGrid.GetOwner(Index), *Allocator);
+		}
+		CharacterGrid.RefreshPoses();
+		return;
+	}
+
+	//whole islands go to the least loaded job, lowest job on ties, so the split is fixed for a given set of islands.
+	TArray<TArray<int32, TInlineAllocator<32>>, TInlineAllocator<64>> JobIslands;
+	TArray<int32, TInlineAllocator<64>> JobLoad;
+	JobIslands.SetNum(JobCount);
+	JobLoad.SetNumZeroed(JobCount);
+	for (int32 Island = 0; Island < IslandCount; ++Island)
+	{
+		int32 Lightest = 0;
+		for (int32 Job = 1; Job < JobCount; ++Job)
+		{
+			Lightest = JobLoad[Job] < JobLoad[Lightest] ? Job : Lightest;
+		}
+		JobIslands[Lightest].Add(Island);
+		JobLoad[Lightest] += CharacterIslandStarts[Island + 1] - CharacterIslandStarts[Island];
+	}
+	while (CharacterAllocators.Num() < JobCount)
+	{
+		CharacterAllocators.Emplace(MakeUnique<JPH::TempAllocatorImplWithMallocFallback>(256 * 1024));
+	}
+
+	JPH::JobSystem::Barrier* StepBarrier = job_system->CreateBarrier();
+	for (int32 Job = 0; Job < JobCount; ++Job)
+	{
+		JPH::JobHandle Handle = job_system->CreateJob("StepCharacters", JPH::Color::sGreen, [this, Job, &JobIslands]()
+		{
+			JPH::TempAllocator& StepAllocator = *CharacterAllocators[Job];
+			for (int32 Island : JobIslands[Job])
+			{
+				for (int32 Slot = CharacterIslandStarts[Island]; Slot < CharacterIslandStarts[Island + 1]; ++Slot)
+				{
+					StepOneCharacter(CharacterGrid.GetOwner(CharacterIslandOrder[Slot]), StepAllocator);
+				}
+			}
+		});
+		StepBarrier->AddJob(Handle);
+	}
+	job_system->WaitForJobs(StepBarrier);
+	job_system->DestroyBarrier(StepBarrier);
+	CharacterGrid.RefreshPoses();
+}
+
 bool FWorldSimOwner::OptimizeBroadPhase()
 {
 	// Optional step: Before starting the physics simulation you can optimize the broad phase. This improves collision detection performance (it's pointless here because we only have 2 bodies).
@@ -642,6 +1166,41 @@ bool FWorldSimOwner::OptimizeBroadPhase()
 	return true;
 }
 
+double FWorldSimOwner::BroadPhaseChurnScore(const JPH::BroadPhase::LayerChurn& Churn)
+{
+	return static_cast<double>(Churn.mAdded) + Churn.mRemoved
+		+ static_cast<double>(Churn.mMoved) / FMath::Max(GBarrageBroadPhaseOptimizeMovesPerChange, 1);
+}
+
+bool FWorldSimOwner::OptimizeChurnedBroadPhase(uint64 TickCount)
+{
+	TSharedPtr<JPH::PhysicsSystem> HoldOpen = physics_system;
+	int32 Worst = INDEX_NONE;
+	double WorstOverThreshold = 0;
+	for (uint32 Layer = 0; Layer < JOLT::BroadPhaseLayers::NUM_LAYERS; ++Layer)
+	{
+		JPH::BroadPhase::LayerChurn Churn;
+		if (!HoldOpen->GetBroadPhaseLayerChurn(JPH::BroadPhaseLayer(static_cast<JPH::BroadPhaseLayer::Type>(Layer)), Churn))
+		{
+			return TickCount % 64 == 0 && OptimizeBroadPhase();
+		}
+		const double Threshold = FMath::Max<double>(GBarrageBroadPhaseOptimizeMinChurn, Churn.mNumBodies * GBarrageBroadPhaseOptimizeChurn);
+		const double OverThreshold = BroadPhaseChurnScore(Churn) / Threshold;
+		if (OverThreshold >= 1 && OverThreshold > WorstOverThreshold)
+		{
+			Worst = Layer;
+			WorstOverThreshold = OverThreshold;
+		}
+	}
+	if (Worst == INDEX_NONE)
+	{
+		return false;
+	}
+	//one layer a tick at most. if two are due, the other one goes next tick rather than stacking both into this one.
+	HoldOpen->OptimizeBroadPhaseLayer(JPH::BroadPhaseLayer(static_cast<JPH::BroadPhaseLayer::Type>(Worst)));
+	return true;
+}
+
 FBarrageKey FWorldSimOwner::GenerateBarrageKeyFromBodyId(const BodyID& Input) const
 {
 	return GenerateBarrageKeyFromBodyId(Input.GetIndexAndSequenceNumber());
@@ -663,7 +1222,13 @@ FWorldSimOwner::~FWorldSimOwner()
 	//this is the canonical order.
 	//grab our hold open.		
 	TSharedPtr<JPH::PhysicsSystem> HoldOpen = physics_system;
+	RagdollPool.Reset(); //ragdolls destroy their bodies on the way out, so they go while the system is still whole.
+	if (HoldOpen)
+	{
+		HoldOpen->SetBodyActivationListener(nullptr); //the tracker is a member, and goes before anyone's last reference.
+	}
 	physics_system.Reset(); //cast it into the fire.
+	CharacterGrid.Reset(); //raw pointers into the characters we're about to free.
 	CharacterToJoltMapping->Reset();//free characters so they don't double free inner shapes.
 	std::this_thread::yield(); //Cycle.
 
@@ -1,7 +1,7 @@
 ﻿// Jolt Physics Library
 // Barrage Extension
 
-#include "Experimental/CollisionGroupUnaware_FleshBroadPhase.h"
+#include "Experimental/FleshBroadPhase.h"
 #include <concepts>
 
 
@@ -9,7 +9,8 @@ PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 JPH_NAMESPACE_BEGIN
 	//shadow copy ops are a tick apart. as a result, you need to be not one, but two ticks behind to actually experience repercussions.
 	//this means we _directly reference without locking_
-	void CollisionGroupUnaware_FleshBroadPhase::CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
 	                                                    const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                    const ObjectLayerFilter& inObjectLayerFilter,
 	                                                    uint32_t AllowedHits) const
@@ -27,7 +28,8 @@ JPH_NAMESPACE_BEGIN
 		ApproxCastRay(inRay, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, AllowedHits);
 	}
 
-	bool CollisionGroupUnaware_FleshBroadPhase::ScoopUpHitsRay(RayCastBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	bool TFleshBroadPhase<CollisionGroupAware>::ScoopUpHitsRay(RayCastBodyCollector& ioCollector,
 	                                                           const ObjectLayerFilter& inObjectLayerFilter,
 	                                                           uint32_t AllowedHits, Vec3 origin,
 	                                                           RayInvDirection inv_direction,
@@ -35,6 +37,7 @@ JPH_NAMESPACE_BEGIN
 	                                                           uint32_t hits) const
 	{
 		size_t prevID = SIZE_T_MAX;
+		auto Pin = mBodies;
 		//we actually get a ton of info from WHICH points in a BB's set are in our knn.
 		//using it is a bit complicated, and I just want to see if this works at all first.
 		//but if you're reading this, just be aware that there's a ton of optimizations available to us using a truthtable
@@ -51,12 +54,16 @@ JPH_NAMESPACE_BEGIN
 				continue;
 			}
 			prevID = idx;
+			//the lsh can be a tick ahead of or behind the shadows, so it can name slots that are empty or gone.
+			if (idx >= Pin->size() || (*Pin)[idx].meta.IsInvalid())
+			{
+				continue;
+			}
 			//turn the idx into the body id by key_ref
-			auto id = BodyID((*mBodies)[idx].meta);
-			//TODO: check the api... I think this throws on a missed find...
+			auto id = BodyID((*Pin)[idx].meta);
 
 			//get the original bb. doing it this way may mean that we can release the ds_ref? idk yet.
-			auto& bodyshadow = (*mBodies)[idx]; //body shadows are both smaller and safer.
+			auto& bodyshadow = (*Pin)[idx]; //body shadows are both smaller and safer.
 
 			// Test layer
 			if (
@@ -82,7 +89,8 @@ JPH_NAMESPACE_BEGIN
 		return false;
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::ApproxCastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::ApproxCastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
 	                                                          const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                          const ObjectLayerFilter& inObjectLayerFilter,
 	                                                          uint32_t AllowedHits) const
@@ -111,7 +119,8 @@ JPH_NAMESPACE_BEGIN
 		               hits);
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::CollideAABox(const AABox& inBox, CollideShapeBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CollideAABox(const AABox& inBox, CollideShapeBodyCollector& ioCollector,
 	                                                         const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                         const ObjectLayerFilter& inObjectLayerFilter) const
 	{
@@ -126,7 +135,7 @@ JPH_NAMESPACE_BEGIN
 			bool Acc(const AABox& inBox,
 			         const ObjectLayerFilter& inObjectLayerFilter, float lenny,
 			         [[maybe_unused]] UnorderedSet<uint32_t>& Setti,
-			         CollisionGroupUnaware_FleshBroadPhase::BodyBoxSafeShadow& body,
+			         BodyBoxSafeShadow& body,
 			         [[maybe_unused]] uint32_t idx)
 			{
 				if (inBox.Intersect(body.GetWorldSpaceBounds()).IsValid())
@@ -161,7 +170,8 @@ JPH_NAMESPACE_BEGIN
 		Setti.ClearAndKeepMemory();
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::CollideSphere(Vec3Arg inCenter, float inRadius,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CollideSphere(Vec3Arg inCenter, float inRadius,
 	                                                          CollideShapeBodyCollector& ioCollector,
 	                                                          const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                          const ObjectLayerFilter& inObjectLayerFilter) const
@@ -177,7 +187,7 @@ JPH_NAMESPACE_BEGIN
 			bool Acc(const Vec3& InCent,
 			         const ObjectLayerFilter& inObjectLayerFilter, float lenny,
 			         [[maybe_unused]] UnorderedSet<uint32_t>& Setti,
-			         CollisionGroupUnaware_FleshBroadPhase::BodyBoxSafeShadow& body,
+			         BodyBoxSafeShadow& body,
 			         [[maybe_unused]] uint32_t idx)
 			{
 				if (body.GetWorldSpaceBounds().GetSqDistanceTo(InCent) <= lenny * lenny)
@@ -203,7 +213,8 @@ JPH_NAMESPACE_BEGIN
 		Setti.ClearAndKeepMemory();
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::CollidePoint(Vec3Arg inPoint, CollideShapeBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CollidePoint(Vec3Arg inPoint, CollideShapeBodyCollector& ioCollector,
 	                                                         const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                         const ObjectLayerFilter& inObjectLayerFilter) const
 	{
@@ -212,7 +223,8 @@ JPH_NAMESPACE_BEGIN
 	}
 
 	//unused and unsupported. beepboop
-	void CollisionGroupUnaware_FleshBroadPhase::CollideOrientedBox(const OrientedBox& inBox,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CollideOrientedBox(const OrientedBox& inBox,
 	                                                               CollideShapeBodyCollector& ioCollector,
 	                                                               const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                               const ObjectLayerFilter& inObjectLayerFilter) const
@@ -226,19 +238,21 @@ JPH_NAMESPACE_BEGIN
 
 	//accumulator behaviors effectively determine when to stop seeking results or running. The accumulate function
 	//is basically just a higher order function that applies the behavior in a specific way. I just happen to be most comfy with templates in this context.
+	template <bool CollisionGroupAware>
 	template <typename behavior, typename T>
-	bool CollisionGroupUnaware_FleshBroadPhase::Accumulate(const T& inBox, behavior collector,
+	bool TFleshBroadPhase<CollisionGroupAware>::Accumulate(const T& inBox, behavior collector,
 	                                                       const ObjectLayerFilter& inObjectLayerFilter, float lenny,
 	                                                       UnorderedSet<uint32_t>& Setti,
 	                                                       std::vector<uint32_t>& result) const
 	{
-		if (!result.empty() && mBodies && !mBodies->empty())
+		auto Pin = mBodies;
+		if (!result.empty() && Pin && !Pin->empty())
 		{
 			for (auto idx : result)
 			{
-				if (Setti.insert(idx).second)
+				if (idx < Pin->size() && !(*Pin)[idx].meta.IsInvalid() && Setti.insert(idx).second)
 				{
-					auto& body = (*mBodies)[idx];
+					auto& body = (*Pin)[idx];
 
 					if ((collector.Acc(inBox, inObjectLayerFilter, lenny, Setti, body, idx)))
 					{
@@ -251,7 +265,8 @@ JPH_NAMESPACE_BEGIN
 	}
 
 
-	void CollisionGroupUnaware_FleshBroadPhase::CastAABoxNoLock(const AABoxCast& inBox,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CastAABoxNoLock(const AABoxCast& inBox,
 	                                                            CastShapeBodyCollector& ioCollector,
 	                                                            const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                            const ObjectLayerFilter& inObjectLayerFilter) const
@@ -267,7 +282,7 @@ JPH_NAMESPACE_BEGIN
 
 			bool Acc(const AABoxCast& inBox,
 			         const ObjectLayerFilter& inObjectLayerFilter, float lenny,
-			         UnorderedSet<uint32_t>& Setti, CollisionGroupUnaware_FleshBroadPhase::BodyBoxSafeShadow& body,
+			         UnorderedSet<uint32_t>& Setti, BodyBoxSafeShadow& body,
 			         [[maybe_unused]] uint32_t idx)
 			{
 				auto closest = inBox.mBox.GetClosestPoint(body.GetCenter());
@@ -319,7 +334,8 @@ JPH_NAMESPACE_BEGIN
 		}
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::FindCollidingPairs(BodyID* ioActiveBodies, int inNumActiveBodies,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::FindCollidingPairs(BodyID* ioActiveBodies, int inNumActiveBodies,
 	                                                               float inSpeculativeContactDistance,
 	                                                               const ObjectVsBroadPhaseLayerFilter&
 	                                                               inObjectVsBroadPhaseLayerFilter,
@@ -330,28 +346,31 @@ JPH_NAMESPACE_BEGIN
 		{
 			BodyPairCollector& Collector;
 			BodyBoxSafeShadow Current;
+			const Body* Body1 = nullptr;
 			BodyManager* mBM;
 			EMBED::HashBlob& hash;
 			std::shared_ptr<NodeBlob> mCachedBodiesRef;
+			std::shared_ptr<GroupTable> mCachedGroupsRef;
 			float SpeculativeContactDistance;
 			const ObjectLayerPairFilter& mObjectLayerPairFilter;
 
 			CollidingPairsBehavior(BodyPairCollector& ioCollector, BodyManager* BM, std::shared_ptr<NodeBlob> Shadowed,
-			                       const ObjectLayerPairFilter& inOF, EMBED::HashBlob& Target,
-			                       float inSpeculativeContactDistance)
+			                       std::shared_ptr<GroupTable> Groups, const ObjectLayerPairFilter& inOF,
+			                       EMBED::HashBlob& Target, float inSpeculativeContactDistance)
 				: Collector(ioCollector), mBM(BM), hash(Target),
-				  mCachedBodiesRef(Shadowed), SpeculativeContactDistance(inSpeculativeContactDistance), mObjectLayerPairFilter(inOF)
+				  mCachedBodiesRef(Shadowed), mCachedGroupsRef(Groups),
+				  SpeculativeContactDistance(inSpeculativeContactDistance), mObjectLayerPairFilter(inOF)
 			{
 			}
 
 			bool AttemptAdd(uint32_t IdxToAdd)
 			{
-				//std::cerr << IdxToAdd << std::endl;
+				if (IdxToAdd >= mCachedBodiesRef->size())
+					return false;
 				BodyBoxSafeShadow hit = (*mCachedBodiesRef)[IdxToAdd]; //COPY NOW.
-				//std::cerr << hit.GetIndexAndSequenceNumber() << ":" << (*mCachedBodiesRef)[IdxToAdd].GetCenter() << " & "<< Current.meta.GetIndexAndSequenceNumber() << ":" << Current.meta.IsInvalid() << std::endl;
-
+				if (hit.meta.IsInvalid())
+					return false;
 
-				//std::cerr << body2.IsDynamic() << std::endl;
 				if (!Current.sFindCollidingPairsCanCollide(hit))
 					return false;
 
@@ -360,20 +379,35 @@ JPH_NAMESPACE_BEGIN
 				if (!mObjectLayerPairFilter.ShouldCollide(layer1, hit.GetObjectLayer()))
 					return false;
 
+				//jolt doesn't check groups until the narrowphase, but by then it has paid for a contact. the flyweight
+				//is right here in the shadow, so a ragdoll's limbs never make it that far.
+				if constexpr (CollisionGroupAware)
+				{
+					if (!Body1->GetCollisionGroup().CanCollide((*mCachedGroupsRef)[hit.group]))
+						return false;
+				}
+
 				// Check if bounds overlap
 				AABox bounds1 = Current.GetWorldSpaceBounds(); // we expanded earlier!
 				const AABox& bounds2 = hit.GetWorldSpaceBounds();
-				if (!bounds1.Intersect(bounds2).IsValid()) //they use overlaps. should it be intersects for us?
+				if (!bounds1.Overlaps(bounds2))
+					return false;
+
+				//the shadows can't order a pair, only the active list can, and that moves while we run. so the one
+				//candidate that made it this far pays to look at the real body. it may also be gone since the snapshot.
+				const Body* body2 = mBM->TryGetBody(hit.meta);
+				if (body2 == nullptr || !body2->IsInBroadPhase() || !Body::sFindCollidingPairsCanCollide(*Body1, *body2))
 					return false;
 
 				// Store overlapping pair
-				BodyPair Input(hit.meta, Current.meta);
+				BodyPair Input(Current.meta, hit.meta);
 				Collector.AddHit(Input);
 				return true;
 			}
 		};
 
 		auto Pin = mBodies;
+		auto PinGroups = mGroups;
 
 		if (Pin && Pin.get() && !Pin.get()->empty())
 		{
@@ -382,35 +416,74 @@ JPH_NAMESPACE_BEGIN
 				//this is VERY slow now. and badly needs redone.
 				BodyID b1_id = ioActiveBodies[b1];
 				const Body& body1 = mBodyManager->GetBody(b1_id);
-				auto bounds1 = body1.GetWorldSpaceBounds();
-				auto Cent = bounds1.GetCenter();
-				auto Extt = bounds1.GetExtent();
-				bounds1.ExpandBy(Vec3::sReplicate(SpeculativeContactDistance));
-				BodyBoxSafeShadow BodyShadowStruct(Cent.GetX(), Cent.GetY(), Cent.GetZ(),
-				                                   Extt.GetX(), Extt.GetY(), Extt.GetZ(),
-				                                   body1.GetObjectLayer(),
-				                                   body1.IsKinematic(),
-				                                   body1.IsDynamic(),
-				                                   body1.IsSensor(),
-				                                   body1.IsRigidBody(),
-				                                   body1.IsStatic(),
-				                                   body1.IsActive(),
-				                                   body1.GetCollideKinematicVsNonDynamic(),
-				                                   b1_id);
-
-				FLESHPoint Query = FLESHPoint::FromPoint(
-					BodyShadowStruct.x, BodyShadowStruct.y, BodyShadowStruct.z, MaxExtent);
+				BodyBoxSafeShadow BodyShadowStruct = MakeShadow(body1, inSpeculativeContactDistance);
+				const Vec3 Cent = BodyShadowStruct.GetCenter();
+
+				FLESHPoint Query = FLESHPoint::FromPoint(Cent.GetX(), Cent.GetY(), Cent.GetZ(), MaxExtent);
 				auto q = EMBED::getHash(Query, 1);
 
-				CollidingPairsBehavior HandleIOCollection(ioPairCollector, mBodyManager, Pin, inObjectLayerPairFilter,
-				                                          q, inSpeculativeContactDistance);
+				CollidingPairsBehavior HandleIOCollection(ioPairCollector, mBodyManager, Pin, PinGroups,
+				                                          inObjectLayerPairFilter, q, inSpeculativeContactDistance);
 				HandleIOCollection.Current = BodyShadowStruct;
+				HandleIOCollection.Body1 = &body1;
 				LSH->query_byob(&q, 1, TOPK, HandleIOCollection);
 			}
 		}
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::TestInvokeBuild()
+	//shadows store the min corner and the size. sizes are whole meters, so the +1 rounds them up rather than shaving the
+	//far side off the body.
+	template <bool CollisionGroupAware>
+	typename TFleshBroadPhase<CollisionGroupAware>::BodyBoxSafeShadow TFleshBroadPhase<CollisionGroupAware>::MakeShadow(
+		const Body& inBody, float inExpandBy)
+	{
+		AABox bounds = inBody.GetWorldSpaceBounds();
+		bounds.ExpandBy(Vec3::sReplicate(inExpandBy));
+		const Vec3 Size = bounds.GetSize();
+		return BodyBoxSafeShadow(bounds.mMin.GetX(), bounds.mMin.GetY(), bounds.mMin.GetZ(),
+		                         static_cast<HalfFloat>(Size.GetX() + 1), static_cast<HalfFloat>(Size.GetY() + 1),
+		                         static_cast<HalfFloat>(Size.GetZ() + 1),
+		                         inBody.GetObjectLayer(),
+		                         inBody.IsKinematic(),
+		                         inBody.IsDynamic(),
+		                         inBody.IsSensor(),
+		                         inBody.IsRigidBody(),
+		                         inBody.IsStatic(),
+		                         inBody.IsActive(),
+		                         inBody.GetCollideKinematicVsNonDynamic(),
+		                         inBody.GetID());
+	}
+
+	template <bool CollisionGroupAware>
+	uint32 TFleshBroadPhase<CollisionGroupAware>::GroupIndexOf(const CollisionGroup& inGroup, GroupLookup& ioLookup,
+	                                                           GroupTable& ioTable)
+	{
+		if (inGroup.GetGroupFilter() == nullptr)
+		{
+			return 0;
+		}
+		const GroupKey Key{inGroup.GetGroupFilter(), inGroup.GetGroupID(), inGroup.GetSubGroupID()};
+		const auto Found = ioLookup.find(Key);
+		if (Found != ioLookup.end())
+		{
+			return Found->second;
+		}
+		const uint32 Index = static_cast<uint32>(ioTable.size());
+		ioTable.push_back(inGroup);
+		ioLookup.try_emplace(Key, Index);
+		return Index;
+	}
+
+	template <bool CollisionGroupAware>
+	uint64 TFleshBroadPhase<CollisionGroupAware>::CellKeyOf(const BodyBoxSafeShadow& inShadow)
+	{
+		return HashCombineArgs(static_cast<int>(floor(inShadow.x)), static_cast<int>(floor(inShadow.y)),
+		                       static_cast<int>(floor(inShadow.z)), static_cast<uint32>(inShadow.xBound),
+		                       static_cast<uint32>(inShadow.yBound), static_cast<uint32>(inShadow.zBound));
+	}
+
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::TestInvokeBuild()
 	{
 		//NO-OP for the time being!!!
 		//UpdateFinalize(UpdateState());
@@ -419,44 +492,46 @@ JPH_NAMESPACE_BEGIN
 	//FIt-SNE may be of eventual interest but I'm _really_ hoping not. That said, they do something positively
 	//fascinating with the fast fourier that may actually point the way to a fast option for lightweight
 	//dim reduction
-	void CollisionGroupUnaware_FleshBroadPhase::UpdateFinalize(const UpdateState& inUpdateState)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::UpdateFinalize(const UpdateState& inUpdateState)
 	{
+		//every slot starts empty. an invalid meta is how the queries tell.
+		BodyBoxSafeShadow Empty;
+		Empty.meta = BodyID();
 		mBodiesShadow->clear();
+		//slot 0 is the empty group, for every body that never set one.
+		mGroupsShadow->clear();
+		mGroupsShadow->emplace_back();
+		thread_local GroupLookup Lookup;
+		Lookup.clear();
 		if (mBodyManager)
 		{
 			//this line blows up, which probably points a little towards what's causing our various lock problems.
 			//it's some lock in body manager.
 			//mBodiesShadow->reserve(mBodyManager->GetNumBodies());
-			for (auto body : mBodyManager->GetBodies())
+			const BodyVector& Bodies = mBodyManager->GetBodies();
+			mBodiesShadow->resize(Bodies.size(), Empty);
+			for (auto body : Bodies)
 			{
-				if (mBodyManager->sIsValidBodyPointer(body))
+				if (mBodyManager->sIsValidBodyPointer(body) && body->IsInBroadPhase())
 				{
 					if (JPH::BodyID M(body->GetID()); !M.IsInvalid())
 					{
 						//build mbodies here
 						// we expand the bounding box by the speculative contact distance HERE, not during cast or collide.
-						AABox bounds1 = body->GetWorldSpaceBounds();
-						bounds1.ExpandBy(Vec3::sReplicate(SpeculativeContactDistance));
-						auto Cent = bounds1.GetCenter();
-						auto Extt = bounds1.GetExtent();
-						BodyBoxSafeShadow J(Cent.GetX(), Cent.GetY(), Cent.GetZ(),
-						                    Extt.GetX() + 1, Extt.GetY() + 1, Extt.GetZ() + 1,
-						                    body->GetObjectLayer(),
-						                    body->IsKinematic(),
-						                    body->IsDynamic(),
-						                    body->IsSensor(),
-						                    body->IsRigidBody(),
-						                    body->IsStatic(),
-						                    body->IsActive(),
-						                    body->GetCollideKinematicVsNonDynamic(),
-						                    M);
-						//std::cerr << M.GetIndexAndSequenceNumber() << ":" << M.IsInvalid() << " & "<< J.meta.GetIndexAndSequenceNumber() << ":" << J.meta.IsInvalid() << std::endl;
-
-						mBodiesShadow->push_back(J);
+						BodyBoxSafeShadow J = MakeShadow(*body, SpeculativeContactDistance);
+						if constexpr (CollisionGroupAware)
+						{
+							J.group = GroupIndexOf(body->GetCollisionGroup(), Lookup, *mGroupsShadow);
+						}
+						//the body's index is its id in the lsh. it doesn't move while the body lives, which is what lets
+						//the lsh skip it next tick.
+						(*mBodiesShadow)[M.GetIndex()] = J;
 					}
 				}
 			}
 		}
+		mGroups.swap(mGroupsShadow);
 		mBodies.swap(mBodiesShadow);
 		//build and swap rtree here
 		RebuildLSH();
@@ -465,16 +540,16 @@ JPH_NAMESPACE_BEGIN
 	//without the RTree, bounds will need to be accumulated for maximum speed.
 	//There's not a great way to recover bounds info from the LSH, and we need it anyway
 	//for the T-constant used in the point embedding
-	AABox CollisionGroupUnaware_FleshBroadPhase::GetBounds() const
+	template <bool CollisionGroupAware>
+	AABox TFleshBroadPhase<CollisionGroupAware>::GetBounds() const
 	{
 		AABox bounds({0, 0, 0}, MaxExtent);
 		return bounds;
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::GenerateBBHashes(float oldM, FLESHPoint* Batch,
-	                                                             std::vector<
-		                                                             CollisionGroupUnaware_FleshBroadPhase::BodyBoxSafeShadow>::value_type
-	                                                             & body)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::GenerateBBHashes(float oldM, FLESHPoint* Batch,
+	                                                             BodyBoxSafeShadow& body)
 	{
 		//this code appears twice and we really need to converge it but that turns out to be slightly more annoying than you could reasonably expect.
 		//center
@@ -486,7 +561,8 @@ JPH_NAMESPACE_BEGIN
 		//offset
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::RebuildLSH()
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::RebuildLSH()
 	{
 		//////////////////////////
 		///UNDER CONSTRUCTION
@@ -494,14 +570,31 @@ JPH_NAMESPACE_BEGIN
 		///it really looks like we can use the index mappings behavior of FLINNG to avoid ever
 		/// actually storing our embeddings. That'd be EXTREMELY dope, bluntly.
 
-		float oldM = MaxExtent;
-		MaxExtent = 0;
-		LSHShadow->RegenerateTheFLESH(mBodies->size() * PointsPerBB);
-		//if an ordering is applied to mBodies, you'll get a deterministic build of the LSH.
-		FLESHPoint Batch[PointsPerBB];
+		//MaxExtent is baked into every sketch the lsh kept, so it can't wander tick to tick like it used to. it only grows,
+		//by half again at a time, and every time it does, everything is rehashed once.
+		double Needed = 1;
 		for (auto& body : *mBodies)
 		{
-			auto id = body.meta;
+			if (!body.meta.IsInvalid())
+			{
+				Needed = std::max<double>(Needed, abs(FVector::Distance(FVector::ZeroVector, {__LOCO_FFABVM(body)})));
+			}
+		}
+		if (Needed > MaxExtent)
+		{
+			MaxExtent = ceil(std::max(Needed, MaxExtent * 1.5));
+			LSH->Reset();
+		}
+
+		const float oldM = MaxExtent;
+		for (uint32_t idx = 0; idx < static_cast<uint32_t>(mBodies->size()); ++idx)
+		{
+			auto& body = (*mBodies)[idx];
+			if (body.meta.IsInvalid())
+			{
+				LSH->Remove(idx);
+				continue;
+			}
 			//you might notice that we push the center in first! that means it's always the lowest idx of a bb's point set.
 			//that's semantically important. please don't "fix" this.
 
@@ -510,20 +603,23 @@ JPH_NAMESPACE_BEGIN
 			//PointsPerBB must be adjusted as this code changes. failure to do so will cause funny but devastating bugs.
 			//I believe we can reduce the number of datastructures here significantly as we transisition away from CLSH
 			//////////////////////////////////////////////////////////////
-			//auto ctr
-			auto c1Extent = abs(FVector::Distance(FVector::ZeroVector, {__LOCO_FFABVM(body)}));
-			auto c2Extent = abs(FVector::Distance(FVector::ZeroVector, {__LOCO_FFABVM(body)}));
-			MaxExtent = ceil(FMath::Max3(MaxExtent, c1Extent, c2Extent));
-			GenerateBBHashes(oldM, Batch, body);
-			auto A = LSHShadow->get2Hashes(Batch, 0x1bead).data();
-			LSHShadow->addFoldedHashedPoints(A, PointsPerBB, 0x1bead);
+			LSH->Touch(idx, CellKeyOf(body), [this, oldM, &body](FLESHPoint* Batch)
+			{
+				GenerateBBHashes(oldM, Batch, body);
+			});
 		}
-		//LSHShadow->BuildTableAndIndex();
-		ArenaBack.swap(ArenaFront);
-		LSH.swap(LSHShadow);
+		//bodies past the end of the shadows are gone too.
+		const uint32_t BodyCount = static_cast<uint32_t>(mBodies->size());
+		for (uint32_t idx = BodyCount; idx < LastBodyCount; ++idx)
+		{
+			LSH->Remove(idx);
+		}
+		LastBodyCount = BodyCount;
+		LSH->Commit();
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::UnlockModifications()
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::UnlockModifications()
 	{
 		//less sure than I was.
 	}
@@ -547,48 +643,55 @@ JPH_NAMESPACE_BEGIN
 #pragma region BORON_ZONE
 
 
-	void CollisionGroupUnaware_FleshBroadPhase::Init(JPH::BodyManager* inBodyManager,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::Init(JPH::BodyManager* inBodyManager,
 	                                                 const JPH::BroadPhaseLayerInterface& inLayerInterface)
 	{
 		BroadPhase::Init(inBodyManager, inLayerInterface);
 	}
 
 
-	CollisionGroupUnaware_FleshBroadPhase::~CollisionGroupUnaware_FleshBroadPhase()
+	template <bool CollisionGroupAware>
+	TFleshBroadPhase<CollisionGroupAware>::~TFleshBroadPhase()
 	{
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::Optimize()
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::Optimize()
 	{
 		// this maybe should generate an out-of-band update for the shadowtree
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::FrameSync()
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::FrameSync()
 	{
 		BroadPhase::FrameSync();
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::LockModifications()
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::LockModifications()
 	{
 		//BroadPhase::LockModifications();
 		//this is a no-op for us, oddly.
 	}
 
-	BroadPhase::UpdateState CollisionGroupUnaware_FleshBroadPhase::UpdatePrepare()
+	template <bool CollisionGroupAware>
+	BroadPhase::UpdateState TFleshBroadPhase<CollisionGroupAware>::UpdatePrepare()
 	{
 		return BroadPhase::UpdatePrepare();
 	}
 
 
-	CollisionGroupUnaware_FleshBroadPhase::AddState CollisionGroupUnaware_FleshBroadPhase::AddBodiesPrepare(
+	template <bool CollisionGroupAware>
+	typename TFleshBroadPhase<CollisionGroupAware>::AddState TFleshBroadPhase<CollisionGroupAware>::AddBodiesPrepare(
 		JPH::BodyID* ioBodies, int inNumber)
 	{
 		return BroadPhase::AddBodiesPrepare(ioBodies, inNumber);
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::AddBodiesFinalize(BodyID* ioBodies, int inNumber,
-	                                                              CollisionGroupUnaware_FleshBroadPhase::AddState
-	                                                              inAddState)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::AddBodiesFinalize(BodyID* ioBodies, int inNumber,
+	                                                              AddState inAddState)
 	{
 		// Add bodies
 		BodyVector& bodies = mBodyManager->GetBodies();
@@ -605,12 +708,14 @@ JPH_NAMESPACE_BEGIN
 		}
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::AddBodiesAbort(JPH::BodyID* ioBodies, int inNumber, AddState inAddState)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::AddBodiesAbort(JPH::BodyID* ioBodies, int inNumber, AddState inAddState)
 	{
 		//no-op. until finalize happens, nothing happens with this model.
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::RemoveBodies(BodyID* ioBodies, int inNumber)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::RemoveBodies(BodyID* ioBodies, int inNumber)
 	{
 		BodyVector& bodies = mBodyManager->GetBodies();
 
@@ -626,24 +731,28 @@ JPH_NAMESPACE_BEGIN
 		}
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::NotifyBodiesAABBChanged(BodyID* ioBodies, int inNumber, bool inTakeLock)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::NotifyBodiesAABBChanged(BodyID* ioBodies, int inNumber, bool inTakeLock)
 	{
 		// Do nothing, we directly reference the body
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::NotifyBodiesLayerChanged(BodyID* ioBodies, int inNumber)
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::NotifyBodiesLayerChanged(BodyID* ioBodies, int inNumber)
 	{
 		// Do nothing, we directly reference the body
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
 	                                                    const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                    const ObjectLayerFilter& inObjectLayerFilter) const
 	{
 		CastRay(inRay, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, DefaultMaxAllowedHitsPerCast);
 	}
 
-	void CollisionGroupUnaware_FleshBroadPhase::CastAABox(const AABoxCast& inBox, CastShapeBodyCollector& ioCollector,
+	template <bool CollisionGroupAware>
+	void TFleshBroadPhase<CollisionGroupAware>::CastAABox(const AABoxCast& inBox, CastShapeBodyCollector& ioCollector,
 	                                                      const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 	                                                      const ObjectLayerFilter& inObjectLayerFilter) const
 	{
@@ -652,6 +761,9 @@ JPH_NAMESPACE_BEGIN
 #endif
 #pragma endregion
 #undef BORING_FUNCTION_REGION_OF_HBPH
+
+	template class TFleshBroadPhase<false>;
+	template class TFleshBroadPhase<true>;
 JPH_NAMESPACE_END
 
 PRAGMA_POP_PLATFORM_DEFAULT_PACKING
@@ -1,1407 +1,716 @@
-// // Jolt Physics Library (https://github.com/jrouwe/JoltPhysics)
-// // SPDX-FileCopyrightText: 2021 Jorrit Rouwe
-// // SPDX-License-Identifier: MIT
-//
-// #include "Experimental/PaddingtonTree.h"
-// #include <Jolt/Physics/Collision/BroadPhase/BroadPhaseQuadTree.h>
-// #include <Jolt/Physics/Collision/RayCast.h>
-// #include <Jolt/Physics/Collision/AABoxCast.h>
-// #include <Jolt/Physics/Collision/CastResult.h>
-// #include <Jolt/Physics/Collision/SortReverseAndStore.h>
-// #include <Jolt/Physics/Body/BodyPair.h>
-// #include <Jolt/Physics/PhysicsLock.h>
-// #include <Jolt/Geometry/AABox4.h>
-// #include <Jolt/Geometry/RayAABox.h>
-// #include <Jolt/Geometry/OrientedBox.h>
-// #include <Jolt/Core/STLLocalAllocator.h>
-//
-// #ifdef JPH_DUMP_BROADPHASE_TREE
-// JPH_SUPPRESS_WARNINGS_STD_BEGIN
-// #include <fstream>
-// JPH_SUPPRESS_WARNINGS_STD_END
-// #endif // JPH_DUMP_BROADPHASE_TREE
-//
-// JPH_NAMESPACE_BEGIN
-//
-// ////////////////////////////////////////////////////////////////////////////////////////////////////////
-// // PaddingtonTree::Node
-// ////////////////////////////////////////////////////////////////////////////////////////////////////////
-//
-// PDTH::Node::Node(bool inIsChanged) :
-// 	mIsChanged(inIsChanged)
-// {
-// 	// First reset bounds
-// 	Vec4 val = Vec4::sReplicate(cLargeFloat);
-// 	val.StoreFloat4((Float4 *)&mBoundsMinX);
-// 	val.StoreFloat4((Float4 *)&mBoundsMinY);
-// 	val.StoreFloat4((Float4 *)&mBoundsMinZ);
-// 	val = Vec4::sReplicate(-cLargeFloat);
-// 	val.StoreFloat4((Float4 *)&mBoundsMaxX);
-// 	val.StoreFloat4((Float4 *)&mBoundsMaxY);
-// 	val.StoreFloat4((Float4 *)&mBoundsMaxZ);
-//
-// 	// Reset child node ids
-// 	mChildNodeID[0] = NodeID::sInvalid();
-// 	mChildNodeID[1] = NodeID::sInvalid();
-// 	mChildNodeID[2] = NodeID::sInvalid();
-// 	mChildNodeID[3] = NodeID::sInvalid();
-// }
-//
-// void PDTH::Node::GetChildBounds(int inChildIndex, AABox &outBounds) const
-// {
-// 	// Read bounding box in order min -> max
-// 	outBounds.mMin = Vec3(mBoundsMinX[inChildIndex], mBoundsMinY[inChildIndex], mBoundsMinZ[inChildIndex]);
-// 	outBounds.mMax = Vec3(mBoundsMaxX[inChildIndex], mBoundsMaxY[inChildIndex], mBoundsMaxZ[inChildIndex]);
-// }
-//
-// void PDTH::Node::SetChildBounds(int inChildIndex, const AABox &inBounds)
-// {
-// 	// Bounding boxes provided to the quad tree should never be larger than cLargeFloat because this may trigger overflow exceptions
-// 	// e.g. when squaring the value while testing sphere overlaps
-// 	JPH_ASSERT(inBounds.mMin.GetX() >= -cLargeFloat && inBounds.mMin.GetX() <= cLargeFloat
-// 			   && inBounds.mMin.GetY() >= -cLargeFloat && inBounds.mMin.GetY() <= cLargeFloat
-// 			   && inBounds.mMin.GetZ() >= -cLargeFloat && inBounds.mMin.GetZ() <= cLargeFloat
-// 			   && inBounds.mMax.GetX() >= -cLargeFloat && inBounds.mMax.GetX() <= cLargeFloat
-// 			   && inBounds.mMax.GetY() >= -cLargeFloat && inBounds.mMax.GetY() <= cLargeFloat
-// 			   && inBounds.mMax.GetZ() >= -cLargeFloat && inBounds.mMax.GetZ() <= cLargeFloat);
-//
-// 	// Set max first (this keeps the bounding box invalid for reading threads)
-// 	mBoundsMaxZ[inChildIndex] = inBounds.mMax.GetZ();
-// 	mBoundsMaxY[inChildIndex] = inBounds.mMax.GetY();
-// 	mBoundsMaxX[inChildIndex] = inBounds.mMax.GetX();
-//
-// 	// Then set min (and make box valid)
-// 	mBoundsMinZ[inChildIndex] = inBounds.mMin.GetZ();
-// 	mBoundsMinY[inChildIndex] = inBounds.mMin.GetY();
-// 	mBoundsMinX[inChildIndex] = inBounds.mMin.GetX(); // Min X becomes valid last
-// }
-//
-// void PDTH::Node::InvalidateChildBounds(int inChildIndex)
-// {
-// 	// First we make the box invalid by setting the min to cLargeFloat
-// 	mBoundsMinX[inChildIndex] = cLargeFloat; // Min X becomes invalid first
-// 	mBoundsMinY[inChildIndex] = cLargeFloat;
-// 	mBoundsMinZ[inChildIndex] = cLargeFloat;
-//
-// 	// Then we reset the max values too
-// 	mBoundsMaxX[inChildIndex] = -cLargeFloat;
-// 	mBoundsMaxY[inChildIndex] = -cLargeFloat;
-// 	mBoundsMaxZ[inChildIndex] = -cLargeFloat;
-// }
-//
-// void PDTH::Node::GetNodeBounds(AABox &outBounds) const
-// {
-// 	// Get first child bounds
-// 	GetChildBounds(0, outBounds);
-//
-// 	// Encapsulate other child bounds
-// 	for (int child_idx = 1; child_idx < 4; ++child_idx)
-// 	{
-// 		AABox tmp;
-// 		GetChildBounds(child_idx, tmp);
-// 		outBounds.Encapsulate(tmp);
-// 	}
-// }
-//
-// bool PDTH::Node::EncapsulateChildBounds(int inChildIndex, const AABox &inBounds)
-// {
-// 	bool changed = false;
-// 	// 	AtomicMin(mBoundsMinX[inChildIndex], inBounds.mMin.GetX());
-// 	// changed |= AtomicMin(mBoundsMinY[inChildIndex], inBounds.mMin.GetY());
-// 	// changed |= AtomicMin(mBoundsMinZ[inChildIndex], inBounds.mMin.GetZ());
-// 	// changed |= AtomicMax(mBoundsMaxX[inChildIndex], inBounds.mMax.GetX());
-// 	// changed |= AtomicMax(mBoundsMaxY[inChildIndex], inBounds.mMax.GetY());
-// 	// changed |= AtomicMax(mBoundsMaxZ[inChildIndex], inBounds.mMax.GetZ());
-// 	return changed;
-// }
-//
-// ////////////////////////////////////////////////////////////////////////////////////////////////////////
-// // PaddingtonTree
-// ////////////////////////////////////////////////////////////////////////////////////////////////////////
-//
-// const AABox PaddingtonTree::cInvalidBounds(Vec3::sReplicate(cLargeFloat), Vec3::sReplicate(-cLargeFloat));
-//
-// void PaddingtonTree::GetBodyLocation(const TrackingVector &inTracking, BodyID inBodyID, uint32 &outNodeIdx, uint32 &outChildIdx) const
-// {
-// 	uint32 body_location = inTracking[inBodyID.GetIndex()].mBodyLocation;
-// 	JPH_ASSERT(body_location != Tracking::cInvalidBodyLocation);
-// 	outNodeIdx = body_location & 0x3fffffff;
-// 	outChildIdx = body_location >> 30;
-// 	JPH_ASSERT(mAllocator->Get(outNodeIdx).mChildNodeID[outChildIdx] == inBodyID, "Make sure that the body is in the node where it should be");
-// }
-//
-// void PaddingtonTree::SetBodyLocation(TrackingVector &ioTracking, BodyID inBodyID, uint32 inNodeIdx, uint32 inChildIdx) const
-// {
-// 	JPH_ASSERT(inNodeIdx <= 0x3fffffff);
-// 	JPH_ASSERT(inChildIdx < 4);
-// 	JPH_ASSERT(mAllocator->Get(inNodeIdx).mChildNodeID[inChildIdx] == inBodyID, "Make sure that the body is in the node where it should be");
-// 	ioTracking[inBodyID.GetIndex()].mBodyLocation = inNodeIdx + (inChildIdx << 30);
-//
-// #ifdef JPH_ENABLE_ASSERTS
-// 	uint32 v1, v2;
-// 	GetBodyLocation(ioTracking, inBodyID, v1, v2);
-// 	JPH_ASSERT(v1 == inNodeIdx);
-// 	JPH_ASSERT(v2 == inChildIdx);
-// #endif
-// }
-//
-// void PaddingtonTree::sInvalidateBodyLocation(TrackingVector &ioTracking, BodyID inBodyID)
-// {
-// 	ioTracking[inBodyID.GetIndex()].mBodyLocation = Tracking::cInvalidBodyLocation;
-// }
-//
-// PaddingtonTree::~PaddingtonTree()
-// {
-// 	// Get rid of any nodes that are still to be freed
-// 	//add return-to-pool behavior for mAllocator backing storage.
-// }
-//
-// uint32 PaddingtonTree::AllocateNode(bool inIsChanged)
-// {
-// 	//uint32 index = mAllocator->ConstructObject(inIsChanged);
-// 	return 0;//index;
-// }
-//
-// void PaddingtonTree::Init(std::shared_ptr<PDTH::MemoryPoolPool> PoolAgent)
-// {
-// 	// Store allocator
-// 	mPoolAgentSP = PoolAgent;
-// }
-//
-// AABox PaddingtonTree::GetBounds() const
-// {
-// 	AABox bounds;
-// 	Self.GetNodeBounds(bounds);
-// 	return bounds;
-// }
-//
-// void PaddingtonTree::UpdatePrepare(const BodyVector &inBodies, TrackingVector &ioTracking, UpdateState &outUpdateState, bool inFullRebuild)
-// {
-// #ifdef JPH_ENABLE_ASSERTS
-// 	// We only read positions
-// 	BodyAccess::Grant grant(BodyAccess::EAccess::None, BodyAccess::EAccess::Read);
-// #endif
-//
-// 	// Assert we have no nodes pending deletion, this means DiscardOldTree wasn't called yet
-// 	JPH_ASSERT(mFreeNodeBatch.mNumObjects == 0);
-//
-// 	// Mark tree non-dirty
-// 	mIsDirty = false;
-//
-// 	// Get the current root node
-// 	const RootNode &root_node = GetCurrentRoot();
-//
-// #ifdef JPH_DUMP_BROADPHASE_TREE
-// 	DumpTree(root_node.GetNodeID(), StringFormat("%s_PRE", mName).c_str());
-// #endif
-//
-// 	// Assert sane data
-// #ifdef JPH_DEBUG
-// 	ValidateTree(inBodies, ioTracking, root_node.mIndex, mNumBodies);
-// #endif
-//
-// 	// Create space for all body ID's
-// 	NodeID *node_ids = new NodeID [mNumBodies];
-// 	NodeID *cur_node_id = node_ids;
-//
-// 	// Collect all bodies
-// 	NodeID node_stack[cStackSize];
-// 	node_stack[0] = root_node.GetNodeID();
-// 	JPH_ASSERT(node_stack[0].IsValid());
-// 	int top = 0;
-// 	do
-// 	{
-// 		// Check if node is a body
-// 		NodeID node_id = node_stack[top];
-// 		if (node_id.IsBody())
-// 		{
-// 			// Validate that we're still in the right layer
-// 		#ifdef JPH_ENABLE_ASSERTS
-// 			uint32 body_index = node_id.GetBodyID().GetIndex();
-// 			JPH_ASSERT(ioTracking[body_index].mObjectLayer == inBodies[body_index]->GetObjectLayer());
-// 		#endif
-//
-// 			// Store body
-// 			*cur_node_id = node_id;
-// 			++cur_node_id;
-// 		}
-// 		else
-// 		{
-// 			// Process normal node
-// 			uint32 node_idx = node_id.GetNodeIndex();
-// 			const Node &node = mAllocator->Get(node_idx);
-//
-// 			if (!node.mIsChanged && !inFullRebuild)
-// 			{
-// 				// Node is unchanged, treat it as a whole
-// 				*cur_node_id = node_id;
-// 				++cur_node_id;
-// 			}
-// 			else
-// 			{
-// 				// Node is changed, recurse and get all children
-// 				for (NodeID child_node_id : node.mChildNodeID)
-// 					if (child_node_id.IsValid())
-// 					{
-// 						if (top < cStackSize)
-// 						{
-// 							node_stack[top] = child_node_id;
-// 							top++;
-// 						}
-// 						else
-// 						{
-// 							JPH_ASSERT(false, "Stack full!\n"
-// 								"This must be a very deep tree. Are you batch adding bodies through BodyInterface::AddBodiesPrepare/AddBodiesFinalize?\n"
-// 								"If you add lots of bodies through BodyInterface::AddBody you may need to call PhysicsSystem::OptimizeBroadPhase to rebuild the tree.");
-//
-// 							// Falling back to adding the node as a whole
-// 							*cur_node_id = child_node_id;
-// 							++cur_node_id;
-// 						}
-// 					}
-//
-// 				// Mark node to be freed
-// 				mAllocator->AddObjectToBatch(mFreeNodeBatch, node_idx);
-// 			}
-// 		}
-// 		--top;
-// 	}
-// 	while (top >= 0);
-//
-// 	// Check that our book keeping matches
-// 	uint32 num_node_ids = uint32(cur_node_id - node_ids);
-// 	JPH_ASSERT(inFullRebuild? num_node_ids == mNumBodies : num_node_ids <= mNumBodies);
-//
-// 	// This will be the new root node id
-// 	NodeID root_node_id;
-//
-// 	if (num_node_ids > 0)
-// 	{
-// 		// We mark the first 5 levels (max 1024 nodes) of the newly built tree as 'changed' so that
-// 		// those nodes get recreated every time when we rebuild the tree. This balances the amount of
-// 		// time we spend on rebuilding the tree ('unchanged' nodes will be put in the new tree as a whole)
-// 		// vs the quality of the built tree.
-// 		constexpr uint cMaxDepthMarkChanged = 5;
-//
-// 		// Build new tree
-// 		AABox root_bounds;
-// 		root_node_id = BuildTree(inBodies, ioTracking, node_ids, num_node_ids, cMaxDepthMarkChanged, root_bounds);
-//
-// 		if (root_node_id.IsBody())
-// 		{
-// 			// For a single body we need to allocate a new root node
-// 			uint32 root_idx = AllocateNode(false);
-// 			Node &root = mAllocator->Get(root_idx);
-// 			root.SetChildBounds(0, root_bounds);
-// 			root.mChildNodeID[0] = root_node_id;
-// 			SetBodyLocation(ioTracking, root_node_id.GetBodyID(), root_idx, 0);
-// 			root_node_id = NodeID::sFromNodeIndex(root_idx);
-// 		}
-// 	}
-// 	else
-// 	{
-// 		// Empty tree, create root node
-// 		uint32 root_idx = AllocateNode(false);
-// 		root_node_id = NodeID::sFromNodeIndex(root_idx);
-// 	}
-//
-// 	// Delete temporary data
-// 	delete [] node_ids;
-//
-// 	outUpdateState.mRootNodeID = root_node_id;
-// }
-//
-// void PaddingtonTree::UpdateFinalize([[maybe_unused]] const BodyVector &inBodies, [[maybe_unused]] const TrackingVector &inTracking, const UpdateState &inUpdateState)
-// {
-// 	// Tree building is complete, now we switch the old with the new tree
-// 	uint32 new_root_idx = mRootNodeIndex ^ 1;
-// 	RootNode &new_root_node = mRootNode[new_root_idx];
-// 	{
-// 		// Note: We don't need to lock here as the old tree stays available so any queries
-// 		// that use it can continue using it until DiscardOldTree is called. This slot
-// 		// should be empty and unused at this moment.
-// 		JPH_ASSERT(new_root_node.mIndex == cInvalidNodeIndex);
-// 		new_root_node.mIndex = inUpdateState.mRootNodeID.GetNodeIndex();
-// 	}
-//
-// 	// All queries that start from now on will use this new tree
-// 	mRootNodeIndex = new_root_idx;
-//
-// #ifdef JPH_DUMP_BROADPHASE_TREE
-// 	DumpTree(new_root_node.GetNodeID(), StringFormat("%s_POST", mName).c_str());
-// #endif
-//
-// #ifdef JPH_DEBUG
-// 	ValidateTree(inBodies, inTracking, new_root_node.mIndex, mNumBodies);
-// #endif
-// }
-//
-// void PaddingtonTree::sPartition(NodeID *ioNodeIDs, Vec3 *ioNodeCenters, int inNumber, int &outMidPoint)
-// {
-// 	// Handle trivial case
-// 	if (inNumber <= 4)
-// 	{
-// 		outMidPoint = inNumber / 2;
-// 		return;
-// 	}
-//
-// 	// Calculate bounding box of box centers
-// 	Vec3 center_min = Vec3::sReplicate(cLargeFloat);
-// 	Vec3 center_max = Vec3::sReplicate(-cLargeFloat);
-// 	for (const Vec3 *c = ioNodeCenters, *c_end = ioNodeCenters + inNumber; c < c_end; ++c)
-// 	{
-// 		Vec3 center = *c;
-// 		center_min = Vec3::sMin(center_min, center);
-// 		center_max = Vec3::sMax(center_max, center);
-// 	}
-//
-// 	// Calculate split plane
-// 	int dimension = (center_max - center_min).GetHighestComponentIndex();
-// 	float split = 0.5f * (center_min + center_max)[dimension];
-//
-// 	// Divide bodies
-// 	int start = 0, end = inNumber;
-// 	while (start < end)
-// 	{
-// 		// Search for first element that is on the right hand side of the split plane
-// 		while (start < end && ioNodeCenters[start][dimension] < split)
-// 			++start;
-//
-// 		// Search for the first element that is on the left hand side of the split plane
-// 		while (start < end && ioNodeCenters[end - 1][dimension] >= split)
-// 			--end;
-//
-// 		if (start < end)
-// 		{
-// 			// Swap the two elements
-// 			std::swap(ioNodeIDs[start], ioNodeIDs[end - 1]);
-// 			std::swap(ioNodeCenters[start], ioNodeCenters[end - 1]);
-// 			++start;
-// 			--end;
-// 		}
-// 	}
-// 	JPH_ASSERT(start == end);
-//
-// 	if (start > 0 && start < inNumber)
-// 	{
-// 		// Success!
-// 		outMidPoint = start;
-// 	}
-// 	else
-// 	{
-// 		// Failed to divide bodies
-// 		outMidPoint = inNumber / 2;
-// 	}
-// }
-//
-// void PaddingtonTree::sPartition4(NodeID *ioNodeIDs, Vec3 *ioNodeCenters, int inBegin, int inEnd, int *outSplit)
-// {
-// 	NodeID *node_ids = ioNodeIDs + inBegin;
-// 	Vec3 *node_centers = ioNodeCenters + inBegin;
-// 	int number = inEnd - inBegin;
-//
-// 	// Partition entire range
-// 	sPartition(node_ids, node_centers, number, outSplit[2]);
-//
-// 	// Partition lower half
-// 	sPartition(node_ids, node_centers, outSplit[2], outSplit[1]);
-//
-// 	// Partition upper half
-// 	sPartition(node_ids + outSplit[2], node_centers + outSplit[2], number - outSplit[2], outSplit[3]);
-//
-// 	// Convert to proper range
-// 	outSplit[0] = inBegin;
-// 	outSplit[1] += inBegin;
-// 	outSplit[2] += inBegin;
-// 	outSplit[3] += outSplit[2];
-// 	outSplit[4] = inEnd;
-// }
-//
-// AABox PaddingtonTree::GetNodeOrBodyBounds(const BodyVector &inBodies, NodeID inNodeID) const
-// {
-// 	if (inNodeID.IsNode())
-// 	{
-// 		// It is a node
-// 		uint32 node_idx = inNodeID.GetNodeIndex();
-// 		const Node &node = mAllocator->Get(node_idx);
-//
-// 		AABox bounds;
-// 		node.GetNodeBounds(bounds);
-// 		return bounds;
-// 	}
-// 	else
-// 	{
-// 		// It is a body
-// 		return inBodies[inNodeID.GetBodyID().GetIndex()]->GetWorldSpaceBounds();
-// 	}
-// }
-//
-// PaddingtonTree::NodeID PaddingtonTree::BuildTree(const BodyVector &inBodies, TrackingVector &ioTracking, NodeID *ioNodeIDs, int inNumber, uint inMaxDepthMarkChanged, AABox &outBounds)
-// {
-// 	// Trivial case: No bodies in tree
-// 	if (inNumber == 0)
-// 	{
-// 		outBounds = cInvalidBounds;
-// 		return NodeID::sInvalid();
-// 	}
-//
-// 	// Trivial case: When we have 1 body or node, return it
-// 	if (inNumber == 1)
-// 	{
-// 		if (ioNodeIDs->IsNode())
-// 		{
-// 			// When returning an existing node as root, ensure that no parent has been set
-// 			Node &node = mAllocator->Get(ioNodeIDs->GetNodeIndex());
-// 			node.mParentNodeIndex = cInvalidNodeIndex;
-// 		}
-// 		outBounds = GetNodeOrBodyBounds(inBodies, *ioNodeIDs);
-// 		return *ioNodeIDs;
-// 	}
-//
-// 	// Calculate centers of all bodies that are to be inserted
-// 	Vec3 *centers = new Vec3 [inNumber];
-// 	JPH_ASSERT(IsAligned(centers, JPH_VECTOR_ALIGNMENT));
-// 	Vec3 *c = centers;
-// 	for (const NodeID *n = ioNodeIDs, *n_end = ioNodeIDs + inNumber; n < n_end; ++n, ++c)
-// 		*c = GetNodeOrBodyBounds(inBodies, *n).GetCenter();
-//
-// 	// The algorithm is a recursive tree build, but to avoid the call overhead we keep track of a stack here
-// 	struct StackEntry
-// 	{
-// 		uint32			mNodeIdx;					// Node index of node that is generated
-// 		int				mChildIdx;					// Index of child that we're currently processing
-// 		int				mSplit[5];					// Indices where the node ID's have been split to form 4 partitions
-// 		uint32			mDepth;						// Depth of this node in the tree
-// 		Vec3			mNodeBoundsMin;				// Bounding box of this node, accumulated while iterating over children
-// 		Vec3			mNodeBoundsMax;
-// 	};
-// 	static_assert(sizeof(StackEntry) == 64);
-// 	StackEntry stack[cStackSize / 4]; // We don't process 4 at a time in this loop but 1, so the stack can be 4x as small
-// 	int top = 0;
-//
-// 	// Create root node
-// 	stack[0].mNodeIdx = AllocateNode(inMaxDepthMarkChanged > 0);
-// 	stack[0].mChildIdx = -1;
-// 	stack[0].mDepth = 0;
-// 	stack[0].mNodeBoundsMin = Vec3::sReplicate(cLargeFloat);
-// 	stack[0].mNodeBoundsMax = Vec3::sReplicate(-cLargeFloat);
-// 	sPartition4(ioNodeIDs, centers, 0, inNumber, stack[0].mSplit);
-//
-// 	for (;;)
-// 	{
-// 		StackEntry &cur_stack = stack[top];
-//
-// 		// Next child
-// 		cur_stack.mChildIdx++;
-//
-// 		// Check if all children processed
-// 		if (cur_stack.mChildIdx >= 4)
-// 		{
-// 			// Terminate if there's nothing left to pop
-// 			if (top <= 0)
-// 				break;
-//
-// 			// Add our bounds to our parents bounds
-// 			StackEntry &prev_stack = stack[top - 1];
-// 			prev_stack.mNodeBoundsMin = Vec3::sMin(prev_stack.mNodeBoundsMin, cur_stack.mNodeBoundsMin);
-// 			prev_stack.mNodeBoundsMax = Vec3::sMax(prev_stack.mNodeBoundsMax, cur_stack.mNodeBoundsMax);
-//
-// 			// Store parent node
-// 			Node &node = mAllocator->Get(cur_stack.mNodeIdx);
-// 			node.mParentNodeIndex = prev_stack.mNodeIdx;
-//
-// 			// Store this node's properties in the parent node
-// 			Node &parent_node = mAllocator->Get(prev_stack.mNodeIdx);
-// 			parent_node.mChildNodeID[prev_stack.mChildIdx] = NodeID::sFromNodeIndex(cur_stack.mNodeIdx);
-// 			parent_node.SetChildBounds(prev_stack.mChildIdx, AABox(cur_stack.mNodeBoundsMin, cur_stack.mNodeBoundsMax));
-//
-// 			// Pop entry from stack
-// 			--top;
-// 		}
-// 		else
-// 		{
-// 			// Get low and high index to bodies to process
-// 			int low = cur_stack.mSplit[cur_stack.mChildIdx];
-// 			int high = cur_stack.mSplit[cur_stack.mChildIdx + 1];
-// 			int num_bodies = high - low;
-//
-// 			if (num_bodies == 1)
-// 			{
-// 				// Get body info
-// 				NodeID child_node_id = ioNodeIDs[low];
-// 				AABox bounds = GetNodeOrBodyBounds(inBodies, child_node_id);
-//
-// 				// Update node
-// 				Node &node = mAllocator->Get(cur_stack.mNodeIdx);
-// 				node.mChildNodeID[cur_stack.mChildIdx] = child_node_id;
-// 				node.SetChildBounds(cur_stack.mChildIdx, bounds);
-//
-// 				if (child_node_id.IsNode())
-// 				{
-// 					// Update parent for this node
-// 					Node &child_node = mAllocator->Get(child_node_id.GetNodeIndex());
-// 					child_node.mParentNodeIndex = cur_stack.mNodeIdx;
-// 				}
-// 				else
-// 				{
-// 					// Set location in tracking
-// 					SetBodyLocation(ioTracking, child_node_id.GetBodyID(), cur_stack.mNodeIdx, cur_stack.mChildIdx);
-// 				}
-//
-// 				// Encapsulate bounding box in parent
-// 				cur_stack.mNodeBoundsMin = Vec3::sMin(cur_stack.mNodeBoundsMin, bounds.mMin);
-// 				cur_stack.mNodeBoundsMax = Vec3::sMax(cur_stack.mNodeBoundsMax, bounds.mMax);
-// 			}
-// 			else if (num_bodies > 1)
-// 			{
-// 				// Allocate new node
-// 				StackEntry &new_stack = stack[++top];
-// 				JPH_ASSERT(top < cStackSize / 4);
-// 				uint32 next_depth = cur_stack.mDepth + 1;
-// 				new_stack.mNodeIdx = AllocateNode(inMaxDepthMarkChanged > next_depth);
-// 				new_stack.mChildIdx = -1;
-// 				new_stack.mDepth = next_depth;
-// 				new_stack.mNodeBoundsMin = Vec3::sReplicate(cLargeFloat);
-// 				new_stack.mNodeBoundsMax = Vec3::sReplicate(-cLargeFloat);
-// 				sPartition4(ioNodeIDs, centers, low, high, new_stack.mSplit);
-// 			}
-// 		}
-// 	}
-//
-// 	// Delete temporary data
-// 	delete [] centers;
-//
-// 	// Store bounding box of root
-// 	outBounds.mMin = stack[0].mNodeBoundsMin;
-// 	outBounds.mMax = stack[0].mNodeBoundsMax;
-//
-// 	// Return root
-// 	return NodeID::sFromNodeIndex(stack[0].mNodeIdx);
-// }
-//
-// void PaddingtonTree::MarkNodeAndParentsChanged(uint32 inNodeIndex)
-// {
-// 	uint32 node_idx = inNodeIndex;
-//
-// 	do
-// 	{
-// 		// If node has changed, parent will be too
-// 		Node &node = mAllocator->Get(node_idx);
-// 		if (node.mIsChanged)
-// 			break;
-//
-// 		// Mark node as changed
-// 		node.mIsChanged = true;
-//
-// 		// Get our parent
-// 		node_idx = node.mParentNodeIndex;
-// 	}
-// 	while (node_idx != cInvalidNodeIndex);
-// }
-//
-// void PaddingtonTree::WidenAndMarkNodeAndParentsChanged(uint32 inNodeIndex, const AABox &inNewBounds)
-// {
-// 	uint32 node_idx = inNodeIndex;
-//
-// 	for (;;)
-// 	{
-// 		// Mark node as changed
-// 		Node &node = mAllocator->Get(node_idx);
-// 		node.mIsChanged = true;
-//
-// 		// Get our parent
-// 		uint32 parent_idx = node.mParentNodeIndex;
-// 		if (parent_idx == cInvalidNodeIndex)
-// 			break;
-//
-// 		// Find which child of the parent we're in
-// 		Node &parent_node = mAllocator->Get(parent_idx);
-// 		NodeID node_id = NodeID::sFromNodeIndex(node_idx);
-// 		int child_idx = -1;
-// 		for (int i = 0; i < 4; ++i)
-// 			if (parent_node.mChildNodeID[i] == node_id)
-// 			{
-// 				// Found one, set the node index and child index and update the bounding box too
-// 				child_idx = i;
-// 				break;
-// 			}
-// 		JPH_ASSERT(child_idx != -1, "Nodes don't get removed from the tree, we must have found it");
-//
-// 		// To avoid any race conditions with other threads we only enlarge bounding boxes
-// 		if (!parent_node.EncapsulateChildBounds(child_idx, inNewBounds))
-// 		{
-// 			// No changes to bounding box, only marking as changed remains to be done
-// 			if (!parent_node.mIsChanged)
-// 				MarkNodeAndParentsChanged(parent_idx);
-// 			break;
-// 		}
-//
-// 		// Update node index
-// 		node_idx = parent_idx;
-// 	}
-// }
-//
-// bool PaddingtonTree::TryInsertLeaf(TrackingVector &ioTracking, int inNodeIndex, NodeID inLeafID, const AABox &inLeafBounds, int inLeafNumBodies)
-// {
-// 	// Tentatively assign the node as parent
-// 	bool leaf_is_node = inLeafID.IsNode();
-// 	if (leaf_is_node)
-// 	{
-// 		uint32 leaf_idx = inLeafID.GetNodeIndex();
-// 		mAllocator->Get(leaf_idx).mParentNodeIndex = inNodeIndex;
-// 	}
-//
-// 	// Fetch node that we're adding to
-// 	Node &node = mAllocator->Get(inNodeIndex);
-//
-// 	// Find an empty child
-// 	for (uint32 child_idx = 0; child_idx < 4; ++child_idx)
-// 		if (node.mChildNodeID[child_idx].CompareExchange(NodeID::sInvalid(), inLeafID)) // Check if we can claim it
-// 		{
-// 			// We managed to add it to the node
-//
-// 			// If leaf was a body, we need to update its bookkeeping
-// 			if (!leaf_is_node)
-// 				SetBodyLocation(ioTracking, inLeafID.GetBodyID(), inNodeIndex, child_idx);
-//
-// 			// Now set the bounding box making the child valid for queries
-// 			node.SetChildBounds(child_idx, inLeafBounds);
-//
-// 			// Widen the bounds for our parents too
-// 			WidenAndMarkNodeAndParentsChanged(inNodeIndex, inLeafBounds);
-//
-// 			// Update body counter
-// 			mNumBodies += inLeafNumBodies;
-//
-// 			// And we're done
-// 			return true;
-// 		}
-//
-// 	return false;
-// }
-//
-// bool PaddingtonTree::TryCreateNewRoot(TrackingVector &ioTracking, atomic<uint32> &ioRootNodeIndex, NodeID inLeafID, const AABox &inLeafBounds, int inLeafNumBodies)
-// {
-// 	// Fetch old root
-// 	uint32 root_idx = ioRootNodeIndex;
-// 	Node &root = mAllocator->Get(root_idx);
-//
-// 	// Create new root, mark this new root as changed as we're not creating a very efficient tree at this point
-// 	uint32 new_root_idx = AllocateNode(true);
-// 	Node &new_root = mAllocator->Get(new_root_idx);
-//
-// 	// First child is current root, note that since the tree may be modified concurrently we cannot assume that the bounds of our child will be correct so we set a very large bounding box
-// 	new_root.mChildNodeID[0] = NodeID::sFromNodeIndex(root_idx);
-// 	new_root.SetChildBounds(0, AABox(Vec3::sReplicate(-cLargeFloat), Vec3::sReplicate(cLargeFloat)));
-//
-// 	// Second child is new leaf
-// 	new_root.mChildNodeID[1] = inLeafID;
-// 	new_root.SetChildBounds(1, inLeafBounds);
-//
-// 	// Tentatively assign new root as parent
-// 	bool leaf_is_node = inLeafID.IsNode();
-// 	if (leaf_is_node)
-// 	{
-// 		uint32 leaf_idx = inLeafID.GetNodeIndex();
-// 		mAllocator->Get(leaf_idx).mParentNodeIndex = new_root_idx;
-// 	}
-//
-// 	// Try to swap it
-// 	if (ioRootNodeIndex.compare_exchange_strong(root_idx, new_root_idx))
-// 	{
-// 		// We managed to set the new root
-//
-// 		// If leaf was a body, we need to update its bookkeeping
-// 		if (!leaf_is_node)
-// 			SetBodyLocation(ioTracking, inLeafID.GetBodyID(), new_root_idx, 1);
-//
-// 		// Store parent node for old root
-// 		root.mParentNodeIndex = new_root_idx;
-//
-// 		// Update body counter
-// 		mNumBodies += inLeafNumBodies;
-//
-// 		// And we're done
-// 		return true;
-// 	}
-//
-// 	// Failed to swap, someone else must have created a new root, try again
-// 	mAllocator->DestructObject(new_root_idx);
-// 	return false;
-// }
-//
-// void PaddingtonTree::AddBodiesPrepare(const BodyVector &inBodies, TrackingVector &ioTracking, BodyID *ioBodyIDs, int inNumber, AddState &outState)
-// {
-//
-// 	// Build subtree for the new bodies, note that we mark all nodes as 'not changed'
-// 	// so they will stay together as a batch and will make the tree rebuild cheaper
-// 	outState.mLeafID = BuildTree(inBodies, ioTracking, (NodeID *)ioBodyIDs, inNumber, 0, outState.mLeafBounds);
-//
-// #ifdef JPH_DEBUG
-// 	if (outState.mLeafID.IsNode())
-// 		ValidateTree(inBodies, ioTracking, outState.mLeafID.GetNodeIndex(), inNumber);
-// #endif
-// }
-//
-// void PaddingtonTree::AddBodiesFinalize(TrackingVector &ioTracking, int inNumberBodies, const AddState &inState)
-// {
-// 	// Assert sane input
-// 	JPH_ASSERT(inNumberBodies > 0);
-//
-// 	// Mark tree dirty
-// 	mIsDirty = true;
-//
-// 	// Get the current root node
-// 	RootNode &root_node = GetCurrentRoot();
-//
-// 	for (;;)
-// 	{
-// 		// Check if we can insert the body in the root
-// 		if (TryInsertLeaf(ioTracking, root_node.mIndex, inState.mLeafID, inState.mLeafBounds, inNumberBodies))
-// 			return;
-//
-// 		// Check if we can create a new root
-// 		if (TryCreateNewRoot(ioTracking, root_node.mIndex, inState.mLeafID, inState.mLeafBounds, inNumberBodies))
-// 			return;
-// 	}
-// }
-//
-// void PaddingtonTree::AddBodiesAbort(TrackingVector &ioTracking, const AddState &inState)
-// {
-// 	// Collect all bodies
-// 	Allocator::Batch free_batch;
-// 	NodeID node_stack[cStackSize];
-// 	node_stack[0] = inState.mLeafID;
-// 	JPH_ASSERT(node_stack[0].IsValid());
-// 	int top = 0;
-// 	do
-// 	{
-// 		// Check if node is a body
-// 		NodeID child_node_id = node_stack[top];
-// 		if (child_node_id.IsBody())
-// 		{
-// 			// Reset location of body
-// 			sInvalidateBodyLocation(ioTracking, child_node_id.GetBodyID());
-// 		}
-// 		else
-// 		{
-// 			// Process normal node
-// 			uint32 node_idx = child_node_id.GetNodeIndex();
-// 			const Node &node = mAllocator->Get(node_idx);
-// 			for (NodeID sub_child_node_id : node.mChildNodeID)
-// 				if (sub_child_node_id.IsValid())
-// 				{
-// 					JPH_ASSERT(top < cStackSize);
-// 					node_stack[top] = sub_child_node_id;
-// 					top++;
-// 				}
-//
-// 			// Mark it to be freed
-// 			mAllocator->AddObjectToBatch(free_batch, node_idx);
-// 		}
-// 		--top;
-// 	}
-// 	while (top >= 0);
-//
-// 	// Now free all nodes as a single batch
-// 	mAllocator->DestructObjectBatch(free_batch);
-// }
-//
-// void PaddingtonTree::RemoveBodies([[maybe_unused]] const BodyVector &inBodies, TrackingVector &ioTracking, const BodyID *ioBodyIDs, int inNumber)
-// {
-//
-//
-// 	// Mark tree dirty
-// 	mIsDirty = true;
-//
-// 	for (const BodyID *cur = ioBodyIDs, *end = ioBodyIDs + inNumber; cur < end; ++cur)
-// 	{
-//
-// 		// Get location of body
-// 		uint32 node_idx, child_idx;
-// 		GetBodyLocation(ioTracking, *cur, node_idx, child_idx);
-//
-// 		// First we reset our internal bookkeeping
-// 		sInvalidateBodyLocation(ioTracking, *cur);
-//
-// 		// Then we make the bounding box invalid, no queries can find this node anymore
-// 		Node &node = mAllocator->Get(node_idx);
-// 		node.InvalidateChildBounds(child_idx);
-//
-// 		// Finally we reset the child id, this makes the node available for adds again
-// 		node.mChildNodeID[child_idx] = NodeID::sInvalid();
-//
-// 		// We don't need to bubble up our bounding box changes to our parents since we never make volumes smaller, only bigger
-// 		// But we do need to mark the nodes as changed so that the tree can be rebuilt
-// 		MarkNodeAndParentsChanged(node_idx);
-// 	}
-//
-// 	mNumBodies -= inNumber;
-// }
-//
-// void PaddingtonTree::NotifyBodiesAABBChanged(const BodyVector &inBodies, const TrackingVector &inTracking, const BodyID *ioBodyIDs, int inNumber)
-// {
-// 	// Assert sane input
-// 	JPH_ASSERT(ioBodyIDs != nullptr);
-// 	JPH_ASSERT(inNumber > 0);
-//
-// 	for (const BodyID *cur = ioBodyIDs, *end = ioBodyIDs + inNumber; cur < end; ++cur)
-// 	{
-// 		// Check if BodyID is correct
-// 		const Body *body = inBodies[cur->GetIndex()];
-// 		JPH_ASSERT(body->GetID() == *cur, "Provided BodyID doesn't match BodyID in body manager");
-//
-// 		// Get the new bounding box
-// 		const AABox &new_bounds = body->GetWorldSpaceBounds();
-//
-// 		// Get location of body
-// 		uint32 node_idx, child_idx;
-// 		GetBodyLocation(inTracking, *cur, node_idx, child_idx);
-//
-// 		// Widen bounds for node
-// 		Node &node = mAllocator->Get(node_idx);
-// 		if (node.EncapsulateChildBounds(child_idx, new_bounds))
-// 		{
-// 			// Mark tree dirty
-// 			mIsDirty = true;
-//
-// 			// If bounds changed, widen the bounds for our parents too
-// 			WidenAndMarkNodeAndParentsChanged(node_idx, new_bounds);
-// 		}
-// 	}
-// }
-//
-// template <class Visitor>
-// JPH_INLINE void PaddingtonTree::WalkTree(const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking, Visitor &ioVisitor JPH_IF_TRACK_BROADPHASE_STATS(, LayerToStats &ioStats)) const
-// {
-// 	// Get the root
-// 	const RootNode &root_node = GetCurrentRoot();
-//
-// #ifdef JPH_TRACK_BROADPHASE_STATS
-// 	// Start tracking stats
-// 	int bodies_visited = 0;
-// 	int hits_collected = 0;
-// 	int nodes_visited = 0;
-// 	uint64 collector_ticks = 0;
-//
-// 	uint64 start = GetProcessorTickCount();
-// #endif // JPH_TRACK_BROADPHASE_STATS
-//
-// 	NodeID node_stack[cStackSize];
-// 	node_stack[0] = root_node.GetNodeID();
-// 	int top = 0;
-// 	do
-// 	{
-// 		// Check if node is a body
-// 		NodeID child_node_id = node_stack[top];
-// 		if (child_node_id.IsBody())
-// 		{
-// 			// Track amount of bodies visited
-// 			JPH_IF_TRACK_BROADPHASE_STATS(++bodies_visited;)
-//
-// 			BodyID body_id = child_node_id.GetBodyID();
-// 			ObjectLayer object_layer = inTracking[body_id.GetIndex()].mObjectLayer; // We're not taking a lock on the body, so it may be in the process of being removed so check if the object layer is invalid
-// 			if (object_layer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(object_layer))
-// 			{
-// 				JPH_PROFILE("VisitBody");
-//
-// 				// Track amount of hits
-// 				JPH_IF_TRACK_BROADPHASE_STATS(++hits_collected;)
-//
-// 				// Start track time the collector takes
-// 				JPH_IF_TRACK_BROADPHASE_STATS(uint64 collector_start = GetProcessorTickCount();)
-//
-// 				// We found a body we collide with, call our visitor
-// 				ioVisitor.VisitBody(body_id, top);
-//
-// 				// End track time the collector takes
-// 				JPH_IF_TRACK_BROADPHASE_STATS(collector_ticks += GetProcessorTickCount() - collector_start;)
-//
-// 				// Check if we're done
-// 				if (ioVisitor.ShouldAbort())
-// 					break;
-// 			}
-// 		}
-// 		else if (child_node_id.IsValid())
-// 		{
-// 			JPH_IF_TRACK_BROADPHASE_STATS(++nodes_visited;)
-//
-// 			// Check if stack can hold more nodes
-// 			if (top + 4 < cStackSize)
-// 			{
-// 				// Process normal node
-// 				const Node &node = mAllocator->Get(child_node_id.GetNodeIndex());
-// 				JPH_ASSERT(IsAligned(&node, JPH_CACHE_LINE_SIZE));
-//
-// 				// Load bounds of 4 children
-// 				Vec4 bounds_minx = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMinX);
-// 				Vec4 bounds_miny = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMinY);
-// 				Vec4 bounds_minz = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMinZ);
-// 				Vec4 bounds_maxx = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMaxX);
-// 				Vec4 bounds_maxy = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMaxY);
-// 				Vec4 bounds_maxz = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMaxZ);
-//
-// 				// Load ids for 4 children
-// 				UVec4 child_ids = UVec4::sLoadInt4Aligned((const uint32 *)&node.mChildNodeID[0]);
-//
-// 				// Check which sub nodes to visit
-// 				int num_results = ioVisitor.VisitNodes(bounds_minx, bounds_miny, bounds_minz, bounds_maxx, bounds_maxy, bounds_maxz, child_ids, top);
-// 				child_ids.StoreInt4((uint32 *)&node_stack[top]);
-// 				top += num_results;
-// 			}
-// 			else
-// 				JPH_ASSERT(false, "Stack full!\n"
-// 					"This must be a very deep tree. Are you batch adding bodies through BodyInterface::AddBodiesPrepare/AddBodiesFinalize?\n"
-// 					"If you add lots of bodies through BodyInterface::AddBody you may need to call PhysicsSystem::OptimizeBroadPhase to rebuild the tree.");
-// 		}
-//
-// 		// Fetch next node until we find one that the visitor wants to see
-// 		do
-// 			--top;
-// 		while (top >= 0 && !ioVisitor.ShouldVisitNode(top));
-// 	}
-// 	while (top >= 0);
-//
-// #ifdef JPH_TRACK_BROADPHASE_STATS
-// 	// Calculate total time the broadphase walk took
-// 	uint64 total_ticks = GetProcessorTickCount() - start;
-//
-// 	// Update stats under lock protection (slow!)
-// 	{
-// 		unique_lock lock(mStatsMutex);
-// 		Stat &s = ioStats[inObjectLayerFilter.GetDescription()];
-// 		s.mNumQueries++;
-// 		s.mNodesVisited += nodes_visited;
-// 		s.mBodiesVisited += bodies_visited;
-// 		s.mHitsReported += hits_collected;
-// 		s.mTotalTicks += total_ticks;
-// 		s.mCollectorTicks += collector_ticks;
-// 	}
-// #endif // JPH_TRACK_BROADPHASE_STATS
-// }
-//
-// void PaddingtonTree::CastRay(const RayCast &inRay, RayCastBodyCollector &ioCollector, const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking) const
-// {
-// 	class Visitor
-// 	{
-// 	public:
-// 		/// Constructor
-// 		JPH_INLINE				Visitor(const RayCast &inRay, RayCastBodyCollector &ioCollector) :
-// 			mOrigin(inRay.mOrigin),
-// 			mInvDirection(inRay.mDirection),
-// 			mCollector(ioCollector)
-// 		{
-// 			mFractionStack[0] = -1;
-// 		}
-//
-// 		/// Returns true if further processing of the tree should be aborted
-// 		JPH_INLINE bool			ShouldAbort() const
-// 		{
-// 			return mCollector.ShouldEarlyOut();
-// 		}
-//
-// 		/// Returns true if this node / body should be visited, false if no hit can be generated
-// 		JPH_INLINE bool			ShouldVisitNode(int inStackTop) const
-// 		{
-// 			return mFractionStack[inStackTop] < mCollector.GetEarlyOutFraction();
-// 		}
-//
-// 		/// Visit nodes, returns number of hits found and sorts ioChildNodeIDs so that they are at the beginning of the vector.
-// 		JPH_INLINE int			VisitNodes(Vec4Arg inBoundsMinX, Vec4Arg inBoundsMinY, Vec4Arg inBoundsMinZ, Vec4Arg inBoundsMaxX, Vec4Arg inBoundsMaxY, Vec4Arg inBoundsMaxZ, UVec4 &ioChildNodeIDs, int inStackTop)
-// 		{
-// 			// Test the ray against 4 bounding boxes
-// 			Vec4 fraction = RayAABox4(mOrigin, mInvDirection, inBoundsMinX, inBoundsMinY, inBoundsMinZ, inBoundsMaxX, inBoundsMaxY, inBoundsMaxZ);
-//
-// 			// Sort so that highest values are first (we want to first process closer hits and we process stack top to bottom)
-// 			return SortReverseAndStore(fraction, mCollector.GetEarlyOutFraction(), ioChildNodeIDs, &mFractionStack[inStackTop]);
-// 		}
-//
-// 		/// Visit a body, returns false if the algorithm should terminate because no hits can be generated anymore
-// 		JPH_INLINE void			VisitBody(const BodyID &inBodyID, int inStackTop)
-// 		{
-// 			// Store potential hit with body
-// 			BroadPhaseCastResult result { inBodyID, mFractionStack[inStackTop] };
-// 			mCollector.AddHit(result);
-// 		}
-//
-// 	private:
-// 		Vec3					mOrigin;
-// 		RayInvDirection			mInvDirection;
-// 		RayCastBodyCollector &	mCollector;
-// 		float					mFractionStack[cStackSize];
-// 	};
-//
-// 	Visitor visitor(inRay, ioCollector);
-// 	WalkTree(inObjectLayerFilter, inTracking, visitor JPH_IF_TRACK_BROADPHASE_STATS(, mCastRayStats));
-// }
-//
-// void PaddingtonTree::CollideAABox(const AABox &inBox, CollideShapeBodyCollector &ioCollector, const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking) const
-// {
-// 	class Visitor
-// 	{
-// 	public:
-// 		/// Constructor
-// 		JPH_INLINE					Visitor(const AABox &inBox, CollideShapeBodyCollector &ioCollector) :
-// 			mBox(inBox),
-// 			mCollector(ioCollector)
-// 		{
-// 		}
-//
-// 		/// Returns true if further processing of the tree should be aborted
-// 		JPH_INLINE bool				ShouldAbort() const
-// 		{
-// 			return mCollector.ShouldEarlyOut();
-// 		}
-//
-// 		/// Returns true if this node / body should be visited, false if no hit can be generated
-// 		JPH_INLINE bool				ShouldVisitNode(int inStackTop) const
-// 		{
-// 			return true;
-// 		}
-//
-// 		/// Visit nodes, returns number of hits found and sorts ioChildNodeIDs so that they are at the beginning of the vector.
-// 		JPH_INLINE int				VisitNodes(Vec4Arg inBoundsMinX, Vec4Arg inBoundsMinY, Vec4Arg inBoundsMinZ, Vec4Arg inBoundsMaxX, Vec4Arg inBoundsMaxY, Vec4Arg inBoundsMaxZ, UVec4 &ioChildNodeIDs, int inStackTop) const
-// 		{
-// 			// Test the box vs 4 boxes
-// 			UVec4 hitting = AABox4VsBox(mBox, inBoundsMinX, inBoundsMinY, inBoundsMinZ, inBoundsMaxX, inBoundsMaxY, inBoundsMaxZ);
-// 			return CountAndSortTrues(hitting, ioChildNodeIDs);
-// 		}
-//
-// 		/// Visit a body, returns false if the algorithm should terminate because no hits can be generated anymore
-// 		JPH_INLINE void				VisitBody(const BodyID &inBodyID, int inStackTop)
-// 		{
-// 			// Store potential hit with body
-// 			mCollector.AddHit(inBodyID);
-// 		}
-//
-// 	private:
-// 		const AABox &				mBox;
-// 		CollideShapeBodyCollector &	mCollector;
-// 	};
-//
-// 	Visitor visitor(inBox, ioCollector);
-// 	WalkTree(inObjectLayerFilter, inTracking, visitor JPH_IF_TRACK_BROADPHASE_STATS(, mCollideAABoxStats));
-// }
-//
-// void PaddingtonTree::CollideSphere(Vec3Arg inCenter, float inRadius, CollideShapeBodyCollector &ioCollector, const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking) const
-// {
-// 	class Visitor
-// 	{
-// 	public:
-// 		/// Constructor
-// 		JPH_INLINE					Visitor(Vec3Arg inCenter, float inRadius, CollideShapeBodyCollector &ioCollector) :
-// 			mCenterX(inCenter.SplatX()),
-// 			mCenterY(inCenter.SplatY()),
-// 			mCenterZ(inCenter.SplatZ()),
-// 			mRadiusSq(Vec4::sReplicate(Square(inRadius))),
-// 			mCollector(ioCollector)
-// 		{
-// 		}
-//
-// 		/// Returns true if further processing of the tree should be aborted
-// 		JPH_INLINE bool				ShouldAbort() const
-// 		{
-// 			return mCollector.ShouldEarlyOut();
-// 		}
-//
-// 		/// Returns true if this node / body should be visited, false if no hit can be generated
-// 		JPH_INLINE bool				ShouldVisitNode(int inStackTop) const
-// 		{
-// 			return true;
-// 		}
-//
-// 		/// Visit nodes, returns number of hits found and sorts ioChildNodeIDs so that they are at the beginning of the vector.
-// 		JPH_INLINE int				VisitNodes(Vec4Arg inBoundsMinX, Vec4Arg inBoundsMinY, Vec4Arg inBoundsMinZ, Vec4Arg inBoundsMaxX, Vec4Arg inBoundsMaxY, Vec4Arg inBoundsMaxZ, UVec4 &ioChildNodeIDs, int inStackTop) const
-// 		{
-// 			// Test 4 boxes vs sphere
-// 			UVec4 hitting = AABox4VsSphere(mCenterX, mCenterY, mCenterZ, mRadiusSq, inBoundsMinX, inBoundsMinY, inBoundsMinZ, inBoundsMaxX, inBoundsMaxY, inBoundsMaxZ);
-// 			return CountAndSortTrues(hitting, ioChildNodeIDs);
-// 		}
-//
-// 		/// Visit a body, returns false if the algorithm should terminate because no hits can be generated anymore
-// 		JPH_INLINE void				VisitBody(const BodyID &inBodyID, int inStackTop)
-// 		{
-// 			// Store potential hit with body
-// 			mCollector.AddHit(inBodyID);
-// 		}
-//
-// 	private:
-// 		Vec4						mCenterX;
-// 		Vec4						mCenterY;
-// 		Vec4						mCenterZ;
-// 		Vec4						mRadiusSq;
-// 		CollideShapeBodyCollector &	mCollector;
-// 	};
-//
-// 	Visitor visitor(inCenter, inRadius, ioCollector);
-// 	WalkTree(inObjectLayerFilter, inTracking, visitor JPH_IF_TRACK_BROADPHASE_STATS(, mCollideSphereStats));
-// }
-//
-// void PaddingtonTree::CollidePoint(Vec3Arg inPoint, CollideShapeBodyCollector &ioCollector, const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking) const
-// {
-// 	class Visitor
-// 	{
-// 	public:
-// 		/// Constructor
-// 		JPH_INLINE					Visitor(Vec3Arg inPoint, CollideShapeBodyCollector &ioCollector) :
-// 			mPoint(inPoint),
-// 			mCollector(ioCollector)
-// 		{
-// 		}
-//
-// 		/// Returns true if further processing of the tree should be aborted
-// 		JPH_INLINE bool				ShouldAbort() const
-// 		{
-// 			return mCollector.ShouldEarlyOut();
-// 		}
-//
-// 		/// Returns true if this node / body should be visited, false if no hit can be generated
-// 		JPH_INLINE bool				ShouldVisitNode(int inStackTop) const
-// 		{
-// 			return true;
-// 		}
-//
-// 		/// Visit nodes, returns number of hits found and sorts ioChildNodeIDs so that they are at the beginning of the vector.
-// 		JPH_INLINE int				VisitNodes(Vec4Arg inBoundsMinX, Vec4Arg inBoundsMinY, Vec4Arg inBoundsMinZ, Vec4Arg inBoundsMaxX, Vec4Arg inBoundsMaxY, Vec4Arg inBoundsMaxZ, UVec4 &ioChildNodeIDs, int inStackTop) const
-// 		{
-// 			// Test if point overlaps with box
-// 			UVec4 hitting = AABox4VsPoint(mPoint, inBoundsMinX, inBoundsMinY, inBoundsMinZ, inBoundsMaxX, inBoundsMaxY, inBoundsMaxZ);
-// 			return CountAndSortTrues(hitting, ioChildNodeIDs);
-// 		}
-//
-// 		/// Visit a body, returns false if the algorithm should terminate because no hits can be generated anymore
-// 		JPH_INLINE void				VisitBody(const BodyID &inBodyID, int inStackTop)
-// 		{
-// 			// Store potential hit with body
-// 			mCollector.AddHit(inBodyID);
-// 		}
-//
-// 	private:
-// 		Vec3						mPoint;
-// 		CollideShapeBodyCollector &	mCollector;
-// 	};
-//
-// 	Visitor visitor(inPoint, ioCollector);
-// 	WalkTree(inObjectLayerFilter, inTracking, visitor JPH_IF_TRACK_BROADPHASE_STATS(, mCollidePointStats));
-// }
-//
-// void PaddingtonTree::CollideOrientedBox(const OrientedBox &inBox, CollideShapeBodyCollector &ioCollector, const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking) const
-// {
-// 	class Visitor
-// 	{
-// 	public:
-// 		/// Constructor
-// 		JPH_INLINE					Visitor(const OrientedBox &inBox, CollideShapeBodyCollector &ioCollector) :
-// 			mBox(inBox),
-// 			mCollector(ioCollector)
-// 		{
-// 		}
-//
-// 		/// Returns true if further processing of the tree should be aborted
-// 		JPH_INLINE bool				ShouldAbort() const
-// 		{
-// 			return mCollector.ShouldEarlyOut();
-// 		}
-//
-// 		/// Returns true if this node / body should be visited, false if no hit can be generated
-// 		JPH_INLINE bool				ShouldVisitNode(int inStackTop) const
-// 		{
-// 			return true;
-// 		}
-//
-// 		/// Visit nodes, returns number of hits found and sorts ioChildNodeIDs so that they are at the beginning of the vector.
-// 		JPH_INLINE int				VisitNodes(Vec4Arg inBoundsMinX, Vec4Arg inBoundsMinY, Vec4Arg inBoundsMinZ, Vec4Arg inBoundsMaxX, Vec4Arg inBoundsMaxY, Vec4Arg inBoundsMaxZ, UVec4 &ioChildNodeIDs, int inStackTop) const
-// 		{
-// 			// Test if point overlaps with box
-// 			UVec4 hitting = AABox4VsBox(mBox, inBoundsMinX, inBoundsMinY, inBoundsMinZ, inBoundsMaxX, inBoundsMaxY, inBoundsMaxZ);
-// 			return CountAndSortTrues(hitting, ioChildNodeIDs);
-// 		}
-//
-// 		/// Visit a body, returns false if the algorithm should terminate because no hits can be generated anymore
-// 		JPH_INLINE void				VisitBody(const BodyID &inBodyID, int inStackTop)
-// 		{
-// 			// Store potential hit with body
-// 			mCollector.AddHit(inBodyID);
-// 		}
-//
-// 	private:
-// 		OrientedBox					mBox;
-// 		CollideShapeBodyCollector &	mCollector;
-// 	};
-//
-// 	Visitor visitor(inBox, ioCollector);
-// 	WalkTree(inObjectLayerFilter, inTracking, visitor JPH_IF_TRACK_BROADPHASE_STATS(, mCollideOrientedBoxStats));
-// }
-//
-// void PaddingtonTree::CastAABox(const AABoxCast &inBox, CastShapeBodyCollector &ioCollector, const ObjectLayerFilter &inObjectLayerFilter, const TrackingVector &inTracking) const
-// {
-// 	class Visitor
-// 	{
-// 	public:
-// 		/// Constructor
-// 		JPH_INLINE					Visitor(const AABoxCast &inBox, CastShapeBodyCollector &ioCollector) :
-// 			mOrigin(inBox.mBox.GetCenter()),
-// 			mExtent(inBox.mBox.GetExtent()),
-// 			mInvDirection(inBox.mDirection),
-// 			mCollector(ioCollector)
-// 		{
-// 			mFractionStack[0] = -1;
-// 		}
-//
-// 		/// Returns true if further processing of the tree should be aborted
-// 		JPH_INLINE bool				ShouldAbort() const
-// 		{
-// 			return mCollector.ShouldEarlyOut();
-// 		}
-//
-// 		/// Returns true if this node / body should be visited, false if no hit can be generated
-// 		JPH_INLINE bool				ShouldVisitNode(int inStackTop) const
-// 		{
-// 			return mFractionStack[inStackTop] < mCollector.GetPositiveEarlyOutFraction();
-// 		}
-//
-// 		/// Visit nodes, returns number of hits found and sorts ioChildNodeIDs so that they are at the beginning of the vector.
-// 		JPH_INLINE int				VisitNodes(Vec4Arg inBoundsMinX, Vec4Arg inBoundsMinY, Vec4Arg inBoundsMinZ, Vec4Arg inBoundsMaxX, Vec4Arg inBoundsMaxY, Vec4Arg inBoundsMaxZ, UVec4 &ioChildNodeIDs, int inStackTop)
-// 		{
-// 			// Enlarge them by the casted aabox extents
-// 			Vec4 bounds_min_x = inBoundsMinX, bounds_min_y = inBoundsMinY, bounds_min_z = inBoundsMinZ, bounds_max_x = inBoundsMaxX, bounds_max_y = inBoundsMaxY, bounds_max_z = inBoundsMaxZ;
-// 			AABox4EnlargeWithExtent(mExtent, bounds_min_x, bounds_min_y, bounds_min_z, bounds_max_x, bounds_max_y, bounds_max_z);
-//
-// 			// Test 4 children
-// 			Vec4 fraction = RayAABox4(mOrigin, mInvDirection, bounds_min_x, bounds_min_y, bounds_min_z, bounds_max_x, bounds_max_y, bounds_max_z);
-//
-// 			// Sort so that highest values are first (we want to first process closer hits and we process stack top to bottom)
-// 			return SortReverseAndStore(fraction, mCollector.GetPositiveEarlyOutFraction(), ioChildNodeIDs, &mFractionStack[inStackTop]);
-// 		}
-//
-// 		/// Visit a body, returns false if the algorithm should terminate because no hits can be generated anymore
-// 		JPH_INLINE void				VisitBody(const BodyID &inBodyID, int inStackTop)
-// 		{
-// 			// Store potential hit with body
-// 			BroadPhaseCastResult result { inBodyID, mFractionStack[inStackTop] };
-// 			mCollector.AddHit(result);
-// 		}
-//
-// 	private:
-// 		Vec3						mOrigin;
-// 		Vec3						mExtent;
-// 		RayInvDirection				mInvDirection;
-// 		CastShapeBodyCollector &	mCollector;
-// 		float						mFractionStack[cStackSize];
-// 	};
-//
-// 	Visitor visitor(inBox, ioCollector);
-// 	WalkTree(inObjectLayerFilter, inTracking, visitor JPH_IF_TRACK_BROADPHASE_STATS(, mCastAABoxStats));
-// }
-//
-// void PaddingtonTree::FindCollidingPairs(const BodyVector &inBodies, const BodyID *inActiveBodies, int inNumActiveBodies, float inSpeculativeContactDistance, BodyPairCollector &ioPairCollector, const ObjectLayerPairFilter &inObjectLayerPairFilter) const
-// {
-// 	// Note that we don't lock the tree at this point. We know that the tree is not going to be swapped or deleted while finding collision pairs due to the way the jobs are scheduled in the PhysicsSystem::Update.
-// 	// We double check this at the end of the function.
-// 	const RootNode &root_node = GetCurrentRoot();
-// 	JPH_ASSERT(root_node.mIndex != cInvalidNodeIndex);
-//
-// 	// Assert sane input
-// 	JPH_ASSERT(inActiveBodies != nullptr);
-// 	JPH_ASSERT(inNumActiveBodies > 0);
-//
-// 	NodeID node_stack[cStackSize];
-//
-// 	// Loop over all active bodies
-// 	for (int b1 = 0; b1 < inNumActiveBodies; ++b1)
-// 	{
-// 		BodyID b1_id = inActiveBodies[b1];
-// 		const Body &body1 = *inBodies[b1_id.GetIndex()];
-// 		JPH_ASSERT(!body1.IsStatic());
-//
-// 		// Expand the bounding box by the speculative contact distance
-// 		AABox bounds1 = body1.GetWorldSpaceBounds();
-// 		bounds1.ExpandBy(Vec3::sReplicate(inSpeculativeContactDistance));
-//
-// 		// Test each body with the tree
-// 		node_stack[0] = root_node.GetNodeID();
-// 		int top = 0;
-// 		do
-// 		{
-// 			// Check if node is a body
-// 			NodeID child_node_id = node_stack[top];
-// 			if (child_node_id.IsBody())
-// 			{
-// 				// Don't collide with self
-// 				BodyID b2_id = child_node_id.GetBodyID();
-// 				if (b1_id != b2_id)
-// 				{
-// 					// Collision between dynamic pairs need to be picked up only once
-// 					const Body &body2 = *inBodies[b2_id.GetIndex()];
-// 					if (inObjectLayerPairFilter.ShouldCollide(body1.GetObjectLayer(), body2.GetObjectLayer())
-// 						&& Body::sFindCollidingPairsCanCollide(body1, body2)
-// 						&& bounds1.Overlaps(body2.GetWorldSpaceBounds())) // In the broadphase we widen the bounding box when a body moves, do a final check to see if the bounding boxes actually overlap
-// 					{
-// 						// Store potential hit between bodies
-// 						ioPairCollector.AddHit({ b1_id, b2_id });
-// 					}
-// 				}
-// 			}
-// 			else if (child_node_id.IsValid())
-// 			{
-// 				// Process normal node
-// 				const Node &node = mAllocator->Get(child_node_id.GetNodeIndex());
-// 				JPH_ASSERT(IsAligned(&node, JPH_CACHE_LINE_SIZE));
-//
-// 				// Get bounds of 4 children
-// 				Vec4 bounds_minx = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMinX);
-// 				Vec4 bounds_miny = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMinY);
-// 				Vec4 bounds_minz = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMinZ);
-// 				Vec4 bounds_maxx = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMaxX);
-// 				Vec4 bounds_maxy = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMaxY);
-// 				Vec4 bounds_maxz = Vec4::sLoadFloat4Aligned((const Float4 *)&node.mBoundsMaxZ);
-//
-// 				// Test overlap
-// 				UVec4 overlap = AABox4VsBox(bounds1, bounds_minx, bounds_miny, bounds_minz, bounds_maxx, bounds_maxy, bounds_maxz);
-// 				int num_results = overlap.CountTrues();
-// 				if (num_results > 0)
-// 				{
-// 					// Load ids for 4 children
-// 					UVec4 child_ids = UVec4::sLoadInt4Aligned((const uint32 *)&node.mChildNodeID[0]);
-//
-// 					// Sort so that overlaps are first
-// 					child_ids = UVec4::sSort4True(overlap, child_ids);
-//
-// 					// Push them onto the stack
-// 					if (top + 4 < cStackSize)
-// 					{
-// 						child_ids.StoreInt4((uint32 *)&node_stack[top]);
-// 						top += num_results;
-// 					}
-// 					else
-// 						JPH_ASSERT(false, "Stack full!\n"
-// 							"This must be a very deep tree. Are you batch adding bodies through BodyInterface::AddBodiesPrepare/AddBodiesFinalize?\n"
-// 							"If you add lots of bodies through BodyInterface::AddBody you may need to call PhysicsSystem::OptimizeBroadPhase to rebuild the tree.");
-// 				}
-// 			}
-// 			--top;
-// 		}
-// 		while (top >= 0);
-// 	}
-//
-// 	// Test that the root node was not swapped while finding collision pairs.
-// 	// This would mean that UpdateFinalize/DiscardOldTree ran during collision detection which should not be possible due to the way the jobs are scheduled.
-// 	JPH_ASSERT(root_node.mIndex != cInvalidNodeIndex);
-// 	JPH_ASSERT(&root_node == &GetCurrentRoot());
-// }
-//
-// uint PaddingtonTree::GetMaxTreeDepth(const NodeID &inNodeID) const
-// {
-// 	// Reached a leaf?
-// 	if (!inNodeID.IsValid() || inNodeID.IsBody())
-// 		return 0;
-//
-// 	// Recurse to children
-// 	uint max_depth = 0;
-// 	const Node &node = mAllocator->Get(inNodeID.GetNodeIndex());
-// 	for (NodeID child_node_id : node.mChildNodeID)
-// 		max_depth = max(max_depth, GetMaxTreeDepth(child_node_id));
-// 	return max_depth + 1;
-// }
-//
-// JPH_NAMESPACE_END
+// Jolt Physics Library (https://github.com/jrouwe/JoltPhysics)
+// SPDX-FileCopyrightText: 2021 Jorrit Rouwe
+// SPDX-License-Identifier: MIT
+
+#include "Experimental/PaddingtonTree.h"
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/AABoxCast.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Body/BodyPair.h>
+#include <Jolt/Geometry/RayAABox.h>
+#include <Jolt/Geometry/OrientedBox.h>
+#include <Jolt/Core/QuickSort.h>
+
+JPH_SUPPRESS_WARNINGS_STD_BEGIN
+#include <algorithm>
+#include <cmath>
+JPH_SUPPRESS_WARNINGS_STD_END
+
+JPH_NAMESPACE_BEGIN
+
+//room every body gets before a move has to touch its entry, plus a bit more for the big ones. meters.
+static constexpr float cPadding = 0.1f;
+static constexpr float cPaddingFraction = 0.1f;
+//below this many bodies the huge list isn't worth the bookkeeping.
+static constexpr uint32 cMinBodiesForHugeSplit = 64;
+//anything this many times wider than the 90th percentile entry gets brute forced instead of swept.
+static constexpr float cHugeWidthFactor = 8.0f;
+//moves per entry the insertion sort gets before we decide last tick's order was no help and QuickSort instead.
+static constexpr uint64 cInsertionSortBudget = 8;
+//pending lists longer than this get sorted once per FindCollidingPairs call instead of brute forced per active body.
+static constexpr uint32 cSortPendingThreshold = 32;
+//strips get at least this many entries on average, and there are never more than cMaxStrips (it has to fit in Entry::mStrip).
+static constexpr uint32 cMinEntriesPerStrip = 8;
+static constexpr uint32 cMaxStrips = 4096;
+//and they're at least as wide as the 90th percentile entry, so a query touches three or four of them.
+static constexpr float cStripWidthFactor = 1.0f;
+
+static JPH_INLINE void sAtomicMax(atomic<float>& ioValue, float inValue)
+{
+	float current = ioValue.load(memory_order_relaxed);
+	while (current < inValue && !ioValue.compare_exchange_weak(current, inValue, memory_order_relaxed))
+	{
+	}
+}
+
+static JPH_INLINE bool sOverlaps(const Float3& inMinA, const Float3& inMaxA, const Float3& inMinB, const Float3& inMaxB)
+{
+	return inMinA.x <= inMaxB.x && inMaxA.x >= inMinB.x
+		&& inMinA.y <= inMaxB.y && inMaxA.y >= inMinB.y
+		&& inMinA.z <= inMaxB.z && inMaxA.z >= inMinB.z;
+}
+
+//returns false, with the range still a permutation, if it ran out of budget.
+template <class EntryType, class Less>
+static bool sInsertionSort(EntryType* ioEntries, uint32 inCount, const Less& inLess, uint64 inBudget)
+{
+	uint64 moves = 0;
+	for (uint32 i = 1; i < inCount; ++i)
+	{
+		const EntryType entry = ioEntries[i];
+		uint32 j = i;
+		while (j > 0 && inLess(entry, ioEntries[j - 1]))
+		{
+			ioEntries[j] = ioEntries[j - 1];
+			--j;
+			if (++moves > inBudget)
+			{
+				ioEntries[j] = entry;
+				return false;
+			}
+		}
+		ioEntries[j] = entry;
+	}
+	return true;
+}
+
+PaddingtonTree::~PaddingtonTree()
+{
+	for (Buffer& buffer : mBuffers)
+	{
+		delete [] buffer.mPending;
+	}
+}
+
+void PaddingtonTree::Init(BroadPhaseLayer::Type inLayer, uint32 inMaxBodies)
+{
+	mLayer = inLayer;
+	mMaxBodies = inMaxBodies;
+	for (Buffer& buffer : mBuffers)
+	{
+		delete [] buffer.mPending;
+		buffer.mPending = new atomic<uint32> [inMaxBodies];
+		for (uint32 p = 0; p < inMaxBodies; ++p)
+			buffer.mPending[p].store(BodyID::cInvalidBodyID, memory_order_relaxed);
+		buffer.mNumPending = 0;
+	}
+}
+
+void PaddingtonTree::sPad(Vec3Arg inMin, Vec3Arg inMax, Entry& outEntry)
+{
+	const Vec3 padding = Vec3::sReplicate(cPadding + cPaddingFraction * 0.5f * (inMax - inMin).ReduceMax());
+	outEntry.mMin.Store(inMin - padding);
+	outEntry.mMax.Store(inMax + padding);
+}
+
+bool PaddingtonTree::IsLive(uint32 inBodyID, const TrackingVector& inTracking) const
+{
+	if (inBodyID == BodyID::cInvalidBodyID)
+		return false;
+
+	// The entry may be from a buffer we're holding open for an old query, or the body may have been removed, or removed and
+	// re-added to another layer. Tracking is the only thing that's always current.
+	const Tracking& t = inTracking[BodyID(inBodyID).GetIndex()];
+	return t.mBodyID.load(memory_order_acquire) == inBodyID && t.mBroadPhaseLayer.load(memory_order_relaxed) == mLayer;
+}
+
+template <class Visit>
+void PaddingtonTree::Sweep(const AABox& inBounds, const TrackingVector& inTracking, const Array<Entry>* inSortedPending,
+                           Visit&& inVisit) const
+{
+	const Buffer& buffer = GetCurrent();
+	const int axis = int(buffer.mAxis);
+
+	Float3 query_min, query_max;
+	inBounds.mMin.StoreFloat3(&query_min);
+	inBounds.mMax.StoreFloat3(&query_max);
+
+	auto visit_body = [&](uint32 inBodyID) -> bool
+	{
+		if (!IsLive(inBodyID, inTracking))
+			return true;
+		const BodyID body_id(inBodyID);
+		const Tracking& t = inTracking[body_id.GetIndex()];
+		Float3 bounds_min, bounds_max;
+		t.GetBounds(bounds_min, bounds_max);
+		if (!sOverlaps(query_min, query_max, bounds_min, bounds_max))
+			return true;
+		return inVisit(body_id, t.mObjectLayer.load(memory_order_relaxed), AABox(Vec3(bounds_min), Vec3(bounds_max)));
+	};
+
+	auto visit_entry = [&](const Entry& inEntry) -> bool
+	{
+		// padded box first, it's right here in the line we already pulled. tracking is a miss.
+		if (!sOverlaps(query_min, query_max, inEntry.mMin.Load(), inEntry.mMax.Load()))
+			return true;
+		return visit_body(inEntry.mBodyID);
+	};
+
+	// Widen the window by how wide an entry can be and how far one can have drifted from its key or strip
+	const float slack = buffer.mSlack.load(memory_order_relaxed);
+	const float low = query_min[axis] - buffer.mMaxWidth.load(memory_order_relaxed) - slack;
+	const float high = query_max[axis] + slack;
+	const float* keys = buffer.mKeys.data();
+	const uint32* strip_starts = buffer.mStripStarts.data();
+	const uint32 num_strips = uint32(buffer.mStripStarts.size()) - 1;
+	const int strip_axis = int(buffer.mStripAxis);
+	auto strip_of = [&buffer, num_strips](float inValue)
+	{
+		const float strip = (inValue - buffer.mStripOrigin) / buffer.mStripSize;
+		return strip <= 0.0f? 0u : (strip >= float(num_strips - 1)? num_strips - 1 : uint32(strip));
+	};
+	if (!buffer.mSorted.empty())
+	{
+		const uint32 last_strip = strip_of(query_max[strip_axis] + slack);
+		for (uint32 strip = strip_of(query_min[strip_axis] - buffer.mMaxStripWidth.load(memory_order_relaxed) - slack); strip <= last_strip; ++strip)
+		{
+			const uint32 end = strip_starts[strip + 1];
+			for (uint32 i = uint32(std::lower_bound(keys + strip_starts[strip], keys + end, low) - keys); i < end && keys[i] <= high; ++i)
+				if (!visit_entry(buffer.mSorted[i]))
+					return;
+		}
+	}
+
+	for (const Entry& entry : buffer.mHuge)
+		if (!visit_entry(entry))
+			return;
+
+	if (inSortedPending != nullptr)
+	{
+		// These are tight boxes sorted on the current axis, so no slack, but they can be any width
+		float max_width = 0;
+		for (const Entry& entry : *inSortedPending)
+			max_width = max(max_width, entry.mMax[axis] - entry.mMin[axis]);
+		const Entry* first = std::lower_bound(inSortedPending->data(), inSortedPending->data() + inSortedPending->size(), query_min[axis] - max_width,
+			[axis](const Entry& inEntry, float inKey) { return inEntry.mMin[axis] < inKey; });
+		for (const Entry* entry = first; entry < inSortedPending->data() + inSortedPending->size() && entry->mMin[axis] <= query_max[axis]; ++entry)
+			if (!visit_entry(*entry))
+				return;
+		return;
+	}
+
+	const uint32 num_pending = min(buffer.mNumPending.load(memory_order_acquire), mMaxBodies);
+	for (uint32 p = 0; p < num_pending; ++p)
+		if (!visit_body(buffer.mPending[p].load(memory_order_acquire)))
+			return;
+}
+
+AABox PaddingtonTree::GetBounds(const TrackingVector& inTracking) const
+{
+	const Buffer& buffer = GetCurrent();
+	AABox bounds;
+	auto encapsulate = [&](uint32 inBodyID)
+	{
+		if (IsLive(inBodyID, inTracking))
+		{
+			const Tracking& t = inTracking[BodyID(inBodyID).GetIndex()];
+			bounds.Encapsulate(t.GetBounds());
+		}
+	};
+	for (const Entry& entry : buffer.mSorted)
+		encapsulate(entry.mBodyID);
+	for (const Entry& entry : buffer.mHuge)
+		encapsulate(entry.mBodyID);
+	const uint32 num_pending = min(buffer.mNumPending.load(memory_order_acquire), mMaxBodies);
+	for (uint32 p = 0; p < num_pending; ++p)
+		encapsulate(buffer.mPending[p].load(memory_order_acquire));
+	return bounds;
+}
+
+void PaddingtonTree::UpdatePrepare(TrackingVector& ioTracking, bool inFullRebuild)
+{
+	JPH_PROFILE_FUNCTION();
+
+	// The other buffer must have been released by FrameSync, or a query could still be walking it
+	JPH_ASSERT(CanBeUpdated());
+
+	const uint32 current = mCurrent.load(memory_order_relaxed);
+	const Buffer& front = mBuffers[current];
+	Buffer& back = mBuffers[current ^ 1];
+	Tracking* tracking = ioTracking.data();
+
+	// Back is two rebuilds stale and nobody reads it anymore, start over
+	back.mSorted.clear();
+	back.mHuge.clear();
+	back.mKeys.clear();
+	back.mStripStarts.clear();
+	const uint32 stale_pending = min(back.mNumPending.load(memory_order_relaxed), mMaxBodies);
+	for (uint32 p = 0; p < stale_pending; ++p)
+		back.mPending[p].store(BodyID::cInvalidBodyID, memory_order_relaxed);
+	back.mNumPending.store(0, memory_order_relaxed);
+	back.mSorted.reserve(mNumBodies.load(memory_order_relaxed));
+
+	// Entries whose body is still inside its padding keep it, so a world that settled rebuilds to the same boxes.
+	Vec3 center_sum = Vec3::sZero(), center_sq_sum = Vec3::sZero();
+	auto emplace = [&](uint32 inBodyID, const Entry* inPrevious)
+	{
+		const Tracking& t = tracking[BodyID(inBodyID).GetIndex()];
+		const AABox bounds = t.GetBounds();
+		const Vec3 min = bounds.mMin, max = bounds.mMax;
+		Entry& entry = back.mSorted.emplace_back();
+		entry.mBodyID = inBodyID;
+		entry.mObjectLayer = t.mObjectLayer.load(memory_order_relaxed);
+		sPad(min, max, entry);
+		if (inPrevious != nullptr && !inFullRebuild)
+		{
+			// Moves only ever grow an entry (see NotifyBodiesAABBChanged), so one that grew past twice its padding gets
+			// a fresh box. Anything the body has just been drifting around inside stays put.
+			const AABox previous(Vec3(inPrevious->mMin.Load()), Vec3(inPrevious->mMax.Load()));
+			const Vec3 padding = min - Vec3(entry.mMin.Load());
+			if (previous.Contains(bounds) && AABox(min - 2.0f * padding, max + 2.0f * padding).Contains(previous))
+			{
+				entry.mMin = inPrevious->mMin;
+				entry.mMax = inPrevious->mMax;
+			}
+		}
+		const Vec3 center = 0.5f * (min + max);
+		center_sum += center;
+		center_sq_sum += center * center;
+	};
+
+	for (const Entry& entry : front.mSorted)
+		if (IsLive(entry.mBodyID, ioTracking))
+			emplace(entry.mBodyID, &entry);
+	const uint32 num_previously_sorted = uint32(back.mSorted.size());
+	for (const Entry& entry : front.mHuge)
+		if (IsLive(entry.mBodyID, ioTracking))
+			emplace(entry.mBodyID, &entry);
+	const uint32 num_pending = min(front.mNumPending.load(memory_order_acquire), mMaxBodies);
+	for (uint32 p = 0; p < num_pending; ++p)
+	{
+		const uint32 body_id = front.mPending[p].load(memory_order_acquire);
+		if (IsLive(body_id, ioTracking))
+			emplace(body_id, nullptr);
+	}
+	const uint32 count = uint32(back.mSorted.size());
+
+	// Sweep along whichever axis the bodies spread out on most, in strips along the next one
+	uint axis = front.mAxis, strip_axis = front.mStripAxis;
+	if (count > 1)
+	{
+		const Vec3 mean = center_sum / float(count);
+		Vec3 variance = center_sq_sum / float(count) - mean * mean;
+		axis = uint(variance.GetHighestComponentIndex());
+		variance.SetComponent(axis, -1.0f);
+		strip_axis = uint(variance.GetHighestComponentIndex());
+	}
+	Entry* entries = back.mSorted.data();
+
+	// Split off the few bodies that would blow the sweep window wide open for everyone else. The 90th percentile on the
+	// strip axis also sizes the strips.
+	float huge_width = FLT_MAX, huge_strip_width = FLT_MAX, usual_strip_width = 0;
+	if (count >= cMinBodiesForHugeSplit)
+	{
+		Array<float>& widths = back.mKeys; // scratch until we write the keys
+		widths.resize(count);
+		float* percentile = widths.data() + (count * 9) / 10;
+		for (uint32 i = 0; i < count; ++i)
+			widths[i] = entries[i].mMax[int(axis)] - entries[i].mMin[int(axis)];
+		std::nth_element(widths.data(), percentile, widths.data() + count);
+		huge_width = cHugeWidthFactor * *percentile;
+		for (uint32 i = 0; i < count; ++i)
+			widths[i] = entries[i].mMax[int(strip_axis)] - entries[i].mMin[int(strip_axis)];
+		std::nth_element(widths.data(), percentile, widths.data() + count);
+		usual_strip_width = *percentile;
+		huge_strip_width = cHugeWidthFactor * usual_strip_width;
+	}
+
+	uint32 num_sorted = 0, num_in_order = 0;
+	float max_width = 0, max_strip_width = 0;
+	float strip_min = FLT_MAX, strip_max = -FLT_MAX;
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const Entry entry = entries[i];
+		const float width = entry.mMax[int(axis)] - entry.mMin[int(axis)];
+		const float strip_width = entry.mMax[int(strip_axis)] - entry.mMin[int(strip_axis)];
+		if (width > huge_width || strip_width > huge_strip_width)
+		{
+			tracking[BodyID(entry.mBodyID).GetIndex()].mBodyLocation.store(cHugeBit | uint32(back.mHuge.size()), memory_order_relaxed);
+			back.mHuge.push_back(entry);
+		}
+		else
+		{
+			// Keeps the order, so the insertion sort below still gets last tick's
+			if (i < num_previously_sorted)
+				++num_in_order;
+			entries[num_sorted++] = entry;
+			max_width = max(max_width, width);
+			max_strip_width = max(max_strip_width, strip_width);
+			strip_min = min(strip_min, entry.mMin[int(strip_axis)]);
+			strip_max = max(strip_max, entry.mMin[int(strip_axis)]);
+		}
+	}
+	back.mSorted.resize(num_sorted);
+
+	// Strips are a power of two wide and sit on multiples of their width, so a body only changes strip when it crosses a
+	// line, not whenever the world's extent twitches. That's what keeps the insertion sort cheap.
+	float strip_size = FLT_MAX;
+	uint32 num_strips = 1;
+	if (num_sorted > 0 && strip_max > strip_min)
+	{
+		const uint32 max_strips = max(1u, min(cMaxStrips, num_sorted / cMinEntriesPerStrip));
+		const float wanted = max((strip_max - strip_min) / float(max_strips), cStripWidthFactor * usual_strip_width);
+		if (wanted > 0.0f)
+		{
+			int exponent;
+			std::frexp(wanted, &exponent);
+			strip_size = std::ldexp(1.0f, exponent);
+			num_strips = min(cMaxStrips, uint32((strip_max - std::floor(strip_min / strip_size) * strip_size) / strip_size) + 1);
+		}
+	}
+	back.mStripAxis = strip_axis;
+	back.mStripSize = strip_size;
+	back.mStripOrigin = num_strips > 1? std::floor(strip_min / strip_size) * strip_size : 0.0f;
+	for (uint32 i = 0; i < num_sorted; ++i)
+	{
+		const float strip = (entries[i].mMin[int(strip_axis)] - back.mStripOrigin) / strip_size;
+		entries[i].mStrip = uint16(strip <= 0.0f? 0u : min(num_strips - 1, uint32(strip)));
+	}
+
+	// Last tick's order is nearly right for everything that was already sorted the same way. The rest is new or was huge.
+	auto less = [axis](const Entry& inLHS, const Entry& inRHS) { return inLHS.mStrip < inRHS.mStrip || (inLHS.mStrip == inRHS.mStrip && inLHS.mMin[int(axis)] < inRHS.mMin[int(axis)]); };
+	if (axis == front.mAxis && strip_axis == front.mStripAxis && strip_size == front.mStripSize
+		&& sInsertionSort(entries, num_in_order, less, cInsertionSortBudget * num_in_order))
+	{
+		QuickSort(entries + num_in_order, entries + num_sorted, less);
+		std::inplace_merge(entries, entries + num_in_order, entries + num_sorted, less);
+	}
+	else
+	{
+		QuickSort(entries, entries + num_sorted, less);
+	}
+
+	back.mKeys.resize(num_sorted);
+	back.mStripStarts.resize(num_strips + 1);
+	uint32 strip = 0;
+	for (uint32 i = 0; i < num_sorted; ++i)
+	{
+		const Entry& entry = entries[i];
+		while (strip <= entry.mStrip)
+			back.mStripStarts[strip++] = i;
+		back.mKeys[i] = entry.mMin[int(axis)];
+		tracking[BodyID(entry.mBodyID).GetIndex()].mBodyLocation.store(i, memory_order_relaxed);
+	}
+	while (strip <= num_strips)
+		back.mStripStarts[strip++] = num_sorted;
+	for (uint32 h = 0; h < uint32(back.mHuge.size()); ++h)
+		tracking[BodyID(back.mHuge[h].mBodyID).GetIndex()].mBodyLocation.store(cHugeBit | h, memory_order_relaxed);
+
+	back.mAxis = axis;
+	back.mMaxWidth.store(max_width, memory_order_relaxed);
+	back.mMaxStripWidth.store(max_strip_width, memory_order_relaxed);
+	back.mSlack.store(0, memory_order_relaxed);
+}
+
+void PaddingtonTree::UpdateFinalize()
+{
+	// Queries from here on use the new buffer, the old one stays as it was until DiscardOldTree
+	mCurrent.store(mCurrent.load(memory_order_relaxed) ^ 1, memory_order_release);
+	mOldBufferHeld = true;
+	mIsDirty = false;
+}
+
+void PaddingtonTree::DiscardOldTree()
+{
+	// Nothing to free, the buffer gets reused by the next UpdatePrepare
+	mOldBufferHeld = false;
+}
+
+void PaddingtonTree::AddBodiesPrepare(const BodyVector& inBodies, TrackingVector& ioTracking, BodyID* ioBodyIDs, int inNumber,
+                                      AddState& outState)
+{
+	JPH_PROFILE_FUNCTION();
+
+	// Nobody looks at these until AddBodiesFinalize publishes the body id
+	for (const BodyID* b = ioBodyIDs, *b_end = ioBodyIDs + inNumber; b < b_end; ++b)
+	{
+		const AABox& bounds = inBodies[b->GetIndex()]->GetWorldSpaceBounds();
+		ioTracking[b->GetIndex()].SetBounds(bounds);
+	}
+	outState.mBodyStart = ioBodyIDs;
+}
+
+void PaddingtonTree::AddBodiesFinalize(TrackingVector& ioTracking, int inNumberBodies, const AddState& inState)
+{
+	JPH_PROFILE_FUNCTION();
+
+	Buffer& buffer = GetCurrent();
+	const uint32 first = buffer.mNumPending.fetch_add(uint32(inNumberBodies), memory_order_relaxed);
+
+	// A body can only be pending once per rebuild unless it's being added and removed over and over without the world
+	// stepping, and every step rebuilds a dirty tree. So this holds unless someone is doing something very strange.
+	JPH_ASSERT(first + uint32(inNumberBodies) <= mMaxBodies, "Paddington pending list overflowed, step the world");
+
+	for (int i = 0; i < inNumberBodies; ++i)
+	{
+		const BodyID body_id = inState.mBodyStart[i];
+		Tracking& t = ioTracking[body_id.GetIndex()];
+		const uint32 slot = first + uint32(i);
+		if (slot < mMaxBodies)
+		{
+			t.mBodyLocation.store(cPendingBit | slot, memory_order_relaxed);
+			buffer.mPending[slot].store(body_id.GetIndexAndSequenceNumber(), memory_order_release);
+		}
+
+		// Goes last, this is what makes the body visible to queries
+		t.mBodyID.store(body_id.GetIndexAndSequenceNumber(), memory_order_release);
+	}
+
+	mNumBodies.fetch_add(uint32(inNumberBodies), memory_order_relaxed);
+	mIsDirty = true;
+}
+
+void PaddingtonTree::AddBodiesAbort(TrackingVector& ioTracking, const AddState& inState)
+{
+	// Prepare only wrote bounds, and nobody reads those until the body id is set
+}
+
+void PaddingtonTree::RemoveBodies(TrackingVector& ioTracking, const BodyID* ioBodyIDs, int inNumber)
+{
+	JPH_PROFILE_FUNCTION();
+
+	Buffer& buffer = GetCurrent();
+	for (const BodyID* b = ioBodyIDs, *b_end = ioBodyIDs + inNumber; b < b_end; ++b)
+	{
+		Tracking& t = ioTracking[b->GetIndex()];
+
+		// Held open buffers and in-flight queries stop seeing it here
+		t.mBodyID.store(BodyID::cInvalidBodyID, memory_order_release);
+
+		// And we kill the entry where it sits, so re-adding the same id before the next rebuild can't show up twice
+		const uint32 location = t.mBodyLocation.load(memory_order_relaxed);
+		if (location != Tracking::cInvalidBodyLocation)
+		{
+			const uint32 slot = location & cSlotMask;
+			if (location & cPendingBit)
+				buffer.mPending[slot].store(BodyID::cInvalidBodyID, memory_order_relaxed);
+			else if (location & cHugeBit)
+				buffer.mHuge[slot].mBodyID = BodyID::cInvalidBodyID;
+			else
+				buffer.mSorted[slot].mBodyID = BodyID::cInvalidBodyID;
+		}
+		t.mBodyLocation.store(Tracking::cInvalidBodyLocation, memory_order_relaxed);
+	}
+
+	mNumBodies.fetch_sub(uint32(inNumber), memory_order_relaxed);
+	mIsDirty = true;
+}
+
+void PaddingtonTree::NotifyBodiesAABBChanged(const BodyVector& inBodies, TrackingVector& ioTracking, const BodyID* ioBodyIDs,
+                                             int inNumber)
+{
+	JPH_PROFILE_FUNCTION();
+
+	Buffer& buffer = GetCurrent();
+	const int axis = int(buffer.mAxis);
+	const int strip_axis = int(buffer.mStripAxis);
+	bool moved_entry = false;
+	for (const BodyID* b = ioBodyIDs, *b_end = ioBodyIDs + inNumber; b < b_end; ++b)
+	{
+		const AABox& bounds = inBodies[b->GetIndex()]->GetWorldSpaceBounds();
+		Tracking& t = ioTracking[b->GetIndex()];
+		t.SetBounds(bounds);
+
+		// Pending bodies have no entry, they get tested against the tracked bounds directly
+		const uint32 location = t.mBodyLocation.load(memory_order_relaxed);
+		if (location == Tracking::cInvalidBodyLocation || (location & cPendingBit))
+			continue;
+
+		Entry& entry = (location & cHugeBit) ? buffer.mHuge[location & cSlotMask] : buffer.mSorted[location];
+		const AABox old_box(Vec3(entry.mMin.Load()), Vec3(entry.mMax.Load()));
+		if (old_box.Contains(bounds))
+			continue;
+
+		// Queries are reading this entry while we write it, a component at a time. So the box only ever grows here: any
+		// mix of old and new components a query picks up still holds the old box, which is what it would have seen a
+		// moment earlier anyway. The next rebuild shrinks it back down.
+		Entry padded = entry;
+		sPad(bounds.mMin, bounds.mMax, padded);
+		padded.mMin.Store(Vec3::sMin(Vec3(padded.mMin.Load()), old_box.mMin));
+		padded.mMax.Store(Vec3::sMax(Vec3(padded.mMax.Load()), old_box.mMax));
+		if ((location & cHugeBit) == 0)
+		{
+			// Widen the window before moving the entry, so a sweep never finds the entry outside it. The last strip runs
+			// on forever, the first one doesn't, nothing was sorted below it.
+			const float strip_min = buffer.mStripOrigin + float(entry.mStrip) * buffer.mStripSize;
+			const float strip_drift = padded.mMin[strip_axis] < strip_min? strip_min - padded.mMin[strip_axis]
+				: (entry.mStrip + 2u < uint32(buffer.mStripStarts.size())? max(0.0f, padded.mMin[strip_axis] - (strip_min + buffer.mStripSize)) : 0.0f);
+			sAtomicMax(buffer.mMaxWidth, padded.mMax[axis] - padded.mMin[axis]);
+			sAtomicMax(buffer.mMaxStripWidth, padded.mMax[strip_axis] - padded.mMin[strip_axis]);
+			sAtomicMax(buffer.mSlack, max(abs(padded.mMin[axis] - buffer.mKeys[location]), strip_drift));
+		}
+		entry.mMin = padded.mMin;
+		entry.mMax = padded.mMax;
+		moved_entry = true;
+	}
+
+	// Slack only ever grows until a rebuild, so get one scheduled
+	if (moved_entry)
+		mIsDirty = true;
+}
+
+void PaddingtonTree::CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector, const ObjectLayerFilter& inObjectLayerFilter,
+                             const TrackingVector& inTracking) const
+{
+	const Vec3 origin(inRay.mOrigin);
+	const RayInvDirection inv_direction(inRay.mDirection);
+	AABox bounds(origin, origin);
+	bounds.Encapsulate(origin + inRay.mDirection);
+
+	Sweep(bounds, inTracking, nullptr, [&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox& inBodyBounds)
+	{
+		if (inObjectLayer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(inObjectLayer))
+		{
+			const float fraction = RayAABox(origin, inv_direction, inBodyBounds.mMin, inBodyBounds.mMax);
+			if (fraction < ioCollector.GetEarlyOutFraction())
+			{
+				BroadPhaseCastResult result { inBodyID, fraction };
+				ioCollector.AddHit(result);
+			}
+		}
+		return !ioCollector.ShouldEarlyOut();
+	});
+}
+
+void PaddingtonTree::CollideAABox(const AABox& inBox, CollideShapeBodyCollector& ioCollector, const ObjectLayerFilter& inObjectLayerFilter,
+                                  const TrackingVector& inTracking) const
+{
+	// Sweep already did the overlap test against the tracked bounds
+	Sweep(inBox, inTracking, nullptr, [&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox&)
+	{
+		if (inObjectLayer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(inObjectLayer))
+			ioCollector.AddHit(inBodyID);
+		return !ioCollector.ShouldEarlyOut();
+	});
+}
+
+void PaddingtonTree::CollideSphere(Vec3Arg inCenter, float inRadius, CollideShapeBodyCollector& ioCollector,
+                                   const ObjectLayerFilter& inObjectLayerFilter, const TrackingVector& inTracking) const
+{
+	const float radius_sq = Square(inRadius);
+	const AABox bounds(inCenter - Vec3::sReplicate(inRadius), inCenter + Vec3::sReplicate(inRadius));
+
+	Sweep(bounds, inTracking, nullptr, [&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox& inBodyBounds)
+	{
+		if (inObjectLayer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(inObjectLayer)
+			&& inBodyBounds.GetSqDistanceTo(inCenter) <= radius_sq)
+			ioCollector.AddHit(inBodyID);
+		return !ioCollector.ShouldEarlyOut();
+	});
+}
+
+void PaddingtonTree::CollidePoint(Vec3Arg inPoint, CollideShapeBodyCollector& ioCollector, const ObjectLayerFilter& inObjectLayerFilter,
+                                  const TrackingVector& inTracking) const
+{
+	// A point box overlapping the body's box is the body containing the point
+	Sweep(AABox(inPoint, inPoint), inTracking, nullptr, [&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox&)
+	{
+		if (inObjectLayer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(inObjectLayer))
+			ioCollector.AddHit(inBodyID);
+		return !ioCollector.ShouldEarlyOut();
+	});
+}
+
+void PaddingtonTree::CollideOrientedBox(const OrientedBox& inBox, CollideShapeBodyCollector& ioCollector,
+                                        const ObjectLayerFilter& inObjectLayerFilter, const TrackingVector& inTracking) const
+{
+	const AABox bounds = AABox(-inBox.mHalfExtents, inBox.mHalfExtents).Transformed(inBox.mOrientation);
+
+	Sweep(bounds, inTracking, nullptr, [&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox& inBodyBounds)
+	{
+		if (inObjectLayer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(inObjectLayer)
+			&& inBox.Overlaps(inBodyBounds))
+			ioCollector.AddHit(inBodyID);
+		return !ioCollector.ShouldEarlyOut();
+	});
+}
+
+void PaddingtonTree::CastAABox(const AABoxCast& inBox, CastShapeBodyCollector& ioCollector, const ObjectLayerFilter& inObjectLayerFilter,
+                               const TrackingVector& inTracking) const
+{
+	const Vec3 origin = inBox.mBox.GetCenter();
+	const Vec3 extent = inBox.mBox.GetExtent();
+	const RayInvDirection inv_direction(inBox.mDirection);
+	AABox bounds = inBox.mBox;
+	bounds.Encapsulate(inBox.mBox.mMin + inBox.mDirection);
+	bounds.Encapsulate(inBox.mBox.mMax + inBox.mDirection);
+
+	Sweep(bounds, inTracking, nullptr, [&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox& inBodyBounds)
+	{
+		if (inObjectLayer != cObjectLayerInvalid && inObjectLayerFilter.ShouldCollide(inObjectLayer))
+		{
+			// Same as the quadtree, cast the center against the body's box grown by our extent
+			const float fraction = RayAABox(origin, inv_direction, inBodyBounds.mMin - extent, inBodyBounds.mMax + extent);
+			if (fraction < ioCollector.GetPositiveEarlyOutFraction())
+			{
+				BroadPhaseCastResult result { inBodyID, fraction };
+				ioCollector.AddHit(result);
+			}
+		}
+		return !ioCollector.ShouldEarlyOut();
+	});
+}
+
+void PaddingtonTree::FindCollidingPairs(const BodyVector& inBodies, const TrackingVector& inTracking, const BodyID* inActiveBodies,
+                                        int inNumActiveBodies, float inSpeculativeContactDistance, BodyPairCollector& ioPairCollector,
+                                        const ObjectLayerPairFilter& inObjectLayerPairFilter) const
+{
+	JPH_PROFILE_FUNCTION();
+
+	// Note that we don't lock anything at this point. UpdateFinalize can't swap the buffers until the pair jobs are done,
+	// and nothing adds, removes or moves bodies in the middle of a step, see PhysicsSystem::Update.
+
+	// Assert sane input
+	JPH_ASSERT(inActiveBodies != nullptr);
+	JPH_ASSERT(inNumActiveBodies > 0);
+
+	// When a swarm spawns, every active body would otherwise brute force every new bullet. Sort them once instead.
+	const Buffer& buffer = GetCurrent();
+	Array<Entry> sorted_pending;
+	const uint32 num_pending = min(buffer.mNumPending.load(memory_order_acquire), mMaxBodies);
+	if (num_pending > cSortPendingThreshold)
+	{
+		sorted_pending.reserve(num_pending);
+		for (uint32 p = 0; p < num_pending; ++p)
+		{
+			const uint32 body_id = buffer.mPending[p].load(memory_order_acquire);
+			if (IsLive(body_id, inTracking))
+			{
+				const Tracking& t = inTracking[BodyID(body_id).GetIndex()];
+				Float3 bounds_min, bounds_max;
+				t.GetBounds(bounds_min, bounds_max);
+				sorted_pending.push_back({ bounds_min, bounds_max, body_id, t.mObjectLayer.load(memory_order_relaxed), 0 });
+			}
+		}
+		const int axis = int(buffer.mAxis);
+		QuickSort(sorted_pending.data(), sorted_pending.data() + sorted_pending.size(), [axis](const Entry& inLHS, const Entry& inRHS) { return inLHS.mMin[axis] < inRHS.mMin[axis]; });
+	}
+
+	for (int b1 = 0; b1 < inNumActiveBodies; ++b1)
+	{
+		const BodyID b1_id = inActiveBodies[b1];
+		const Body& body1 = *inBodies[b1_id.GetIndex()];
+		JPH_ASSERT(!body1.IsStatic());
+
+		// Expand the bounding box by the speculative contact distance
+		AABox bounds1 = body1.GetWorldSpaceBounds();
+		bounds1.ExpandBy(Vec3::sReplicate(inSpeculativeContactDistance));
+		const ObjectLayer layer1 = body1.GetObjectLayer();
+
+		Sweep(bounds1, inTracking, num_pending > cSortPendingThreshold ? &sorted_pending : nullptr,
+			[&](const BodyID& inBodyID, ObjectLayer inObjectLayer, const AABox&)
+			{
+				// Don't collide with self. Same checks as the quadtree otherwise, so the two agree on every pair. Sweep already
+				// tested the tracked bounds, which are the body's bounds, so we only touch body2 when the layers say go.
+				if (inBodyID != b1_id
+					&& inObjectLayerPairFilter.ShouldCollide(layer1, inObjectLayer)
+					&& Body::sFindCollidingPairsCanCollide(body1, *inBodies[inBodyID.GetIndex()]))
+				{
+					ioPairCollector.AddHit({ b1_id, inBodyID });
+				}
+				return true;
+			});
+	}
+}
+
+JPH_NAMESPACE_END
@@ -2,7 +2,7 @@
 
 using namespace JOLT;
 
-JPH::BodyID FBCharacter::Create(JPH::CharacterVsCharacterCollision* CVCColliderSystem)
+JPH::BodyID FBCharacter::Create(JPH::CharacterVsCharacterCollision* CVCColliderSystem, FBarrageCharacterShapes& ShapeRegistry)
 {
 	JPH::BodyID ret = BodyID();
 	// Create capsule
@@ -13,20 +13,17 @@ JPH::BodyID FBCharacter::Create(JPH::CharacterVsCharacterCollision* CVCColliderS
 		{
 			mGravity = Vec3(0, -9.80, 0);
 			mCharacterSettings.mMass = 1000;
-			Ref<Shape> capsule = new CapsuleShape(0.5f * mHeightStanding, mRadiusStanding);
-			Ref<Shape> capsuleB = new CapsuleShape(0.5f * mHeightStanding, mRadiusStanding);
+			const FBarrageCharacterShapes::FShapes Shapes = ShapeRegistry.Get(mHeightStanding, mRadiusStanding);
 			mCharacterSettings.mEnhancedInternalEdgeRemoval = true;
-			mCharacterSettings.mShape = RotatedTranslatedShapeSettings(
-				Vec3(0, 0.5f * mHeightStanding + mRadiusStanding, 0), Quat::sIdentity(), capsule).Create().Get();
+			mCharacterSettings.mShape = Shapes.Outer;
 			// Configure supporting volume
 			mCharacterSettings.mSupportingVolume = Plane(Vec3::sAxisY(), -mHeightStanding);
 			mForcesUpdate = Vec3::sZero();
 			mCharacterSettings.mInnerBodyLayer = Layers::EJoltPhysicsLayer::MOVING;
-			auto SettingsForInnerShape = RotatedTranslatedShapeSettings(
-				Vec3(0, 0.5f * mHeightStanding + mRadiusStanding, 0), Quat::sIdentity(), capsuleB);
 			// Accept contacts that touch the lower sphere of the capsule
 			// If you want to create character WITH innerbodyshape - don't try to reduce, reuse, or recycle here.
-			InnerStandingShape =  SettingsForInnerShape.Create().Get();
+			// (the inner shape is shared with other characters' inner bodies, but never with the outer shape.)
+			InnerStandingShape = Shapes.Inner;
 			//TODO: set up mInnerBodyIDOverride once we get to full determinism. all other shapes are ordered using queuing.
 			mCharacterSettings.mInnerBodyShape = InnerStandingShape;
 			mCharacter = new CharacterVirtual(&mCharacterSettings, mInitialPosition, Quat::sIdentity(), 0, World.Get());
@@ -40,7 +37,7 @@ JPH::BodyID FBCharacter::Create(JPH::CharacterVsCharacterCollision* CVCColliderS
 	return ret;
 }
 
-void FBCharacter::StepCharacter()
+void FBCharacter::StepCharacter(JPH::TempAllocator& Allocator)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FBCharacter::StepCharacter)
 	
@@ -105,7 +102,6 @@ void FBCharacter::StepCharacter()
 	// Update the character position. splitting this into two half-length updates allows you to get VERY
 	// fine grained control by moving them around with respect to the clamp and update.
     {
-    	TempAllocatorMalloc allocator;
     	mCharacter->ExtendedUpdate(mDeltaTime,
     							   mGravity,
     							   mUpdateSettings,
@@ -113,7 +109,7 @@ void FBCharacter::StepCharacter()
     							   World->GetDefaultLayerFilter(Layers::MOVING),
     							   IgnoreSingleBodyFilter(mCharacter->GetInnerBodyID()),
     							   {},
-    							   allocator);
+    							   Allocator);
     }
 
 	// Update character velocity for carry over.
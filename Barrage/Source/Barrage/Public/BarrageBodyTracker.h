@@ -0,0 +1,63 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+#include "Containers/Queue.h"
+
+//Arena levels are mostly bodies that aren't doing anything: static props that never move, and debris that has settled
+//and gone to sleep. The post-step passes used to walk every body in the world to find the few that moved.
+//
+//Jolt already knows which bodies are awake, and tells its activation listener whenever that changes. So we keep the
+//awake set ourselves, from those callbacks, and after each step hand out Moved: every body that is awake now, plus
+//every body that fell asleep during the step, since its last bit of motion still needs to go out. Static bodies never
+//wake, so they never show up. Characters are virtual and have no body that sleeps, so they don't either, and the
+//post-step passes have to visit them separately.
+//
+//The callbacks come from inside jolt, often from its jobs, so they only queue. Update folds them in and belongs to the
+//stepping thread, right after the step. Moved is sorted by body index, so the passes that walk it stay deterministic.
+class BARRAGE_API FBarrageBodyTracker : public JPH::BodyActivationListener
+{
+public:
+	virtual void OnBodyActivated(const JPH::BodyID& inBodyID, uint64 inBodyUserData) override;
+	virtual void OnBodyDeactivated(const JPH::BodyID& inBodyID, uint64 inBodyUserData) override;
+
+	void Update();
+	//good until the next Update.
+	TConstArrayView<JPH::BodyID> Moved() const
+	{
+		return MovedBodies;
+	}
+	//whether Body was in Moved as of the last Update.
+	bool HasMoved(const JPH::BodyID& Body) const
+	{
+		const uint32 Index = Body.GetIndex();
+		return MovedStamp.IsValidIndex(Index) && MovedStamp[Index] == Stamp && MovedIDs[Index] == Body;
+	}
+	int32 NumAwake() const
+	{
+		return Awake.Num();
+	}
+	void Reset();
+
+private:
+	struct FActivation
+	{
+		JPH::BodyID Body;
+		bool bAwake = false;
+	};
+
+	void Grow(uint32 Index);
+
+	TQueue<FActivation, EQueueMode::Mpsc> Pending;
+	//dense, so the post-step walk is a walk over an array, with each body's slot in it kept by index for the removes.
+	TArray<JPH::BodyID> Awake;
+	TArray<int32> AwakeSlot;
+	TArray<JPH::BodyID> FellAsleep;
+	TArray<JPH::BodyID> MovedBodies;
+	//by body index. a body is in Moved if its stamp is this Update's, and its id still matches.
+	TArray<uint32> MovedStamp;
+	TArray<JPH::BodyID> MovedIDs;
+	uint32 Stamp = 0;
+};
@@ -0,0 +1,102 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+#include "Containers/Queue.h"
+
+class FBCharacterBase;
+
+//Character vs character collision backed by a uniform spatial hash instead of Jolt's brute force list.
+//CharacterVsCharacterCollisionSimple checks every character against every other one, which is fine for three players
+//and quadratic for a horde of enemy characters.
+//
+//Rebuild buckets every registered character by its world bounds, once per tick, before the characters step. Queries
+//only narrowphase against characters that share a cell with the query bounds, then run exactly the same checks the
+//simple version does, in registration order, so results match it. Characters keep moving after the rebuild, so each
+//one is bucketed with some Slack around it. Anything that moves farther than that in one tick can get missed by a
+//neighbour for that tick, so keep Slack above your fastest character's per-tick travel.
+//
+//Add is safe from any thread, and takes effect at the next Rebuild. Remove and Rebuild belong to the stepping thread.
+//CollideCharacter and CastCharacter only read, and are safe to call from several characters at once between rebuilds.
+//they never touch the other characters themselves, only the poses Rebuild copied out of them. characters in other
+//islands are moving on other jobs while a character steps, so reading them live would be a race.
+class BARRAGE_API FBarrageCharacterGrid : public JPH::CharacterVsCharacterCollision
+{
+public:
+	//in jolt units. cells grow to fit the biggest character, so this is a floor.
+	float CellSize = 2.0f;
+	float Slack = 0.5f;
+
+	//the owner is only carried along so whoever steps characters can get back to them from an island.
+	void Add(JPH::CharacterVirtual* Character, FBCharacterBase* Owner = nullptr);
+	void Remove(const JPH::CharacterVirtual* Character);
+	void Rebuild();
+	//re-copies every character's pose without rebucketing. call it once the characters are done stepping, so anything
+	//that queries before the next Rebuild sees where they ended up rather than where they started.
+	void RefreshPoses();
+	void Reset();
+	int32 Num() const
+	{
+		return Characters.Num();
+	}
+	FBCharacterBase* GetOwner(int32 Index) const
+	{
+		return Owners[Index];
+	}
+
+	//groups characters that might touch this tick, as of the last Rebuild. Order holds character indices island by
+	//island, and island i is Order[Starts[i]] up to Order[Starts[i + 1]]. islands are ordered by their lowest index
+	//and members ascend, so the result only depends on registration order and positions. characters in different
+	//islands are farther apart than twice Slack (plus padding), so they can be stepped at the same time.
+	void BuildIslands(TArray<int32>& Order, TArray<int32>& Starts) const;
+
+	virtual void CollideCharacter(const JPH::CharacterVirtual* inCharacter, JPH::RMat44Arg inCenterOfMassTransform,
+	                              const JPH::CollideShapeSettings& inCollideShapeSettings, JPH::RVec3Arg inBaseOffset,
+	                              JPH::CollideShapeCollector& ioCollector) const override;
+	virtual void CastCharacter(const JPH::CharacterVirtual* inCharacter, JPH::RMat44Arg inCenterOfMassTransform,
+	                           JPH::Vec3Arg inDirection, const JPH::ShapeCastSettings& inShapeCastSettings,
+	                           JPH::RVec3Arg inBaseOffset, JPH::CastShapeCollector& ioCollector) const override;
+
+private:
+	//what a query needs from another character, copied out at Rebuild.
+	struct FPose
+	{
+		JPH::RMat44 CenterOfMass;
+		JPH::RefConst<JPH::Shape> Shape;
+		float Padding = 0;
+	};
+
+	using FCandidates = TArray<int32, TInlineAllocator<64>>;
+	//indices into Characters that share a cell with Query, sorted and unique. every character if the grid is stale.
+	void Gather(const JPH::AABox& Query, FCandidates& Out) const;
+	uint64 CellKey(int32 X, int32 Y, int32 Z) const
+	{
+		//21 bits an axis. at 2m cells that's +-2000km before anything wraps, and a wrap only costs a false candidate.
+		constexpr uint64 Mask = (1 << 21) - 1;
+		return (static_cast<uint64>(X) & Mask) | ((static_cast<uint64>(Y) & Mask) << 21) | ((static_cast<uint64>(Z) & Mask) << 42);
+	}
+	FIntVector ToCell(JPH::Vec3Arg Point) const
+	{
+		return FIntVector(FMath::FloorToInt32(Point.GetX() * InverseCellSize),
+		                  FMath::FloorToInt32(Point.GetY() * InverseCellSize),
+		                  FMath::FloorToInt32(Point.GetZ() * InverseCellSize));
+	}
+
+	void TakePending();
+
+	TQueue<TPair<JPH::CharacterVirtual*, FBCharacterBase*>, EQueueMode::Mpsc> Pending;
+	TArray<JPH::CharacterVirtual*> Characters;
+	TArray<FBCharacterBase*> Owners;
+	TArray<FPose> Poses;
+	//padded bounds from the last Rebuild, by character index.
+	TArray<JPH::AABox> Bounds;
+	//cell key to a run in CellMembers.
+	TMap<uint64, TPair<int32, int32>> Cells;
+	TArray<int32> CellMembers;
+	float InverseCellSize = 0.5f;
+	float MaxPadding = 0;
+	//characters added or removed since the last rebuild make the cells lie, so queries fall back to everything.
+	bool bStale = true;
+};
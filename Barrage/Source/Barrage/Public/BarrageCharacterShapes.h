@@ -0,0 +1,46 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+
+//Characters used to build two capsules and two rotated-translated wrappers apiece, even though a wave of a hundred
+//enemies is usually one or two sizes. This hands out one set of shapes per (standing height, radius), shared by every
+//character that size. Jolt shapes are refcounted and immutable once built, so sharing between bodies is fine.
+//
+//Outer and inner are still two separate shapes. Create has warned against reusing the outer shape for the inner body
+//for a long time, and we're not going to find out why the hard way.
+//
+//Get and Prewarm are safe from any thread. Prewarm the sizes you know about at load, and spawns never allocate shapes.
+class BARRAGE_API FBarrageCharacterShapes
+{
+public:
+	struct FShapes
+	{
+		//for the CharacterVirtual itself.
+		JPH::Ref<JPH::Shape> Outer;
+		//for its inner body.
+		JPH::Ref<JPH::Shape> Inner;
+	};
+
+	//jolt units. builds the pair if this size hasn't been seen yet.
+	FShapes Get(float HeightStanding, float RadiusStanding);
+	void Prewarm(float HeightStanding, float RadiusStanding)
+	{
+		Get(HeightStanding, RadiusStanding);
+	}
+	int32 Num() const;
+	void Reset();
+
+private:
+	//tenth of a millimeter. anything closer than that is the same character as far as anyone can tell.
+	static uint64 Key(float HeightStanding, float RadiusStanding)
+	{
+		return (static_cast<uint64>(static_cast<uint32>(FMath::RoundToInt32(HeightStanding * 10000.f))) << 32)
+			| static_cast<uint32>(FMath::RoundToInt32(RadiusStanding * 10000.f));
+	}
+
+	mutable FCriticalSection Lock;
+	TMap<uint64, FShapes> Shapes;
+};
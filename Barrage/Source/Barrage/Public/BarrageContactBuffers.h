@@ -0,0 +1,123 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BarrageContactEvent.h"
+#include "FBarrageKey.h"
+
+//What the listener writes down from inside the solver: body ids, layers, a point. no key lookups, no shared queue.
+struct FBarrageRawContact
+{
+	uint32 Body1 = JPH::BodyID::cInvalidBodyID;
+	uint32 Body2 = JPH::BodyID::cInvalidBodyID;
+	FVector3f Point = FVector3f::ZeroVector;
+	Layers::EJoltPhysicsLayer Layer1 = Layers::NUM_LAYERS;
+	Layers::EJoltPhysicsLayer Layer2 = Layers::NUM_LAYERS;
+	EBarrageContactEventType Type = EBarrageContactEventType::GHOST;
+};
+
+//One layer pair's worth of a batch. Layer1 <= Layer2, and every event in here has ContactEntity1 on Layer1.
+struct FBarrageContactPartition
+{
+	Layers::EJoltPhysicsLayer Layer1 = Layers::NUM_LAYERS;
+	Layers::EJoltPhysicsLayer Layer2 = Layers::NUM_LAYERS;
+	TConstArrayView<BarrageContactEvent> Events;
+};
+
+//Everything of one event type from one step, for consumers that would rather loop over hits than take a delegate call
+//apiece. Events are copies, reordered so ContactEntity1 is always the lower layer (the lower key when the layers match),
+//grouped by layer pair, and sorted by ContactEntity1's key, then ContactEntity2's, inside each group.
+//
+//Views are only good for the duration of the broadcast. Batches are built once per step and never retried.
+struct FBarrageContactBatch
+{
+	EBarrageContactEventType Type = EBarrageContactEventType::GHOST;
+	TConstArrayView<BarrageContactEvent> Events;
+	TConstArrayView<FBarrageContactPartition> Partitions;
+
+	//order of the arguments doesn't matter. empty if nothing touched on that pair this step.
+	TConstArrayView<BarrageContactEvent> Between(Layers::EJoltPhysicsLayer A, Layers::EJoltPhysicsLayer B) const
+	{
+		const Layers::EJoltPhysicsLayer Low = FMath::Min(A, B);
+		const Layers::EJoltPhysicsLayer High = FMath::Max(A, B);
+		for (const FBarrageContactPartition& Partition : Partitions)
+		{
+			if (Partition.Layer1 == Low && Partition.Layer2 == High)
+			{
+				return Partition.Events;
+			}
+		}
+		return {};
+	}
+
+	bool IsEmpty() const
+	{
+		return Events.IsEmpty();
+	}
+};
+
+//Contact callbacks come from Jolt's job threads in the middle of PhysicsSystem::Update. They used to all push into one
+//8192 deep circular queue, which meant every core in the solver fought over the same cache lines, and a big enough
+//burst just dropped events on the floor without a word.
+//
+//Now each Jolt worker appends to its own lane, indexed by MyWORKERIndex, and anything else (the stepping thread when it
+//helps out with jobs, character updates) shares one lane behind a lock that's basically never contested. After the step,
+//Merge gathers the lanes, sorts them into an order that doesn't depend on thread timing, drops duplicate pairs,
+//and resolves keys for the whole batch. Nothing has a fixed cap.
+//
+//Record is safe from any thread while the world steps. Merge, Ready, and MarkDelivered belong to the stepping thread,
+//and must not overlap a step.
+class BARRAGE_API FBarrageContactBuffers
+{
+public:
+	//must match ALLOWED_THREADS_FOR_BARRAGE_PHYSICS. checked in BarrageDispatch.cpp.
+	static constexpr int32 WorkerLanes = 64;
+
+	void Record(int32 WorkerIndex, const FBarrageRawContact& Contact);
+	//for events that already know their keys, like projectile sweep hits. stepping thread only, between steps. these
+	//skip the sort and the pair dedup, and go out after this step's solver contacts, in the order they were recorded.
+	void RecordResolved(const BarrageContactEvent& Event)
+	{
+		Resolved.Add(Event);
+	}
+	//appends this step's contacts to whatever hasn't been delivered yet.
+	void Merge(TFunctionRef<FBarrageKey(uint32)> ToBarrageKey);
+	TConstArrayView<BarrageContactEvent> Ready() const
+	{
+		return TConstArrayView<BarrageContactEvent>(Merged).RightChop(Delivered);
+	}
+	void MarkDelivered(int32 Count)
+	{
+		Delivered += Count;
+	}
+	bool IsEmpty() const
+	{
+		return Delivered >= Merged.Num();
+	}
+	//the newest Merge's contacts of this type, batched. empty for GHOST.
+	FBarrageContactBatch Batch(EBarrageContactEventType Type) const;
+	void Reset();
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FLane
+	{
+		TArray<FBarrageRawContact> Contacts;
+	};
+
+	FLane Lanes[WorkerLanes];
+	FLane SharedLane;
+	FCriticalSection SharedLaneLock;
+
+	TArray<FBarrageRawContact> Gathered;
+	TArray<BarrageContactEvent> Resolved;
+	TArray<BarrageContactEvent> Merged;
+	int32 Delivered = 0;
+
+	void BuildBatches(int32 FirstNew);
+	static constexpr int32 BatchedTypes = static_cast<int32>(EBarrageContactEventType::GHOST);
+	TArray<BarrageContactEvent> Batched;
+	TArray<FBarrageContactPartition> Partitions;
+	//[start, end) into Partitions, per type.
+	int32 TypePartitions[BatchedTypes + 1] = {};
+};
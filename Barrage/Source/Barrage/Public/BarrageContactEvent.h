@@ -20,13 +20,19 @@ struct BarrageContactEntity
 	}
 	
 	BarrageContactEntity(const FBarrageKey ContactKeyIn, const JPH::Body& BodyIn)
+		: BarrageContactEntity(ContactKeyIn, static_cast<Layers::EJoltPhysicsLayer>(BodyIn.GetObjectLayer()))
+	{
+	}
+
+	//NUM_LAYERS means we don't know, same as the key-only constructor.
+	BarrageContactEntity(const FBarrageKey ContactKeyIn, const Layers::EJoltPhysicsLayer LayerIn)
 	{
 		ContactKey = ContactKeyIn;
-		bIsProjectile = BodyIn.GetObjectLayer() == Layers::PROJECTILE || BodyIn.GetObjectLayer() == Layers::ENEMYPROJECTILE;
-		bIsStaticGeometry = BodyIn.GetObjectLayer() == Layers::NON_MOVING;
-		bIsNormalCastQuery = BodyIn.GetObjectLayer() == Layers::CAST_QUERY;
-		bIsPureHitbox = BodyIn.GetObjectLayer() == Layers::ENEMYHITBOX || BodyIn.GetObjectLayer() == Layers::HITBOX;
-		MyLayer = static_cast<Layers::EJoltPhysicsLayer>(BodyIn.GetObjectLayer());
+		bIsProjectile = LayerIn == Layers::PROJECTILE || LayerIn == Layers::ENEMYPROJECTILE;
+		bIsStaticGeometry = LayerIn == Layers::NON_MOVING;
+		bIsNormalCastQuery = LayerIn == Layers::CAST_QUERY;
+		bIsPureHitbox = LayerIn == Layers::ENEMYHITBOX || LayerIn == Layers::HITBOX;
+		MyLayer = LayerIn;
 	}
 
 	FBarrageKey ContactKey;
@@ -34,6 +40,8 @@ struct BarrageContactEntity
 	bool bIsStaticGeometry = false;
 	bool bIsNormalCastQuery = false;
 	bool bIsPureHitbox = false;
+	//a swept projectile has no body, so its ContactKey is its FSkeletonKey, not a barrage key. see FBarrageProjectileSweep.
+	bool bIsSwept = false;
 	Layers::EJoltPhysicsLayer MyLayer;
 };
 
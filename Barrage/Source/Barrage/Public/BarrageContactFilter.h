@@ -0,0 +1,76 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BarrageContactEvent.h"
+#include <atomic>
+
+//Which layer pairs anybody actually wants contact events for, by event type. One bit per pair, one 16 bit row per
+//layer, so the check in the listener is a load, a shift, and a mask, and it happens before we touch a key or a lane.
+//
+//Each event type starts open: until someone subscribes to it, every pair reports, which is how things always worked.
+//The first subscription for a type closes it to everything that hasn't been asked for. So if you bind a contact
+//delegate in a world where anyone subscribes, subscribe too, or you'll be hearing a lot less than you expect.
+//
+//Pairs are symmetric. Layers we don't know (NUM_LAYERS, which is what character contacts and removals carry)
+//always pass, because we can't say nobody wants them.
+class FBarrageContactFilter
+{
+public:
+	static constexpr int32 FilteredTypes = static_cast<int32>(EBarrageContactEventType::GHOST);
+	static_assert(Layers::NUM_LAYERS <= 16, "contact filter rows are 16 bits. widen them before adding layers.");
+
+	FBarrageContactFilter()
+	{
+		Reset();
+	}
+
+	void Subscribe(Layers::EJoltPhysicsLayer A, Layers::EJoltPhysicsLayer B, EBarrageContactEventType Type)
+	{
+		const int32 TypeIndex = static_cast<int32>(Type);
+		if (TypeIndex >= FilteredTypes || A >= Layers::NUM_LAYERS || B >= Layers::NUM_LAYERS)
+		{
+			return;
+		}
+		Rows[TypeIndex][A].fetch_or(static_cast<uint16>(1 << B), std::memory_order_relaxed);
+		Rows[TypeIndex][B].fetch_or(static_cast<uint16>(1 << A), std::memory_order_relaxed);
+		Open[TypeIndex].store(false, std::memory_order_release);
+	}
+
+	//A against every layer, including itself.
+	void SubscribeAll(Layers::EJoltPhysicsLayer A, EBarrageContactEventType Type)
+	{
+		for (uint8 B = 0; B < Layers::NUM_LAYERS; ++B)
+		{
+			Subscribe(A, static_cast<Layers::EJoltPhysicsLayer>(B), Type);
+		}
+	}
+
+	bool Wants(EBarrageContactEventType Type, Layers::EJoltPhysicsLayer A, Layers::EJoltPhysicsLayer B) const
+	{
+		const int32 TypeIndex = static_cast<int32>(Type);
+		if (TypeIndex >= FilteredTypes || Open[TypeIndex].load(std::memory_order_acquire)
+			|| A >= Layers::NUM_LAYERS || B >= Layers::NUM_LAYERS)
+		{
+			return true;
+		}
+		return (Rows[TypeIndex][A].load(std::memory_order_relaxed) >> B) & 1;
+	}
+
+	void Reset()
+	{
+		for (int32 TypeIndex = 0; TypeIndex < FilteredTypes; ++TypeIndex)
+		{
+			Open[TypeIndex].store(true, std::memory_order_relaxed);
+			for (std::atomic<uint16>& Row : Rows[TypeIndex])
+			{
+				Row.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	std::atomic<uint16> Rows[FilteredTypes][Layers::NUM_LAYERS];
+	std::atomic<bool> Open[FilteredTypes];
+};
@@ -4,6 +4,8 @@
 #include "SkeletonTypes.h"
 
 #include "BarrageContactEvent.h"
+#include "BarrageContactBuffers.h"
+#include "BarrageContactFilter.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "FBarrageKey.h"
 #include "CapsuleTypes.h"
@@ -11,6 +13,9 @@
 #include "FBPhysicsInput.h"
 #include "Containers/CircularQueue.h"
 #include "FBShapeParams.h"
+#include "BarrageHitboxFollowers.h"
+#include "BarrageProjectileSweep.h"
+#include "BarrageStateHash.h"
 #include "KeyedConcept.h"
 #include "ORDIN.h"
 #include "TransformDispatch.h"
@@ -21,6 +26,7 @@
 #endif
 
 class ALandscapeProxy;
+class ULevel;
 
 static constexpr uint32 MAX_FOUND_OBJECTS = 1024;
 
@@ -48,6 +54,7 @@ struct BarrageContactEvent;
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnBarrageContactAdded, const BarrageContactEvent&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnBarrageContactPersisted, const BarrageContactEvent&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnBarrageContactRemoved, const BarrageContactEvent&);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBarrageContactBatch, const FBarrageContactBatch&);
 constexpr int32 ALLOWED_THREADS_FOR_BARRAGE_PHYSICS = 64;
 //if we could make a promise about when threads are allocated, we could probably get rid of this
 //since the accumulator is in the world subsystem and so gets cleared when the world spins down.
@@ -80,7 +87,7 @@ public:
 	static constexpr float TickRateInDelta = 1.0f / HERTZ_OF_BARRAGE;
 	int32 ThreadAccTicker = 0;
 	TSharedPtr<TransformUpdatesForGameThread> GameTransformPump;
-	TSharedPtr<TCircularQueue<BarrageContactEvent>> ContactEventPump;
+	TSharedPtr<FBarrageContactBuffers> ContactEventPump;
 	 //this value indicates you have none.
 	mutable FCriticalSection GrowOnlyAccLock;
 	int32 WorkerThreadAccTicker = 0;
@@ -98,21 +105,63 @@ public:
 	
 	virtual void SphereCast(double Radius, double Distance, FVector3d CastFrom, FVector3d Direction, TSharedPtr<FHitResult> OutHit, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, uint64_t timestamp = 0);
 	virtual void SphereSearch(FBarrageKey ShapeSource, FVector3d Location, double Radius, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, uint32* OutFoundObjectCount, TArray<uint32>& OutFoundObjects);
+	//SphereSearch when all you want is how many. Predicate gets raw body ids, same as SphereSearch hands back, and the
+	//search stops once StopAt have counted. see FWorldSimOwner::SphereCount and SphereCountMany.
+	uint32 SphereCount(FVector3d Location, double Radius, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TFunctionRef<bool(uint32)> Predicate, uint32 StopAt = MAX_uint32, TArray<uint32>* OutFirstFound = nullptr) const;
+	void SphereCountMany(TConstArrayView<FVector3d> Locations, double Radius, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TFunctionRef<bool(uint32)> Predicate, TArrayView<uint32> OutCounts, uint32 StopAt = MAX_uint32) const;
 
 	virtual void CastRay(FVector3d CastFrom, FVector3d Direction, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TSharedPtr<FHitResult> OutHit);
+	//CastRay for a whole set of rays at once, OutHits[i] for CastFrom[i]. far cheaper when the rays are coherent, like a
+	//beam or a fan of LOS checks. see FWorldSimOwner::CastRayPacket.
+	void CastRayPacket(TConstArrayView<FVector3d> CastFrom, TConstArrayView<FVector3d> Directions, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TArrayView<FHitResult> OutHits);
 	
 	//and viola [sic] actually pretty elegant even without type polymorphism by using overloading polymorphism.
 	//see EAllowedDOFs from Barrage\Source\JoltPhysics\Jolt\Physics\Body\AllowedDOFs.h
 	FBLet CreatePrimitive(FBBoxParams& Definition, FSkeletonKey Outkey, uint16 Layer, bool IsSensor = false, bool forceDynamic = false, bool isMovable = true, float AngularDamp = 0.2, JPH::EAllowedDOFs AllowedDOF = RelaxedBoxDOFs);
 	FBLet CreatePrimitive(FBCapParams& Definition, FSkeletonKey Outkey, uint16 Layer, bool IsSensor = false, bool forceDynamic = false, bool isMovable = true, float AngularDamp = 0.1, JPH::EAllowedDOFs AllowedDOF =  StandardCapAllowedDOFs);
 	FBLet CreatePrimitive(FBCharParams& Definition, FSkeletonKey Outkey, uint16 Layer);
+	//builds the shapes for characters this size now, so spawning them later doesn't. call it at load for each
+	//character size you expect; repeats are free.
+	void PrewarmCharacterShapes(const FBCharParams& Definition);
 	FBLet CreatePrimitive(FBSphereParams& Definition, FSkeletonKey OutKey, uint16 Layer, bool IsSensor = false);
 	FBLet CreateProjectile(FBBoxParams& Definition, FSkeletonKey OutKey, uint16_t Layer);
 	FBLet LoadComplexStaticMesh(FBTransform& MeshTransform, const UStaticMeshComponent* StaticMeshComponent, FSkeletonKey OutKey, bool IsSensor = false);
 	FBLet LoadEnemyHitboxFromStaticMesh(FBTransform& MeshTransform, const UStaticMeshComponent* StaticMeshComponent, FSkeletonKey OutKey, bool IsSensor = false, bool UseRawMeshForCollision = false, FVector CenterOfMassTranslation = {0,0,0});
 	void CreateHeightfieldLandscapeMesh(TNotNull<const ALandscapeProxy*> LandscapeActor);
+	//For level loads and streaming: converts every mesh at once on the jolt job pool, then adds them all together on
+	//the next step with one broadphase rebuild, instead of one body and one hitch at a time. Results line up with
+	//Meshes, nullptr where a mesh had no usable collision. See FWorldSimOwner::ImportStaticGeometry.
+	TArray<FBLet> ImportStaticGeometry(TConstArrayView<FBStaticImport> Meshes, TConstArrayView<const ALandscapeProxy*> Landscapes = {});
+	//Every static mobility, collision enabled static mesh in the level, plus its landscapes. The first mesh on an actor is
+	//keyed the way UBarrageStaticAutoMesh keys it, and the rest get keys derived from that one. Don't also give those actors an auto mesh, or they'll be in the world twice.
+	static void GatherStaticGeometry(const ULevel* Level, TArray<FBStaticImport>& OutMeshes, TArray<const ALandscapeProxy*>& OutLandscapes);
+	TArray<FBLet> ImportLevelStaticGeometry(const ULevel* Level);
 	FBLet GetShapeRef(FBarrageKey Existing) const;
 	FBLet GetShapeRef(FSkeletonKey Existing) const;
+
+	//Batch resolve for things that touch several keys every tick, like homing ticklites. OutPrimitives must be at least
+	//as long as Keys. Writes NON-OWNING pointers, nullptr for anything unknown or tombstoned, and returns how many resolved.
+	//No shared pointer is copied, so no refcount atomics. The pointers are good for the current tick and no longer:
+	//we refuse anything already tombstoned, and a live entry cannot leave the lifecycle map for at least
+	//TombstoneInitialMinimum steps after it is marked. If you need to hold one past the tick, use GetShapeRef.
+	int32 ResolveFBLets(TConstArrayView<FSkeletonKey> Keys, TArrayView<FBarragePrimitive*> OutPrimitives) const;
+
+	//pins Child to Parent's pose every StackUp, until either is tombstoned. safe from any thread, and fine to call before
+	//the parent exists. see FBarrageHitboxFollowers.
+	void FollowParent(FSkeletonKey Child, FSkeletonKey Parent, FVector3d LocalOffset = FVector3d::ZeroVector);
+	//sweeps a bodiless projectile after every step until it hits something or is stopped. a hit is an ADDED contact
+	//event like any other, with bIsSwept set on the projectile's side. safe from any thread. see FBarrageProjectileSweep.
+	//with no body, nothing else can hit it, including other projectiles, so don't sweep anything antimissile has to stop.
+	void SweepProjectile(const FBarrageSweptProjectileParams& Params);
+	void StopSweepingProjectile(FSkeletonKey Projectile);
+	//the world's fingerprint after the step for Tick, kept for the last FBarrageStateHash::HistoryLength ticks. safe
+	//from any thread. hand it to the other peers, and hand theirs to ReportRemoteStateHash. see FBarrageStateHash.
+	bool TryGetStateHash(uint64 Tick, uint64& OutHash) const;
+	void ReportRemoteStateHash(uint64 Tick, uint64 Hash);
+	const FBarrageStateHash& GetStateHashes() const
+	{
+		return StateHash;
+	}
 	void FinalizeReleasePrimitive(FBarrageKey BarrageKey);
 
 	//any non-zero value is the same, effectively, as a nullity for the purposes of any new operation.
@@ -129,6 +178,8 @@ public:
 		if (FBarragePrimitive::IsNotNull(Target))
 		{
 			Target->tombstone = TombstoneInitialMinimum + TombOffset;
+			//picked up by the next StepWorld, rather than found by walking every body.
+			PendingTombs.Enqueue(Target);
 			return Target->tombstone;
 		}
 		return 1;
@@ -151,6 +202,25 @@ public:
 	//TODO: oh dear I'm doing the same thing as the TransformQueue... Also probably want to check back on this.
 	bool BroadcastContactEvents() const;
 	
+	//tell the listener which layer pairs you care about. see FBarrageContactFilter, especially the part about how the
+	//first subscription to an event type turns off every pair nobody asked for.
+	void SubscribeToContacts(Layers::EJoltPhysicsLayer A, Layers::EJoltPhysicsLayer B,
+	                         EBarrageContactEventType Type = EBarrageContactEventType::ADDED)
+	{
+		ContactFilter.Subscribe(A, B, Type);
+	}
+	void SubscribeToContacts(Layers::EJoltPhysicsLayer A, EBarrageContactEventType Type = EBarrageContactEventType::ADDED)
+	{
+		ContactFilter.SubscribeAll(A, Type);
+	}
+	bool WantsContact(EBarrageContactEventType Type, Layers::EJoltPhysicsLayer A, Layers::EJoltPhysicsLayer B) const
+	{
+		return ContactFilter.Wants(Type, A, B);
+	}
+
+	//once per step per event type that had anything, before the per-event delegates. see FBarrageContactBatch.
+	//if you bind this, don't also bind the per-event delegate for the same type, or you'll see everything twice.
+	FOnBarrageContactBatch OnBarrageContactBatchDelegate;
 	FOnBarrageContactAdded OnBarrageContactAddedDelegate;
 	void HandleContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold,
 	                        JPH::ContactSettings& ioSettings);
@@ -193,6 +263,7 @@ private:
 	//tons and tons of bodies in one frame. if that's a bottleneck for you, you may wish to shorten the tombstone promise
 	//or optimize this for memory better. In general, Barrage and Artillery trade memory for speed and elegance.
 	TSharedPtr<TArray<FBLet>> Tombs[TombstoneInitialMinimum + 1];
+	TQueue<FBLet, EQueueMode::Mpsc> PendingTombs;
 
 	void CleanTombs()
 	{
@@ -225,4 +296,8 @@ private:
 private:
 	std::array<FBPhysicsInput, 32000> InternalSortableSet = {};
 	std::array<JPH::BodyID, 8192> Adds;
+	FBarrageHitboxFollowers HitboxFollowers;
+	FBarrageProjectileSweep ProjectileSweep;
+	FBarrageStateHash StateHash;
+	FBarrageContactFilter ContactFilter;
 };
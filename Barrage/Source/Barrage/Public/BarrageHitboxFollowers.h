@@ -0,0 +1,66 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FBarragePrimitive.h"
+#include "Containers/Queue.h"
+
+class FWorldSimOwner;
+
+//Secondary hitboxes (armor, shields, weak points) are separate bodies that ride along with a parent body. These used
+//to be one FTickHitbox ticklite apiece, each doing two key lookups and enqueueing a position and a rotation every tick.
+//Enemies carry 4-10 of these, so that's a lot of map traffic and a lot of inputs for what is really a copy.
+//
+//Here, we keep (parent, child, offset) flat and sorted by parent. The FBLets are resolved once and cached,
+//so there's no per-tick lookup, and a tombstone on either end drops the entry. Like the ticklite, a registration whose
+//parent doesn't exist yet just waits, for as long as the child is alive. Each tick we drop the entries whose parent
+//and child both sat still through the last step, going by the body tracker, before any locks are taken. Character
+//parents aren't tracked, so they're always visited, and a new entry is always placed once. For the rest, we read every
+//parent pose once, take the body locks for the whole set at once, and write the children through the no-lock body
+//interface. A child that is already where its parent puts it is left alone, so when the parent settles, the child
+//gets to sleep too.
+//
+//Follow is safe from any thread. Update belongs to whoever calls StackUp, and runs at the end of it, so the children
+//see the parent's inputs for this tick before the step.
+class BARRAGE_API FBarrageHitboxFollowers
+{
+public:
+	//the offset is in the parent's local frame, in UE units. most hitboxes bake their offset into the shape
+	//at creation (a rotated translated shape) and should pass zero here, or the offset gets applied twice.
+	void Follow(FSkeletonKey Child, FSkeletonKey Parent, FVector3d LocalOffset = FVector3d::ZeroVector);
+	void Update(FWorldSimOwner& Sim, TFunctionRef<FBLet(FSkeletonKey)> Resolve);
+	void Reset();
+	int32 Num() const
+	{
+		return Followers.Num();
+	}
+
+private:
+	struct FPendingFollow
+	{
+		FSkeletonKey Child;
+		FSkeletonKey Parent;
+		JPH::Vec3 LocalOffset = JPH::Vec3::sZero();
+	};
+
+	struct FFollower
+	{
+		FBLet Parent;
+		FBLet Child;
+		JPH::Vec3 LocalOffset = JPH::Vec3::sZero();
+		bool bPlaced = false;
+	};
+
+	void ResolvePending(TFunctionRef<FBLet(FSkeletonKey)> Resolve);
+
+	TQueue<FPendingFollow, EQueueMode::Mpsc> Pending;
+	TArray<FPendingFollow> Unresolved;
+	TArray<FFollower> Followers;
+	bool Unsorted = false;
+
+	//scratch, kept around so a steady state allocates nothing.
+	TArray<int32> Live;
+	TArray<JPH::BodyID> LockSet;
+	TArray<int32> ParentLockIndex;
+};
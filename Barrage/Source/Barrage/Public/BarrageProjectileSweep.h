@@ -0,0 +1,108 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkeletonTypes.h"
+#include "EPhysicsLayer.h"
+#include "IsolatedJoltIncludes.h"
+#include "CoordinateUtils.h"
+#include "Containers/Queue.h"
+
+class FWorldSimOwner;
+
+struct FBarrageSweptProjectileParams
+{
+	FSkeletonKey Projectile;
+	FVector3d Origin = FVector3d::ZeroVector;
+	//UE units per second.
+	FVector3d Velocity = FVector3d::ZeroVector;
+	//jolt units, same as FTSphereCast. zero sweeps a ray instead of a sphere.
+	float Radius = 0.f;
+	Layers::EJoltPhysicsLayer Layer = Layers::PROJECTILE;
+	//seconds. a projectile that hasn't hit anything by then is retired without a hit.
+	float MaxLifetime = 20.f;
+	//UE units. same as MaxLifetime, but by distance flown. zero never runs out.
+	double MaxRange = 0.0;
+};
+
+//The first thing one projectile's segment ran into this tick. The projectile stops sweeping once it has hit something.
+struct FBarrageSweepHit
+{
+	FSkeletonKey Projectile;
+	uint32 Body = JPH::BodyID::cInvalidBodyID;
+	Layers::EJoltPhysicsLayer ProjectileLayer = Layers::NUM_LAYERS;
+	Layers::EJoltPhysicsLayer BodyLayer = Layers::NUM_LAYERS;
+	//UE coordinates, where the sweep touched the body.
+	FVector3f Point = FVector3f::ZeroVector;
+	//how far along this tick's segment the hit was, 0 to 1.
+	float Fraction = 1.f;
+};
+
+//Fast, small bullets don't need a rigid body apiece. As bodies, each one is a broadphase entry that moves every tick,
+//a solver island, and a LinearCast motion quality that Jolt sweeps one at a time, all to find out what it ran into.
+//
+//Here a bullet is just a row: origin, velocity, radius, and layer, kept flat. Each tick, every row becomes the segment
+//it covers this tick, and the segments are cast against the world in chunks on the jolt job pool, using the layer's
+//cached query filters. Each chunk writes into its own rows, so there's nothing to lock. The first hit along a segment
+//stops that projectile and is handed back. A projectile that outlives its MaxLifetime or MaxRange first is retired
+//quietly, partway through the segment it ran out on. Anything that needs a physical response after that (ricochets, grenades
+//that bounce) is the caller's to promote to a real body at the hit.
+//
+//Launch and Stop are safe from any thread, and are picked up at the start of the next Sweep. Sweep and Hits belong to
+//the stepping thread, and should run after the step, so the segments see the bodies where the step left them.
+class BARRAGE_API FBarrageProjectileSweep
+{
+public:
+	//below this, a chunk costs more to schedule than to cast.
+	static constexpr int32 ProjectilesPerJob = 128;
+
+	void Launch(const FBarrageSweptProjectileParams& Params);
+	void Stop(FSkeletonKey Projectile);
+	//casts this tick's segments, advances everything that didn't hit, and drops everything that hit or ran out.
+	void Sweep(FWorldSimOwner& Sim, float DeltaTime);
+	//this tick's hits, sorted by projectile key. good until the next Sweep.
+	TConstArrayView<FBarrageSweepHit> Hits() const
+	{
+		return SweepHits;
+	}
+	//everything still in flight, in UE coordinates. there's no body to follow, so whoever draws them asks here.
+	template <class Visitor>
+	void VisitInFlight(Visitor&& Visit) const
+	{
+		for (int32 Row = 0; Row < Keys.Num(); ++Row)
+		{
+			Visit(Keys[Row], CoordinateUtils::FromJoltCoordinates(Origins[Row]), CoordinateUtils::FromJoltCoordinates(Velocities[Row]));
+		}
+	}
+	void Reset();
+	int32 Num() const
+	{
+		return Keys.Num();
+	}
+
+private:
+	void ApplyPending();
+	void SweepRange(const FWorldSimOwner& Sim, float DeltaTime, int32 First, int32 Last);
+	//this tick's stretch of a row's flight, cut short if it runs out of life or range partway. true if it's the last.
+	bool SegmentOf(int32 Row, float DeltaTime, JPH::Vec3& OutSegment) const;
+	void RemoveRow(int32 Row);
+
+	TQueue<FBarrageSweptProjectileParams, EQueueMode::Mpsc> PendingLaunches;
+	TQueue<FSkeletonKey, EQueueMode::Mpsc> PendingStops;
+
+	//one row per projectile in flight, all in jolt coordinates.
+	TArray<FSkeletonKey> Keys;
+	TArray<JPH::Vec3> Origins;
+	TArray<JPH::Vec3> Velocities;
+	TArray<float> Radii;
+	TArray<Layers::EJoltPhysicsLayer> ProjectileLayers;
+	//seconds, and jolt units. both are always above zero for a row that's still here.
+	TArray<float> LifeLeft;
+	TArray<float> RangeLeft;
+	//written by the chunk that owns the row. Body is invalid for a miss.
+	TArray<FBarrageSweepHit> RowHits;
+
+	TArray<FBarrageSweepHit> SweepHits;
+	TSet<FSkeletonKey> Stopping;
+};
@@ -0,0 +1,34 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+#include "Jolt/Physics/Ragdoll/Ragdoll.h"
+
+//Ragdolls that died and came back. CreateRagdoll makes a body per part and a constraint per joint, and removing them
+//throws all of that away again, which is a lot of churn when fifty enemies go down in the same explosion and get
+//cleaned up together a few seconds later.
+//
+//Release pulls a ragdoll out of the physics system and keeps it, keyed by the settings it was made from. Acquire hands
+//one of those back, posed and with its velocities zeroed, before it falls back to making a new one. Pair this with
+//Barrage::Conversion::FindOrCreateJoltRagdollSettings so the settings pointer is actually shared between ragdolls.
+//
+//Not thread safe. Use it from the thread that adds and removes bodies, and Reset it before the physics system goes away.
+class BARRAGE_API FBarrageRagdollPool
+{
+public:
+	//how many spare ragdolls we keep per settings. past this, released ragdolls are just freed.
+	static constexpr int32 MaxFreePerSettings = 64;
+
+	//added to the physics system and active. the group id is handed to the ragdoll's collision group either way.
+	JPH::Ref<JPH::Ragdoll> Acquire(JPH::PhysicsSystem& PhysicsSystem, const JPH::RagdollSettings& Settings, const JPH::SkeletonPose& Pose,
+	                               JPH::CollisionGroup::GroupID GroupID = 0);
+	//removes it from the physics system. don't touch it after this, it may come back out of Acquire as someone else's.
+	void Release(JPH::Ragdoll* Ragdoll);
+	int32 NumFree() const;
+	void Reset();
+
+private:
+	TMap<const JPH::RagdollSettings*, TArray<JPH::Ref<JPH::Ragdoll>>> Free;
+};
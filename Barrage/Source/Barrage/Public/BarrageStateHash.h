@@ -0,0 +1,91 @@
+﻿// Copyright 2025 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+#include "Containers/Queue.h"
+#include <atomic>
+
+class FWorldSimOwner;
+
+//A fingerprint of the world after each step, so a desync between peers, or between a replay and the run it recorded,
+//shows up on the tick it happens instead of whenever the visuals finally drift apart.
+//
+//Each body's id, center of mass, rotation, and velocities are quantized to a grid and mashed together with FMMM.
+//Quantizing means -0 and +0, and anything else below the grid, hash the same. Body ids are part of the hash, so the
+//peers have to create their bodies in the same order, which jolt's own determinism needs anyway.
+//
+//Every live body is rehashed every step, in BodyID order, in fixed size chunks that run on the jolt job pool. The
+//chunks are folded in order, so the answer depends on the world and not on how many workers there were. Nothing is
+//carried over from one step to the next, so two peers hashing the same world get the same answer no matter when they
+//started hashing or what they hashed before. Caching the hashes of sleeping bodies looks tempting, but anything that
+//changes a body without waking it, like a DontActivate teleport or moving a static, would then only show up on peers
+//whose cache happened to miss it, which is a false desync.
+//
+//Record belongs to the stepping thread and runs once per step, after the step. The last HistoryLength hashes
+//are kept in a ring indexed by tick. ReportRemote is safe from any thread: it queues a peer's hash, and the next Record
+//checks it against ours. Remote hashes from ahead of us wait until we get there. Ones too old for the ring are dropped
+//uncompared.
+class BARRAGE_API FBarrageStateHash
+{
+public:
+	//about 2 seconds at 128hz.
+	static constexpr uint32 HistoryLength = 256;
+	//bodies per chunk. below this, a chunk costs more to schedule than to hash.
+	static constexpr int32 BodiesPerJob = 1024;
+	//jolt units. a millimeter, a hundredth of a degree or so, and a few mm per second.
+	static constexpr float PositionQuanta = 1024.f;
+	static constexpr float RotationQuanta = 32767.f;
+	static constexpr float VelocityQuanta = 256.f;
+
+	uint64 Record(const FWorldSimOwner& Sim, uint64 Tick);
+	//false if we haven't hashed that tick yet, or it has fallen out of the ring. safe from any thread.
+	bool TryGet(uint64 Tick, uint64& OutHash) const;
+	void ReportRemote(uint64 Tick, uint64 Hash);
+
+	//the earliest tick a remote hash disagreed with ours, or MAX_uint64 if none has.
+	uint64 FirstDesyncTick() const
+	{
+		return FirstDesync.load(std::memory_order_relaxed);
+	}
+	uint32 NumDesyncs() const
+	{
+		return Desyncs.load(std::memory_order_relaxed);
+	}
+	uint32 NumMatches() const
+	{
+		return Matches.load(std::memory_order_relaxed);
+	}
+	void Reset();
+
+private:
+	struct FRemoteHash
+	{
+		uint64 Tick = 0;
+		uint64 Hash = 0;
+	};
+
+	//the tick is written last, after the hash, and a reader checks it on both sides of reading the hash.
+	struct FHistorySlot
+	{
+		std::atomic<uint64> Tick = MAX_uint64;
+		std::atomic<uint64> Hash = 0;
+	};
+
+	static uint64 HashBody(const JPH::BodyLockInterfaceNoLock& Bodies, const JPH::BodyID& ID);
+	//hashes BodyIDs[First, Last) and folds them, in order.
+	uint64 HashRange(const FWorldSimOwner& Sim, int32 First, int32 Last) const;
+	void CompareRemotes(uint64 Tick);
+
+	FHistorySlot History[HistoryLength];
+	TQueue<FRemoteHash, EQueueMode::Mpsc> PendingRemotes;
+	TArray<FRemoteHash> Waiting;
+	std::atomic<uint64> FirstDesync = MAX_uint64;
+	std::atomic<uint32> Desyncs = 0;
+	std::atomic<uint32> Matches = 0;
+
+	//scratch, kept around so a steady state allocates nothing. neither outlives the Record that fills it.
+	JPH::BodyIDVector BodyIDs;
+	TArray<uint64> ChunkHashes;
+};
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include "IsolatedJoltIncludes.h"
+
+//SphereSearchCollector, minus the array. Most callers of SphereSearch only wanted to know how many of something were
+//nearby, and got 1024 body pointers filled in to count them. This counts bodies that pass the body filter and the
+//predicate, keeps the first few ids if asked, and tells the broadphase to stop the moment the count reaches mStopAt.
+//The predicate sees raw body ids (same as SphereSearch hands back), and runs after the body filter, so it only pays
+//for bodies that could count.
+class SphereCountCollector : public JPH::CollideShapeBodyCollector
+{
+public:
+	SphereCountCollector(const JPH::BodyLockInterface &inBodyLockInterface, const JPH::BodyFilter &inBodyFilter,
+		TFunctionRef<bool(uint32)> inPredicate, uint32 inStopAt, TArray<uint32>* outFirstFound = nullptr)
+		: mBodyLockInterface(inBodyLockInterface), mBodyFilter(inBodyFilter), mPredicate(inPredicate),
+		  mStopAt(inStopAt), mFirstFound(outFirstFound)
+	{
+	}
+
+	virtual void AddHit(const ResultType &inResult) override
+	{
+		if (mCount >= mStopAt || !mBodyFilter.ShouldCollide(inResult))
+		{
+			return;
+		}
+		{
+			JPH::BodyLockRead lock(mBodyLockInterface, inResult);
+			if (!lock.SucceededAndIsInBroadPhase() || !mBodyFilter.ShouldCollideLocked(lock.GetBody()))
+			{
+				return;
+			}
+		}
+		const uint32 id = inResult.GetIndexAndSequenceNumber();
+		if (!mPredicate(id))
+		{
+			return;
+		}
+		if (mFirstFound)
+		{
+			mFirstFound->Add(id);
+		}
+		if (++mCount >= mStopAt)
+		{
+			ForceEarlyOut();
+		}
+	}
+
+	// Physics data handlers
+	const JPH::BodyLockInterface& mBodyLockInterface;
+	const JPH::BodyFilter& mBodyFilter;
+	TFunctionRef<bool(uint32)> mPredicate;
+	uint32 mStopAt;
+	TArray<uint32>* mFirstFound;
+
+	// Hit results
+	uint32 mCount = 0;
+};
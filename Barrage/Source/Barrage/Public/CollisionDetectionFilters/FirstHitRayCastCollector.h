@@ -43,7 +43,7 @@ public:
 
 						// Update early out fraction based on narrow phase collector
 						UpdateEarlyOutFraction(mHit.mFraction);
-						mContactPosition = mRay.GetPointOnRay(inResult.mFraction);
+						mContactPosition = mRay.GetPointOnRay(mHit.mFraction);
 					}
 				}
 			}
@@ -0,0 +1,197 @@
+﻿#pragma once
+#include "IsolatedJoltIncludes.h"
+
+//Up to MaxRays segments, stored four to a lane so one box can be slab tested against four rays at a time. Beam weapons
+//and LOS checks fire big, coherent sets of rays every tick, and as single rays each one walks the broadphase on its own
+//and locks every body it passes. As a packet, the broadphase is walked once with the box around every segment, and
+//each body it hands back is culled against all the rays' slabs before anybody pays for a shape level CastRay.
+//A beam fired on a diagonal has an axis aligned box that's mostly empty space, so the packet also keeps a box lined up
+//with its average heading, and the broadphase gets walked with whichever of the two is smaller.
+//
+//Jolt's Vec4 is SSE on x64 and NEON on arm, and plain floats anywhere else. OverlapsScalar is the same test one ray at
+//a time, and is what the SIMD path gets checked against.
+class RayPacket
+{
+public:
+	static constexpr int MaxRays = 16;
+
+	explicit RayPacket(TConstArrayView<JPH::RRayCast> inRays)
+	{
+		JPH_ASSERT(inRays.Num() <= MaxRays);
+		mNum = FMath::Min(inRays.Num(), MaxRays);
+		mLanes = (mNum + 3) / 4;
+		mBounds = JPH::AABox();
+		for (int ray = 0; ray < MaxRays; ++ray)
+		{
+			if (ray >= mNum)
+			{
+				//padding never hits. it leaves every box before it gets to it.
+				mOriginX[ray] = mOriginY[ray] = mOriginZ[ray] = 0;
+				mInvX[ray] = mInvY[ray] = mInvZ[ray] = 0;
+				mParallelX[ray] = mParallelY[ray] = mParallelZ[ray] = 0;
+				mMaxFraction[ray] = -1;
+				continue;
+			}
+			const JPH::RRayCast& cast = inRays[ray];
+			mBounds.Encapsulate(cast.mOrigin);
+			mBounds.Encapsulate(cast.mOrigin + cast.mDirection);
+			SetAxis(ray, cast.mOrigin.GetX(), cast.mDirection.GetX(), mOriginX, mInvX, mParallelX);
+			SetAxis(ray, cast.mOrigin.GetY(), cast.mDirection.GetY(), mOriginY, mInvY, mParallelY);
+			SetAxis(ray, cast.mOrigin.GetZ(), cast.mDirection.GetZ(), mOriginZ, mInvZ, mParallelZ);
+			mMaxFraction[ray] = 1.0f;
+		}
+
+		JPH::Vec3 heading = JPH::Vec3::sZero();
+		for (int ray = 0; ray < mNum; ++ray)
+		{
+			heading += JPH::Vec3(inRays[ray].mDirection).NormalizedOr(JPH::Vec3::sZero());
+		}
+		//rays fanned out in every direction have no heading worth lining up with.
+		if (heading.LengthSq() < 1.0e-6f)
+		{
+			return;
+		}
+		const JPH::Vec3 axis_x = heading.Normalized();
+		const JPH::Vec3 axis_y = axis_x.GetNormalizedPerpendicular();
+		const JPH::Vec3 axis_z = axis_x.Cross(axis_y);
+		JPH::AABox local;
+		for (int ray = 0; ray < mNum; ++ray)
+		{
+			for (const JPH::Vec3 end : {JPH::Vec3(inRays[ray].mOrigin), JPH::Vec3(inRays[ray].mOrigin + inRays[ray].mDirection)})
+			{
+				local.Encapsulate(JPH::Vec3(axis_x.Dot(end), axis_y.Dot(end), axis_z.Dot(end)));
+			}
+		}
+		mOriented = JPH::OrientedBox(JPH::Mat44(JPH::Vec4(axis_x, 0), JPH::Vec4(axis_y, 0), JPH::Vec4(axis_z, 0), JPH::Vec3::sZero()), local);
+		mOrientedIsTighter = local.GetVolume() < mBounds.GetVolume();
+	}
+
+	int Num() const
+	{
+		return mNum;
+	}
+
+	//the box around every segment in the packet. this is what the broadphase gets walked with.
+	const JPH::AABox& GetBounds() const
+	{
+		return mBounds;
+	}
+
+	//the box around every segment, lined up with the packet's heading. only worth walking with when it's tighter.
+	const JPH::OrientedBox& GetOrientedBounds() const
+	{
+		return mOriented;
+	}
+
+	bool IsOrientedBoundsTighter() const
+	{
+		return mOrientedIsTighter;
+	}
+
+	//once a ray has hit something, nothing past that can be its first hit, so stop looking there.
+	void ClampRay(int inRay, float inFraction)
+	{
+		mMaxFraction[inRay] = FMath::Min(mMaxFraction[inRay], inFraction);
+	}
+
+	//bit i is set if ray i's segment, up to its clamp, touches inBox.
+	uint32 Overlaps(const JPH::AABox& inBox) const
+	{
+		const JPH::Vec4 min_x = JPH::Vec4::sReplicate(inBox.mMin.GetX());
+		const JPH::Vec4 min_y = JPH::Vec4::sReplicate(inBox.mMin.GetY());
+		const JPH::Vec4 min_z = JPH::Vec4::sReplicate(inBox.mMin.GetZ());
+		const JPH::Vec4 max_x = JPH::Vec4::sReplicate(inBox.mMax.GetX());
+		const JPH::Vec4 max_y = JPH::Vec4::sReplicate(inBox.mMax.GetY());
+		const JPH::Vec4 max_z = JPH::Vec4::sReplicate(inBox.mMax.GetZ());
+		uint32 mask = 0;
+		for (int lane = 0; lane < mLanes; ++lane)
+		{
+			const int first = lane * 4;
+			JPH::Vec4 t_enter = JPH::Vec4::sZero();
+			JPH::Vec4 t_exit = Load(mMaxFraction, first);
+			Slab(Load(mOriginX, first), Load(mInvX, first), LoadMask(mParallelX, first), min_x, max_x, t_enter, t_exit);
+			Slab(Load(mOriginY, first), Load(mInvY, first), LoadMask(mParallelY, first), min_y, max_y, t_enter, t_exit);
+			Slab(Load(mOriginZ, first), Load(mInvZ, first), LoadMask(mParallelZ, first), min_z, max_z, t_enter, t_exit);
+			mask |= static_cast<uint32>(JPH::Vec4::sLessOrEqual(t_enter, t_exit).GetTrues()) << first;
+		}
+		return mask;
+	}
+
+	uint32 OverlapsScalar(const JPH::AABox& inBox) const
+	{
+		uint32 mask = 0;
+		for (int ray = 0; ray < mNum; ++ray)
+		{
+			float t_enter = 0;
+			float t_exit = mMaxFraction[ray];
+			SlabScalar(mOriginX[ray], mInvX[ray], mParallelX[ray], inBox.mMin.GetX(), inBox.mMax.GetX(), t_enter, t_exit);
+			SlabScalar(mOriginY[ray], mInvY[ray], mParallelY[ray], inBox.mMin.GetY(), inBox.mMax.GetY(), t_enter, t_exit);
+			SlabScalar(mOriginZ[ray], mInvZ[ray], mParallelZ[ray], inBox.mMin.GetZ(), inBox.mMax.GetZ(), t_enter, t_exit);
+			mask |= static_cast<uint32>(t_enter <= t_exit) << ray;
+		}
+		return mask;
+	}
+
+private:
+	//same cutoff jolt's RayInvDirection uses.
+	static void SetAxis(int inRay, float inOrigin, float inDirection, float* outOrigin, float* outInv, uint32* outParallel)
+	{
+		const bool parallel = FMath::Abs(inDirection) <= 1.0e-20f;
+		outOrigin[inRay] = inOrigin;
+		outInv[inRay] = parallel ? 0.0f : 1.0f / inDirection;
+		outParallel[inRay] = parallel ? 0xffffffffu : 0u;
+	}
+
+	static JPH::Vec4 Load(const float* inLanes, int inFirst)
+	{
+		return JPH::Vec4::sLoadFloat4Aligned(reinterpret_cast<const JPH::Float4*>(inLanes + inFirst));
+	}
+
+	static JPH::UVec4 LoadMask(const uint32* inLanes, int inFirst)
+	{
+		return JPH::UVec4::sLoadInt4Aligned(inLanes + inFirst);
+	}
+
+	//a ray parallel to an axis can't enter or leave that slab. it's either inside the whole way, or never.
+	static void Slab(JPH::Vec4Arg inOrigin, JPH::Vec4Arg inInv, JPH::UVec4Arg inParallel, JPH::Vec4Arg inMin, JPH::Vec4Arg inMax, JPH::Vec4& ioNear, JPH::Vec4& ioFar)
+	{
+		const JPH::Vec4 t1 = (inMin - inOrigin) * inInv;
+		const JPH::Vec4 t2 = (inMax - inOrigin) * inInv;
+		const JPH::UVec4 inside = JPH::UVec4::sAnd(JPH::Vec4::sGreaterOrEqual(inOrigin, inMin), JPH::Vec4::sLessOrEqual(inOrigin, inMax));
+		const JPH::Vec4 open_near = JPH::Vec4::sSelect(JPH::Vec4::sReplicate(FLT_MAX), JPH::Vec4::sReplicate(-FLT_MAX), inside);
+		const JPH::Vec4 open_far = JPH::Vec4::sSelect(JPH::Vec4::sReplicate(-FLT_MAX), JPH::Vec4::sReplicate(FLT_MAX), inside);
+		ioNear = JPH::Vec4::sMax(ioNear, JPH::Vec4::sSelect(JPH::Vec4::sMin(t1, t2), open_near, inParallel));
+		ioFar = JPH::Vec4::sMin(ioFar, JPH::Vec4::sSelect(JPH::Vec4::sMax(t1, t2), open_far, inParallel));
+	}
+
+	static void SlabScalar(float inOrigin, float inInv, uint32 inParallel, float inMin, float inMax, float& ioNear, float& ioFar)
+	{
+		if (inParallel)
+		{
+			const bool inside = inOrigin >= inMin && inOrigin <= inMax;
+			ioNear = FMath::Max(ioNear, inside ? -FLT_MAX : FLT_MAX);
+			ioFar = FMath::Min(ioFar, inside ? FLT_MAX : -FLT_MAX);
+			return;
+		}
+		const float t1 = (inMin - inOrigin) * inInv;
+		const float t2 = (inMax - inOrigin) * inInv;
+		ioNear = FMath::Max(ioNear, FMath::Min(t1, t2));
+		ioFar = FMath::Min(ioFar, FMath::Max(t1, t2));
+	}
+
+	alignas(16) float mOriginX[MaxRays];
+	alignas(16) float mOriginY[MaxRays];
+	alignas(16) float mOriginZ[MaxRays];
+	alignas(16) float mInvX[MaxRays];
+	alignas(16) float mInvY[MaxRays];
+	alignas(16) float mInvZ[MaxRays];
+	alignas(16) uint32 mParallelX[MaxRays];
+	alignas(16) uint32 mParallelY[MaxRays];
+	alignas(16) uint32 mParallelZ[MaxRays];
+	alignas(16) float mMaxFraction[MaxRays];
+	JPH::AABox mBounds;
+	JPH::OrientedBox mOriented;
+	bool mOrientedIsTighter = false;
+	int mNum = 0;
+	int mLanes = 0;
+};
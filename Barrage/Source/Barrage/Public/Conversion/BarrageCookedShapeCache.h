@@ -0,0 +1,66 @@
+﻿// Copyright 2026 Oversized Sun Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IsolatedJoltIncludes.h"
+#include "Hash/xxhash.h"
+
+class UBodySetup;
+
+namespace Chaos
+{
+	class FImplicitObject;
+}
+
+namespace Barrage::Conversion
+{
+	/**
+	 * Converting collision is most of what a big level load spends its time on. Every static mesh instance used to run
+	 * UnrealBodySetupToJolt and then Create, which rebuilds the mesh BVH from scratch, even when the last hundred
+	 * instances were the same mesh and the last hundred loads were the same level.
+	 *
+	 * This sits in front of the conversion and hands out finished shapes instead of settings. Shapes are keyed by a hash
+	 * of the source geometry (the aggregate elements, the trimesh vertex and index buffers, the heightfield samples)
+	 * plus the conversion cvars and a format version, so an edited mesh or a changed cvar is just a different key.
+	 * In memory, every instance of a mesh gets the same shape until the world goes; UBarrageDispatch::Deinitialize resets
+	 * the cache. On disk, shapes are saved with Jolt's SaveWithChildren under Saved/DerivedDataCache/Barrage and restored
+	 * with sRestoreWithChildren next time, BVH and all.
+	 *
+	 * Nothing ever deletes old files. They're content addressed, so the worst a stale one does is take up space.
+	 *
+	 * Safe from any thread. Two threads asking for the same new shape at once may both build it; only one gets kept.
+	 */
+	class BARRAGE_API FCookedShapeCache
+	{
+	public:
+		static FCookedShapeCache& Get();
+
+		// Same arguments as UnrealBodySetupToJolt. Empty (not an error) when there was nothing to convert.
+		JPH::ShapeSettings::ShapeResult BodySetupToJoltShape(const UBodySetup* UnrealBodySetup,
+		                                                     bool bSimpleCollision = true,
+		                                                     bool bComplexCollision = false,
+		                                                     bool bIgnoreTransform = false);
+
+		// Same as ConvertChaosGeoToJoltBody. Geometry we don't know how to hash still converts, it just isn't cached.
+		JPH::ShapeSettings::ShapeResult ChaosGeoToJoltShape(const Chaos::FImplicitObject& ChaosGeo);
+
+		int32 Num() const;
+		// Drops the in-memory shapes. Bodies holding them keep them alive, and the disk cache is left alone.
+		void Reset();
+
+		FString CacheDirectory() const;
+		// Points the disk cache somewhere else, or back at the default when empty. Not thread safe: set it before
+		// anything converts.
+		void SetCacheDirectory(const FString& Directory);
+
+	private:
+		JPH::ShapeSettings::ShapeResult FindOrBuild(const FXxHash128& Key, TFunctionRef<JPH::ShapeSettings*()> Convert);
+		JPH::Ref<JPH::Shape> LoadFromDisk(const FXxHash128& Key) const;
+		void SaveToDisk(const FXxHash128& Key, const JPH::Shape& Shape) const;
+
+		mutable FRWLock Lock;
+		TMap<FXxHash128, JPH::Ref<JPH::Shape>> Shapes;
+		FString DirectoryOverride;
+	};
+}
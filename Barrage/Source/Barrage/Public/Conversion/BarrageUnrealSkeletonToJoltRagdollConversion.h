@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "IsolatedJoltIncludes.h"
+#include "Jolt/Physics/Ragdoll/Ragdoll.h"
 
 namespace JPH {
 	class SkeletonPose;
@@ -11,6 +13,8 @@ namespace JPH {
 	class Skeleton;
 }
 
+class FBarrageRagdollPool;
+
 namespace Barrage::Conversion {
 	
 	/**
@@ -18,12 +22,50 @@ namespace Barrage::Conversion {
 	 * @return a RagdollSettings that can be used to create ragdoll bodies with constraints. Also stores a jolt skeleton
 	 * @todo we might want to split off making a jolt skeleton from the ragdoll just in case
 	 * You are responsible for storing this pointer safely (It is recommended to use jolt's JPH::Ref<JPH::RagdollSettings> as a simple shared ptr)
+	 * This always converts. Unless you need a private copy to mess with, you want FindOrCreateJoltRagdollSettings.
 	 */
 	BARRAGE_API JPH::RagdollSettings* CreateJoltRagdollSettingsFromUnrealSkeleton(TNotNull<const USkeleton*> InUnrealSkeleton,
 	                                                                              TNotNull<const UPhysicsAsset*> InUnrealPhysAsset);
 
-	BARRAGE_API JPH::Ragdoll* ExampleCreateJoltRagdollFromUnrealSkeleton(JPH::PhysicsSystem& PhysicsSystem,
+	/**
+	 * A finished ragdoll conversion: stabilized, parent/child collisions already off, ready for CreateRagdoll.
+	 * Shared by everything using the same skeleton and physics asset, so treat the settings as read only.
+	 */
+	struct FJoltRagdollConversion {
+		JPH::Ref<JPH::RagdollSettings> Settings;
+		// The unreal bone each jolt joint came from, by joint index. Posing goes through these instead of joint names.
+		TArray<FName> JointBoneNames;
+	};
+
+	/**
+	 * One conversion per (skeleton, physics asset) pair, made the first time anyone asks. A wave of deaths is one
+	 * conversion and a lot of lookups. nullptr if the pair doesn't convert (and we'll try again next time, loudly).
+	 * Game thread. If you edit a physics asset in the editor, reset the cache or you'll keep getting the old one.
+	 */
+	BARRAGE_API TSharedPtr<const FJoltRagdollConversion> FindOrCreateJoltRagdollSettings(TNotNull<const USkeleton*> InUnrealSkeleton,
+	                                                                                     TNotNull<const UPhysicsAsset*> InUnrealPhysAsset);
+	BARRAGE_API void ResetJoltRagdollSettingsCache();
+	// Drops conversions whose skeleton or physics asset has been unloaded since. Nobody can ask for those again.
+	BARRAGE_API void PruneJoltRagdollSettingsCache();
+
+	/**
+	 * Fills OutPose with the component's current bone transforms, in world space, for the conversion's skeleton.
+	 * @return false if the component doesn't have the bones the conversion expects
+	 */
+	BARRAGE_API bool PoseJoltRagdollFromComponent(const FJoltRagdollConversion& Conversion,
+	                                              TNotNull<const USkeletalMeshComponent*> InUnrealSkeletalMeshComponent,
+	                                              JPH::SkeletonPose& OutPose);
+
+	/**
+	 * Posed from the component, out of Pool if it has a spare. Hold on to the ref, since dropping the last one frees
+	 * the ragdoll's bodies, and hand it back with ReleaseJoltRagdoll when you're done with it.
+	 */
+	BARRAGE_API JPH::Ref<JPH::Ragdoll> ExampleCreateJoltRagdollFromUnrealSkeleton(JPH::PhysicsSystem& PhysicsSystem,
+	                                                                     FBarrageRagdollPool& Pool,
 																		 TNotNull<const USkeletalMeshComponent*> InUnrealSkeletalMeshComponent,
 	                                                                     TNotNull<const USkeleton*> InUnrealSkeleton,
 	                                                                     TNotNull<const UPhysicsAsset*> InUnrealPhysAsset);
+
+	// Back into the pool, and the conversion cache gets pruned while we're at it. Same thread as the pool.
+	BARRAGE_API void ReleaseJoltRagdoll(FBarrageRagdollPool& Pool, JPH::Ragdoll* Ragdoll);
 }
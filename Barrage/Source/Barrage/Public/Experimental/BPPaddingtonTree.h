@@ -4,27 +4,23 @@
 
 #pragma once
 #include "IsolatedJoltIncludes.h"
-#include "FlattenedBodyBox.h"
 #include "PaddingtonTree.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 JPH_NAMESPACE_BEGIN
-	/// Fast SIMD based quad tree BroadPhase that is multithreading aware and tries to do a minimal amount of locking.
-	/// This variation uses a precomputed adaptive top node, triple buffers, and prefetches.
+	/// Broadphase that is multithreading aware and tries to do a minimal amount of locking, built for worlds with very large
+	/// numbers of small moving bodies. One PaddingtonTree per broadphase layer, see PaddingtonTree.h for how those work.
+	/// Select it per world with EBarrageBroadPhase, see FWorldSimOwner.
 	/// It's called a Paddington Tree because that's my dog's name.
 	/// It's not actually a cool backronym. Sorry. I just love my dog.
 	// ReSharper disable once CppClassNeedsConstructorBecauseOfUninitializedMember
 	// adds layer-count monomorphism, allowing signficantly more elegant tree handling.
 	template <uint32_t mNumLayers>
-	class JPH_EXPORT BPPaddingtonTree final : public BroadPhase
+	class BPPaddingtonTree final : public BroadPhase
 	{
 	public:
 		JPH_OVERRIDE_NEW_DELETE
 
-
-		using NodeBlob = std::vector<BodyBoxFlatCopy>;
-		/// Destructor
-
 	private:
 		/// Helper struct for AddBodies handle
 		struct LayerState
@@ -34,85 +30,78 @@ JPH_NAMESPACE_BEGIN
 			BodyID* mBodyStart = nullptr;
 			BodyID* mBodyEnd;
 			PaddingtonTree::AddState mAddState;
-			std::shared_ptr<NodeBlob> mBodies;
-			//switch to pool once that's in place and use something like = NodeBlob(1024)); with ya boy the blind alloc
 		};
 
 		using Tracking = PaddingtonTree::Tracking;
 		using TrackingVector = PaddingtonTree::TrackingVector;
 
+#ifdef JPH_ENABLE_ASSERTS
+		/// Context used to lock a physics lock
+		PhysicsLockContext mLockContext = nullptr;
+#endif // JPH_ENABLE_ASSERTS
+
 		/// Max amount of bodies we support
 		size_t mMaxBodies = 0;
 
-		/// Array that for each BodyID keeps track of where it is located in which tree
+		/// Array that for each BodyID keeps track of where it is located in which tree, and its bounds as of the last change
 		TrackingVector mTracking;
 
-		/// Node allocator for all trees
-		/// Paddington trees take care of their own node pooling for reasons that will become obvious.
-		//PaddingtonTree::Allocator mAllocator;
-
 		/// Information about broad phase layers
 		const BroadPhaseLayerInterface* mBroadPhaseLayerInterface = nullptr;
 
-		/// One tree per object layer. Update swaps. Rather than locking queries for update or framesync, we allow a query to hold
-		/// a ref per the holdopen pattern used throughout barrage and artillery. this is _significantly_ faster.
-		std::shared_ptr<PaddingtonTree> mLayers[mNumLayers];
+		/// One tree per broadphase layer. Each double buffers itself, and we hold the retired buffer open until FrameSync
+		/// the same way the quadtree holds its old nodes.
+		PaddingtonTree mLayers[mNumLayers];
 
-		/// UpdateState implementation for this tree used during UpdatePrepare/Finalize()
+		/// UpdateState implementation for this tree used during UpdatePrepare/Finalize(). Every dirty layer rebuilds in
+		/// the same update, so they all swap together under one query lock flip.
 		struct UpdateStateImpl
 		{
-			PaddingtonTree* mTree;
-			PaddingtonTree::UpdateState mUpdateState;
+			uint32 mUpdatedLayers;
 		};
 
 		static_assert(sizeof(UpdateStateImpl) <= sizeof(UpdateState));
 		static_assert(alignof(UpdateStateImpl) <= alignof(UpdateState));
+		static_assert(mNumLayers <= 32, "UpdateStateImpl tracks updated layers in a 32 bit mask");
 
 		/// Mutex that prevents object modification during UpdatePrepare/Finalize()
 		SharedMutex mUpdateMutex;
 
-		/// We double buffer all trees so that we can query while building the next one and we destroy the old tree the next physics update.
-		/// This structure ensures that we wait for queries that are still using the old tree.
+		/// We double buffer all trees so that we can query while building the next one and we release the old buffer the next physics update.
+		/// This structure ensures that we wait for queries that are still using the old buffer.
 		mutable SharedMutex mQueryLocks[2];
 
 		/// This index indicates which lock is currently active, it alternates between 0 and 1
 		atomic<uint32> mQueryLockIdx{0};
 
-		/// This is the next tree to update in UpdatePrepare()
-		uint32 mNextLayerToUpdate = 0;
-		bool RequireFull = false;
-
-public:
-		// THE HEART OF THE CLASS, FOLKS
-		// implement Broadphase Interface
-		virtual ~BPPaddingtonTree() override
-		{
-		}
-
-		virtual void Init(BodyManager* inBodyManager,
-		                  const BroadPhaseLayerInterface& inLayerInterface) override
+	public:
+		virtual void Init(BodyManager* inBodyManager, const BroadPhaseLayerInterface& inLayerInterface) override
 		{
 			BroadPhase::Init(inBodyManager, inLayerInterface);
 
 			// Store input parameters
 			mBroadPhaseLayerInterface = &inLayerInterface;
-			
+			JPH_ASSERT(inLayerInterface.GetNumBroadPhaseLayers() == mNumLayers);
+
+#ifdef JPH_ENABLE_ASSERTS
+			// Store lock context
+			mLockContext = inBodyManager;
+#endif // JPH_ENABLE_ASSERTS
+
 			// Store max bodies
 			mMaxBodies = inBodyManager->GetMaxBodies();
 
 			// Initialize tracking data
 			mTracking.resize(mMaxBodies);
-			// We use double the amount of nodes while rebuilding the tree during Update()
 
 			// Init sub trees
-			mLayers = new PaddingtonTree [mNumLayers];
-			for (uint l = 0; l < mNumLayers; ++l)
+			for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
 			{
-				mLayers[l].Init(); //trees share an allocator, which is _very bad_ for memory locality.
+				mLayers[l].Init(l, uint32(mMaxBodies));
 
 #if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
-		// Set the name of the layer
-		mLayers[l].SetName(inLayerInterface.GetBroadPhaseLayerName(BroadPhaseLayer(BroadPhaseLayer::Type(l))));
+				// Set the name of the layer
+				mLayers[l].SetName(inLayerInterface.GetBroadPhaseLayerName(BroadPhaseLayer(l)));
 #endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
 			}
 		}
@@ -120,39 +109,43 @@ public:
 		virtual void FrameSync() override
 		{
 			JPH_PROFILE_FUNCTION();
-			
-			UniqueLock root_lock(
-				mQueryLocks[mQueryLockIdx ^ 1]
-				JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseQuery));
+
+			// Take a unique lock on the old query lock so that we know no one is using the old buffers anymore.
+			// Same rules as BroadPhaseQuadTree::FrameSync, nothing else may be locked here.
+			UniqueLock root_lock(mQueryLocks[mQueryLockIdx ^ 1] JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseQuery));
 
 			for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
 				mLayers[l].DiscardOldTree();
 		}
 
-		//this is paired with the artillery busy worker, which always optimizes once every 128 ticks, and never while a step is running.
-		//you may need to revisit guarantees here around memory allocators or you'll probably get EFFED in the allocator. 
-		virtual void BPPaddingtonTree::Optimize() override
+		//bulk static import (AddPendingStaticGeometry) and the periodic optimize in StepWorld both land here. never while a step is running.
+		virtual void Optimize() override
 		{
 			JPH_PROFILE_FUNCTION();
 
+			// Free the previous buffers so we can build new ones
 			FrameSync();
 
 			LockModifications();
 
-			for (uint l = 0; l < mNumLayers; ++l)
+			bool updated = false;
+			for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
 			{
 				PaddingtonTree& tree = mLayers[l];
-				if (tree.HasBodies())
+				if (tree.HasBodies() || tree.IsDirty())
 				{
-					PaddingtonTree::UpdateState update_state;
-					tree.UpdatePrepare(mBodyManager->GetBodies(), mTracking, update_state, true);
-					tree.UpdateFinalize(mBodyManager->GetBodies(), mTracking, update_state);
+					tree.UpdatePrepare(mTracking, true);
+					tree.UpdateFinalize();
+					updated = true;
 				}
 			}
+			if (updated)
+				mQueryLockIdx = mQueryLockIdx ^ 1;
 
 			UnlockModifications();
 
-			mNextLayerToUpdate = 0;
+			// Free the buffers from before the optimize
+			FrameSync();
 		}
 
 		virtual void LockModifications() override
@@ -169,30 +162,20 @@ public:
 			// Create update state
 			UpdateState update_state;
 			UpdateStateImpl* update_state_impl = reinterpret_cast<UpdateStateImpl*>(&update_state);
+			update_state_impl->mUpdatedLayers = 0;
 
-			// Loop until we've seen all layers
-			for (uint iteration = 0; iteration < mNumLayers; ++iteration)
+			// Unlike the quadtree we rebuild every dirty layer each step. A rebuild is mostly an insertion sort over
+			// nearly sorted entries, and letting the slack on a busy layer pile up for a few steps costs more than that.
+			for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
 			{
-				// Get the layer
-				PaddingtonTree& tree = mLayers[mNextLayerToUpdate];
-				mNextLayerToUpdate = (mNextLayerToUpdate + 1) % mNumLayers;
-
-				// If it is dirty we update this one
-				if (tree.HasBodies() && tree.IsDirty() && tree.CanBeUpdated())
+				PaddingtonTree& tree = mLayers[l];
+				if (tree.IsDirty() && tree.CanBeUpdated())
 				{
-					update_state_impl->mTree = &tree;
-					bool capture = RequireFull; //this is atomic but offers no order guarantees.
-					RequireFull = false; //we set this to false NOW but still execute the full update.
-					//this reduces the chance of a missed remove req to near zero.
-					//TODO: switch to atomic for sanity?
-					tree.UpdatePrepare(mBodyManager->GetBodies(), mTracking, update_state_impl->mUpdateState, capture);
-
-					return update_state;
+					tree.UpdatePrepare(mTracking, false);
+					update_state_impl->mUpdatedLayers |= 1u << l;
 				}
 			}
 
-			// Nothing to update
-			update_state_impl->mTree = nullptr;
 			return update_state;
 		}
 
@@ -203,11 +186,12 @@ public:
 
 			// Test if a tree was updated
 			const UpdateStateImpl* update_state_impl = reinterpret_cast<const UpdateStateImpl*>(&inUpdateState);
-			if (update_state_impl->mTree == nullptr)
+			if (update_state_impl->mUpdatedLayers == 0)
 				return;
 
-			update_state_impl->mTree->UpdateFinalize(mBodyManager->GetBodies(), mTracking,
-			                                         update_state_impl->mUpdateState);
+			for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
+				if (update_state_impl->mUpdatedLayers & (1u << l))
+					mLayers[l].UpdateFinalize();
 
 			// Make all queries from now on use the new lock
 			mQueryLockIdx = mQueryLockIdx ^ 1;
@@ -216,11 +200,10 @@ public:
 		virtual void UnlockModifications() override
 		{
 			// From this point on we allow modifications to the tree again
-			PhysicsLock::sUnlock(
-				mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+			PhysicsLock::sUnlock(mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
 		}
 
-		BroadPhase::AddState BPPaddingtonTree::AddBodiesPrepare(BodyID* ioBodies, int inNumber)
+		virtual AddState AddBodiesPrepare(BodyID* ioBodies, int inNumber) override
 		{
 			JPH_PROFILE_FUNCTION();
 
@@ -231,61 +214,50 @@ public:
 			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
 
 			LayerState* state = new LayerState [mNumLayers];
-			for (uint32_t ii = 0; ii < mNumLayers; ++ii)
-			{
-				state[ii].mBodies = std::make_shared<NodeBlob>(256);
-			}
-			// bin bodies by layer
+
+			// Sort bodies on layer
 			Body* const * const bodies_ptr = bodies.data(); // C pointer or else sort is incredibly slow in debug mode
-			BodyID *b_start = ioBodies, *b_end = ioBodies + inNumber;
-			//single pass instead of quicksort. skipping around in bodies is deadly to our perf. qs is broadly faster, but causes more cache disorder
-			//this also means we walk out with a cached version of the body data we need, and we'll only touch body manager one more time.
-			for (int i = 0; i < inNumber; ++i)
-			{
-				auto& body = bodies_ptr[ioBodies[i].GetIndexAndSequenceNumber()];
-				auto BBBWB = body->GetWorldSpaceBounds(); //boundingbox body:worldspace bounds. okay, okay, sorry.
-				auto Cent = BBBWB.GetCenter();
-				auto Extt = BBBWB.GetExtent();
-				auto shadow = BodyBoxFlatCopy(Cent.GetX(), Cent.GetY(), Cent.GetZ(),
-				                              Extt.GetX() + 1, Extt.GetY() + 1, Extt.GetZ() + 1,
-				                              body->GetObjectLayer(),
-				                              body->IsKinematic(),
-				                              body->IsDynamic(),
-				                              body->IsSensor(),
-				                              body->IsRigidBody(),
-				                              body->IsStatic(),
-				                              body->IsActive(),
-				                              body->GetCollideKinematicVsNonDynamic(),
-				                              ioBodies[i]);
-				state[shadow.layer].mBodies->push_back(shadow);
-			}
+			QuickSort(ioBodies, ioBodies + inNumber, [bodies_ptr](BodyID inLHS, BodyID inRHS) { return bodies_ptr[inLHS.GetIndex()]->GetBroadPhaseLayer() < bodies_ptr[inRHS.GetIndex()]->GetBroadPhaseLayer(); });
 
-			for (uint32_t shadow = 0; shadow < mNumLayers; ++shadow)
+			BodyID *b_start = ioBodies, *b_end = ioBodies + inNumber;
+			while (b_start < b_end)
 			{
 				// Get broadphase layer
-				if (state[shadow].mBodies->size() > 0)
-				{
-					LayerState& layer_state = state[shadow];
-					// Keep track of state for this layer
+				BroadPhaseLayer::Type broadphase_layer = (BroadPhaseLayer::Type)bodies[b_start->GetIndex()]->GetBroadPhaseLayer();
+				JPH_ASSERT(broadphase_layer < mNumLayers);
 
-					// Insert all bodies of the same layer
-					//mLayers[shadow].AddBodiesPrepare(bodies, mTracking, b_start, int(b_mid - b_start), layer_state.mAddState);
+				// Find first body with different layer
+				BodyID* b_mid = std::upper_bound(b_start, b_end, broadphase_layer, [bodies_ptr](BroadPhaseLayer::Type inLayer, BodyID inBodyID) { return inLayer < (BroadPhaseLayer::Type)bodies_ptr[inBodyID.GetIndex()]->GetBroadPhaseLayer(); });
 
-					// Keep track in which tree we placed the object
-					for (auto& b : *(state[shadow].mBodies))
-					{
-						uint32 index = b.meta.GetIndex();
-						Tracking& t = mTracking[index];
-						t.mBroadPhaseLayer = shadow;
-						t.mObjectLayer = bodies[index]->GetObjectLayer();
-					}
+				// Keep track of state for this layer
+				LayerState& layer_state = state[broadphase_layer];
+				layer_state.mBodyStart = b_start;
+				layer_state.mBodyEnd = b_mid;
+
+				// Record bounds for all bodies of the same layer
+				mLayers[broadphase_layer].AddBodiesPrepare(bodies, mTracking, b_start, int(b_mid - b_start), layer_state.mAddState);
+
+				// Keep track in which tree we placed the object
+				for (const BodyID* b = b_start; b < b_mid; ++b)
+				{
+					uint32 index = b->GetIndex();
+					JPH_ASSERT(bodies[index]->GetID() == *b, "Provided BodyID doesn't match BodyID in body manager");
+					JPH_ASSERT(!bodies[index]->IsInBroadPhase());
+					Tracking& t = mTracking[index];
+					JPH_ASSERT(t.mBroadPhaseLayer == (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid);
+					t.mBroadPhaseLayer = broadphase_layer;
+					JPH_ASSERT(t.mObjectLayer == cObjectLayerInvalid);
+					t.mObjectLayer = bodies[index]->GetObjectLayer();
 				}
+
+				// Repeat
+				b_start = b_mid;
 			}
 
 			return state;
 		}
 
-		void BPPaddingtonTree::AddBodiesFinalize(BodyID* ioBodies, int inNumber, AddState inAddState)
+		virtual void AddBodiesFinalize(BodyID* ioBodies, int inNumber, AddState inAddState) override
 		{
 			JPH_PROFILE_FUNCTION();
 
@@ -296,8 +268,6 @@ public:
 			}
 
 			// This cannot run concurrently with UpdatePrepare()/UpdateFinalize()
-			//todo: switch this to a try lock with a thread safe fallback. that will allow us to isolate our memory allocations
-			//which means we can switch to a brute-stupid memory allocation solution like the threadblind alloc for extreme speed.
 			SharedLock lock(mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
 
 			BodyVector& bodies = mBodyManager->GetBodies();
@@ -317,8 +287,7 @@ public:
 					for (const BodyID* b = l.mBodyStart; b < l.mBodyEnd; ++b)
 					{
 						uint32 index = b->GetIndex();
-						JPH_ASSERT(bodies[index]->GetID() == *b,
-						           "Provided BodyID doesn't match BodyID in body manager");
+						JPH_ASSERT(bodies[index]->GetID() == *b, "Provided BodyID doesn't match BodyID in body manager");
 						JPH_ASSERT(mTracking[index].mBroadPhaseLayer == broadphase_layer);
 						JPH_ASSERT(mTracking[index].mObjectLayer == bodies[index]->GetObjectLayer());
 						JPH_ASSERT(!bodies[index]->IsInBroadPhase());
@@ -330,20 +299,88 @@ public:
 			delete [] state;
 		}
 
-		void BPPaddingtonTree::AddBodiesAbort(BodyID* ioBodies, int inNumber, AddState inAddState)
+		virtual void AddBodiesAbort(BodyID* ioBodies, int inNumber, AddState inAddState) override
 		{
-			throw; //absolutely not. just remove them like a normal human, for the love of god.
+			JPH_PROFILE_FUNCTION();
+
+			if (inNumber <= 0)
+			{
+				JPH_ASSERT(inAddState == nullptr);
+				return;
+			}
+
+			LayerState* state = (LayerState*)inAddState;
+
+			for (BroadPhaseLayer::Type broadphase_layer = 0; broadphase_layer < mNumLayers; broadphase_layer++)
+			{
+				const LayerState& l = state[broadphase_layer];
+				if (l.mBodyStart != nullptr)
+				{
+					mLayers[broadphase_layer].AddBodiesAbort(mTracking, l.mAddState);
+
+					// Reset bookkeeping
+					for (const BodyID* b = l.mBodyStart; b < l.mBodyEnd; ++b)
+					{
+						Tracking& t = mTracking[b->GetIndex()];
+						JPH_ASSERT(t.mBroadPhaseLayer == broadphase_layer);
+						t.mBroadPhaseLayer = (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid;
+						t.mObjectLayer = cObjectLayerInvalid;
+					}
+				}
+			}
+
+			delete [] state;
 		}
 
-		//TODO: just lie less?
-		void BPPaddingtonTree::RemoveBodies(BodyID* ioBodies, int inNumber)
+		virtual void RemoveBodies(BodyID* ioBodies, int inNumber) override
 		{
 			JPH_PROFILE_FUNCTION();
 
-			RequireFull = true; // we DO NOT manually remove things. I lied above.
+			if (inNumber <= 0)
+				return;
+
+			// This cannot run concurrently with UpdatePrepare()/UpdateFinalize()
+			SharedLock lock(mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+
+			BodyVector& bodies = mBodyManager->GetBodies();
+			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
+
+			// Sort bodies on layer
+			Tracking* tracking = mTracking.data(); // C pointer or else sort is incredibly slow in debug mode
+			QuickSort(ioBodies, ioBodies + inNumber, [tracking](BodyID inLHS, BodyID inRHS) { return tracking[inLHS.GetIndex()].mBroadPhaseLayer < tracking[inRHS.GetIndex()].mBroadPhaseLayer; });
+
+			BodyID *b_start = ioBodies, *b_end = ioBodies + inNumber;
+			while (b_start < b_end)
+			{
+				// Get broad phase layer
+				BroadPhaseLayer::Type broadphase_layer = tracking[b_start->GetIndex()].mBroadPhaseLayer;
+				JPH_ASSERT(broadphase_layer != (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid);
+
+				// Find first body with different layer
+				BodyID* b_mid = std::upper_bound(b_start, b_end, broadphase_layer, [tracking](BroadPhaseLayer::Type inLayer, BodyID inBodyID) { return inLayer < tracking[inBodyID.GetIndex()].mBroadPhaseLayer; });
+
+				// Remove all bodies of the same layer
+				mLayers[broadphase_layer].RemoveBodies(mTracking, b_start, int(b_mid - b_start));
+
+				for (const BodyID* b = b_start; b < b_mid; ++b)
+				{
+					// Reset bookkeeping
+					uint32 index = b->GetIndex();
+					Tracking& t = tracking[index];
+					t.mBroadPhaseLayer = (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid;
+					t.mObjectLayer = cObjectLayerInvalid;
+
+					// Mark removed from broadphase
+					JPH_ASSERT(bodies[index]->IsInBroadPhase());
+					bodies[index]->SetInBroadPhaseInternal(false);
+				}
+
+				// Repeat
+				b_start = b_mid;
+			}
 		}
 
-		void BPPaddingtonTree::NotifyBodiesAABBChanged(BodyID* ioBodies, int inNumber, bool inTakeLock)
+		virtual void NotifyBodiesAABBChanged(BodyID* ioBodies, int inNumber, bool inTakeLock) override
 		{
 			JPH_PROFILE_FUNCTION();
 
@@ -352,8 +389,7 @@ public:
 
 			// This cannot run concurrently with UpdatePrepare()/UpdateFinalize()
 			if (inTakeLock)
-				PhysicsLock::sLockShared(
-					mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+				PhysicsLock::sLockShared(mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
 			else
 				JPH_ASSERT(mUpdateMutex.is_locked());
 
@@ -362,7 +398,7 @@ public:
 
 			// Sort bodies on layer
 			const Tracking* tracking = mTracking.data(); // C pointer or else sort is incredibly slow in debug mode
-			//QuickSort(ioBodies, ioBodies + inNumber, [tracking](BodyID inLHS, BodyID inRHS) { return tracking[inLHS.GetIndex()].mBroadPhaseLayer < tracking[inRHS.GetIndex()].mBroadPhaseLayer; });
+			QuickSort(ioBodies, ioBodies + inNumber, [tracking](BodyID inLHS, BodyID inRHS) { return tracking[inLHS.GetIndex()].mBroadPhaseLayer < tracking[inRHS.GetIndex()].mBroadPhaseLayer; });
 
 			BodyID *b_start = ioBodies, *b_end = ioBodies + inNumber;
 			while (b_start < b_end)
@@ -372,11 +408,7 @@ public:
 				JPH_ASSERT(broadphase_layer != (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid);
 
 				// Find first body with different layer
-				BodyID* b_mid = std::upper_bound(b_start, b_end, broadphase_layer,
-				                                 [tracking](BroadPhaseLayer::Type inLayer, BodyID inBodyID)
-				                                 {
-					                                 return inLayer < tracking[inBodyID.GetIndex()].mBroadPhaseLayer;
-				                                 });
+				BodyID* b_mid = std::upper_bound(b_start, b_end, broadphase_layer, [tracking](BroadPhaseLayer::Type inLayer, BodyID inBodyID) { return inLayer < tracking[inBodyID.GetIndex()].mBroadPhaseLayer; });
 
 				// Notify all bodies of the same layer changed
 				mLayers[broadphase_layer].NotifyBodiesAABBChanged(bodies, mTracking, b_start, int(b_mid - b_start));
@@ -386,25 +418,55 @@ public:
 			}
 
 			if (inTakeLock)
-				PhysicsLock::sUnlockShared(
-					mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+				PhysicsLock::sUnlockShared(mUpdateMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::BroadPhaseUpdate));
 		}
 
-		void BPPaddingtonTree::NotifyBodiesLayerChanged(BodyID* ioBodies, int inNumber)
+		virtual void NotifyBodiesLayerChanged(BodyID* ioBodies, int inNumber) override
 		{
-			//this is no longer supported.
-			throw;
+			JPH_PROFILE_FUNCTION();
+
+			if (inNumber <= 0)
+				return;
+
+			// First sort the bodies that actually changed layer to beginning of the array
+			const BodyVector& bodies = mBodyManager->GetBodies();
+			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
+			for (BodyID* body_id = ioBodies + inNumber - 1; body_id >= ioBodies; --body_id)
+			{
+				uint32 index = body_id->GetIndex();
+				JPH_ASSERT(bodies[index]->GetID() == *body_id, "Provided BodyID doesn't match BodyID in body manager");
+				const Body* body = bodies[index];
+				BroadPhaseLayer::Type broadphase_layer = (BroadPhaseLayer::Type)body->GetBroadPhaseLayer();
+				JPH_ASSERT(broadphase_layer < mNumLayers);
+				if (mTracking[index].mBroadPhaseLayer == broadphase_layer)
+				{
+					// Update tracking information
+					mTracking[index].mObjectLayer = body->GetObjectLayer();
+
+					// Move the body to the end, layer didn't change
+					std::swap(*body_id, ioBodies[inNumber - 1]);
+					--inNumber;
+				}
+			}
+
+			if (inNumber > 0)
+			{
+				// Changing layer requires us to remove from one tree and add to another, so this is equivalent to removing all bodies first and then adding them again
+				RemoveBodies(ioBodies, inNumber);
+				AddState add_state = AddBodiesPrepare(ioBodies, inNumber);
+				AddBodiesFinalize(ioBodies, inNumber, add_state);
+			}
 		}
 
-		void BPPaddingtonTree::CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
-		                               const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
-		                               const ObjectLayerFilter& inObjectLayerFilter) const
+		virtual void CastRay(const RayCast& inRay, RayCastBodyCollector& ioCollector,
+		                     const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
+		                     const ObjectLayerFilter& inObjectLayerFilter) const override
 		{
 			JPH_PROFILE_FUNCTION();
 
 			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
 
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			// Loop over all layers and test the ones that could hit
@@ -421,15 +483,15 @@ public:
 			}
 		}
 
-		void BPPaddingtonTree::CollideAABox(const AABox& inBox, CollideShapeBodyCollector& ioCollector,
-		                                    const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
-		                                    const ObjectLayerFilter& inObjectLayerFilter) const
+		virtual void CollideAABox(const AABox& inBox, CollideShapeBodyCollector& ioCollector,
+		                          const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
+		                          const ObjectLayerFilter& inObjectLayerFilter) const override
 		{
 			JPH_PROFILE_FUNCTION();
 
 			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
 
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			// Loop over all layers and test the ones that could hit
@@ -446,15 +508,15 @@ public:
 			}
 		}
 
-		void BPPaddingtonTree::CollideSphere(Vec3Arg inCenter, float inRadius, CollideShapeBodyCollector& ioCollector,
-		                                     const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
-		                                     const ObjectLayerFilter& inObjectLayerFilter) const
+		virtual void CollideSphere(Vec3Arg inCenter, float inRadius, CollideShapeBodyCollector& ioCollector,
+		                           const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
+		                           const ObjectLayerFilter& inObjectLayerFilter) const override
 		{
 			JPH_PROFILE_FUNCTION();
 
 			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
 
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			// Loop over all layers and test the ones that could hit
@@ -479,7 +541,7 @@ public:
 
 			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
 
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			// Loop over all layers and test the ones that could hit
@@ -504,7 +566,7 @@ public:
 
 			JPH_ASSERT(mMaxBodies == mBodyManager->GetMaxBodies());
 
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			// Loop over all layers and test the ones that could hit
@@ -547,7 +609,7 @@ public:
 		                       const BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 		                       const ObjectLayerFilter& inObjectLayerFilter) const override
 		{
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			CastAABoxNoLock(inBox, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
@@ -568,7 +630,7 @@ public:
 
 			// Sort bodies on layer
 			const Tracking* tracking = mTracking.data(); // C pointer or else sort is incredibly slow in debug mode
-			//QuickSort(ioActiveBodies, ioActiveBodies + inNumActiveBodies, [tracking](BodyID inLHS, BodyID inRHS) { return tracking[inLHS.GetIndex()].mObjectLayer < tracking[inRHS.GetIndex()].mObjectLayer; });
+			QuickSort(ioActiveBodies, ioActiveBodies + inNumActiveBodies, [tracking](BodyID inLHS, BodyID inRHS) { return tracking[inLHS.GetIndex()].mObjectLayer < tracking[inRHS.GetIndex()].mObjectLayer; });
 
 			BodyID *b_start = ioActiveBodies, *b_end = ioActiveBodies + inNumActiveBodies;
 			while (b_start < b_end)
@@ -578,21 +640,16 @@ public:
 				JPH_ASSERT(object_layer != cObjectLayerInvalid);
 
 				// Find first body with different layer
-				BodyID* b_mid = std::upper_bound(b_start, b_end, object_layer,
-				                                 [tracking](ObjectLayer inLayer, BodyID inBodyID)
-				                                 {
-					                                 return inLayer < tracking[inBodyID.GetIndex()].mObjectLayer;
-				                                 });
+				BodyID* b_mid = std::upper_bound(b_start, b_end, object_layer, [tracking](ObjectLayer inLayer, BodyID inBodyID) { return inLayer < tracking[inBodyID.GetIndex()].mObjectLayer; });
 
 				// Loop over all layers and test the ones that could hit
 				for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
 				{
 					const PaddingtonTree& tree = mLayers[l];
-					if (tree.HasBodies() && inObjectVsBroadPhaseLayerFilter.ShouldCollide(
-						object_layer, BroadPhaseLayer(l)))
+					if (tree.HasBodies() && inObjectVsBroadPhaseLayerFilter.ShouldCollide(object_layer, BroadPhaseLayer(l)))
 					{
 						JPH_PROFILE(tree.GetName());
-						tree.FindCollidingPairs(bodies, b_start, int(b_mid - b_start), inSpeculativeContactDistance,
+						tree.FindCollidingPairs(bodies, mTracking, b_start, int(b_mid - b_start), inSpeculativeContactDistance,
 						                        ioPairCollector, inObjectLayerPairFilter);
 					}
 				}
@@ -604,16 +661,15 @@ public:
 
 		virtual AABox GetBounds() const override
 		{
-			// Prevent this from running in parallel with node deletion in FrameSync(), see notes there
+			// Prevent this from running in parallel with the buffer release in FrameSync(), see notes there
 			shared_lock lock(mQueryLocks[mQueryLockIdx]);
 
 			AABox bounds;
 			for (BroadPhaseLayer::Type l = 0; l < mNumLayers; ++l)
-				bounds.Encapsulate(mLayers[l].GetBounds());
+				bounds.Encapsulate(mLayers[l].GetBounds(mTracking));
 			return bounds;
 		}
 	};
-template class BPPaddingtonTree<JOLT::BroadPhaseLayers::NUM_LAYERS>;
 
 typedef BPPaddingtonTree<JOLT::BroadPhaseLayers::NUM_LAYERS> MMBP_PaddingtonTree;
 JPH_NAMESPACE_END
@@ -141,7 +141,7 @@ public:
 		{
 			if (IHaveAPool && INTERNAL_ARENA) // if I think I have a pool and I still hold a strong ref to the arena
 			{
-				memset(ForMemsetClear, 0, PoolSize);
+				memset(ForMemsetClear, 0, cell_alloc.Size);
 			}
 		}
 
@@ -166,11 +166,25 @@ public:
 			ForMemsetClear = cell_alloc.InitialPool;//we don't use it but we do save it.
 		}
 
+		//what Build will ask the pool for at this DataSize, plus room for the tlsf's own bookkeeping.
+		static size_t PoolBytesFor(uint64_t DataSize)
+		{
+			const size_t Needed = num_rows * std::max<uint64_t>(DataSize, 1) * sizeof(CellType) + table_width * sizeof(IndexType);
+			return Needed + Needed / 8 + (1 << 20);
+		}
+
+		//whether RegenerateTheFLESH(DataSize) still fits in the pool this was born with. the pool never grows.
+		bool Fits(uint64_t DataSize) const
+		{
+			return PoolBytesFor(DataSize) <= cell_alloc.Size;
+		}
+
 		//when flesh is destroyed, it memsets the pool but DOES NOT DESTROY IT unless you discard that out param.
 		//it will do the right thing either way, functionally.
+		//the pool is PoolSize, or bigger if DataSize needs it. past about 350k bounding boxes, it does.
 		FLESH(uint64_t DataSize, Arena& OUT_PARAM_ARENALIFECYCLE)
 			: cells_per_row(std::max(DataSize, 1ull)), //c'mon. man.
-			  cell_alloc(PoolSize)
+			  cell_alloc(static_cast<uint32_t>(std::max(PoolSize, PoolBytesFor(DataSize))))
 		{
 			INTERNAL_ARENA = cell_alloc.Init();
 			total_points_added = 0;
@@ -427,6 +441,301 @@ public:
 			ApplyBehaviorAndQuery<QueryBehavior>(hashes, top_k, num_queries, A);
 		}
 	};
+
+	//FLESH never modifies itself, which is lovely right up until everything that moves has to be rehashed every tick.
+	//DeltaFLESH keeps one full build around and only rehashes what actually changed:
+	//	- entries whose cell key matches last time are skipped without even being embedded.
+	//	- entries that embed to the same voxels as last time kept their sketch, so they're skipped too.
+	//	- everything else gets hashed once, into a side FLESH with its own arena, and its copy in the main build goes stale.
+	//Every MergeEvery commits, or sooner if the side gets big, the main build is redone from the sketches we kept and the
+	//side is emptied. A merge never hashes anything, and hashing is most of what a rebuild costs.
+	//
+	//Ids belong to the owner. Keep them stable and fairly dense, they index a vector. Touch, Remove, Reset and Commit
+	//belong to one thread. Queries see whatever the last Commit published, without locking, with the same two ticks of
+	//slack the FLESH broadphase has always had.
+	template <uint32_t PointsPerEntry>
+	class DeltaFLESH
+	{
+	public:
+		enum class ETouch : uint8_t
+		{
+			Skipped, //same cell key. never embedded.
+			KeptSketch, //embedded to the same voxels.
+			Rehashed, //moved to the side.
+			Added
+		};
+
+		uint32_t MergeEvery = 8;
+		uint32_t Seed = 0x1bead;
+
+		//call with a point batch of PointsPerEntry, which it fills in. only called when the cell key changed.
+		template <class EmbedFunction>
+		ETouch Touch(uint32_t Id, uint64_t CellKey, EmbedFunction&& Embed)
+		{
+			if (Id >= Slots.size())
+			{
+				Slots.resize(Id + 1);
+			}
+			Slot& Entry = Slots[Id];
+			const bool bAdded = !Entry.bLive;
+			if (!bAdded && Entry.CellKey == CellKey)
+			{
+				return ETouch::Skipped;
+			}
+			Entry.CellKey = CellKey;
+			FLESHPoint Points[PointsPerEntry];
+			Embed(Points);
+			if (!bAdded && memcmp(Entry.Voxels, Points, sizeof(Points)) == 0)
+			{
+				return ETouch::KeptSketch;
+			}
+			memcpy(Entry.Voxels, Points, sizeof(Points));
+			for (uint32_t Point = 0; Point < PointsPerEntry; ++Point)
+			{
+				alt_dense_hash(Entry.Hashes[Point].Blob, Points[Point]);
+			}
+			if (bAdded)
+			{
+				Entry.bLive = true;
+				++LiveCount;
+			}
+			if (!Entry.bInSide)
+			{
+				Entry.bInSide = true;
+				++SideCount;
+				MarkStale(Entry);
+			}
+			return bAdded ? ETouch::Added : ETouch::Rehashed;
+		}
+
+		void Remove(uint32_t Id)
+		{
+			if (Id >= Slots.size() || !Slots[Id].bLive)
+			{
+				return;
+			}
+			Slot& Entry = Slots[Id];
+			MarkStale(Entry);
+			SideCount -= Entry.bInSide;
+			--LiveCount;
+			Entry = Slot();
+		}
+
+		//forgets every sketch, so the next Touch of each id embeds and hashes from scratch. for when the embedding itself
+		//changes underneath us. the next Commit merges.
+		void Reset()
+		{
+			Slots.clear();
+			Stale.clear();
+			LiveCount = 0;
+			SideCount = 0;
+			bForceMerge = true;
+		}
+
+		//publishes everything touched since the last Commit. true if it merged.
+		bool Commit()
+		{
+			std::shared_ptr<View> Next = std::make_shared<View>();
+			const bool bMerge = bForceMerge || ++CommitsSinceMerge >= MergeEvery || SideCount * 4 > LiveCount;
+			if (bMerge)
+			{
+				FLESH& Target = Regenerate(Mains, MainArenas, MainFlip, LiveCount);
+				std::shared_ptr<std::vector<uint32_t>> Ids = std::make_shared<std::vector<uint32_t>>();
+				Ids->reserve(LiveCount);
+				for (uint32_t Id = 0; Id < Slots.size(); ++Id)
+				{
+					Slot& Entry = Slots[Id];
+					if (Entry.bLive)
+					{
+						Entry.MainPosition = static_cast<uint32_t>(Ids->size());
+						Entry.bInSide = false;
+						Target.addFoldedHashedPoints(Entry.Hashes, PointsPerEntry, Seed);
+						Ids->push_back(Id);
+					}
+				}
+				Stale.assign((Ids->size() + 63) / 64, 0);
+				SideCount = 0;
+				CommitsSinceMerge = 0;
+				bForceMerge = false;
+				Next->Main = Mains[MainFlip];
+				Next->MainIds = Ids;
+			}
+			else
+			{
+				Next->Main = Front->Main;
+				Next->MainIds = Front->MainIds;
+				if (SideCount > 0)
+				{
+					//the side is small, so it's simplest to just redo it from the kept sketches every commit.
+					FLESH& Target = Regenerate(Sides, SideArenas, SideFlip, SideCount);
+					Next->SideIds.reserve(SideCount);
+					for (uint32_t Id = 0; Id < Slots.size(); ++Id)
+					{
+						Slot& Entry = Slots[Id];
+						if (Entry.bLive && Entry.bInSide)
+						{
+							Target.addFoldedHashedPoints(Entry.Hashes, PointsPerEntry, Seed);
+							Next->SideIds.push_back(Id);
+						}
+					}
+					Next->Side = Sides[SideFlip];
+				}
+			}
+			Next->Stale = Stale;
+			Front = Next;
+			return bMerge;
+		}
+
+		uint64_t Num() const
+		{
+			return LiveCount;
+		}
+
+		uint64_t NumInSide() const
+		{
+			return SideCount;
+		}
+
+		//same shapes as FLESH's queries, but the results are ids, not positions.
+		template <class QueryBehavior>
+		bool query_byob(HashBlob* hashes, size_t queries, uint32_t top_k, QueryBehavior& Behavior) const
+		{
+			const std::shared_ptr<View> Pin = Front;
+			if (!Pin || !Pin->Main)
+			{
+				return false;
+			}
+			Translated<QueryBehavior> FromMain(Behavior, *Pin->MainIds, Pin->Stale.empty() ? nullptr : Pin->Stale.data());
+			Pin->Main->query_byob(hashes, queries, top_k, FromMain);
+			if (Pin->Side)
+			{
+				Translated<QueryBehavior> FromSide(Behavior, Pin->SideIds, nullptr);
+				Pin->Side->query_byob(hashes, queries, top_k, FromSide);
+			}
+			return true;
+		}
+
+		std::vector<uint32_t> query(HashBlob* hashes, size_t queries, uint32_t top_k) const
+		{
+			std::vector<uint32_t> results;
+			return query_byoa(hashes, queries, top_k, results);
+		}
+
+		std::vector<uint32_t> query(HashBlob& hash, uint32_t top_k) const
+		{
+			return query(&hash, 1, top_k);
+		}
+
+		std::vector<uint32_t> query_byoa(HashBlob* hashes, size_t queries, uint32_t top_k,
+		                                 std::vector<uint32_t>& results) const
+		{
+			typename FLESH::DefaultBehavior Collect(results);
+			query_byob(hashes, queries, top_k, Collect);
+			return results;
+		}
+
+		std::vector<HashBlob> getHashes(std::vector<FLESHPoint> data, uint32_t seed) const
+		{
+			std::vector<HashBlob> result(data.size());
+			for (size_t point_id = 0; point_id < data.size(); ++point_id)
+			{
+				alt_dense_hash(result[point_id].Blob, data[point_id]);
+			}
+			return result;
+		}
+
+		std::array<HashBlob, 2> get2Hashes(FLESHPoint* data, uint32_t seed) const
+		{
+			std::array<HashBlob, 2> result = {};
+			alt_dense_hash(result[0].Blob, data[0]);
+			alt_dense_hash(result[1].Blob, data[1]);
+			return result;
+		}
+
+	private:
+		struct Slot
+		{
+			uint64_t CellKey = 0;
+			FLESHPoint Voxels[PointsPerEntry] = {};
+			HashBlob Hashes[PointsPerEntry] = {};
+			uint32_t MainPosition = UINT32_MAX;
+			bool bLive = false;
+			bool bInSide = false;
+		};
+
+		//what one Commit published. never touched again once it's out.
+		struct View
+		{
+			std::shared_ptr<FLESH> Main;
+			std::shared_ptr<const std::vector<uint32_t>> MainIds;
+			//a bit per main position, set once that copy has moved to the side or been removed.
+			std::vector<uint64_t> Stale;
+			std::shared_ptr<FLESH> Side;
+			std::vector<uint32_t> SideIds;
+		};
+
+		//FLESH hands back positions in the order things were added. this turns them into ids and drops the stale ones.
+		template <class Inner>
+		struct Translated
+		{
+			Inner& In;
+			const std::vector<uint32_t>& Ids;
+			const uint64_t* StaleBits;
+			HashBlob hash = {};
+
+			Translated(Inner& inInner, const std::vector<uint32_t>& inIds, const uint64_t* inStale)
+				: In(inInner), Ids(inIds), StaleBits(inStale)
+			{
+			}
+
+			bool AttemptAdd(uint32_t Position)
+			{
+				if (Position >= Ids.size() || (StaleBits && (StaleBits[Position / 64] >> (Position % 64)) & 1))
+				{
+					return false;
+				}
+				return In.AttemptAdd(Ids[Position]);
+			}
+		};
+
+		void MarkStale(const Slot& Entry)
+		{
+			if (Entry.MainPosition != UINT32_MAX)
+			{
+				Stale[Entry.MainPosition / 64] |= 1ull << (Entry.MainPosition % 64);
+			}
+		}
+
+		//flips to the other buffer, so the one the last View holds is left alone, and grows it if it can't hold Entries.
+		FLESH& Regenerate(std::shared_ptr<FLESH> (&Buffers)[2], typename FLESH::Arena (&Arenas)[2], uint8_t& Flip,
+		                  uint64_t Entries)
+		{
+			Flip ^= 1;
+			const uint64_t DataSize = std::max<uint64_t>(Entries, 1) * PointsPerEntry;
+			if (!Buffers[Flip] || !Buffers[Flip]->Fits(DataSize))
+			{
+				//half again as much, so a world that grows slowly doesn't reallocate every merge.
+				Buffers[Flip] = std::make_shared<FLESH>(DataSize + DataSize / 2, Arenas[Flip]);
+			}
+			Buffers[Flip]->RegenerateTheFLESH(DataSize);
+			return *Buffers[Flip];
+		}
+
+		std::vector<Slot> Slots;
+		std::vector<uint64_t> Stale;
+		uint64_t LiveCount = 0;
+		uint64_t SideCount = 0;
+		uint32_t CommitsSinceMerge = 0;
+		bool bForceMerge = true;
+
+		std::shared_ptr<View> Front;
+		std::shared_ptr<FLESH> Mains[2];
+		std::shared_ptr<FLESH> Sides[2];
+		typename FLESH::Arena MainArenas[2];
+		typename FLESH::Arena SideArenas[2];
+		uint8_t MainFlip = 0;
+		uint8_t SideFlip = 0;
+	};
 };
 
 PRAGMA_POP_PLATFORM_DEFAULT_PACKING
@@ -19,15 +19,24 @@ JPH_NAMESPACE_BEGIN
 //But at the moment, we actually just beat them to death with by using very high values for topk results, AND filtering for collision earlier
 //than usual. We're able to do this by taking shadow copies of just about everything.
 //
-//Currently, we don't support collision groups. This is pretty bad, I'll be straight with you, but we also don't use them yet. Adding them would be
-//as simple as either adding them to the shadowing struct we use for bodies, but it'd be better to keep a lookup table of all the groups as refs
-//and then add a flyweight link into that index to the shadow struct. With some care, this is actually MORE likely to stay cache hot, as the collision group
-//data structure is 16 bytes and currently, the entire shadow is only 24. going with the flyweight makes it 32b, so at least two are fetched during a cache prefetch on
-//most machines. Fetching two means that you almost never get a cache miss when doing forward iteration, and this is a huge performance improvement.
+//Collision groups ride along as a flyweight. Every UpdateFinalize, alongside the shadows, we build a table of the distinct
+//groups in play, and each shadow carries an index into it. Slot 0 is the empty group, which is nearly everything. That
+//takes the shadow from 24b to 32b, which is still two to a cache line fill. Groups get checked while we verify LSH
+//candidates in FindCollidingPairs, before any pair reaches the narrowphase. Queries don't filter on groups, same as
+//every other jolt broadphase.
+//
+//The LSH itself is kept incrementally, in a DeltaFLESH. Shadows live at their body's index, and that index is the id we
+//hand the LSH, so a body that hasn't crossed a cell since last tick costs a compare instead of a rehash. MaxExtent feeds
+//the embedding, so it's frozen between rebuilds. When the world outgrows it, it grows by half again and everything is
+//rehashed once.
+//
+//FleshBroadPhase is the one you want. CollisionGroupUnaware_FleshBroadPhase keeps the 24b shadow for worlds that
+//know they'll never use groups. Pick it per world with EBarrageBroadPhase.
 //
 //It may be possible to condense the collision groups significantly. if so, then you're HooOooOooome free. good luck with that, future Jake.
 //--JMK
-	class CollisionGroupUnaware_FleshBroadPhase : public JPH::BroadPhase
+	template <bool CollisionGroupAware>
+	class TFleshBroadPhase : public JPH::BroadPhase
 	{
 		static inline constexpr uint32_t DefaultMaxAllowedHitsPerCast = 2048;
 		static inline constexpr float AllowedAddedScanRangeMult = 3;
@@ -70,7 +79,9 @@ JPH_NAMESPACE_BEGIN
 		};
 		*/
 	public:
-		using BodyBoxSafeShadow = BodyBoxFlatCopy;
+		using BodyBoxSafeShadow = std::conditional_t<CollisionGroupAware, BodyBoxGroupedCopy, BodyBoxFlatCopy>;
+		//every distinct group in the world at the last UpdateFinalize. shadows index into this, and 0 is the empty group.
+		using GroupTable = std::vector<CollisionGroup>;
 
 
 		JPH_OVERRIDE_NEW_DELETE
@@ -80,6 +91,7 @@ JPH_NAMESPACE_BEGIN
 		void TestInvokeBuild();
 		using EMBED = Embedder<2>;
 		using FLESH = EMBED::FLESH;
+		using DELTA = EMBED::DeltaFLESH<PointsPerBB>;
 		using NodeBlob = std::vector<BodyBoxSafeShadow>;
 		/// Handle used during adding bodies to the broadphase
 		using AddState = void*;
@@ -146,24 +158,55 @@ JPH_NAMESPACE_BEGIN
 		                             const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter,
 		                             const JPH::ObjectLayerFilter& inObjectLayerFilter) const override;
 		virtual JPH::AABox GetBounds() const override;
-		void GenerateBBHashes(float oldM, FLESHPoint* Batch,
-		                      std::vector<CollisionGroupUnaware_FleshBroadPhase::BodyBoxSafeShadow>::value_type& body);
-		virtual ~CollisionGroupUnaware_FleshBroadPhase() override;
+		void GenerateBBHashes(float oldM, FLESHPoint* Batch, BodyBoxSafeShadow& body);
+		virtual ~TFleshBroadPhase() override;
 
 	private:
+		struct GroupKey
+		{
+			const GroupFilter* Filter;
+			CollisionGroup::GroupID Group;
+			CollisionGroup::SubGroupID SubGroup;
+
+			bool operator==(const GroupKey& inRHS) const
+			{
+				return Filter == inRHS.Filter && Group == inRHS.Group && SubGroup == inRHS.SubGroup;
+			}
+		};
+
+		struct GroupKeyHash
+		{
+			uint64 operator()(const GroupKey& inKey) const
+			{
+				return HashCombineArgs(inKey.Filter, inKey.Group, inKey.SubGroup);
+			}
+		};
+
+		using GroupLookup = UnorderedMap<GroupKey, uint32, GroupKeyHash>;
+		static BodyBoxSafeShadow MakeShadow(const Body& inBody, float inExpandBy);
+		static uint32 GroupIndexOf(const CollisionGroup& inGroup, GroupLookup& ioLookup, GroupTable& ioTable);
+		//same key, same sketch. whole meters, same as the sizes.
+		static uint64 CellKeyOf(const BodyBoxSafeShadow& inShadow);
+
 		//may need to macro this out for full platform support...
 		//oh c++, never change*
 		//no, seriously, please don't break ABI compatibility.
 		//*as of C++20. even 11 is barely a usable language.
-		FLESH::Arena ArenaFront = nullptr;
-		FLESH::Arena ArenaBack = nullptr;
-		std::shared_ptr<FLESH> LSH = std::make_shared<FLESH>((1024), ArenaFront);
-		std::shared_ptr<FLESH> LSHShadow = std::make_shared<FLESH>((1024), ArenaBack);
+		//keeps its own double buffers and arenas.
+		std::shared_ptr<DELTA> LSH = std::make_shared<DELTA>();
+		//how many shadow slots the lsh saw last rebuild, so it can forget any that fell off the end.
+		uint32_t LastBodyCount = 0;
 		//we'll need to come back and roll these to a proper blob alloc.
-		//and probably swap to LockFreeHashMap or allocation optimized hashmap. but for now, let's just get this thing WORKING
-		std::shared_ptr<NodeBlob> mBodies = std::make_shared<NodeBlob>(NodeBlob(1024));
-		std::shared_ptr<NodeBlob> mBodiesShadow = std::make_shared<NodeBlob>(NodeBlob(1024));
+		//indexed by body index. slots with no body in the broadphase have an invalid meta.
+		std::shared_ptr<NodeBlob> mBodies = std::make_shared<NodeBlob>();
+		std::shared_ptr<NodeBlob> mBodiesShadow = std::make_shared<NodeBlob>();
+		//swapped with mBodies, so a pinned pair of them always agree.
+		std::shared_ptr<GroupTable> mGroups = std::make_shared<GroupTable>(1);
+		std::shared_ptr<GroupTable> mGroupsShadow = std::make_shared<GroupTable>(1);
 	};
 
+	using CollisionGroupUnaware_FleshBroadPhase = TFleshBroadPhase<false>;
+	using FleshBroadPhase = TFleshBroadPhase<true>;
+
 	PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 JPH_NAMESPACE_END
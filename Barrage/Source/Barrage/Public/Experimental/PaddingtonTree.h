@@ -4,7 +4,6 @@
 
 #pragma once
 #include "IsolatedJoltIncludes.h"
-#include "PaddingtonDetail.h"
 #include <Jolt/Core/NonCopyable.h>
 #include <Jolt/Physics/Body/BodyManager.h>
 #include <Jolt/Physics/Collision/BroadPhase/BroadPhase.h>
@@ -13,17 +12,16 @@
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 JPH_NAMESPACE_BEGIN
-#define HOW_MANY_OBJECTS_DO_YOU_REALLY_NEED_GUYS 600000
 	///
 	/// remember when I said this wasn't an acronym?
 	/// It's not, but it is actually a pretty useful mnemonic. these are basically very esoteric rtrees, in a sense.
-	/// This is a parallel add-only tree built out of padded grid-tries of nvoxels.
+	/// This is a parallel add-mostly tree built out of padded grid-tries of nvoxels.
 	///
-	/// Parallel Add Only
-	/// The paddington tree only supports add, but supports add in smooth parallel using a swap-swap approach and reserve bit tricks.
-	/// As a result, removes trigger a rebuild. because we tick so fast, removes are actually rare relative to the number of steps, though they tend
-	/// to come in bursts as waves of bullets hit or objects unload in groups. As a result, a rebuild-on-remove policy made sense.
-	/// allowing remove was basically going to add 3 months, and I have a game to make. Honestly, I'm only making this because I'm sad about my dog.
+	/// Parallel Add Mostly
+	/// Adds go in smooth parallel using a swap-swap approach and reserve bit tricks. The first cut only supported add and rebuilt on
+	/// every remove, but removes come in bursts as waves of bullets hit or objects unload in groups, and that hurt more than expected.
+	/// Removes and moves are now done in place on the current buffer, and the sort gets fixed up at the next rebuild. See what actually
+	/// shipped, below. Honestly, I'm only making this because I'm sad about my dog.
 	/// 
 	/// Grid Trie
 	/// Each node of a paddington tree is a 256^K grid of voxels dividing a cube of space. An object or subnode is an AABB over this grid,
@@ -62,104 +60,58 @@ JPH_NAMESPACE_BEGIN
 	/// workloads at the moment. We use a tick-linked hold-open pattern for query and lifecycle management instead.
 	/// The backing memory is pooled, and we DO NOT call destructors for anything allocated into it. You have been warned.
 	/// We may switch to a fixed allocator, but being able to use stl
+	///
+	/// WHAT ACTUALLY SHIPPED
+	/// The voxel node format above is still where this is going, but it never got past the drawing board, so what's in here
+	/// right now is the layer-level machinery with a much dumber inside. Each tree is two buffers of padded boxes sorted on
+	/// their min along whichever axis the bodies spread out on most. A single sorted axis falls over on the flat, wide worlds we
+	/// actually have, where a query's slab along one axis holds a few hundred bodies, so the entries are first cut into strips
+	/// along the second most spread out axis and only sorted inside those. A query binary searches the three or four strips it
+	/// touches, then walks a short run of 32 byte entries in each. That's about as cache friendly as it gets short of the voxels.
+	///
+	/// Moves write the new padded box into the entry where it sits, and only do that when the body leaves its padding. The
+	/// order goes a little stale when that happens, so each buffer tracks how far any entry has drifted from its sort key
+	/// or strip (slack), and sweeps widen by that much. Adds go on a lock-free pending list that everyone brute forces until the next
+	/// rebuild. Removes just kill the entry where it sits. The next UpdatePrepare sorts live entries and pending adds into the
+	/// other buffer, which is mostly an insertion sort because last tick's order is nearly right. UpdateFinalize flips which
+	/// buffer is current, and the old one is held open until FrameSync, same as the quadtree, so queries in flight never
+	/// see it change underneath them.
+	///
+	/// A handful of very large bodies (landscape, big static meshes) would wreck the sweep window, so at rebuild anything far
+	/// wider than the usual body goes into a short list that gets brute forced instead.
 
 	class JPH_EXPORT PaddingtonTree : public NonCopyable
 	{
 	public:
 		JPH_OVERRIDE_NEW_DELETE
 
-	private:
-		// Forward declare
-		using AtomicNodeID = PDTH::AtomicNodeID; //we can drop these.
-		using Node = PDTH::Node;
-		using RootNode = PDTH::RootNode;
-		using Allocator = PDTH::Allocator;
-
-		uint32 num_leaves = (uint32)(HOW_MANY_OBJECTS_DO_YOU_REALLY_NEED_GUYS + 1) / 2; // Assume 50% fill
-		uint32 num_leaves_plus_internal_nodes = num_leaves + (num_leaves + 2) / 3;
-
-		/// Class that points to either a body or a node in the tree
-		class NodeID
+		/// Float3 whose components are relaxed atomics, for boxes that a move rewrites while queries are reading them. A
+		/// reader can get some components from before the write and some from after, but never half of a float.
+		struct RelaxedFloat3
 		{
-		public:
-			JPH_OVERRIDE_NEW_DELETE
-
-			/// Default constructor does not initialize
-			inline NodeID() = default;
-
-			/// Construct a node ID
-			static inline NodeID sInvalid() { return NodeID(cInvalidNodeIndex); }
-
-			static inline NodeID sFromBodyID(BodyID inID)
+			RelaxedFloat3() = default;
+			RelaxedFloat3(const Float3& inRHS)								{ Store(inRHS); }
+			RelaxedFloat3(const RelaxedFloat3& inRHS)						{ Store(inRHS.Load()); }
+			RelaxedFloat3& operator = (const RelaxedFloat3& inRHS)			{ Store(inRHS.Load()); return *this; }
+
+			JPH_INLINE float operator [] (int inIndex) const				{ return mComponents[inIndex].load(memory_order_relaxed); }
+			JPH_INLINE Float3 Load() const									{ return Float3((*this)[0], (*this)[1], (*this)[2]); }
+			JPH_INLINE void Store(const Float3& inValue)
 			{
-				NodeID node_id(inID.GetIndexAndSequenceNumber());
-				JPH_ASSERT(node_id.IsBody());
-				return node_id;
+				mComponents[0].store(inValue.x, memory_order_relaxed);
+				mComponents[1].store(inValue.y, memory_order_relaxed);
+				mComponents[2].store(inValue.z, memory_order_relaxed);
 			}
-
-			static inline NodeID sFromNodeIndex(uint32 inIdx)
+			JPH_INLINE void Store(Vec3Arg inValue)
 			{
-				JPH_ASSERT((inIdx & cIsNode) == 0);
-				return NodeID(inIdx | cIsNode);
+				Float3 value;
+				inValue.StoreFloat3(&value);
+				Store(value);
 			}
 
-			/// Check what type of ID it is
-			inline bool IsValid() const { return mID != cInvalidNodeIndex; }
-			inline bool IsBody() const { return (mID & cIsNode) == 0; }
-			inline bool IsNode() const { return (mID & cIsNode) != 0; }
-
-			/// Get body or node index
-			inline BodyID GetBodyID() const
-			{
-				JPH_ASSERT(IsBody());
-				return BodyID(mID);
-			}
-
-			inline uint32 GetNodeIndex() const
-			{
-				JPH_ASSERT(IsNode());
-				return mID & ~cIsNode;
-			}
-
-			/// Comparison
-			inline bool operator ==(const BodyID& inRHS) const { return mID == inRHS.GetIndexAndSequenceNumber(); }
-			inline bool operator ==(const NodeID& inRHS) const { return mID == inRHS.mID; }
-
-		private:
-			friend class AtomicNodeID;
-
-			inline explicit NodeID(uint32 inID) : mID(inID)
-			{
-			}
-
-			static const uint32 cIsNode = BodyID::cBroadPhaseBit;
-			///< If this bit is set it means that the ID refers to a node, otherwise it refers to a body
-
-			uint32 mID;
+			atomic<float> mComponents[3];
 		};
 
-		static_assert(sizeof(NodeID) == sizeof(BodyID), "Body id's should have the same size as NodeIDs");
-	
-
-		// Maximum size of the stack during tree walk
-		static constexpr int cStackSize = 128;
-
-		static_assert(sizeof(atomic<float>) == 4, "Assuming that an atomic doesn't add any additional storage");
-		static_assert(sizeof(atomic<uint32>) == 4, "Assuming that an atomic doesn't add any additional storage");
-		static_assert(std::is_trivially_destructible<Node>(), "Assuming that we don't have a destructor");
-
-	public:
-		//As trees click into and out of existence, once they saturate their root node, we will create a giant pool allocator for them.
-		//Generally, we'll give each tree either 8 or 16 megs of memory, because memory is incredibly cheap now, and RAM's a big advantage
-		//when you're picking CPU over GPU. Note that these are SEPARATE from the jolt temp allocator AND separate from each other.
-		//And they are large. I want to be clear. I know that number looks scary. Tuning it downward is an exercise in pain.
-		//As a result of the size of these memory slabs, the BPPaddingtonTree owns the process of pooling the pools.
-		//Generally, it will go ahead and grab 8 upfront. Why 8? 64 megs of ram is the biggest number people don't flinch at.
-		//I'd go bigger if I thought anyone would still use my library. Meh. --JMK
-		
-
-		RootNode Self;
-
 		/// Data to track location of a Body in the tree
 		struct Tracking
 		{
@@ -168,7 +120,10 @@ JPH_NAMESPACE_BEGIN
 
 			Tracking(const Tracking& inRHS) : mBroadPhaseLayer(inRHS.mBroadPhaseLayer.load()),
 			                                  mObjectLayer(inRHS.mObjectLayer.load()),
-			                                  mBodyLocation(inRHS.mBodyLocation.load())
+			                                  mBodyLocation(inRHS.mBodyLocation.load()),
+			                                  mBodyID(inRHS.mBodyID.load()),
+			                                  mBoundsMin(inRHS.mBoundsMin),
+			                                  mBoundsMax(inRHS.mBoundsMax)
 			{
 			}
 
@@ -177,11 +132,52 @@ JPH_NAMESPACE_BEGIN
 
 			atomic<BroadPhaseLayer::Type> mBroadPhaseLayer = (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid;
 			atomic<ObjectLayer> mObjectLayer = cObjectLayerInvalid;
+			/// Slot in the current buffer of the tree, or'd with cPendingBit or cHugeBit when it's not in the sorted entries
 			atomic<uint32> mBodyLocation{cInvalidBodyLocation};
+			/// Full id of the body for as long as it's in the broadphase. Held open buffers check their entries against this.
+			atomic<uint32> mBodyID{BodyID::cInvalidBodyID};
+			/// World space bounds as of the last add or aabb change. Queries test against these, not the padded entry.
+			/// These are exact, so a mix of two boxes would be wrong, and they sit behind a sequence lock instead.
+			void SetBounds(const AABox& inBounds)
+			{
+				// One writer per body at a time, jolt never adds or moves the same body from two threads at once
+				const uint32 sequence = mBoundsSequence.load(memory_order_relaxed);
+				mBoundsSequence.store(sequence + 1, memory_order_relaxed);
+				atomic_thread_fence(memory_order_release);
+				mBoundsMin.Store(inBounds.mMin);
+				mBoundsMax.Store(inBounds.mMax);
+				mBoundsSequence.store(sequence + 2, memory_order_release);
+			}
+			void GetBounds(Float3& outMin, Float3& outMax) const
+			{
+				for (;;)
+				{
+					const uint32 sequence = mBoundsSequence.load(memory_order_acquire);
+					outMin = mBoundsMin.Load();
+					outMax = mBoundsMax.Load();
+					atomic_thread_fence(memory_order_acquire);
+					if ((sequence & 1) == 0 && mBoundsSequence.load(memory_order_relaxed) == sequence)
+						return;
+				}
+			}
+			AABox GetBounds() const
+			{
+				Float3 min, max;
+				GetBounds(min, max);
+				return AABox(Vec3(min), Vec3(max));
+			}
+
+			atomic<uint32> mBoundsSequence{0};
+			RelaxedFloat3 mBoundsMin{Float3(0, 0, 0)};
+			RelaxedFloat3 mBoundsMax{Float3(0, 0, 0)};
 		};
 
 		using TrackingVector = Array<Tracking>;
 
+		static constexpr uint32 cPendingBit = 0x80000000;
+		static constexpr uint32 cHugeBit = 0x40000000;
+		static constexpr uint32 cSlotMask = ~(cPendingBit | cHugeBit);
+
 		/// Destructor
 		~PaddingtonTree();
 
@@ -197,50 +193,48 @@ JPH_NAMESPACE_BEGIN
 		/// Check if the tree needs an UpdatePrepare/Finalize()
 		inline bool IsDirty() const { return mIsDirty; }
 
-		/// Initialization
-		void Init(std::shared_ptr<PDTH::MemoryPoolPool> PoolAgent);
+		/// Check if this tree can get an UpdatePrepare/Finalize() or if it needs a DiscardOldTree() first
+		inline bool CanBeUpdated() const { return !mOldBufferHeld; }
 
-		struct UpdateState
-		{
-			NodeID mRootNodeID; ///< This will be the new root node id
-		};
+		/// Initialization. inMaxBodies sizes the pending lists, so it should be the body manager's max.
+		void Init(BroadPhaseLayer::Type inLayer, uint32 inMaxBodies);
 
 		/// Get the bounding box for this tree
-		AABox GetBounds() const;
+		AABox GetBounds(const TrackingVector& inTracking) const;
+
+		/// Sort the live entries and pending adds into the other buffer. Can run while queries and FindCollidingPairs run
+		/// against the current buffer, but not alongside adds, removes or aabb changes.
+		/// inFullRebuild re-pads every entry from its current bounds instead of keeping padding that still fits.
+		void UpdatePrepare(TrackingVector& ioTracking, bool inFullRebuild);
+		/// Make the buffer UpdatePrepare built current. The old one stays readable until DiscardOldTree().
+		void UpdateFinalize();
 
-		/// Update the broadphase, needs to be called regularly to achieve a tight fit of the tree when bodies have been modified.
-		/// UpdatePrepare() will build the tree, UpdateFinalize() will lock the root of the tree shortly and swap the trees and afterwards clean up temporary data structures.
-		void UpdatePrepare(const BodyVector& inBodies, TrackingVector& ioTracking, UpdateState& outUpdateState,
-		                   bool inFullRebuild);
-		void UpdateFinalize(const BodyVector& inBodies, const TrackingVector& inTracking,
-		                    const UpdateState& inUpdateState);
+		/// Release the buffer retired by the last UpdateFinalize(). Call once no query can still be using it.
+		void DiscardOldTree();
 
 		/// Temporary data structure to pass information between AddBodiesPrepare and AddBodiesFinalize/Abort
 		struct AddState
 		{
-			NodeID mLeafID = NodeID::sInvalid();
-			AABox mLeafBounds;
+			const BodyID* mBodyStart = nullptr;
 		};
 
-		/// Prepare adding inNumber bodies at ioBodyIDs to the quad tree, returns the state in outState that should be used in AddBodiesFinalize.
+		/// Prepare adding inNumber bodies at ioBodyIDs to the tree, returns the state in outState that should be used in AddBodiesFinalize.
 		/// This can be done on a background thread without influencing the broadphase.
-		/// ioBodyIDs may be shuffled around by this function.
 		void AddBodiesPrepare(const BodyVector& inBodies, TrackingVector& ioTracking, BodyID* ioBodyIDs, int inNumber,
 		                      AddState& outState);
 
-		/// Finalize adding bodies to the quadtree, supply the same number of bodies as in AddBodiesPrepare.
+		/// Finalize adding bodies to the tree, supply the same number of bodies as in AddBodiesPrepare.
 		void AddBodiesFinalize(TrackingVector& ioTracking, int inNumberBodies, const AddState& inState);
 
-		/// Abort adding bodies to the quadtree, supply the same bodies and state as in AddBodiesPrepare.
+		/// Abort adding bodies to the tree, supply the same bodies and state as in AddBodiesPrepare.
 		/// This can be done on a background thread without influencing the broadphase.
 		void AddBodiesAbort(TrackingVector& ioTracking, const AddState& inState);
 
-		/// Remove inNumber bodies in ioBodyIDs from the quadtree.
-		void RemoveBodies(const BodyVector& inBodies, TrackingVector& ioTracking, const BodyID* ioBodyIDs,
-		                  int inNumber);
+		/// Remove inNumber bodies in ioBodyIDs from the tree.
+		void RemoveBodies(TrackingVector& ioTracking, const BodyID* ioBodyIDs, int inNumber);
 
 		/// Call whenever the aabb of a body changes.
-		void NotifyBodiesAABBChanged(const BodyVector& inBodies, const TrackingVector& inTracking,
+		void NotifyBodiesAABBChanged(const BodyVector& inBodies, TrackingVector& ioTracking,
 		                             const BodyID* ioBodyIDs, int inNumber);
 
 		/// Cast a ray and get the intersecting bodies in ioCollector.
@@ -268,100 +262,88 @@ JPH_NAMESPACE_BEGIN
 		               const ObjectLayerFilter& inObjectLayerFilter, const TrackingVector& inTracking) const;
 
 		/// Find all colliding pairs between dynamic bodies, calls ioPairCollector for every pair found
-		void FindCollidingPairs(const BodyVector& inBodies, const BodyID* inActiveBodies, int inNumActiveBodies,
-		                        float inSpeculativeContactDistance, BodyPairCollector& ioPairCollector,
+		void FindCollidingPairs(const BodyVector& inBodies, const TrackingVector& inTracking, const BodyID* inActiveBodies,
+		                        int inNumActiveBodies, float inSpeculativeContactDistance,
+		                        BodyPairCollector& ioPairCollector,
 		                        const ObjectLayerPairFilter& inObjectLayerPairFilter) const;
 
-#ifdef JPH_TRACK_BROADPHASE_STATS
-	/// Sum up all the ticks spent in the various layers
-	uint64						GetTicks100Pct() const;
-
-	/// Trace the stats of this tree to the TTY
-	void						ReportStats(uint64 inTicks100Pct) const;
-#endif // JPH_TRACK_BROADPHASE_STATS
-
 	private:
-		/// Constants
-
-		static const AABox cInvalidBounds; ///< Invalid bounding box using cLargeFloat
-		static constexpr uint32 cInvalidNodeIndex = 0xffffffff; ///< Value used to indicate node index is invalid
-		/// Caches location of body inBodyID in the tracker, body can be found in mNodes[inNodeIdx].mChildNodeID[inChildIdx]
-		void GetBodyLocation(const TrackingVector& inTracking, BodyID inBodyID, uint32& outNodeIdx,
-		                     uint32& outChildIdx) const;
-		void SetBodyLocation(TrackingVector& ioTracking, BodyID inBodyID, uint32 inNodeIdx, uint32 inChildIdx) const;
-		static void sInvalidateBodyLocation(TrackingVector& ioTracking, BodyID inBodyID);
-
-		/// Get the current root of the tree
-		JPH_INLINE const RootNode& GetCurrentRoot() const { return Self; }
-		JPH_INLINE RootNode& GetCurrentRoot() { return Self; }
-
-		/// Depending on if inNodeID is a body or tree node return the bounding box
-		inline AABox GetNodeOrBodyBounds(const BodyVector& inBodies, NodeID inNodeID) const;
-
-		/// Mark node and all of its parents as changed
-		inline void MarkNodeAndParentsChanged(uint32 inNodeIndex);
-
-		/// Widen parent bounds of node inNodeIndex to encapsulate inNewBounds, also mark node and all of its parents as changed
-		inline void WidenAndMarkNodeAndParentsChanged(uint32 inNodeIndex, const AABox& inNewBounds);
-
-		/// Allocate a new node
-		inline uint32 AllocateNode(bool inIsChanged);
-
-		/// Try to insert a new leaf to the tree at inNodeIndex
-		inline bool TryInsertLeaf(TrackingVector& ioTracking, int inNodeIndex, NodeID inLeafID,
-		                          const AABox& inLeafBounds, int inLeafNumBodies);
+		/// A padded box and who it belongs to. Two of these per cache line. A move rewrites the box while queries read it,
+		/// see NotifyBodiesAABBChanged.
+		struct Entry
+		{
+			RelaxedFloat3 mMin;
+			RelaxedFloat3 mMax;
+			uint32 mBodyID;
+			ObjectLayer mObjectLayer;
+			/// Which strip of the second axis this entry was sorted into, see Buffer
+			uint16 mStrip;
+		};
 
-		/// Try to replace the existing root with a new root that contains both the existing root and the new leaf
-		inline bool TryCreateNewRoot(TrackingVector& ioTracking, atomic<uint32>& ioRootNodeIndex, NodeID inLeafID,
-		                             const AABox& inLeafBounds, int inLeafNumBodies);
+		static_assert(sizeof(Entry) <= 32, "Entries are meant to pack two to a cache line");
 
-		/// Build a tree for ioBodyIDs, returns the NodeID of the root (which will be the ID of a single body if inNumber = 1). All tree levels up to inMaxDepthMarkChanged will be marked as 'changed'.
-		NodeID BuildTree(const BodyVector& inBodies, TrackingVector& ioTracking, NodeID* ioNodeIDs, int inNumber,
-		                 uint inMaxDepthMarkChanged, AABox& outBounds);
+		/// One side of the double buffer
+		struct Buffer
+		{
+			/// Axis the entries are sorted on
+			uint mAxis = 0;
+			/// Second axis. Entries are bucketed into strips of mStripSize along it by their min, and sorted on mAxis inside each strip.
+			uint mStripAxis = 1;
+			float mStripOrigin = 0;
+			float mStripSize = FLT_MAX;
+			/// mSorted index of the first entry of each strip, plus one past the end
+			Array<uint32> mStripStarts;
+			/// mSorted[i].mMin[mAxis] as of the rebuild. Kept apart so the binary search only touches keys.
+			Array<float> mKeys;
+			Array<Entry> mSorted;
+			/// Bodies too wide to sweep. Brute forced.
+			Array<Entry> mHuge;
+			/// Widest sorted entry along each axis, grows when a move pads an entry wider.
+			atomic<float> mMaxWidth{0};
+			atomic<float> mMaxStripWidth{0};
+			/// Furthest any sorted entry's min has moved from its key, or out of its strip, since the rebuild.
+			atomic<float> mSlack{0};
+			/// Full body ids added since the rebuild, cInvalidBodyID where one got removed again.
+			atomic<uint32>* mPending = nullptr;
+			atomic<uint32> mNumPending{0};
+		};
 
-		/// Sorts ioNodeIDs spatially into 2 groups. Second groups starts at ioNodeIDs + outMidPoint.
-		/// After the function returns ioNodeIDs and ioNodeCenters will be shuffled
-		static void sPartition(NodeID* ioNodeIDs, Vec3* ioNodeCenters, int inNumber, int& outMidPoint);
+		/// How much room a body gets before a move has to touch its entry
+		static inline void sPad(Vec3Arg inMin, Vec3Arg inMax, Entry& outEntry);
 
-		/// Sorts ioNodeIDs from inBegin to (but excluding) inEnd spatially into 4 groups.
-		/// outSplit needs to be 5 ints long, when the function returns each group runs from outSplit[i] to (but excluding) outSplit[i + 1]
-		/// After the function returns ioNodeIDs and ioNodeCenters will be shuffled
-		static void sPartition4(NodeID* ioNodeIDs, Vec3* ioNodeCenters, int inBegin, int inEnd, int* outSplit);
+		/// Walk every live body of the current buffer whose tracked bounds overlap inBounds, handing its id, object layer and
+		/// bounds to inVisit, which returns false to stop the walk. Pending adds are brute forced unless the caller already
+		/// sorted them into inSortedPending (see FindCollidingPairs).
+		template <class Visit>
+		JPH_INLINE void Sweep(const AABox& inBounds, const TrackingVector& inTracking, const Array<Entry>* inSortedPending,
+		                      Visit&& inVisit) const;
 
-#ifdef JPH_DEBUG
-	/// Validate that the tree is consistent.
-	/// Note: This function only works if the tree is not modified while we're traversing it.
-	void						ValidateTree(const BodyVector &inBodies, const TrackingVector &inTracking, uint32 inNodeIndex, uint32 inNumExpectedBodies) const;
-#endif
+		/// Is this entry still the body it was written for
+		JPH_INLINE bool IsLive(uint32 inBodyID, const TrackingVector& inTracking) const;
 
-#ifdef JPH_DUMP_BROADPHASE_TREE
-	/// Dump the tree in DOT format (see: https://graphviz.org/)
-	void						DumpTree(const NodeID &inRoot, const char *inFileNamePrefix) const;
-#endif
+		JPH_INLINE const Buffer& GetCurrent() const { return mBuffers[mCurrent.load(memory_order_acquire)]; }
+		JPH_INLINE Buffer& GetCurrent() { return mBuffers[mCurrent.load(memory_order_acquire)]; }
 
-		/// Allocator that controls adding / freeing nodes
-		Allocator mAllocator;
-		std::shared_ptr<PDTH::MemoryPoolPool> mPoolAgentSP;
+		Buffer mBuffers[2];
+		atomic<uint32> mCurrent{0};
+		uint32 mMaxBodies = 0;
+		BroadPhaseLayer::Type mLayer = (BroadPhaseLayer::Type)cBroadPhaseLayerInvalid;
 
 		/// Number of bodies currently in the tree
-		/// This is aligned to be in a different cache line from the `Allocator` pointer to prevent cross-thread syncs
-		/// when reading nodes.
 		alignas(JPH_CACHE_LINE_SIZE) atomic<uint32> mNumBodies{0};
-	
-		atomic<uint32> mRootNodeIndex{0};
 
 		/// Flag to keep track of changes to the broadphase, if false, we don't need to UpdatePrepare/Finalize()
 		atomic<bool> mIsDirty = false;
-	
-
-		/// Debug function to get the depth of the tree from node inNodeID
-		uint GetMaxTreeDepth(const NodeID& inNodeID) const;
 
-		/// Walk the node tree calling the Visitor::VisitNodes for each node encountered and Visitor::VisitBody for each body encountered
-		template <class Visitor>
-		JPH_INLINE void WalkTree(const ObjectLayerFilter& inObjectLayerFilter, const TrackingVector& inTracking,
-		                         Visitor& ioVisitor JPH_IF_TRACK_BROADPHASE_STATS(, LayerToStats &ioStats)) const;
+		/// The buffer we swapped away from is still held open for queries until DiscardOldTree()
+		bool mOldBufferHeld = false;
 
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+	/// Name of this tree for debugging purposes
+	const char *				mName = "Layer";
+#endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
 	};
 
 JPH_NAMESPACE_END
+
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
@@ -4,6 +4,9 @@
 
 #include "CoordinateUtils.h"
 #include "MassByCategory.h"
+#include "SkeletonTypes.h"
+
+class UStaticMeshComponent;
 
 //The immediate question is why not use type polymorphism? This looks like THE standard example!
 //Well, meshes can't be primitives but they are shape parameters. Okay, we'll just specialize them.
@@ -110,6 +113,14 @@ struct FBTransform
 	FQuat4f GetRotationQuat() const { return Rotation; }
 };
 
+//One static mesh for a bulk import. See FWorldSimOwner::ImportStaticGeometry.
+struct FBStaticImport
+{
+	FBTransform Transform;
+	const UStaticMeshComponent* StaticMeshComponent = nullptr;
+	FSkeletonKey OutKey;
+};
+
 class FBCharParams
 {
 public:
@@ -91,6 +91,11 @@ public:
 	static void SetGravityFactor(float GravityFactor, FBLet Target);
 	//immediately sets the velocity of object to given velocity vector
 	static void SetVelocity(FVector3d Velocity, FBLet Target);
+	//non-owning variant for pointers from UBarrageDispatch::ResolveFBLets. same rules: this tick only.
+	static void SetVelocity(FVector3d Velocity, const FBarragePrimitive* Target);
+	//batched variants for swarm systems. one hold open, one feed lookup, N enqueues. null or tombstoned targets are skipped.
+	//Targets and Velocities must be the same length.
+	static void SetVelocities(TConstArrayView<FBarragePrimitive*> Targets, TConstArrayView<FVector3d> Velocities);
 	static void SetPosition(FVector Position, FBLet Target);
 	//transform forces transparently from UE world space to jolt world space
 	//then apply them directly to the "primitive"
@@ -100,6 +105,8 @@ public:
 	//transform the quaternion from the UE ref to the Jolt ref
 	//then apply it to the "primitive"
 	static void ApplyRotation(FQuat4d Rotator, FBLet Target);
+	static void ApplyRotation(FQuat4d Rotator, const FBarragePrimitive* Target);
+	static void ApplyRotations(TConstArrayView<FBarragePrimitive*> Targets, TConstArrayView<FQuat4d> Rotators);
 	//Applies any given quat as any given input to any given target. use of this is not recommended.
 	static void Apply_Unsafe(FQuat4d Any, FBLet Target, PhysicsInputType Type);
 
@@ -116,7 +123,9 @@ public:
 	template<typename OwnerType, typename QueueType> static void TryUpdateTransformFromJolt(const FBarragePrimitive* Target, JPH::BodyID PassIn, TSharedPtr<OwnerType>& GameSimHoldOpen, TSharedPtr<QueueType>& HoldOpen,  uint64 Time);
 	static FVector3f GetCentroidPossiblyStale(FBLet Target);
 	static FVector3f GetPosition(FBLet Target);
+	static FVector3f GetPosition(const FBarragePrimitive* Target);
 	static FVector3f GetVelocity(FBLet Target);
+	static FVector3f GetVelocity(const FBarragePrimitive* Target);
 
 	//in almost all cases, we recommend that you use the vector attributes, as rotation rarely actually provides
 	//the information about facing, aim point, and similar that you might want it to. this is especially true for
@@ -134,6 +143,13 @@ public:
 		return Target != nullptr && Target->tombstone == 0;
 	};
 
+	//the raw overloads exist for batch resolution, where we deliberately skip the shared pointer copy.
+	//see UBarrageDispatch::ResolveFBLets for the lifetime rules. short version: don't keep them past the tick.
+	static bool IsNotNull(const FBarragePrimitive* Target)
+	{
+		return Target != nullptr && Target->tombstone == 0;
+	};
+
 	static FVector3d UpConvertFloatVector(FVector3f InVector)
 	{
 		return FVector3d(InVector.X, InVector.Y, InVector.Z);
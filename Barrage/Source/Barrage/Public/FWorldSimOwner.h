@@ -12,8 +12,13 @@
 #include "FBPhysicsInput.h"
 #include "SkeletonTypes.h"
 #include "EPhysicsLayer.h"
-//#include "Experimental/CollisionGroupUnaware_FleshBroadPhase.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
+//#include "Experimental/FleshBroadPhase.h"
 #include "BarrageContactListener.h"
+#include "BarrageCharacterGrid.h"
+#include "BarrageCharacterShapes.h"
+#include "BarrageRagdollPool.h"
+#include "BarrageBodyTracker.h"
 #include "IsolatedJoltIncludes.h"
 
 // All Jolt symbols are in the JPH namespace
@@ -66,13 +71,26 @@ public:
 	// Calculated effective velocity after a step
 	JPH::Vec3 mEffectiveVelocity = JPH::Vec3::sZero();
 	virtual void IngestUpdate(FBPhysicsInput& input) = 0;
-	virtual void StepCharacter() = 0;
+	//the allocator is the stepping job's own. characters may step on any jolt job thread, see StepCharacters.
+	virtual void StepCharacter(JPH::TempAllocator& Allocator) = 0;
 	
 	TSharedPtr<JPH::PhysicsSystem, ESPMode::ThreadSafe> World;
 protected:
 	friend class FWorldSimOwner;
 };
 
+//Which broadphase a world runs on. Default defers to barrage.BroadPhase, so you can flip a whole session without
+//touching code. The quadtree is Jolt's own. Paddington trades a little query speed on big static worlds for cheap
+//updates when tens of thousands of small things move every tick, see Experimental/PaddingtonTree.h. FLESH is approximate
+//and eats memory, but it's built for casting rays into huge clouds of debris and projectiles, see Experimental/FleshBroadPhase.h.
+enum class EBarrageBroadPhase : uint8
+{
+	Default,
+	QuadTree,
+	PaddingtonTree,
+	Flesh
+};
+
 class BARRAGE_API FWorldSimOwner
 {
 	// If you want your code to compile using single or double precision write 0.0_r to get a Real value that compiles to double or float depending if JPH_DOUBLE_PRECISION is set or not.
@@ -86,7 +104,6 @@ public:
 	//BodyId is actually a freaking 4byte struct, so it's _worse_ potentially to have a pointer to it than just copy it.
 	TSharedPtr<KeyToBody> BarrageToJoltMapping;
 	TSharedPtr<TMap<FBarrageKey, TSharedPtr<FBCharacterBase>>> CharacterToJoltMapping;
-	//std::shared_ptr<JPH::CollisionGroupUnaware_FleshBroadPhase> mTestBroadPhase;
 	
 	 /*
 	 * 
@@ -106,9 +123,21 @@ public:
 	TSharedPtr<JPH::TempAllocatorImpl> Allocator;
 	// List of active characters in the scene so they can collide
 	//https://github.com/jrouwe/JoltPhysics/blob/e3ed3b1d33f3a0e7195fbac8b45b30f0a5c8a55b/Jolt/Physics/Character/CharacterVirtual.h#L143
-	//note this is the only extant character collision handler, and it is not very efficient since it doesn't use a BSP.
-	//This will need to go as soon as we have more than three characters or so.
-	JPH::CharacterVsCharacterCollisionSimple CharacterVsCharacterCollisionSimple;
+	//this replaced CharacterVsCharacterCollisionSimple, which was brute force. rebuilt each tick before characters step.
+	FBarrageCharacterGrid CharacterGrid;
+	//characters have never collided with each other here: the simple collider the grid replaced never had anyone added
+	//to it. the grid tracks every character regardless, since it's also what steps them. flip this before creating
+	//characters if you want crowds to push on each other.
+	bool bCharactersCollide = false;
+	FBarrageCharacterShapes CharacterShapes;
+	//dead ragdolls waiting to be reused. emptied before the physics system goes, since freeing one destroys its bodies.
+	FBarrageRagdollPool RagdollPool;
+	//who's awake, from jolt's activation callbacks, so the post-step passes only visit bodies that moved.
+	FBarrageBodyTracker BodyTracker;
+	//one per character stepping job, kept between ticks. they fall back to malloc if a step outgrows them.
+	TArray<TUniquePtr<JPH::TempAllocatorImplWithMallocFallback>> CharacterAllocators;
+	TArray<int32> CharacterIslandOrder;
+	TArray<int32> CharacterIslandStarts;
 	// Each broadphase layer results in a separate bounding volume tree in the broad phase. You at least want to have
 	// a layer for non-moving and moving objects to avoid having to update a tree full of static objects every frame.
 	// You can have a 1-on-1 mapping between object layers and broadphase layers (like in this case) but if you have
@@ -119,58 +148,16 @@ public:
 	class ObjectLayerPairFilterImpl : public JPH::ObjectLayerPairFilter
 	{
 	public:
+		//see LayerRules in LayerCollisionMatrix.h, which is where the rules live now.
 		virtual bool ShouldCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2) const override
 		{
-			switch (inObject1)
-			{
-			// TODO: in future if we want to enforce principle of hitbox vs. movement colliders being different,
-			// could force all entities to have both a moving physics shape + a hitbox physics shape and remove collision between MOVING and {PROJECTILE, CAST_QUERY}
-			case Layers::NON_MOVING:
-				return inObject2 != Layers::NON_MOVING && inObject2 != Layers::HITBOX && inObject2 != Layers::ENEMYHITBOX; // Non-moving collides with all moving stuff EXCEPT hitbox
-			case Layers::MOVING:
-				return inObject2 == Layers::NON_MOVING || inObject2 == Layers::MOVING || inObject2 == Layers::ENEMY || inObject2 == Layers::ENEMYPROJECTILE || inObject2 == Layers::CAST_QUERY; // Moving collides with everything but hitboxes and debris
-			case Layers::ENEMY:
-				return inObject2 == Layers::NON_MOVING || inObject2 == Layers::MOVING || inObject2 == Layers::ENEMY || inObject2 == Layers::PROJECTILE || inObject2 == Layers::CAST_QUERY;
-			case Layers::ENEMYHITBOX: //bonkfree is an emergency option that causes enemies to freely collide. It can be used in conjunction with other layers to create variable hitboxing for enemies for pathing, players, environment, and other enemies.
-				return  inObject2 == Layers::PROJECTILE || inObject2 == Layers::CAST_QUERY || inObject2 == Layers::HITBOX; 
-			case Layers::HITBOX:
-				return inObject2 == Layers::PROJECTILE ||  inObject2 == Layers::ENEMYHITBOX || inObject2 == Layers::ENEMYPROJECTILE || inObject2 == Layers::CAST_QUERY; // Hitboxes only collide with projectiles and cast_queries
-			case Layers::PROJECTILE:
-				return inObject2 == Layers::NON_MOVING || inObject2 == Layers::ENEMYHITBOX || inObject2 == Layers::ENEMY || inObject2 == Layers::HITBOX || inObject2 == Layers::CAST_QUERY;
-			case Layers::ENEMYPROJECTILE:
-				return (inObject2 != Layers::ENEMYPROJECTILE) && (inObject2 == Layers::NON_MOVING || inObject2 == Layers::MOVING || inObject2 == Layers::HITBOX);
-			case Layers::CAST_QUERY:
-				return inObject2 == Layers::NON_MOVING || inObject2 == Layers::MOVING || inObject2 == Layers::ENEMY || inObject2 == Layers::ENEMYHITBOX || inObject2 == Layers::HITBOX || inObject2 == Layers::PROJECTILE  || inObject2 == Layers::ENEMYPROJECTILE;
-			case Layers::CAST_QUERY_LEVEL_GEOMETRY_ONLY:
-				return inObject2 == Layers::NON_MOVING;
-			case Layers::DEBRIS:
-				return inObject2 == Layers::NON_MOVING; // Debris only hits static non-moving stuff (environment)
-			default:
-				// Jolt is sad you did not define a layer's collision properties :(
-				JPH_ASSERT(false);
-				return false;
-			}
+			return Layers::ShouldLayersCollide(inObject1, inObject2);
 		}
 	};
 	
 	class BPLayerInterfaceImpl final : public JPH::BroadPhaseLayerInterface
 	{
 	public:
-		BPLayerInterfaceImpl()
-		{
-			// Create a mapping table from object to broad phase layer
-			mObjectToBroadPhase[Layers::NON_MOVING] = JOLT::BroadPhaseLayers::NON_MOVING;
-			mObjectToBroadPhase[Layers::MOVING] = JOLT::BroadPhaseLayers::MOVING;
-			mObjectToBroadPhase[Layers::HITBOX] = JOLT::BroadPhaseLayers::MOVING;
-			mObjectToBroadPhase[Layers::PROJECTILE]	= JOLT::BroadPhaseLayers::MOVING;
-			mObjectToBroadPhase[Layers::ENEMYPROJECTILE]	= JOLT::BroadPhaseLayers::ENEMYHITBOX;
-			mObjectToBroadPhase[Layers::ENEMYHITBOX]	= JOLT::BroadPhaseLayers::ENEMYHITBOX;
-			mObjectToBroadPhase[Layers::ENEMY]	= JOLT::BroadPhaseLayers::MOVING;
-			mObjectToBroadPhase[Layers::CAST_QUERY]	= JOLT::BroadPhaseLayers::MOVING;
-			mObjectToBroadPhase[Layers::CAST_QUERY_LEVEL_GEOMETRY_ONLY]	= JOLT::BroadPhaseLayers::MOVING;
-			mObjectToBroadPhase[Layers::DEBRIS]	= JOLT::BroadPhaseLayers::DEBRIS;
-		}
-
 		virtual unsigned int GetNumBroadPhaseLayers() const override
 		{
 			return JOLT::BroadPhaseLayers::NUM_LAYERS;
@@ -178,8 +165,7 @@ public:
 
 		virtual JPH::BroadPhaseLayer GetBroadPhaseLayer(JPH::ObjectLayer inLayer) const override
 		{
-			JPH_ASSERT(inLayer < Layers::NUM_LAYERS);
-			return mObjectToBroadPhase[inLayer];
+			return Layers::BroadPhaseOf(inLayer);
 		}
   
 #if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
@@ -196,9 +182,6 @@ public:
 			}
 		}
 #endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
-
-	private:
-		JPH::BroadPhaseLayer mObjectToBroadPhase[Layers::NUM_LAYERS];
 	};
 
 	/// Class that determines if an object layer can collide with a broadphase layer
@@ -210,32 +193,7 @@ public:
 
 		virtual bool ShouldCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2) const override
 		{
-			switch (inLayer1)
-			{
-			case Layers::NON_MOVING:
-				return inLayer2 != JOLT::BroadPhaseLayers::NON_MOVING;
-			case Layers::MOVING:
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS;
-			case Layers::HITBOX:
-				return false;
-			case Layers::PROJECTILE:
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS;
-			case Layers::ENEMYPROJECTILE:
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS && inLayer2 != JOLT::BroadPhaseLayers::ENEMYHITBOX;
-			case Layers::ENEMY:
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS;
-			case Layers::ENEMYHITBOX: //TODO: do we need to modify this to get true freedom from bonks?
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS && inLayer2 != JOLT::BroadPhaseLayers::ENEMYHITBOX && inLayer2 != JOLT::BroadPhaseLayers::NON_MOVING;
-			case Layers::CAST_QUERY:
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS;
-			case Layers::CAST_QUERY_LEVEL_GEOMETRY_ONLY:
-				return inLayer2 != JOLT::BroadPhaseLayers::DEBRIS;
-			case Layers::DEBRIS:
-				return inLayer2 == JOLT::BroadPhaseLayers::NON_MOVING;
-			default:
-				JPH_ASSERT(false);
-				return false;
-			}
+			return Layers::ShouldLayerSearch(inLayer1, inLayer2);
 		}
 	};
 	
@@ -303,7 +261,7 @@ public:
 	//do not move this up. see C++ standard ~ 12.6.2
 	TSharedPtr<JPH::PhysicsSystem> physics_system;
 
-	FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadInitializer);
+	FWorldSimOwner(float cDeltaTime, InitExitFunction JobThreadInitializer, EBarrageBroadPhase BroadPhase = EBarrageBroadPhase::Default);
 	void SphereCast(
 		double Radius,
 		double Distance,
@@ -323,9 +281,38 @@ public:
 		const JPH::BodyFilter& BodiesFilter,
 		uint32* OutFoundObjectCount,
 		TArray<uint32>& OutFoundObjectIDs) const;
+	// SphereSearch for when you only want a count. Bodies have to pass the filters and then Predicate, which gets the
+	// raw body id. The search stops as soon as StopAt bodies have counted. If OutFirstFound is set, the ids that
+	// counted are appended to it, so StopAt = K gets you the first K. No cap, and nothing is allocated otherwise.
+	uint32 SphereCount(
+		const FVector3d& Location,
+		double Radius,
+		const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+		const JPH::ObjectLayerFilter& ObjectFilter,
+		const JPH::BodyFilter& BodiesFilter,
+		TFunctionRef<bool(uint32)> Predicate,
+		uint32 StopAt = MAX_uint32,
+		TArray<uint32>* OutFirstFound = nullptr) const;
+	// SphereCount around each of Locations, OutCounts[i] for Locations[i], with one walk of the broadphase for all of
+	// them. Predicate runs at most once per body. The walk covers the box around every sphere, so keep the centers
+	// close together, like the targets in one volley, and batch far apart ones separately. A NaN center counts 0.
+	void SphereCountMany(
+		TConstArrayView<FVector3d> Locations,
+		double Radius,
+		const JPH::BroadPhaseLayerFilter& BroadPhaseFilter,
+		const JPH::ObjectLayerFilter& ObjectFilter,
+		const JPH::BodyFilter& BodiesFilter,
+		TFunctionRef<bool(uint32)> Predicate,
+		TArrayView<uint32> OutCounts,
+		uint32 StopAt = MAX_uint32) const;
 
 	// Cast a ray at something and get the first thing it hits
 	void CastRay(FVector3d CastFrom, FVector3d Direction, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TSharedPtr<FHitResult> OutHit) const;
+	// Same answers as CastRay, one per ray, but the rays go through the broadphase in packets of RayPacket::MaxRays.
+	// Made for beams and LOS fans, where the rays in a packet start near each other and point the same way.
+	// Rays are only packed with others headed into the same octant, so mixed directions don't have to be sorted first.
+	// OutHits must be at least as long as CastFrom. A ray with a NaN origin isn't cast, and its hit is reset to a miss.
+	void CastRayPacket(TConstArrayView<FVector3d> CastFrom, TConstArrayView<FVector3d> Directions, const JPH::BroadPhaseLayerFilter& BroadPhaseFilter, const JPH::ObjectLayerFilter& ObjectFilter, const JPH::BodyFilter& BodiesFilter, TArrayView<FHitResult> OutHits) const;
 	JPH::EMotionType LayerToMotionTypeMapping(uint16 Layer);
 	JPH::Ref<JPH::Shape> MakeBox(double JoltX, double JoltY, double JoltZ, float HEReduceMin);
 	//we could use type indirection or inheritance, but the fact of the matter is that this is much easier
@@ -357,22 +344,48 @@ public:
 	
 	void CreateHeightfieldLandscapeMesh(TNotNull<const ALandscapeProxy*> NotNull);
 
+	//Bulk LoadComplexStaticMesh and CreateHeightfieldLandscapeMesh, for level loads and streaming. Every distinct body
+	//setup and landscape component converts at once on the job pool. Bodies are then created right here in input order,
+	//so their ids don't depend on threads, and they're all added together on the next step with one broadphase rebuild.
+	//OutMeshes lines up with Meshes, nullptr where a mesh had no usable collision. Landscapes get no FBLet, same as ever.
+	//Game thread, since we're reading components.
+	void ImportStaticGeometry(TConstArrayView<FBStaticImport> Meshes,
+		TConstArrayView<const ALandscapeProxy*> Landscapes,
+		TArray<FBLet>& OutMeshes);
+	//Adds everything ImportStaticGeometry has created since last time in a single batch, then optimizes the broadphase.
+	//Barrage thread, before the step. False if there was nothing waiting.
+	bool AddPendingStaticGeometry();
+
 
 	//This'll be trouble.
 	//https://www.youtube.com/watch?v=KKC3VePrBOY&lc=Ugw9YRxHjcywQKH5LO54AaABAg
 	void StepSimulation();
+	//rebuilds the character grid, then steps each island of characters that could touch on its own job.
+	//characters in an island step one after another in registration order, so results don't depend on threads.
+	void StepCharacters();
 
 	//Broad Phase is the first pass in the engine's cycle, and the optimization used to accelerate it breaks down as objects are added. As a result, when you have time after adding objects,
 	//you should call optimize broad phase. You should also batch object creation whenever possible, but we don't support that well yet.
 	//Generally, as we add and remove objects, we'll want to perform this, but we really don't want to run it every tick. We can either use trigger logic or a cadenced ticklite
 	bool OptimizeBroadPhase();
+	//the cadenced ticklite. rebuilds the one broadphase layer that churned the most since its last rebuild, and only once
+	//that churn is worth a rebuild, so quiet ticks cost a few atomic loads. broadphases that don't count churn get a full
+	//optimize every 64 ticks instead, same as always. true if anything was rebuilt.
+	bool OptimizeChurnedBroadPhase(uint64 TickCount);
+	//adds and removes count whole, moves count for much less. the quadtree refits moved bodies every step, but it
+	//never fixes the shape of the tree around them.
+	static double BroadPhaseChurnScore(const JPH::BroadPhase::LayerChurn& Churn);
 
 	
 	void FinalizeReleasePrimitive(FBarrageKey BarrageKey)
 	{
 
-		if (CharacterToJoltMapping->Contains(BarrageKey))
+		if (TSharedPtr<FBCharacterBase>* Character = CharacterToJoltMapping->Find(BarrageKey))
 		{
+			if (*Character && (*Character)->mCharacter)
+			{
+				CharacterGrid.Remove((*Character)->mCharacter);
+			}
 			CharacterToJoltMapping->Remove(BarrageKey);
 		}
 
@@ -399,5 +412,14 @@ private:
 	//maybe. but this was a... decision.
 	void
 	AddInternalQueuing(JPH::BodyID ToQueue, uint64 ordinant);
+
+	//everything LoadComplexStaticMesh does once it has a shape. false if jolt wouldn't scale it.
+	bool MakeStaticMeshBodySettings(const JPH::Shape* CreatedShape, const FBTransform& MeshTransform,
+		Layers::EJoltPhysicsLayer Layer, JPH::EMotionType Movement, bool IsSensor, FVector CenterOfMassTranslation,
+		JPH::BodyCreationSettings& OutSettings) const;
+
+	//created by ImportStaticGeometry, not yet in the broadphase.
+	FCriticalSection PendingStaticLock;
+	JPH::Array<JPH::BodyID> PendingStatics;
 	
 };
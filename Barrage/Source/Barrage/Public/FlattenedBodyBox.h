@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "IsolatedJoltIncludes.h"
+#include "Jolt/Geometry/AABox4.h"
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 JPH_NAMESPACE_BEGIN
 
@@ -179,7 +180,7 @@ struct BodyBoxFlatCopy
 			inline bool sFindCollidingPairsCanCollide(const BodyBoxFlatCopy& inBody2)
 			{
 				//all further behavior assumes body1 (this) is rigid, not soft.
-				if (IsRigid)
+				if (!IsRigid)
 					return false;
 
 				// One of these conditions must be true
@@ -211,15 +212,188 @@ struct BodyBoxFlatCopy
 				//     will be added to the end of the active list which will make B.Index > A.Index (this holds only true when we don't deactivate
 				//     bodies during the Broad/NarrowPhase step), so to collide A.Index < B.Index.
 				// (5) As tie breaker we can use the same condition A.Index < B.Index to collide, this means that if A, B collides then B, A won't
-				static_assert(Body::cInactiveIndex == 0xffffffff, "The algorithm below uses this value");
+				//
+				// all of those are indices into the active body list, which a shadow can't know. the body index is NOT a stand in,
+				// it drops every pair where the static body happened to be created first. so we only do (1) here and leave the
+				// ordering to Body::sFindCollidingPairsCanCollide once a candidate survives everything else.
 				if (meta.GetIndexAndSequenceNumber() == inBody2.meta.GetIndexAndSequenceNumber())
 					return false;
-				if (inBody2.IsRigid && meta.GetIndex() >= inBody2.meta.GetIndex())
-					return false;
 
 				return true;
 			}
 		};
 
+//A flat copy plus a flyweight index into a table of collision groups, for broadphases that want to filter on groups
+//without going back to the body. The owner builds the table, and 0 should always be the empty group. The spare word
+//takes this to exactly 32b, so two of them fill a cache line.
+struct alignas(32) BodyBoxGroupedCopy : BodyBoxFlatCopy
+{
+	using BodyBoxFlatCopy::BodyBoxFlatCopy;
+
+	uint32 group = 0;
+	uint32 spare = 0;
+};
+static_assert(sizeof(BodyBoxGroupedCopy) == 32, "two to a cache line");
+
+//The Path to 16b, walked. Four of these to a cache line where BodyBoxFlatCopy gets two and change, which matters once
+//a sweep is bound on memory rather than on compares. Not the exact layout in the comment above, but the same idea:
+//integer cells on a fixed grid instead of floats, and a tiny size class exponent per axis.
+//
+//Positions are in cells of a power of two stride, counted from the grid origin. Each axis is one 32 bit word:
+//	bits 0-21	min corner, signed, so +-2^21 cells (+-65km at the default stride)
+//	bits 22-23	exponent E
+//	bits 24-31	extent X, and the box runs from min to min + X * 4^E cells
+//The fourth word is the body id. Layer is defined by the array the shadow is stored in, and the flags that
+//sFindCollidingPairsCanCollide wants aren't in here at all. Go to the body for those once the box says yes, which is rare.
+//
+//Packing always rounds outward, by at least half a cell on every side, so float error in the conversion can't eat into
+//the real bounds. A shadow can be a little fat. It is never thin. Anything that won't fit (out past the grid, or more than
+//255 * 64 cells across on some axis) is refused, and the owner keeps those bodies on a list of their own.
+struct BodyBoxPackedGrid
+{
+	Vec3 origin = Vec3::sZero();
+	//keep this a power of two so cell edges land exactly on floats. 1/32m is finer than any padding we use.
+	float stride = 1.0f / 32.0f;
+
+	//world space to cell space, half a cell wider on every side. queries go through here too, see BodyBoxPackedShadow.
+	AABox ToCells(const AABox& inWorld) const
+	{
+		const Vec3 half = Vec3::sReplicate(0.5f);
+		const float scale = 1.0f / stride;
+		return AABox((inWorld.mMin - origin) * scale - half, (inWorld.mMax - origin) * scale + half);
+	}
+
+	AABox ToWorld(const AABox& inCells) const
+	{
+		return AABox(inCells.mMin * stride + origin, inCells.mMax * stride + origin);
+	}
+};
+
+struct alignas(16) BodyBoxPackedShadow
+{
+	static constexpr int cMinCell = -(1 << 21);
+	static constexpr int cMaxCell = (1 << 21) - 1;
+
+	uint32 axis[3] = {0, 0, 0};
+	BodyID meta;
+
+	//false, and the shadow is left alone, if the box doesn't fit.
+	bool Pack(const AABox& inWorldBounds, const BodyID& inID, const BodyBoxPackedGrid& inGrid)
+	{
+		const AABox cells = inGrid.ToCells(inWorldBounds);
+		uint32 packed[3];
+		for (int a = 0; a < 3; ++a)
+		{
+			const float lo = std::floor(cells.mMin[a]);
+			const float hi = std::ceil(cells.mMax[a]);
+			//written this way round so NaNs get refused too.
+			if (!(lo >= float(cMinCell) && hi <= float(cMaxCell) && lo <= hi))
+			{
+				return false;
+			}
+			const uint32 size = uint32(hi - lo);
+			uint32 exponent = 0;
+			uint32 extent = size;
+			while (extent > 255)
+			{
+				if (++exponent > 3)
+				{
+					return false;
+				}
+				//round up, or the far side of the box gets clipped.
+				const uint32 step = 2 * exponent;
+				extent = (size + (1u << step) - 1) >> step;
+			}
+			packed[a] = (uint32(int(lo)) & 0x003FFFFF) | (exponent << 22) | (extent << 24);
+		}
+		axis[0] = packed[0];
+		axis[1] = packed[1];
+		axis[2] = packed[2];
+		meta = inID;
+		return true;
+	}
+
+	bool Pack(const Body& inBody, const BodyBoxPackedGrid& inGrid)
+	{
+		return Pack(inBody.GetWorldSpaceBounds(), inBody.GetID(), inGrid);
+	}
+
+	int GetMinCell(int inAxis) const
+	{
+		//shift the sign bit of the 22 bit field up to the top and back down again.
+		return int(axis[inAxis] << 10) >> 10;
+	}
+
+	uint32 GetSizeInCells(int inAxis) const
+	{
+		return (axis[inAxis] >> 24) << (2 * ((axis[inAxis] >> 22) & 3));
+	}
+
+	AABox GetCellBounds() const
+	{
+		const Vec3 min(float(GetMinCell(0)), float(GetMinCell(1)), float(GetMinCell(2)));
+		return AABox(min, min + Vec3(float(GetSizeInCells(0)), float(GetSizeInCells(1)), float(GetSizeInCells(2))));
+	}
+
+	AABox GetWorldSpaceBounds(const BodyBoxPackedGrid& inGrid) const
+	{
+		return inGrid.ToWorld(GetCellBounds());
+	}
+
+	//inQueryCells comes from BodyBoxPackedGrid::ToCells, which widens it by the same half cell the shadows got. between the
+	//two, nothing whose real bounds touch the query can be missed.
+	bool Overlaps(const AABox& inQueryCells) const
+	{
+		return GetCellBounds().Overlaps(inQueryCells);
+	}
+
+	//four shadows against one box, one lane each. everything in the cell decode stays exact in a float, since the largest
+	//number it can produce is 2^21 + 255 * 64.
+	static UVec4 sOverlaps4(const BodyBoxPackedShadow* inFour, const AABox& inQueryCells)
+	{
+		//one shadow per column, then flip it so each column is one word from all four.
+		const Mat44 words = Mat44(
+			UVec4::sLoadInt4Aligned(inFour[0].axis).ReinterpretAsFloat(),
+			UVec4::sLoadInt4Aligned(inFour[1].axis).ReinterpretAsFloat(),
+			UVec4::sLoadInt4Aligned(inFour[2].axis).ReinterpretAsFloat(),
+			UVec4::sLoadInt4Aligned(inFour[3].axis).ReinterpretAsFloat()).Transposed();
+		const UVec4 exponentMask = UVec4::sReplicate(0x00C00000);
+		const UVec4 one = UVec4::sReplicate(0x3F800000);
+		Vec4 min[3];
+		Vec4 max[3];
+		for (int a = 0; a < 3; ++a)
+		{
+			const UVec4 word = words.GetColumn4(a).ReinterpretAsInt();
+			min[a] = word.LogicalShiftLeft<10>().ArithmeticShiftRight<10>().ToFloat();
+			//4^E built straight into the float exponent: E sits at bit 22, so two more up is 2E at bit 23.
+			const Vec4 scale = (UVec4::sAnd(word, exponentMask).LogicalShiftLeft<2>() + one).ReinterpretAsFloat();
+			max[a] = min[a] + word.LogicalShiftRight<24>().ToFloat() * scale;
+		}
+		return AABox4VsBox(inQueryCells, min[0], min[1], min[2], max[0], max[1], max[2]);
+	}
+
+	//calls inVisitor with every shadow that overlaps. four at a time, with a scalar tail.
+	template <typename Visitor>
+	static void sCollide(const BodyBoxPackedShadow* inShadows, uint32 inCount, const AABox& inQueryCells, Visitor&& inVisitor)
+	{
+		uint32 i = 0;
+		for (; i + 4 <= inCount; i += 4)
+		{
+			for (int hits = sOverlaps4(inShadows + i, inQueryCells).GetTrues(); hits != 0; hits &= hits - 1)
+			{
+				inVisitor(inShadows[i + CountTrailingZeros(uint32(hits))]);
+			}
+		}
+		for (; i < inCount; ++i)
+		{
+			if (inShadows[i].Overlaps(inQueryCells))
+			{
+				inVisitor(inShadows[i]);
+			}
+		}
+	}
+};
+static_assert(sizeof(BodyBoxPackedShadow) == 16, "four to a cache line, or what's the point");
+
 JPH_NAMESPACE_END
 PRAGMA_POP_PLATFORM_DEFAULT_PACKING
\ No newline at end of file
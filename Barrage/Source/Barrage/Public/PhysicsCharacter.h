@@ -31,8 +31,9 @@ public:
 	
 	// Create the character
 	// Fails if the mProperties are not correctly set.
-	JPH::BodyID Create(JPH::CharacterVsCharacterCollision* CVCColliderSystem);
-	virtual void StepCharacter() override;
+	// Shapes come out of the registry, shared with every other character this size.
+	JPH::BodyID Create(JPH::CharacterVsCharacterCollision* CVCColliderSystem, FBarrageCharacterShapes& ShapeRegistry);
+	virtual void StepCharacter(JPH::TempAllocator& Allocator) override;
 
 	//To prevent cheeky bullshit and maximize the value we get from the queuing we already do, this
 	// should likely be called during step update OR during the locomotion step
@@ -3,12 +3,16 @@
 #include "EPhysicsLayer.h"
 #include "IsolatedJoltIncludes.h"
 
+//One bit per broadphase layer, in a plain mask rather than a bitset built out of a vector every time one of these is made.
+//If the layers you want are known up front, build the mask with Layers::BroadPhaseMask and pass that.
 class FastExcludeBroadphaseLayerFilter : public JPH::BroadPhaseLayerFilter
 {
 public:
-	FastExcludeBroadphaseLayerFilter()
+	FastExcludeBroadphaseLayerFilter() = default;
+
+	explicit FastExcludeBroadphaseLayerFilter(uint16 InExcludedMask)
+		: ExcludedLayers(InExcludedMask)
 	{
-		ExcludedLayers.reset();
 	}
 	
 	FastExcludeBroadphaseLayerFilter(
@@ -19,31 +23,38 @@ public:
 
 	virtual bool ShouldCollide(JPH::BroadPhaseLayer inLayer) const override
 	{
-		return !ExcludedLayers.test(inLayer.GetValue());
+		return !((ExcludedLayers >> (inLayer.GetValue() & 15)) & 1);
 	}
 
 	void SetExcludedLayers(
 		const std::vector<EPhysicsLayer>& LayersToExclude)
 	{
-		ExcludedLayers.reset();
+		ExcludedLayers = 0;
 		for (const EPhysicsLayer& Layer : LayersToExclude)
 		{
-			ExcludedLayers.set(static_cast<size_t>(Layer));
+			ExcludedLayers |= static_cast<uint16>(1u << static_cast<uint8>(Layer));
 		}
 	}
 
+	void SetExcludedMask(uint16 InExcludedMask)
+	{
+		ExcludedLayers = InExcludedMask;
+	}
+
 private:
-	std::bitset<Layers::NUM_LAYERS> ExcludedLayers; 
+	uint16 ExcludedLayers = 0;
 };
 
 class FastIncludeBroadphaseLayerFilter : public JPH::BroadPhaseLayerFilter
 {
 public:
-	FastIncludeBroadphaseLayerFilter()
+	FastIncludeBroadphaseLayerFilter() = default;
+
+	explicit FastIncludeBroadphaseLayerFilter(uint16 InIncludedMask)
+		: IncludedLayers(InIncludedMask)
 	{
-		IncludedLayers.reset();
 	}
-
+	
 	FastIncludeBroadphaseLayerFilter(
 		const std::vector<EPhysicsLayer>& LayersToExclude)
 	{
@@ -52,26 +63,30 @@ public:
 
 	FastIncludeBroadphaseLayerFilter(
 		Layers::EJoltPhysicsLayer SingleLayer)
+		: IncludedLayers(static_cast<uint16>(1u << SingleLayer))
 	{
-		IncludedLayers.reset();
-		IncludedLayers.set(static_cast<size_t>(SingleLayer));
 	}
 
 	virtual bool ShouldCollide(JPH::BroadPhaseLayer inLayer) const override
 	{
-		return IncludedLayers.test(inLayer.GetValue());
+		return (IncludedLayers >> (inLayer.GetValue() & 15)) & 1;
 	}
 
 	void SetIncludedLayers(
 		const std::vector<EPhysicsLayer>& LayersToExclude)
 	{
-		IncludedLayers.reset();
+		IncludedLayers = 0;
 		for (const EPhysicsLayer& Layer : LayersToExclude)
 		{
-			IncludedLayers.set(static_cast<size_t>(Layer));
+			IncludedLayers |= static_cast<uint16>(1u << static_cast<uint8>(Layer));
 		}
 	}
 
+	void SetIncludedMask(uint16 InIncludedMask)
+	{
+		IncludedLayers = InIncludedMask;
+	}
+
 private:
-	std::bitset<Layers::NUM_LAYERS> IncludedLayers; 
+	uint16 IncludedLayers = 0;
 };
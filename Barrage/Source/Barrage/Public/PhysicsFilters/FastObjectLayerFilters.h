@@ -3,12 +3,16 @@
 #include "EPhysicsLayer.h"
 #include "IsolatedJoltIncludes.h"
 
+//One bit per layer, in a plain mask rather than a bitset built out of a vector every time one of these is made.
+//If the layers you want are known up front, build the mask with Layers::LayerMask and pass that.
 class FastExcludeObjectLayerFilter : public JPH::ObjectLayerFilter
 {
 public:
-	FastExcludeObjectLayerFilter()
+	FastExcludeObjectLayerFilter() = default;
+
+	explicit FastExcludeObjectLayerFilter(uint16 InExcludedMask)
+		: ExcludedLayers(InExcludedMask)
 	{
-		ExcludedLayers.reset();
 	}
 	
 	FastExcludeObjectLayerFilter(
@@ -19,29 +23,36 @@ public:
 
 	virtual bool ShouldCollide(JPH::ObjectLayer inLayer) const override
 	{
-		return !ExcludedLayers.test(inLayer);
+		return !((ExcludedLayers >> (inLayer & 15)) & 1);
 	}
 
 	void SetExcludedLayers(
 		const std::vector<EPhysicsLayer>& LayersToExclude)
 	{
-		ExcludedLayers.reset();
+		ExcludedLayers = 0;
 		for (const EPhysicsLayer& Layer : LayersToExclude)
 		{
-			ExcludedLayers.set(static_cast<size_t>(Layer));
+			ExcludedLayers |= static_cast<uint16>(1u << static_cast<uint8>(Layer));
 		}
 	}
 
+	void SetExcludedMask(uint16 InExcludedMask)
+	{
+		ExcludedLayers = InExcludedMask;
+	}
+
 private:
-	std::bitset<Layers::NUM_LAYERS> ExcludedLayers; 
+	uint16 ExcludedLayers = 0;
 };
 
 class FastIncludeObjectLayerFilter : public JPH::ObjectLayerFilter
 {
 public:
-	FastIncludeObjectLayerFilter()
+	FastIncludeObjectLayerFilter() = default;
+
+	explicit FastIncludeObjectLayerFilter(uint16 InIncludedMask)
+		: IncludedLayers(InIncludedMask)
 	{
-		IncludedLayers.reset();
 	}
 	
 	FastIncludeObjectLayerFilter(
@@ -52,26 +63,30 @@ public:
 
 	FastIncludeObjectLayerFilter(
 		Layers::EJoltPhysicsLayer SingleLayer)
+		: IncludedLayers(static_cast<uint16>(1u << SingleLayer))
 	{
-		IncludedLayers.reset();
-		IncludedLayers.set(static_cast<size_t>(SingleLayer));
 	}
 
 	virtual bool ShouldCollide(JPH::ObjectLayer inLayer) const override
 	{
-		return IncludedLayers.test(inLayer);
+		return (IncludedLayers >> (inLayer & 15)) & 1;
 	}
 
 	void SetIncludedLayers(
 		const std::vector<EPhysicsLayer>& LayersToExclude)
 	{
-		IncludedLayers.reset();
+		IncludedLayers = 0;
 		for (const EPhysicsLayer& Layer : LayersToExclude)
 		{
-			IncludedLayers.set(static_cast<size_t>(Layer));
+			IncludedLayers |= static_cast<uint16>(1u << static_cast<uint8>(Layer));
 		}
 	}
 
+	void SetIncludedMask(uint16 InIncludedMask)
+	{
+		IncludedLayers = InIncludedMask;
+	}
+
 private:
-	std::bitset<Layers::NUM_LAYERS> IncludedLayers; 
+	uint16 IncludedLayers = 0;
 };
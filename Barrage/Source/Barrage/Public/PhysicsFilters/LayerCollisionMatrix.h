@@ -0,0 +1,174 @@
+﻿#pragma once
+
+#include "EPhysicsLayer.h"
+#include "IsolatedJoltIncludes.h"
+#include "PhysicsFilters/FastBroadphaseLayerFilter.h"
+#include "PhysicsFilters/FastObjectLayerFilters.h"
+
+//The one place that says which layers touch. The pair filter, the broadphase mapping, the object vs broadphase filter,
+//and the cached query filters are all read out of the matrix generated from this, so they can't drift apart anymore.
+//Jolt asks these questions millions of times a step, and each answer is now a load, a shift, and a mask.
+//
+//Rows are read as "a body on Layer, looking around", so the pair filter is exactly what's written here, one way.
+//That matters for one pair: CAST_QUERY sees ENEMYPROJECTILE, but ENEMYPROJECTILE doesn't list CAST_QUERY.
+//Queries always come from the cast query side, so that's the direction that counts.
+namespace Layers
+{
+	static_assert(NUM_LAYERS <= 16, "the layer matrix is 16x16. widen the rows before adding layers.");
+	static_assert(JOLT::BroadPhaseLayers::NUM_LAYERS <= 8, "broadphase rows are 8 bits.");
+
+	constexpr uint16 LayerBit(EJoltPhysicsLayer Layer)
+	{
+		return static_cast<uint16>(1u << Layer);
+	}
+
+	constexpr uint8 BroadPhaseBit(JPH::BroadPhaseLayer Layer)
+	{
+		return static_cast<uint8>(1u << static_cast<JPH::BroadPhaseLayer::Type>(Layer));
+	}
+
+	template <typename... TLayers>
+	constexpr uint16 LayerMask(TLayers... InLayers)
+	{
+		return static_cast<uint16>((0u | ... | LayerBit(InLayers)));
+	}
+
+	template <typename... TLayers>
+	constexpr uint8 BroadPhaseMask(TLayers... InLayers)
+	{
+		return static_cast<uint8>((0u | ... | BroadPhaseBit(InLayers)));
+	}
+
+	struct FLayerRule
+	{
+		EJoltPhysicsLayer Layer;
+		//the tree this layer's bodies live in.
+		JPH::BroadPhaseLayer BroadPhase;
+		//object layers a body on this layer collides with.
+		uint16 CollidesWith;
+		//trees a body on this layer bothers to look in. bodies that only ever get found, like hitboxes, look nowhere.
+		uint8 SearchesBroadPhases;
+	};
+
+	// TODO: in future if we want to enforce principle of hitbox vs. movement colliders being different,
+	// could force all entities to have both a moving physics shape + a hitbox physics shape and remove collision between MOVING and {PROJECTILE, CAST_QUERY}
+	inline constexpr FLayerRule LayerRules[] =
+	{
+		// Non-moving collides with all moving stuff EXCEPT hitbox
+		{NON_MOVING, JOLT::BroadPhaseLayers::NON_MOVING,
+			LayerMask(MOVING, PROJECTILE, ENEMYPROJECTILE, ENEMY, CAST_QUERY, CAST_QUERY_LEVEL_GEOMETRY_ONLY, DEBRIS),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::MOVING, JOLT::BroadPhaseLayers::ENEMYHITBOX, JOLT::BroadPhaseLayers::DEBRIS)},
+		// Moving collides with everything but hitboxes and debris
+		{MOVING, JOLT::BroadPhaseLayers::MOVING,
+			LayerMask(NON_MOVING, MOVING, ENEMYPROJECTILE, ENEMY, CAST_QUERY),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING, JOLT::BroadPhaseLayers::MOVING, JOLT::BroadPhaseLayers::ENEMYHITBOX)},
+		// Hitboxes only collide with projectiles and cast_queries
+		{HITBOX, JOLT::BroadPhaseLayers::MOVING,
+			LayerMask(PROJECTILE, ENEMYPROJECTILE, ENEMYHITBOX, CAST_QUERY),
+			BroadPhaseMask()},
+		{PROJECTILE, JOLT::BroadPhaseLayers::MOVING,
+			LayerMask(NON_MOVING, HITBOX, ENEMYHITBOX, ENEMY, CAST_QUERY),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING, JOLT::BroadPhaseLayers::MOVING, JOLT::BroadPhaseLayers::ENEMYHITBOX)},
+		{ENEMYPROJECTILE, JOLT::BroadPhaseLayers::ENEMYHITBOX,
+			LayerMask(NON_MOVING, MOVING, HITBOX),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING, JOLT::BroadPhaseLayers::MOVING)},
+		//bonkfree is an emergency option that causes enemies to freely collide. It can be used in conjunction with other layers to create variable hitboxing for enemies for pathing, players, environment, and other enemies.
+		//TODO: do we need to modify the broadphase side of this to get true freedom from bonks?
+		{ENEMYHITBOX, JOLT::BroadPhaseLayers::ENEMYHITBOX,
+			LayerMask(HITBOX, PROJECTILE, CAST_QUERY),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::MOVING)},
+		{ENEMY, JOLT::BroadPhaseLayers::MOVING,
+			LayerMask(NON_MOVING, MOVING, PROJECTILE, ENEMY, CAST_QUERY),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING, JOLT::BroadPhaseLayers::MOVING, JOLT::BroadPhaseLayers::ENEMYHITBOX)},
+		{CAST_QUERY, JOLT::BroadPhaseLayers::MOVING,
+			LayerMask(NON_MOVING, MOVING, HITBOX, PROJECTILE, ENEMYPROJECTILE, ENEMYHITBOX, ENEMY),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING, JOLT::BroadPhaseLayers::MOVING, JOLT::BroadPhaseLayers::ENEMYHITBOX)},
+		{CAST_QUERY_LEVEL_GEOMETRY_ONLY, JOLT::BroadPhaseLayers::MOVING,
+			LayerMask(NON_MOVING),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING, JOLT::BroadPhaseLayers::MOVING, JOLT::BroadPhaseLayers::ENEMYHITBOX)},
+		// Debris only hits static non-moving stuff (environment)
+		{DEBRIS, JOLT::BroadPhaseLayers::DEBRIS,
+			LayerMask(NON_MOVING),
+			BroadPhaseMask(JOLT::BroadPhaseLayers::NON_MOVING)},
+	};
+
+	//the table, flattened. layers past NUM_LAYERS have empty rows, so they collide with nothing and land in tree 0.
+	struct FLayerMatrix
+	{
+		uint16 CollidesWith[16] = {};
+		uint8 SearchesBroadPhases[16] = {};
+		JPH::BroadPhaseLayer::Type BroadPhaseOf[16] = {};
+		//layers that got a rule, and whether any got two. checked below.
+		uint16 Defined = 0;
+		bool bDuplicate = false;
+	};
+
+	constexpr FLayerMatrix BuildLayerMatrix()
+	{
+		FLayerMatrix Matrix;
+		for (const FLayerRule& Rule : LayerRules)
+		{
+			Matrix.bDuplicate |= (Matrix.Defined & LayerBit(Rule.Layer)) != 0;
+			Matrix.Defined |= LayerBit(Rule.Layer);
+			Matrix.CollidesWith[Rule.Layer] = Rule.CollidesWith;
+			Matrix.SearchesBroadPhases[Rule.Layer] = Rule.SearchesBroadPhases;
+			Matrix.BroadPhaseOf[Rule.Layer] = static_cast<JPH::BroadPhaseLayer::Type>(Rule.BroadPhase);
+		}
+		return Matrix;
+	}
+
+	inline constexpr FLayerMatrix LayerMatrix = BuildLayerMatrix();
+	// Jolt is sad you did not define a layer's collision properties :(
+	static_assert(LayerMatrix.Defined == static_cast<uint16>((1u << NUM_LAYERS) - 1), "every layer needs a rule in LayerRules.");
+	static_assert(!LayerMatrix.bDuplicate, "a layer has two rules in LayerRules.");
+
+	//out of range layers are an assert, and in release they read a row of a layer that collides with nothing.
+	FORCEINLINE bool ShouldLayersCollide(JPH::ObjectLayer Layer, JPH::ObjectLayer Other)
+	{
+		JPH_ASSERT(Layer < NUM_LAYERS && Other < NUM_LAYERS);
+		return (LayerMatrix.CollidesWith[Layer & 15] >> (Other & 15)) & 1;
+	}
+
+	FORCEINLINE bool ShouldLayerSearch(JPH::ObjectLayer Layer, JPH::BroadPhaseLayer BroadPhase)
+	{
+		JPH_ASSERT(Layer < NUM_LAYERS);
+		return (LayerMatrix.SearchesBroadPhases[Layer & 15] >> (static_cast<JPH::BroadPhaseLayer::Type>(BroadPhase) & 7)) & 1;
+	}
+
+	FORCEINLINE JPH::BroadPhaseLayer BroadPhaseOf(JPH::ObjectLayer Layer)
+	{
+		JPH_ASSERT(Layer < NUM_LAYERS);
+		return JPH::BroadPhaseLayer(LayerMatrix.BroadPhaseOf[Layer & 15]);
+	}
+
+	static_assert((LayerMatrix.CollidesWith[CAST_QUERY_LEVEL_GEOMETRY_ONLY] & ~LayerBit(NON_MOVING)) == 0, "level geometry queries should only ever see level geometry.");
+
+	//What a query sees when it runs as a body on Layer. Same answers as physics_system->GetDefaultBroadPhaseLayerFilter
+	//and GetDefaultLayerFilter for that layer, without going through the pair filter for every body, and without
+	//building anything per query. Made once, never change, safe to share between threads.
+	struct FQueryLayerProfile
+	{
+		FastIncludeBroadphaseLayerFilter BroadPhase;
+		FastIncludeObjectLayerFilter Objects;
+	};
+
+	inline const FQueryLayerProfile& QueryProfile(EJoltPhysicsLayer Layer)
+	{
+		struct FProfiles
+		{
+			FQueryLayerProfile Rows[16];
+
+			FProfiles()
+			{
+				for (int32 Row = 0; Row < 16; ++Row)
+				{
+					Rows[Row].BroadPhase.SetIncludedMask(LayerMatrix.SearchesBroadPhases[Row]);
+					Rows[Row].Objects.SetIncludedMask(LayerMatrix.CollidesWith[Row]);
+				}
+			}
+		};
+		static const FProfiles Profiles;
+		JPH_ASSERT(Layer < NUM_LAYERS);
+		return Profiles.Rows[Layer & 15];
+	}
+}
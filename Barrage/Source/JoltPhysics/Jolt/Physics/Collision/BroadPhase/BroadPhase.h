@@ -34,6 +34,21 @@ public:
 	/// Should be called after many objects have been inserted to make the broadphase more efficient, usually done on startup only
 	virtual void		Optimize()															{ /* Optionally overridden by implementation */ }
 
+	/// Bodies added to, removed from and moved within a broadphase layer since that layer was last fully rebuilt by Optimize or OptimizeLayer
+	struct LayerChurn
+	{
+		uint32			mAdded = 0;
+		uint32			mRemoved = 0;
+		uint32			mMoved = 0;
+		uint32			mNumBodies = 0;														///< Bodies in the layer right now
+	};
+
+	/// Get the churn of a single layer. Returns false if this broadphase doesn't keep track of churn.
+	virtual bool		GetLayerChurn([[maybe_unused]] BroadPhaseLayer inLayer, [[maybe_unused]] LayerChurn &outChurn) const { return false; }
+
+	/// Like Optimize, but only rebuilds a single layer. Broadphases without layers rebuild everything.
+	virtual void		OptimizeLayer([[maybe_unused]] BroadPhaseLayer inLayer)				{ Optimize(); }
+
 	/// Must be called just before updating the broadphase when none of the body mutexes are locked
 	virtual void		FrameSync()															{ /* Optionally overridden by implementation */ }
 
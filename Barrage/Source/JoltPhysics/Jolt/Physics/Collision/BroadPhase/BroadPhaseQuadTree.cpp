@@ -14,6 +14,7 @@ JPH_NAMESPACE_BEGIN
 BroadPhaseQuadTree::~BroadPhaseQuadTree()
 {
 	delete [] mLayers;
+	delete [] mChurn;
 }
 
 void BroadPhaseQuadTree::Init(BodyManager *inBodyManager, const BroadPhaseLayerInterface &inLayerInterface)
@@ -44,6 +45,7 @@ void BroadPhaseQuadTree::Init(BodyManager *inBodyManager, const BroadPhaseLayerI
 
 	// Init sub trees
 	mLayers = new QuadTree [mNumLayers];
+	mChurn = new LayerCounters [mNumLayers];
 	for (uint l = 0; l < mNumLayers; ++l)
 	{
 		mLayers[l].Init(mAllocator);
@@ -79,15 +81,7 @@ void BroadPhaseQuadTree::Optimize()
 	LockModifications();
 
 	for (uint l = 0; l < mNumLayers; ++l)
-	{
-		QuadTree &tree = mLayers[l];
-		if (tree.HasBodies() || tree.IsDirty())
-		{
-			QuadTree::UpdateState update_state;
-			tree.UpdatePrepare(mBodyManager->GetBodies(), mTracking, update_state, true);
-			tree.UpdateFinalize(mBodyManager->GetBodies(), mTracking, update_state);
-		}
-	}
+		RebuildLayer(l);
 
 	UnlockModifications();
 
@@ -97,6 +91,56 @@ void BroadPhaseQuadTree::Optimize()
 	mNextLayerToUpdate = 0;
 }
 
+void BroadPhaseQuadTree::OptimizeLayer(BroadPhaseLayer inLayer)
+{
+	JPH_PROFILE_FUNCTION();
+
+	BroadPhaseLayer::Type l = (BroadPhaseLayer::Type)inLayer;
+	JPH_ASSERT(l < mNumLayers);
+
+	// Same as Optimize, but only for one tree
+	FrameSync();
+
+	LockModifications();
+
+	RebuildLayer(l);
+
+	UnlockModifications();
+
+	FrameSync();
+}
+
+void BroadPhaseQuadTree::RebuildLayer(uint inLayer)
+{
+	QuadTree &tree = mLayers[inLayer];
+	if (tree.HasBodies() || tree.IsDirty())
+	{
+		QuadTree::UpdateState update_state;
+		tree.UpdatePrepare(mBodyManager->GetBodies(), mTracking, update_state, true);
+		tree.UpdateFinalize(mBodyManager->GetBodies(), mTracking, update_state);
+	}
+
+	// The incremental updates in UpdatePrepare keep unchanged nodes as they are, so only a full rebuild resets the churn
+	LayerCounters &churn = mChurn[inLayer];
+	churn.mAdded.store(0, memory_order_relaxed);
+	churn.mRemoved.store(0, memory_order_relaxed);
+	churn.mMoved.store(0, memory_order_relaxed);
+}
+
+bool BroadPhaseQuadTree::GetLayerChurn(BroadPhaseLayer inLayer, LayerChurn &outChurn) const
+{
+	BroadPhaseLayer::Type l = (BroadPhaseLayer::Type)inLayer;
+	if (l >= mNumLayers)
+		return false;
+
+	const LayerCounters &churn = mChurn[l];
+	outChurn.mAdded = churn.mAdded.load(memory_order_relaxed);
+	outChurn.mRemoved = churn.mRemoved.load(memory_order_relaxed);
+	outChurn.mMoved = churn.mMoved.load(memory_order_relaxed);
+	outChurn.mNumBodies = churn.mNumBodies.load(memory_order_relaxed);
+	return true;
+}
+
 void BroadPhaseQuadTree::LockModifications()
 {
 	// From this point on we prevent modifications to the tree
@@ -235,6 +279,11 @@ void BroadPhaseQuadTree::AddBodiesFinalize(BodyID *ioBodies, int inNumber, AddSt
 			// Insert all bodies of the same layer
 			mLayers[broadphase_layer].AddBodiesFinalize(mTracking, int(l.mBodyEnd - l.mBodyStart), l.mAddState);
 
+			// Count them for the churn
+			uint32 num_added = uint32(l.mBodyEnd - l.mBodyStart);
+			mChurn[broadphase_layer].mAdded.fetch_add(num_added, memory_order_relaxed);
+			mChurn[broadphase_layer].mNumBodies.fetch_add(num_added, memory_order_relaxed);
+
 			// Mark added to broadphase
 			for (const BodyID *b = l.mBodyStart; b < l.mBodyEnd; ++b)
 			{
@@ -321,6 +370,11 @@ void BroadPhaseQuadTree::RemoveBodies(BodyID *ioBodies, int inNumber)
 		// Remove all bodies of the same layer
 		mLayers[broadphase_layer].RemoveBodies(bodies, mTracking, b_start, int(b_mid - b_start));
 
+		// Count them for the churn
+		uint32 num_removed = uint32(b_mid - b_start);
+		mChurn[broadphase_layer].mRemoved.fetch_add(num_removed, memory_order_relaxed);
+		mChurn[broadphase_layer].mNumBodies.fetch_sub(num_removed, memory_order_relaxed);
+
 		for (const BodyID *b = b_start; b < b_mid; ++b)
 		{
 			// Reset bookkeeping
@@ -372,6 +426,9 @@ void BroadPhaseQuadTree::NotifyBodiesAABBChanged(BodyID *ioBodies, int inNumber,
 		// Notify all bodies of the same layer changed
 		mLayers[broadphase_layer].NotifyBodiesAABBChanged(bodies, mTracking, b_start, int(b_mid - b_start));
 
+		// Count them for the churn
+		mChurn[broadphase_layer].mMoved.fetch_add(uint32(b_mid - b_start), memory_order_relaxed);
+
 		// Repeat
 		b_start = b_mid;
 	}
@@ -22,6 +22,8 @@ public:
 	// Implementing interface of BroadPhase (see BroadPhase for documentation)
 	virtual void			Init(BodyManager *inBodyManager, const BroadPhaseLayerInterface &inLayerInterface) override;
 	virtual void			Optimize() override;
+	virtual bool			GetLayerChurn(BroadPhaseLayer inLayer, LayerChurn &outChurn) const override;
+	virtual void			OptimizeLayer(BroadPhaseLayer inLayer) override;
 	virtual void			FrameSync() override;
 	virtual void			LockModifications() override;
 	virtual	UpdateState		UpdatePrepare() override;
@@ -57,6 +59,18 @@ private:
 		QuadTree::AddState	mAddState;
 	};
 
+	/// Churn counters for a single layer, see LayerChurn. Updated from whichever thread adds, removes or moves bodies.
+	struct LayerCounters
+	{
+		atomic<uint32>		mAdded { 0 };
+		atomic<uint32>		mRemoved { 0 };
+		atomic<uint32>		mMoved { 0 };
+		atomic<uint32>		mNumBodies { 0 };
+	};
+
+	/// Fully rebuild a single layer, the caller must have locked modifications
+	void					RebuildLayer(uint inLayer);
+
 	using Tracking = QuadTree::Tracking;
 	using TrackingVector = QuadTree::TrackingVector;
 
@@ -81,6 +95,9 @@ private:
 	QuadTree *				mLayers;
 	uint					mNumLayers;
 
+	/// One set of churn counters per layer
+	LayerCounters *			mChurn = nullptr;
+
 	/// UpdateState implementation for this tree used during UpdatePrepare/Finalize()
 	struct UpdateStateImpl
 	{
@@ -56,7 +56,8 @@ public:
 	/// @param inBroadPhaseLayerInterface Information on the mapping of object layers to broad phase layers. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.
 	/// @param inObjectVsBroadPhaseLayerFilter Filter callback function that is used to determine if an object layer collides with a broad phase layer. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.
 	/// @param inObjectLayerPairFilter Filter callback function that is used to determine if two object layers collide. Since this is a virtual interface, the instance needs to stay alive during the lifetime of the PhysicsSystem.
-	void						Init(uint inMaxBodies, uint inNumBodyMutexes, uint inMaxBodyPairs, uint inMaxContactConstraints, const BroadPhaseLayerInterface &inBroadPhaseLayerInterface, const ObjectVsBroadPhaseLayerFilter &inObjectVsBroadPhaseLayerFilter, const ObjectLayerPairFilter &inObjectLayerPairFilter);
+	/// @param inBroadPhase Broadphase to use instead of the default quadtree one. Must be allocated with new and not yet initialized, the PhysicsSystem takes ownership and initializes it.
+	void						Init(uint inMaxBodies, uint inNumBodyMutexes, uint inMaxBodyPairs, uint inMaxContactConstraints, const BroadPhaseLayerInterface &inBroadPhaseLayerInterface, const ObjectVsBroadPhaseLayerFilter &inObjectVsBroadPhaseLayerFilter, const ObjectLayerPairFilter &inObjectLayerPairFilter, BroadPhase *inBroadPhase = nullptr);
 
 	/// Listener that is notified whenever a body is activated/deactivated
 	void						SetBodyActivationListener(BodyActivationListener *inListener) { mBodyManager.SetBodyActivationListener(inListener); }
@@ -147,6 +148,13 @@ public:
 	/// Don't call this function while bodies are being modified from another thread or use the locking BodyInterface to modify bodies.
 	void						OptimizeBroadPhase();
 
+	/// Like OptimizeBroadPhase, but only rebuilds a single broadphase layer. Use GetBroadPhaseLayerChurn to decide which layer needs it.
+	/// The same threading rules as OptimizeBroadPhase apply.
+	void						OptimizeBroadPhaseLayer(BroadPhaseLayer inLayer)			{ mBroadPhase->OptimizeLayer(inLayer); }
+
+	/// Get how much a broadphase layer changed since it was last optimized. Returns false if the broadphase doesn't keep track.
+	bool						GetBroadPhaseLayerChurn(BroadPhaseLayer inLayer, BroadPhase::LayerChurn &outChurn) const { return mBroadPhase->GetLayerChurn(inLayer, outChurn); }
+
 	/// Adds a new step listener
 	void						AddStepListener(PhysicsStepListener *inListener);
 
@@ -300,6 +300,32 @@ void FBarrageDispatchTests::Define()
 							FBLet Result = nullptr;
 							TestEqual("Null primitive should have tombstone of 1", BarrageDispatch->SuggestTombstone(Result), 1U);
 						});
+
+					It("Should batch resolve primitives by skeleton key", [this]()
+						{
+							const FSkeletonKey LiveKey(0x1234ull);
+							FBBoxParams BoxParams = FBarrageBounder::GenerateBoxBounds(
+								FVector3d(0, 0, 0),
+								100.0,
+								100.0,
+								100.0
+							);
+							FBLet Result = BarrageDispatch->CreateProjectile(BoxParams, LiveKey, Layers::MOVING);
+							BlockingWaitOnAsyncWorldSimulation(BarrageDispatch);
+
+							const FSkeletonKey Keys[3] = { LiveKey, FSkeletonKey::Invalid(), FSkeletonKey(0x4321ull) };
+							FBarragePrimitive* Found[3] = { nullptr, nullptr, nullptr };
+							const int32 Resolved = BarrageDispatch->ResolveFBLets(Keys, Found);
+
+							TestEqual("Only the live key should resolve", Resolved, 1);
+							TestTrue("Live key should resolve to the created primitive", Found[0] == Result.Get());
+							TestNull("Invalid key should resolve to null", Found[1]);
+							TestNull("Unknown key should resolve to null", Found[2]);
+
+							BarrageDispatch->SuggestTombstone(Result);
+							TestEqual("Tombstoned primitive should no longer resolve", BarrageDispatch->ResolveFBLets(Keys, Found), 0);
+							TestNull("Tombstoned primitive should resolve to null", Found[0]);
+						});
 				});
 
 			Describe("Primitive Functions Requiring Global Barrage", [this]()
@@ -342,6 +368,23 @@ void FBarrageDispatchTests::Define()
 							TestEqual("Position should match set value", ActualPosition, FVector3f(NewPosition));
 						});
 
+					It("Should move a follower onto its parent's pose", [this]()
+						{
+							const FSkeletonKey ParentKey(0x5150ull);
+							const FSkeletonKey ChildKey(0x5151ull);
+							FBSphereParams ParentParams = FBarrageBounder::GenerateSphereBounds(FVector3d(0, 0, 0), 50.0);
+							FBSphereParams ChildParams = FBarrageBounder::GenerateSphereBounds(FVector3d(0, 500, 0), 25.0);
+							FBLet Parent = BarrageDispatch->CreatePrimitive(ParentParams, ParentKey, Layers::NON_MOVING);
+							FBLet Child = BarrageDispatch->CreatePrimitive(ChildParams, ChildKey, Layers::NON_MOVING);
+							BlockingWaitOnAsyncWorldSimulation(BarrageDispatch);
+
+							BarrageDispatch->FollowParent(ChildKey, ParentKey);
+							const FVector3d NewPosition{ 100., 0., 0. };
+							FBarragePrimitive::SetPosition(NewPosition, Parent);
+							BlockingWaitOnAsyncWorldSimulation(BarrageDispatch);
+							TestEqual("Follower should sit on the parent", FBarragePrimitive::GetPosition(Child), FVector3f(NewPosition));
+						});
+
 					It("should return a false-y value for a non-character FBLet when GetCharacterGroundState", [this]()
 						{
 							const FVector3d Point(0, 0, 0);
@@ -534,6 +577,83 @@ void FBarrageDispatchTests::Define()
 
 					Describe("Collision Events", [this]()
 						{
+							It("Should merge contact lanes without dropping or duplicating pairs", [this]()
+								{
+									FBarrageContactBuffers& Buffers = *BarrageDispatch->ContactEventPump;
+									constexpr uint32 PairCount = 10000; // more than the old 8192 deep queue could hold
+									for (uint32 Pair = 0; Pair < PairCount; ++Pair)
+									{
+										FBarrageRawContact Raw;
+										Raw.Type = EBarrageContactEventType::ADDED;
+										Raw.Body1 = PairCount - Pair;
+										Raw.Body2 = PairCount + Pair;
+										Buffers.Record(Pair % FBarrageContactBuffers::WorkerLanes, Raw);
+									}
+									// the same pair again, flipped, from a thread without a lane
+									FBarrageRawContact Duplicate;
+									Duplicate.Type = EBarrageContactEventType::ADDED;
+									Duplicate.Body1 = 2 * PairCount - 1;
+									Duplicate.Body2 = 1;
+									Buffers.Record(INDEX_NONE, Duplicate);
+
+									Buffers.Merge([](uint32 Body) { return FBarrageKey(Body); });
+									TConstArrayView<BarrageContactEvent> Ready = Buffers.Ready();
+									TestEqual("Every pair should survive the merge exactly once", Ready.Num(), static_cast<int32>(PairCount));
+									TestEqual("Merged pairs should be ordered by body", Ready[0].ContactEntity1.ContactKey.KeyIntoBarrage, static_cast<uint64>(1));
+									Buffers.Reset();
+								});
+
+							It("Should batch contacts by layer pair in key order", [this]()
+								{
+									FBarrageContactBuffers& Buffers = *BarrageDispatch->ContactEventPump;
+									auto Record = [&Buffers](uint32 Body1, Layers::EJoltPhysicsLayer Layer1, uint32 Body2, Layers::EJoltPhysicsLayer Layer2)
+										{
+											FBarrageRawContact Raw;
+											Raw.Type = EBarrageContactEventType::ADDED;
+											Raw.Body1 = Body1;
+											Raw.Layer1 = Layer1;
+											Raw.Body2 = Body2;
+											Raw.Layer2 = Layer2;
+											Buffers.Record(0, Raw);
+										};
+									// enemies first on purpose, the batch should flip them
+									Record(30, Layers::ENEMY, 3, Layers::PROJECTILE);
+									Record(10, Layers::ENEMY, 1, Layers::PROJECTILE);
+									Record(20, Layers::ENEMY, 2, Layers::PROJECTILE);
+									Record(5, Layers::MOVING, 6, Layers::NON_MOVING);
+
+									Buffers.Merge([](uint32 Body) { return FBarrageKey(Body); });
+									const FBarrageContactBatch Batch = Buffers.Batch(EBarrageContactEventType::ADDED);
+									TestEqual("Batch should hold every contact", Batch.Events.Num(), 4);
+									TestEqual("Batch should have one partition per layer pair", Batch.Partitions.Num(), 2);
+									TConstArrayView<BarrageContactEvent> Hits = Batch.Between(Layers::ENEMY, Layers::PROJECTILE);
+									TestEqual("Projectile hits should share a partition", Hits.Num(), 3);
+									for (int32 Hit = 0; Hit < Hits.Num(); ++Hit)
+									{
+										TestEqual("Lower layer should come first", Hits[Hit].ContactEntity1.MyLayer, Layers::PROJECTILE);
+										TestEqual("Hits should be sorted by key", Hits[Hit].ContactEntity1.ContactKey.KeyIntoBarrage, static_cast<uint64>(Hit + 1));
+									}
+									TestTrue("Other types should be empty", Buffers.Batch(EBarrageContactEventType::PERSISTED).IsEmpty());
+									Buffers.Reset();
+								});
+
+							It("Should only report subscribed layer pairs once a type is subscribed", [this]()
+								{
+									TestTrue("Unsubscribed types should report everything",
+									         BarrageDispatch->WantsContact(EBarrageContactEventType::ADDED, Layers::DEBRIS, Layers::NON_MOVING));
+									BarrageDispatch->SubscribeToContacts(Layers::PROJECTILE, Layers::ENEMY);
+									TestTrue("Subscribed pair should report",
+									         BarrageDispatch->WantsContact(EBarrageContactEventType::ADDED, Layers::PROJECTILE, Layers::ENEMY));
+									TestTrue("Pairs should be symmetric",
+									         BarrageDispatch->WantsContact(EBarrageContactEventType::ADDED, Layers::ENEMY, Layers::PROJECTILE));
+									TestFalse("Unsubscribed pair should not report",
+									          BarrageDispatch->WantsContact(EBarrageContactEventType::ADDED, Layers::DEBRIS, Layers::NON_MOVING));
+									TestTrue("Other types should stay open",
+									         BarrageDispatch->WantsContact(EBarrageContactEventType::PERSISTED, Layers::DEBRIS, Layers::NON_MOVING));
+									TestTrue("Unknown layers should always report",
+									         BarrageDispatch->WantsContact(EBarrageContactEventType::ADDED, Layers::NUM_LAYERS, Layers::DEBRIS));
+								});
+
 							It("Should trigger a contact added event", [this]()
 								{
 									// Bind to the contact added delegate
@@ -760,6 +880,38 @@ void FBarrageDispatchWorldDependentTests::Define()
 					TestTrue("Complex static mesh creation should succeed", FBarragePrimitive::IsNotNull(Result));
 					TestTrue("Complex static mesh should have valid key", Result->KeyIntoBarrage != 0);
 				});
+
+			It("Should give every static mesh on an Actor its own body when importing a level", [this]()
+				{
+					AActor* TestActor = TestWorld->SpawnActor<AActor>();
+					UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+					for (int32 Index = 0; Index < 2; ++Index)
+					{
+						UStaticMeshComponent* MeshComponent = NewObject<UStaticMeshComponent>(TestActor);
+						MeshComponent->SetMobility(EComponentMobility::Static);
+						MeshComponent->SetStaticMesh(Cube);
+						MeshComponent->SetWorldLocation(FVector(Index * 500.0, 0, 0));
+						MeshComponent->RegisterComponent();
+						TestActor->AddInstanceComponent(MeshComponent);
+					}
+
+					TArray<FBStaticImport> Meshes;
+					TArray<const ALandscapeProxy*> Landscapes;
+					UBarrageDispatch::GatherStaticGeometry(TestWorld->PersistentLevel, Meshes, Landscapes);
+					Meshes.RemoveAll([TestActor](const FBStaticImport& Mesh) { return Mesh.StaticMeshComponent->GetOwner() != TestActor; });
+					if (!TestEqual("Both meshes should be gathered", Meshes.Num(), 2))
+					{
+						return;
+					}
+					TestTrue("They should be keyed apart", Meshes[0].OutKey != Meshes[1].OutKey);
+
+					TestEqual("Both should import", BarrageDispatch->ImportStaticGeometry(Meshes).Num(), 2);
+					FBLet First = BarrageDispatch->GetShapeRef(Meshes[0].OutKey);
+					FBLet Second = BarrageDispatch->GetShapeRef(Meshes[1].OutKey);
+					TestTrue("The first mesh should resolve", FBarragePrimitive::IsNotNull(First));
+					TestTrue("The second mesh should resolve", FBarragePrimitive::IsNotNull(Second));
+					TestTrue("To two different bodies", First && Second && First->KeyIntoBarrage != Second->KeyIntoBarrage);
+				});
 		});
 
 	AfterEach([this]()
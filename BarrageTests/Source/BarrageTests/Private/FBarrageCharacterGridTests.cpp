@@ -0,0 +1,231 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "BarrageCharacterGrid.h"
+#include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
+
+//records which character each hit was against, which is all either collider tells us.
+class FOtherCharacterCollector : public JPH::CollideShapeCollector
+{
+public:
+	TArray<uint64> Others;
+	uint64 Current = 0;
+
+	virtual void SetUserData(uint64 inUserData) override
+	{
+		Current = inUserData;
+	}
+
+	virtual void AddHit(const ResultType&) override
+	{
+		Others.Add(Current);
+	}
+};
+
+class FOtherCharacterCastCollector : public JPH::CastShapeCollector
+{
+public:
+	TArray<uint64> Others;
+	uint64 Current = 0;
+
+	virtual void SetUserData(uint64 inUserData) override
+	{
+		Current = inUserData;
+	}
+
+	virtual void AddHit(const ResultType&) override
+	{
+		Others.Add(Current);
+	}
+};
+
+//a jittered crowd of bare characters in a sim of their own, and a way to ask a collider what each one touches.
+struct FCharacterCrowd
+{
+	TSharedPtr<FWorldSimOwner> Sim = MakeShared<FWorldSimOwner>(0.016f, [this](int threadId)
+		{
+			if (Sim.IsValid())
+			{
+				Sim->WorkerAcc[threadId] = FBOutputFeed(std::this_thread::get_id(), 512);
+				Sim->ThreadAcc[threadId] = FWorldSimOwner::FBInputFeed(std::this_thread::get_id(), 512);
+				MyWORKERIndex = threadId;
+				MyBARRAGEIndex = threadId;
+			}
+		});
+	TArray<JPH::Ref<JPH::CharacterVirtual>> Characters;
+
+	//on a lattice tight enough that most characters touch a neighbour or two.
+	void Spawn(int32 Count)
+	{
+		JPH::CharacterVirtualSettings Settings;
+		Settings.mShape = new JPH::CapsuleShape(0.5f, 0.3f);
+		Settings.mCharacterPadding = 0.08f;
+		FRandomStream Jitter(Count);
+		const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(Count)));
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Settings.mID = JPH::CharacterID::sNextCharacterID();
+			const JPH::RVec3 Position(
+				(Index % Side) * 0.7f + Jitter.FRandRange(-0.1f, 0.1f),
+				Jitter.FRandRange(0.f, 0.5f),
+				(Index / Side) * 0.7f + Jitter.FRandRange(-0.1f, 0.1f));
+			Characters.Add(new JPH::CharacterVirtual(&Settings, Position, JPH::Quat::sIdentity(), Sim->physics_system.Get()));
+		}
+	}
+
+	//every character against the rest, sorted per character so the two colliders can be compared directly.
+	TArray<TArray<uint64>> CollideAll(const JPH::CharacterVsCharacterCollision& Collider) const
+	{
+		TArray<TArray<uint64>> Hits;
+		Hits.SetNum(Characters.Num());
+		JPH::CollideShapeSettings Settings;
+		for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		{
+			FOtherCharacterCollector Collector;
+			const JPH::CharacterVirtual* Character = Characters[Index];
+			Collider.CollideCharacter(Character, Character->GetCenterOfMassTransform(), Settings, Character->GetPosition(), Collector);
+			Hits[Index] = MoveTemp(Collector.Others);
+			Hits[Index].Sort();
+		}
+		return Hits;
+	}
+};
+
+BEGIN_DEFINE_SPEC(FBarrageCharacterGridTests, "Artillery.Barrage.Character Grid Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+FCharacterCrowd Crowd;
+TArray<JPH::Ref<JPH::CharacterVirtual>>& Characters = Crowd.Characters;
+END_DEFINE_SPEC(FBarrageCharacterGridTests)
+void FBarrageCharacterGridTests::Define()
+{
+	AfterEach([this]()
+		{
+			Characters.Empty();
+		});
+
+	Describe("A Barrage Character Grid", [this]()
+		{
+			It("should find exactly the contacts the simple collider finds", [this]()
+				{
+					Crowd.Spawn(300);
+					JPH::CharacterVsCharacterCollisionSimple Simple;
+					FBarrageCharacterGrid Grid;
+					for (JPH::CharacterVirtual* Character : Characters)
+					{
+						Simple.Add(Character);
+						Grid.Add(Character);
+					}
+					Grid.Rebuild();
+
+					const TArray<TArray<uint64>> Expected = Crowd.CollideAll(Simple);
+					const TArray<TArray<uint64>> Actual = Crowd.CollideAll(Grid);
+					int32 Touching = 0;
+					for (int32 Index = 0; Index < Characters.Num(); ++Index)
+					{
+						Touching += Expected[Index].Num();
+						if (Expected[Index] != Actual[Index])
+						{
+							AddError(FString::Printf(TEXT("Character %d: simple found %d hits, grid found %d"), Index, Expected[Index].Num(), Actual[Index].Num()));
+						}
+					}
+					TestTrue("The crowd should actually be touching", Touching > 0);
+				});
+
+			It("should still see characters added after the last rebuild", [this]()
+				{
+					Crowd.Spawn(2);
+					Characters[1]->SetPosition(Characters[0]->GetPosition() + JPH::Vec3(0.5f, 0, 0));
+					FBarrageCharacterGrid Grid;
+					Grid.Add(Characters[0]);
+					Grid.Rebuild();
+					Grid.Add(Characters[1]);
+					Grid.Rebuild();
+					TestEqual("Both characters should be registered", Grid.Num(), 2);
+					const uint64 Late = reinterpret_cast<uint64>(Characters[1].GetPtr());
+					TestEqual("A collide from its neighbour should find it", Crowd.CollideAll(Grid)[0], TArray<uint64>({Late}));
+
+					// out of reach of a collide, in the path of a cast
+					Characters[1]->SetPosition(Characters[0]->GetPosition() + JPH::Vec3(3, 0, 0));
+					Grid.Rebuild();
+					TestTrue("Once it's out of reach a collide shouldn't", Crowd.CollideAll(Grid)[0].IsEmpty());
+					FOtherCharacterCastCollector Collector;
+					const JPH::CharacterVirtual* Caster = Characters[0];
+					Grid.CastCharacter(Caster, Caster->GetCenterOfMassTransform(), JPH::Vec3(5, 0, 0), JPH::ShapeCastSettings(), Caster->GetPosition(), Collector);
+					TestEqual("A cast toward it should", Collector.Others, TArray<uint64>({Late}));
+
+					Grid.Remove(Characters[1]);
+					TestEqual("Removed characters should be gone", Grid.Num(), 1);
+				});
+
+			It("should split characters that can't touch into separate islands", [this]()
+				{
+					Crowd.Spawn(4);
+					// move the middle two far away from the rest, and from each other
+					Characters[1]->SetPosition(JPH::RVec3(100, 0, 0));
+					Characters[2]->SetPosition(JPH::RVec3(-100, 0, 0));
+					FBarrageCharacterGrid Grid;
+					for (JPH::CharacterVirtual* Character : Characters)
+					{
+						Grid.Add(Character);
+					}
+					Grid.Rebuild();
+					TArray<int32> Order;
+					TArray<int32> Starts;
+					Grid.BuildIslands(Order, Starts);
+					TestEqual("Three islands", Starts.Num() - 1, 3);
+					TestEqual("Islands are ordered by their lowest member", Order, TArray<int32>({0, 3, 1, 2}));
+					TestEqual("The first island holds the two neighbours", Starts[1], 2);
+				});
+
+			It("should query the poses it copied, not the live characters", [this]()
+				{
+					Crowd.Spawn(2);
+					Characters[1]->SetPosition(Characters[0]->GetPosition() + JPH::Vec3(0.5f, 0, 0));
+					FBarrageCharacterGrid Grid;
+					Grid.Add(Characters[0]);
+					Grid.Add(Characters[1]);
+					Grid.Rebuild();
+					// what another job stepping this character mid-query looks like from here
+					Characters[1]->SetPosition(JPH::RVec3(100, 0, 0));
+					TestEqual("The neighbour is still where the rebuild saw it", Crowd.CollideAll(Grid)[0], TArray<uint64>({reinterpret_cast<uint64>(Characters[1].GetPtr())}));
+					Grid.RefreshPoses();
+					TestTrue("And gone once the poses are refreshed", Crowd.CollideAll(Grid)[0].IsEmpty());
+				});
+		});
+}
+
+//timings only, so it stays out of the product runs. read the log when you touch the grid or the crowd sizes we care
+//about change.
+BEGIN_DEFINE_SPEC(FBarrageCharacterGridBenchmarks, "Artillery.Barrage.Character Grid Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+FCharacterCrowd Crowd;
+END_DEFINE_SPEC(FBarrageCharacterGridBenchmarks)
+void FBarrageCharacterGridBenchmarks::Define()
+{
+	Describe("A Barrage Character Grid", [this]()
+		{
+			It("should benchmark against the simple collider", [this]()
+				{
+					for (int32 Count : {50, 500, 2000})
+					{
+						Crowd.Characters.Empty();
+						Crowd.Spawn(Count);
+						JPH::CharacterVsCharacterCollisionSimple Simple;
+						FBarrageCharacterGrid Grid;
+						for (JPH::CharacterVirtual* Character : Crowd.Characters)
+						{
+							Simple.Add(Character);
+							Grid.Add(Character);
+						}
+
+						double Start = FPlatformTime::Seconds();
+						Crowd.CollideAll(Simple);
+						const double SimpleMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+						Start = FPlatformTime::Seconds();
+						Grid.Rebuild();
+						Crowd.CollideAll(Grid);
+						const double GridMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+						AddInfo(FString::Printf(TEXT("%d characters: simple %.3fms, grid (with rebuild) %.3fms"), Count, SimpleMs, GridMs));
+					}
+				});
+		});
+}
@@ -0,0 +1,130 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//a floor and a carpet of balls resting just above it, so they land, settle, and go to sleep within a few seconds. jolt's
+//own active list is the reference for who's awake.
+BEGIN_DEFINE_SPEC(FBodyTrackerTests, "Artillery.Barrage.Body Tracker Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TSharedPtr<FWorldSimOwner> Sim;
+TArray<JPH::BodyID> Balls;
+
+void Step()
+{
+	Sim->StepSimulation();
+	Sim->BodyTracker.Update();
+}
+
+//steps until everything is asleep, or gives up.
+bool Settle()
+{
+	for (int32 Tick = 0; Tick < 600; ++Tick)
+	{
+		Step();
+		if (Sim->BodyTracker.NumAwake() == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool MatchesJolt()
+{
+	JPH::BodyIDVector Active;
+	Sim->physics_system->GetActiveBodies(JPH::EBodyType::RigidBody, Active);
+	TSet<uint32> Jolt;
+	for (const JPH::BodyID& Body : Active)
+	{
+		Jolt.Add(Body.GetIndexAndSequenceNumber());
+	}
+	int32 Found = 0;
+	for (const JPH::BodyID& Body : Sim->BodyTracker.Moved())
+	{
+		Found += Jolt.Contains(Body.GetIndexAndSequenceNumber());
+	}
+	return Found == Jolt.Num() && Sim->BodyTracker.NumAwake() == Jolt.Num();
+}
+END_DEFINE_SPEC(FBodyTrackerTests)
+void FBodyTrackerTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Sim = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+				{
+					MyWORKERIndex = threadId;
+					MyBARRAGEIndex = threadId;
+				});
+			JPH::BodyCreationSettings Floor(new JPH::BoxShape(JPH::Vec3(100, 1, 100)), JPH::RVec3(0, -1, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+			Sim->body_interface->CreateAndAddBody(Floor, JPH::EActivation::DontActivate);
+			for (int32 Index = 0; Index < 1000; ++Index)
+			{
+				JPH::BodyCreationSettings Ball(new JPH::SphereShape(0.5f), JPH::RVec3(Index % 40 * 2.f - 40, 0.6f, Index / 40 * 2.f - 25), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
+				Balls.Add(Sim->body_interface->CreateAndAddBody(Ball, JPH::EActivation::Activate));
+			}
+		});
+
+	AfterEach([this]()
+		{
+			Balls.Empty();
+			Sim.Reset();
+		});
+
+	Describe("A Body Tracker", [this]()
+		{
+			It("should agree with jolt about who's awake, and never list the statics", [this]()
+				{
+					Step();
+					TestEqual("Every ball starts awake", Sim->BodyTracker.NumAwake(), 1000);
+					TestTrue("And matches jolt", MatchesJolt());
+					TestTrue("Everything goes to sleep", Settle());
+					TestTrue("And the last tick lists who fell asleep on it", Sim->BodyTracker.Moved().Num() > 0);
+					Step();
+					TestEqual("After that, nothing moves", Sim->BodyTracker.Moved().Num(), 0);
+				});
+
+			It("should list a body that fell asleep once, on the step it did", [this]()
+				{
+					TestTrue("Settles", Settle());
+					Sim->body_interface->AddImpulse(Balls[500], JPH::Vec3(0, 5, 0));
+					Step();
+					TestTrue("The kicked ball moved", Sim->BodyTracker.HasMoved(Balls[500]));
+					TestFalse("Its distant neighbor didn't", Sim->BodyTracker.HasMoved(Balls[0]));
+					TestTrue("Matches jolt", MatchesJolt());
+
+					bool bSawItFall = false;
+					for (int32 Tick = 0; Tick < 600 && !bSawItFall; ++Tick)
+					{
+						Step();
+						bSawItFall = Sim->BodyTracker.NumAwake() == 0 && Sim->BodyTracker.HasMoved(Balls[500]);
+					}
+					TestTrue("Its last step is still in Moved", bSawItFall);
+					Step();
+					TestFalse("The one after isn't", Sim->BodyTracker.HasMoved(Balls[500]));
+				});
+
+			It("should drop removed bodies, and not confuse them with whoever gets their index", [this]()
+				{
+					Step();
+					for (int32 Index = 0; Index < 100; ++Index)
+					{
+						Sim->body_interface->RemoveBody(Balls[Index]);
+						Sim->body_interface->DestroyBody(Balls[Index]);
+					}
+					JPH::BodyCreationSettings Ball(new JPH::SphereShape(0.5f), JPH::RVec3(0, 5, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
+					const JPH::BodyID Newcomer = Sim->body_interface->CreateAndAddBody(Ball, JPH::EActivation::Activate);
+					Step();
+					TestTrue("Matches jolt", MatchesJolt());
+					TestTrue("The newcomer moved", Sim->BodyTracker.HasMoved(Newcomer));
+					TestEqual("Removed bodies are gone", Sim->BodyTracker.NumAwake(), 901);
+					for (int32 Index = 1; Index < Sim->BodyTracker.Moved().Num(); ++Index)
+					{
+						if (Sim->BodyTracker.Moved()[Index - 1].GetIndex() >= Sim->BodyTracker.Moved()[Index].GetIndex())
+						{
+							AddError(FString::Printf(TEXT("Moved %d is out of order"), Index));
+							return;
+						}
+					}
+				});
+		});
+}
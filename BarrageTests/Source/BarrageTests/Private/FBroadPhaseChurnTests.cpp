@@ -0,0 +1,79 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//the quadtree counts churn per layer, so these check that a rebuild follows the churn rather than the clock.
+BEGIN_DEFINE_SPEC(FBroadPhaseChurnTests, "Artillery.Barrage.BroadPhase Churn Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TSharedPtr<FWorldSimOwner> Sim;
+TArray<JPH::BodyID> Bodies;
+
+void MakeWorld(EBarrageBroadPhase BroadPhase)
+{
+	Sim = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+		{
+			MyWORKERIndex = threadId;
+			MyBARRAGEIndex = threadId;
+		}, BroadPhase);
+}
+
+void AddSpheres(int32 Count)
+{
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		JPH::BodyCreationSettings Settings(new JPH::SphereShape(0.5f), JPH::RVec3(Index * 2.f, 10, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
+		Bodies.Add(Sim->body_interface->CreateAndAddBody(Settings, JPH::EActivation::DontActivate));
+	}
+}
+
+void RemoveSpheres(int32 Count)
+{
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const JPH::BodyID Body = Bodies.Pop();
+		Sim->body_interface->RemoveBody(Body);
+		Sim->body_interface->DestroyBody(Body);
+	}
+}
+END_DEFINE_SPEC(FBroadPhaseChurnTests)
+void FBroadPhaseChurnTests::Define()
+{
+	AfterEach([this]()
+		{
+			Bodies.Empty();
+			Sim.Reset();
+		});
+
+	Describe("Churn driven broadphase optimization", [this]()
+		{
+			It("should rebuild after real churn and skip quiet ticks", [this]()
+				{
+					MakeWorld(EBarrageBroadPhase::QuadTree);
+					TestFalse("An empty world has nothing to rebuild", Sim->OptimizeChurnedBroadPhase(64));
+
+					AddSpheres(1000);
+					JPH::BroadPhase::LayerChurn Churn;
+					const JPH::BroadPhaseLayer Moving = Sim->broad_phase_layer_interface.GetBroadPhaseLayer(Layers::MOVING);
+					TestTrue("The quadtree counts churn", Sim->physics_system->GetBroadPhaseLayerChurn(Moving, Churn));
+					TestEqual("Every add is counted", static_cast<int32>(Churn.mAdded), 1000);
+
+					TestTrue("A thousand adds is worth a rebuild", Sim->OptimizeChurnedBroadPhase(1));
+					Sim->physics_system->GetBroadPhaseLayerChurn(Moving, Churn);
+					TestEqual("The rebuild clears the churn", static_cast<int32>(Churn.mAdded), 0);
+					TestEqual("But not the count", static_cast<int32>(Churn.mNumBodies), 1000);
+					TestFalse("A quiet tick is skipped, even on the old cadence", Sim->OptimizeChurnedBroadPhase(64));
+
+					RemoveSpheres(10);
+					TestFalse("A few removes aren't", Sim->OptimizeChurnedBroadPhase(2));
+					RemoveSpheres(300);
+					TestTrue("A few hundred are", Sim->OptimizeChurnedBroadPhase(3));
+				});
+
+			It("should fall back to the fixed cadence for broadphases that don't count churn", [this]()
+				{
+					MakeWorld(EBarrageBroadPhase::PaddingtonTree);
+					AddSpheres(1000);
+					TestFalse("Off cadence", Sim->OptimizeChurnedBroadPhase(1));
+					TestTrue("On cadence", Sim->OptimizeChurnedBroadPhase(64));
+				});
+		});
+}
@@ -0,0 +1,277 @@
+#include "Misc/AutomationTest.h"
+#include "Experimental/Embedder.h"
+
+using FTestEmbedder = Embedder<2>;
+using FTestDelta = FTestEmbedder::DeltaFLESH<2>;
+
+//boxes scattered over a couple km, embedded the way the FLESH broadphase embeds its shadows. everything sits in the
+//middle of its cell, so a jiggle under half a meter never changes a key and anything past a meter always does.
+struct FEmbedderField
+{
+	FRandomStream Scatter;
+	TArray<FVector3f> Mins;
+	static constexpr float Size = 2;
+	static constexpr float MaxExtent = 4096;
+
+	void Populate(int32 Count)
+	{
+		Mins.Reset(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Mins.Emplace(FMath::FloorToFloat(Scatter.FRandRange(-1000, 1000)) + 0.5f,
+				FMath::FloorToFloat(Scatter.FRandRange(-1000, 1000)) + 0.5f,
+				FMath::FloorToFloat(Scatter.FRandRange(-1000, 1000)) + 0.5f);
+		}
+	}
+
+	//every fraction-th box leaves its cell. the rest shuffle around inside theirs.
+	void Move(int32 Fraction)
+	{
+		for (int32 Index = 0; Index < Mins.Num(); ++Index)
+		{
+			const float Reach = Index % Fraction == 0 ? 5.f : 0.2f;
+			Mins[Index].X = Index % Fraction == 0
+				? Mins[Index].X + Reach
+				: FMath::FloorToFloat(Mins[Index].X) + 0.5f + Scatter.FRandRange(-Reach, Reach);
+		}
+	}
+
+	uint64 CellKeyOf(int32 Index) const
+	{
+		const FVector3f& Min = Mins[Index];
+		return JPH::HashCombineArgs(FMath::FloorToInt32(Min.X), FMath::FloorToInt32(Min.Y), FMath::FloorToInt32(Min.Z));
+	}
+
+	//center first, then the min/max line, same as GenerateBBHashes.
+	void Embed(int32 Index, FLESHPoint* Batch) const
+	{
+		const FVector3f Min(FMath::FloorToFloat(Mins[Index].X), FMath::FloorToFloat(Mins[Index].Y), FMath::FloorToFloat(Mins[Index].Z));
+		const FVector3f Max = Min + FVector3f(Size);
+		const FVector3f Center = Min + FVector3f(Size / 2);
+		Batch[0] = FLESHPoint::FromPoint(Center.X, Center.Y, Center.Z, MaxExtent);
+		Batch[1] = FLESHPoint::embedLineL1(Max.X, Max.Y, Max.Z, Min.X, Min.Y, Min.Z);
+	}
+
+	FTestDelta::ETouch Touch(FTestDelta& Delta, int32 Index) const
+	{
+		return Delta.Touch(Index, CellKeyOf(Index), [this, Index](FLESHPoint* Batch)
+			{
+				Embed(Index, Batch);
+			});
+	}
+
+	TMap<FTestDelta::ETouch, int32> TouchAll(FTestDelta& Delta) const
+	{
+		TMap<FTestDelta::ETouch, int32> Outcomes;
+		for (int32 Index = 0; Index < Mins.Num(); ++Index)
+		{
+			++Outcomes.FindOrAdd(Touch(Delta, Index));
+		}
+		return Outcomes;
+	}
+};
+
+BEGIN_DEFINE_SPEC(FEmbedderTests, "Artillery.Barrage.Embedder Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+FEmbedderField Field;
+END_DEFINE_SPEC(FEmbedderTests)
+void FEmbedderTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Field.Scatter.Initialize(44);
+		});
+
+	Describe("A Delta FLESH", [this]()
+		{
+			It("should only rehash the entries that left their cell", [this]()
+				{
+					Field.Populate(2000);
+					FTestDelta Delta;
+					TestEqual("Everything is new", Field.TouchAll(Delta).FindRef(FTestDelta::ETouch::Added), 2000);
+					TestTrue("The first commit merges", Delta.Commit());
+
+					Field.Move(10);
+					const TMap<FTestDelta::ETouch, int32> Outcomes = Field.TouchAll(Delta);
+					TestEqual("Leavers are rehashed", Outcomes.FindRef(FTestDelta::ETouch::Rehashed), 200);
+					TestEqual("Everyone else is skipped", Outcomes.FindRef(FTestDelta::ETouch::Skipped), 1800);
+					TestTrue("Leavers wait in the side", Delta.NumInSide() == 200);
+					TestFalse("A small side doesn't merge", Delta.Commit());
+
+					TestEqual("Standing still is free", Field.TouchAll(Delta).FindRef(FTestDelta::ETouch::Skipped), 2000);
+					bool bMerged = false;
+					for (uint32 Tick = 1; Tick < Delta.MergeEvery; ++Tick)
+					{
+						bMerged |= Delta.Commit();
+					}
+					TestTrue("The side is folded back in on schedule", bMerged);
+					TestTrue("And is empty afterwards", Delta.NumInSide() == 0);
+				});
+
+			//the main build is deterministic, so an unmerged delta has to answer exactly like a full build of where
+			//everything was, minus the leavers, followed by a full build of only the leavers where they are now.
+			//once it merges, it has to answer exactly like a full build of where everything is now.
+			It("should answer at old and new positions like a full rebuild would", [this]()
+				{
+					//num_found is 16 bits. this is as close to everything as a query can ask for.
+					constexpr uint32_t Everything = UINT16_MAX - 1;
+					constexpr int32 Fraction = 10;
+					Field.Populate(2000);
+					FTestDelta Delta;
+					FTestDelta Before;
+					Field.TouchAll(Delta);
+					Delta.Commit();
+					Field.TouchAll(Before);
+					Before.Commit();
+
+					TArray<std::array<FTestEmbedder::HashBlob, 2>> OldHashes;
+					for (int32 Index = 0; Index < Field.Mins.Num(); Index += Fraction)
+					{
+						FLESHPoint Batch[2];
+						Field.Embed(Index, Batch);
+						OldHashes.Add(Delta.get2Hashes(Batch, Delta.Seed));
+					}
+
+					Field.Move(Fraction);
+					Field.TouchAll(Delta);
+					TestFalse("The leavers are still in the side", Delta.Commit());
+					FTestDelta Leavers;
+					for (int32 Index = 0; Index < Field.Mins.Num(); Index += Fraction)
+					{
+						Field.Touch(Leavers, Index);
+					}
+					Leavers.Commit();
+
+					int32 StaleFound = 0;
+					int32 SideFound = 0;
+					auto IsLeaver = [](uint32_t Id)
+						{
+							return Id % Fraction == 0;
+						};
+					auto CompareUnmerged = [&](std::array<FTestEmbedder::HashBlob, 2>& Hashes, const FString& What)
+						{
+							std::vector<uint32_t> Expected = Before.query(Hashes.data(), 2, Everything);
+							StaleFound += static_cast<int32>(std::count_if(Expected.begin(), Expected.end(), IsLeaver));
+							Expected.erase(std::remove_if(Expected.begin(), Expected.end(), IsLeaver), Expected.end());
+							const std::vector<uint32_t> FromSide = Leavers.query(Hashes.data(), 2, Everything);
+							SideFound += static_cast<int32>(FromSide.size());
+							Expected.insert(Expected.end(), FromSide.begin(), FromSide.end());
+							TestTrue(What, Delta.query(Hashes.data(), 2, Everything) == Expected);
+						};
+					for (int32 Leaver = 0; Leaver < OldHashes.Num(); ++Leaver)
+					{
+						FLESHPoint Batch[2];
+						Field.Embed(Leaver * Fraction, Batch);
+						std::array<FTestEmbedder::HashBlob, 2> NewHashes = Delta.get2Hashes(Batch, Delta.Seed);
+						CompareUnmerged(OldHashes[Leaver], FString::Printf(TEXT("Leaver %d where it was"), Leaver * Fraction));
+						CompareUnmerged(NewHashes, FString::Printf(TEXT("Leaver %d where it is"), Leaver * Fraction));
+					}
+					TestTrue("The old build had stale copies to drop", StaleFound > 0);
+					TestTrue("And the side had the leavers to add", SideFound > 0);
+
+					FTestDelta Full;
+					Field.TouchAll(Full);
+					Full.Commit();
+					bool bMerged = false;
+					for (uint32 Tick = 0; Tick < Delta.MergeEvery && !bMerged; ++Tick)
+					{
+						bMerged = Delta.Commit();
+					}
+					TestTrue("It merged", bMerged);
+					for (int32 Leaver = 0; Leaver < OldHashes.Num(); ++Leaver)
+					{
+						FLESHPoint Batch[2];
+						Field.Embed(Leaver * Fraction, Batch);
+						std::array<FTestEmbedder::HashBlob, 2> NewHashes = Delta.get2Hashes(Batch, Delta.Seed);
+						TestTrue(FString::Printf(TEXT("Merged, leaver %d where it was"), Leaver * Fraction),
+							Delta.query(OldHashes[Leaver].data(), 2, Everything) == Full.query(OldHashes[Leaver].data(), 2, Everything));
+						TestTrue(FString::Printf(TEXT("Merged, leaver %d where it is"), Leaver * Fraction),
+							Delta.query(NewHashes.data(), 2, Everything) == Full.query(NewHashes.data(), 2, Everything));
+					}
+				});
+
+			It("should keep a sketch when the key changes but the embedding doesn't", [this]()
+				{
+					Field.Populate(1);
+					FTestDelta Delta;
+					Field.Touch(Delta, 0);
+					Delta.Commit();
+					const FTestDelta::ETouch Outcome = Delta.Touch(0, Field.CellKeyOf(0) + 1, [this](FLESHPoint* Batch)
+						{
+							Field.Embed(0, Batch);
+						});
+					TestEqual("Same voxels, same sketch", Outcome, FTestDelta::ETouch::KeptSketch);
+					TestTrue("Nothing went to the side", Delta.NumInSide() == 0);
+				});
+
+			It("should forget removed entries, and treat them as new if they come back", [this]()
+				{
+					Field.Populate(10);
+					FTestDelta Delta;
+					Field.TouchAll(Delta);
+					Delta.Commit();
+					Delta.Remove(3);
+					Delta.Remove(3);
+					TestTrue("Removed once", Delta.Num() == 9);
+					TestEqual("Coming back is an add", Field.Touch(Delta, 3), FTestDelta::ETouch::Added);
+					Delta.Reset();
+					TestTrue("A reset forgets everything", Delta.Num() == 0);
+					TestTrue("And merges next commit", Delta.Commit());
+				});
+		});
+}
+
+//timings only, so it stays out of the product runs. a full rebuild is a Reset, a Touch for everyone, and a Commit,
+//which is what the broadphase used to do every tick. the cells only hold 16 bit positions and alias past 65k entries,
+//so the sizes stop short of that.
+BEGIN_DEFINE_SPEC(FEmbedderBenchmarks, "Artillery.Barrage.Embedder Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+FEmbedderField Field;
+END_DEFINE_SPEC(FEmbedderBenchmarks)
+void FEmbedderBenchmarks::Define()
+{
+	BeforeEach([this]()
+		{
+			Field.Scatter.Initialize(44);
+		});
+
+	Describe("A Delta FLESH", [this]()
+		{
+			It("should benchmark incremental updates against full rebuilds", [this]()
+				{
+					constexpr int32 Ticks = 4;
+					for (int32 Count : {10000, 30000, 60000})
+					{
+						Field.Populate(Count);
+						FTestDelta Full;
+						FTestDelta Incremental;
+						Field.TouchAll(Full);
+						Full.Commit();
+						Field.TouchAll(Incremental);
+						Incremental.Commit();
+
+						double FullMs = 0;
+						double IncrementalMs = 0;
+						int32 Rehashed = 0;
+						int32 Merges = 0;
+						for (int32 Tick = 0; Tick < Ticks; ++Tick)
+						{
+							//one in twenty crosses a cell each tick.
+							Field.Move(20);
+							double Start = FPlatformTime::Seconds();
+							Full.Reset();
+							Field.TouchAll(Full);
+							Full.Commit();
+							FullMs += (FPlatformTime::Seconds() - Start) * 1000.0;
+
+							Start = FPlatformTime::Seconds();
+							Rehashed += Field.TouchAll(Incremental).FindRef(FTestDelta::ETouch::Rehashed);
+							Merges += Incremental.Commit();
+							IncrementalMs += (FPlatformTime::Seconds() - Start) * 1000.0;
+						}
+						//one in twenty, every tick, and nobody else.
+						TestEqual(FString::Printf(TEXT("%d entries: only the leavers are rehashed"), Count), Rehashed, (Count + 19) / 20 * Ticks);
+						AddInfo(FString::Printf(TEXT("%d entries: full rebuild %.3fms/tick, incremental %.3fms/tick (%d rehashed, %d merges over %d ticks)"),
+							Count, FullMs / Ticks, IncrementalMs / Ticks, Rehashed, Merges, Ticks));
+					}
+				});
+		});
+}
@@ -0,0 +1,163 @@
+#include "Misc/AutomationTest.h"
+#include "FlattenedBodyBox.h"
+
+//a scatter of boxes and the shadows packed from them, kept side by side so a shadow can be checked against its box.
+struct FShadowField
+{
+	FRandomStream Scatter = FRandomStream(42);
+	JPH::BodyBoxPackedGrid Grid;
+	TArray<JPH::AABox> Boxes;
+	TArray<JPH::BodyBoxPackedShadow> Shadows;
+
+	//everything from slivers a few millimeters thick up to crates tens of meters across, over a few km.
+	void Populate(int32 Count)
+	{
+		Boxes.Reset();
+		Shadows.Reset();
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const JPH::Vec3 Center(Scatter.FRandRange(-2000, 2000), Scatter.FRandRange(-2000, 2000), Scatter.FRandRange(-2000, 2000));
+			const JPH::Vec3 Extent(Scatter.FRandRange(0.001f, 0.5f), Scatter.FRandRange(0.01f, 40), Index % 2 ? Scatter.FRandRange(0.01f, 40) : 0.002f);
+			const JPH::AABox Box(Center - Extent, Center + Extent);
+			JPH::BodyBoxPackedShadow Shadow;
+			if (Shadow.Pack(Box, JPH::BodyID(Index), Grid))
+			{
+				Boxes.Add(Box);
+				Shadows.Add(Shadow);
+			}
+		}
+	}
+};
+
+//the packed shadow is allowed to be fat but never thin, so most of this is checking it never loses a real overlap.
+BEGIN_DEFINE_SPEC(FFlattenedBodyBoxTests, "Artillery.Barrage.Flattened Body Box Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+FShadowField Field;
+JPH::BodyBoxPackedGrid& Grid = Field.Grid;
+TArray<JPH::AABox>& Boxes = Field.Boxes;
+TArray<JPH::BodyBoxPackedShadow>& Shadows = Field.Shadows;
+
+TArray<bool> Sweep(const JPH::AABox& Query)
+{
+	TArray<bool> Hit;
+	Hit.SetNumZeroed(Shadows.Num());
+	JPH::BodyBoxPackedShadow::sCollide(Shadows.GetData(), Shadows.Num(), Grid.ToCells(Query), [&](const JPH::BodyBoxPackedShadow& Shadow)
+		{
+			Hit[static_cast<int32>(&Shadow - Shadows.GetData())] = true;
+		});
+	return Hit;
+}
+END_DEFINE_SPEC(FFlattenedBodyBoxTests)
+void FFlattenedBodyBoxTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Field.Scatter.Initialize(42);
+		});
+
+	Describe("A Packed Body Box Shadow", [this]()
+		{
+			It("should always contain the box it was packed from", [this]()
+				{
+					Field.Populate(20000);
+					TestEqual("Nothing that size should be refused", Shadows.Num(), 20000);
+					for (int32 Index = 0; Index < Shadows.Num(); ++Index)
+					{
+						if (!Shadows[Index].GetWorldSpaceBounds(Grid).Contains(Boxes[Index]))
+						{
+							AddError(FString::Printf(TEXT("Shadow %d came out smaller than its box"), Index));
+							return;
+						}
+					}
+				});
+
+			It("should refuse boxes that don't fit", [this]()
+				{
+					JPH::BodyBoxPackedShadow Shadow;
+					TestFalse("Too long", Shadow.Pack(JPH::AABox(JPH::Vec3(0, 0, 0), JPH::Vec3(600, 1, 1)), JPH::BodyID(1), Grid));
+					TestFalse("Too far out", Shadow.Pack(JPH::AABox(JPH::Vec3(70000, 0, 0), JPH::Vec3(70001, 1, 1)), JPH::BodyID(1), Grid));
+					TestTrue("Long, near the edge", Shadow.Pack(JPH::AABox(JPH::Vec3(-65000, 0, 0), JPH::Vec3(-64500, 1, 1)), JPH::BodyID(1), Grid));
+				});
+
+			It("should never miss a real overlap, and should agree with itself four at a time", [this]()
+				{
+					Field.Populate(20000);
+					int32 Touching = 0;
+					for (int32 Query = 0; Query < 50; ++Query)
+					{
+						const JPH::Vec3 Center(Field.Scatter.FRandRange(-2000, 2000), Field.Scatter.FRandRange(-2000, 2000), Field.Scatter.FRandRange(-2000, 2000));
+						const JPH::AABox Box(Center - JPH::Vec3::sReplicate(300), Center + JPH::Vec3::sReplicate(300));
+						const JPH::AABox Cells = Grid.ToCells(Box);
+						const TArray<bool> Hit = Sweep(Box);
+						for (int32 Index = 0; Index < Shadows.Num(); ++Index)
+						{
+							if (Hit[Index] != Shadows[Index].Overlaps(Cells))
+							{
+								AddError(FString::Printf(TEXT("Query %d: simd and scalar disagree on shadow %d"), Query, Index));
+								return;
+							}
+							if (Boxes[Index].Overlaps(Box))
+							{
+								++Touching;
+								if (!Hit[Index])
+								{
+									AddError(FString::Printf(TEXT("Query %d: missed shadow %d"), Query, Index));
+									return;
+								}
+							}
+						}
+					}
+					TestTrue("The queries should actually hit something", Touching > 0);
+				});
+		});
+}
+
+//timings only, so it stays out of the product runs. the packed layout only earns its keep once the sweep falls out of
+//cache, so read both sizes.
+BEGIN_DEFINE_SPEC(FFlattenedBodyBoxBenchmarks, "Artillery.Barrage.Flattened Body Box Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+FShadowField Field;
+END_DEFINE_SPEC(FFlattenedBodyBoxBenchmarks)
+void FFlattenedBodyBoxBenchmarks::Define()
+{
+	Describe("A Packed Body Box Shadow", [this]()
+		{
+			It("should benchmark against the flat copy", [this]()
+				{
+					for (int32 Count : {100000, 2000000})
+					{
+						Field.Populate(Count);
+						TArray<JPH::BodyBoxFlatCopy> Flat;
+						Flat.Reserve(Field.Boxes.Num());
+						for (const JPH::AABox& Box : Field.Boxes)
+						{
+							const JPH::Vec3 Center = Box.GetCenter();
+							const JPH::Vec3 Extent = Box.GetExtent();
+							//same rounding the Body constructor does. hit counts won't match exactly, the layouts don't mean quite the same thing.
+							Flat.Emplace(Center.GetX(), Center.GetY(), Center.GetZ(), static_cast<JPH::HalfFloat>(Extent.GetX() + 1),
+								static_cast<JPH::HalfFloat>(Extent.GetY() + 1), static_cast<JPH::HalfFloat>(Extent.GetZ() + 1), 0, JPH::BodyID(0));
+						}
+						const JPH::AABox Query(JPH::Vec3::sReplicate(-100), JPH::Vec3::sReplicate(100));
+						const JPH::AABox Cells = Field.Grid.ToCells(Query);
+
+						int32 FlatHits = 0;
+						double Start = FPlatformTime::Seconds();
+						for (JPH::BodyBoxFlatCopy& Copy : Flat)
+						{
+							FlatHits += Copy.GetWorldSpaceBounds().Overlaps(Query);
+						}
+						const double FlatMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+						int32 PackedHits = 0;
+						Start = FPlatformTime::Seconds();
+						JPH::BodyBoxPackedShadow::sCollide(Field.Shadows.GetData(), Field.Shadows.Num(), Cells, [&PackedHits](const JPH::BodyBoxPackedShadow&)
+							{
+								++PackedHits;
+							});
+						const double PackedMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+						AddInfo(FString::Printf(TEXT("%d boxes: flat copy (%db) %.3fms for %d hits, packed (%db) %.3fms for %d hits"),
+							Field.Shadows.Num(), static_cast<int32>(sizeof(JPH::BodyBoxFlatCopy)), FlatMs, FlatHits,
+							static_cast<int32>(sizeof(JPH::BodyBoxPackedShadow)), PackedMs, PackedHits));
+					}
+				});
+		});
+}
@@ -0,0 +1,73 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "Jolt/Physics/Collision/BroadPhase/BroadPhase.h"
+#include "Jolt/Physics/Collision/CollisionCollectorImpl.h"
+#include "Jolt/Physics/Collision/GroupFilterTable.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//FLESH is approximate, so this doesn't compare it against the quadtree pair for pair. it checks that bodies sitting right
+//on top of each other are found, and that the ones their collision group rules out never are.
+BEGIN_DEFINE_SPEC(FFleshBroadPhaseTests, "Artillery.Barrage.Flesh BroadPhase Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TSharedPtr<FWorldSimOwner> Flesh;
+
+JPH::BodyID AddSphere(const JPH::RVec3& Where, const JPH::CollisionGroup& Group = {})
+{
+	JPH::BodyCreationSettings Settings(new JPH::SphereShape(0.5f), Where, JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
+	Settings.mCollisionGroup = Group;
+	return Flesh->body_interface->CreateAndAddBody(Settings, JPH::EActivation::Activate);
+}
+
+bool Paired(const JPH::BodyID& A, const JPH::BodyID& B)
+{
+	JPH::BodyIDVector Active;
+	Flesh->physics_system->GetActiveBodies(JPH::EBodyType::RigidBody, Active);
+	JPH::AllHitCollisionCollector<JPH::BodyPairCollector> Collector;
+	static_cast<const JPH::BroadPhase&>(Flesh->physics_system->GetBroadPhaseQuery()).FindCollidingPairs(Active.data(), static_cast<int>(Active.size()),
+		Flesh->physics_system->GetPhysicsSettings().mSpeculativeContactDistance,
+		Flesh->object_vs_broadphase_layer_filter, Flesh->object_vs_object_layer_filter, Collector);
+	for (const JPH::BodyPair& Pair : Collector.mHits)
+	{
+		if ((Pair.mBodyA == A && Pair.mBodyB == B) || (Pair.mBodyA == B && Pair.mBodyB == A))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+END_DEFINE_SPEC(FFleshBroadPhaseTests)
+void FFleshBroadPhaseTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Flesh = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+				{
+					MyWORKERIndex = threadId;
+					MyBARRAGEIndex = threadId;
+				}, EBarrageBroadPhase::Flesh);
+		});
+
+	AfterEach([this]()
+		{
+			Flesh.Reset();
+		});
+
+	Describe("A group aware FLESH broadphase", [this]()
+		{
+			It("should pair overlapping bodies unless their collision group says no", [this]()
+				{
+					//two limbs of the same ragdoll that aren't allowed to touch, and two strangers that are.
+					JPH::Ref<JPH::GroupFilterTable> Ragdoll = new JPH::GroupFilterTable(2);
+					Ragdoll->DisableCollision(0, 1);
+					const JPH::BodyID Upper = AddSphere(JPH::RVec3(0, 10, 0), JPH::CollisionGroup(Ragdoll, 0, 0));
+					const JPH::BodyID Lower = AddSphere(JPH::RVec3(0, 10.2f, 0), JPH::CollisionGroup(Ragdoll, 0, 1));
+					const JPH::BodyID Left = AddSphere(JPH::RVec3(50, 10, 0));
+					const JPH::BodyID Right = AddSphere(JPH::RVec3(50, 10.2f, 0));
+
+					//the shadows and the LSH are only rebuilt when the world steps.
+					Flesh->physics_system->Update(0.016f, 1, Flesh->Allocator.Get(), Flesh->job_system.Get());
+
+					TestTrue("Strangers on top of each other should pair", Paired(Left, Right));
+					TestFalse("Limbs the group table keeps apart should never pair", Paired(Upper, Lower));
+				});
+		});
+}
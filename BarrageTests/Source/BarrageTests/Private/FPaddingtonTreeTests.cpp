@@ -0,0 +1,205 @@
+#include "Misc/AutomationTest.h"
+#include "Algo/Count.h"
+#include "FWorldSimOwner.h"
+#include "Jolt/Physics/Body/BodyLock.h"
+#include "Jolt/Physics/Collision/BroadPhase/BroadPhase.h"
+#include "Jolt/Physics/Collision/CollisionCollectorImpl.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//two worlds fed the exact same bodies in the exact same order, so their body ids line up and the broadphases can be
+//compared directly. the quadtree is the reference.
+BEGIN_DEFINE_SPEC(FPaddingtonTreeTests, "Artillery.Barrage.Paddington Tree Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TSharedPtr<FWorldSimOwner> QuadTree;
+TSharedPtr<FWorldSimOwner> Paddington;
+TArray<JPH::BodyID> Movers;
+FRandomStream Scatter;
+
+TSharedPtr<FWorldSimOwner> MakeWorld(EBarrageBroadPhase BroadPhase)
+{
+	return MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+		{
+			MyWORKERIndex = threadId;
+			MyBARRAGEIndex = threadId;
+		}, BroadPhase);
+}
+
+void AddToBoth(const JPH::BodyCreationSettings& Settings, JPH::EActivation Activation)
+{
+	const JPH::BodyID Reference = QuadTree->body_interface->CreateAndAddBody(Settings, Activation);
+	const JPH::BodyID Actual = Paddington->body_interface->CreateAndAddBody(Settings, Activation);
+	check(Reference == Actual);
+	if (Settings.mMotionType != JPH::EMotionType::Static)
+	{
+		Movers.Add(Reference);
+	}
+}
+
+//a swarm of small spheres packed close enough that plenty of them touch, over a floor and a few crates.
+void Populate(int32 Count)
+{
+	JPH::BodyCreationSettings Floor(new JPH::BoxShape(JPH::Vec3(200, 1, 200)), JPH::RVec3(0, -1, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+	AddToBoth(Floor, JPH::EActivation::DontActivate);
+	for (int32 Index = 0; Index < 16; ++Index)
+	{
+		JPH::BodyCreationSettings Crate(new JPH::BoxShape(JPH::Vec3(1, 1, 1)), JPH::RVec3(Scatter.FRandRange(-20, 20), 1, Scatter.FRandRange(-20, 20)), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+		AddToBoth(Crate, JPH::EActivation::DontActivate);
+	}
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		AddMover();
+	}
+}
+
+//players and enemies, alternating. both collide with themselves and each other, so the swarm makes pairs on its own
+//instead of only against the floor and crates. projectiles don't, which would leave most of the tree untested.
+void AddMover()
+{
+	const JPH::ObjectLayer Layer = Movers.Num() % 2 == 0 ? Layers::MOVING : Layers::ENEMY;
+	JPH::BodyCreationSettings Mover(new JPH::SphereShape(0.2f), JPH::RVec3(Scatter.FRandRange(-20, 20), Scatter.FRandRange(0, 4), Scatter.FRandRange(-20, 20)), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layer);
+	AddToBoth(Mover, JPH::EActivation::Activate);
+}
+
+static const JPH::BroadPhase& BroadPhaseOf(const FWorldSimOwner& World)
+{
+	//every broadphase query we get handed is a whole broadphase, jolt just doesn't admit it.
+	return static_cast<const JPH::BroadPhase&>(World.physics_system->GetBroadPhaseQuery());
+}
+
+//all pairs the broadphase hands the narrowphase, lower id first, sorted.
+TArray<TPair<uint32, uint32>> Pairs(const FWorldSimOwner& World)
+{
+	JPH::BodyIDVector Active;
+	World.physics_system->GetActiveBodies(JPH::EBodyType::RigidBody, Active);
+	JPH::AllHitCollisionCollector<JPH::BodyPairCollector> Collector;
+	BroadPhaseOf(World).FindCollidingPairs(Active.data(), static_cast<int>(Active.size()), World.physics_system->GetPhysicsSettings().mSpeculativeContactDistance,
+		World.object_vs_broadphase_layer_filter, World.object_vs_object_layer_filter, Collector);
+	TArray<TPair<uint32, uint32>> Out;
+	for (const JPH::BodyPair& Pair : Collector.mHits)
+	{
+		const uint32 A = Pair.mBodyA.GetIndexAndSequenceNumber();
+		const uint32 B = Pair.mBodyB.GetIndexAndSequenceNumber();
+		Out.Emplace(FMath::Min(A, B), FMath::Max(A, B));
+	}
+	Out.Sort();
+	return Out;
+}
+
+//the quadtree only ever grows its node bounds between rebuilds, so it hands back bodies that have since moved away.
+//both broadphases are allowed to do that, so only compare the hits that really overlap.
+TArray<uint32> Overlapping(const FWorldSimOwner& World, const JPH::AABox& Box)
+{
+	JPH::AllHitCollisionCollector<JPH::CollideShapeBodyCollector> Collector;
+	BroadPhaseOf(World).CollideAABox(Box, Collector);
+	TArray<uint32> Out;
+	for (const JPH::BodyID& Hit : Collector.mHits)
+	{
+		JPH::BodyLockRead Lock(World.physics_system->GetBodyLockInterfaceNoLock(), Hit);
+		if (Lock.Succeeded() && Lock.GetBody().GetWorldSpaceBounds().Overlaps(Box))
+		{
+			Out.Add(Hit.GetIndexAndSequenceNumber());
+		}
+	}
+	Out.Sort();
+	return Out;
+}
+
+void ExpectSamePairs(const FString& When)
+{
+	const TArray<TPair<uint32, uint32>> Expected = Pairs(*QuadTree);
+	const TArray<TPair<uint32, uint32>> Actual = Pairs(*Paddington);
+	TestTrue(FString::Printf(TEXT("%s: the swarm should actually be touching"), *When), Expected.Num() > 0);
+	TSet<uint32> Swarm;
+	for (const JPH::BodyID& Mover : Movers)
+	{
+		Swarm.Add(Mover.GetIndexAndSequenceNumber());
+	}
+	const int32 SwarmPairs = Algo::CountIf(Expected, [&Swarm](const TPair<uint32, uint32>& Pair) { return Swarm.Contains(Pair.Key) && Swarm.Contains(Pair.Value); });
+	TestTrue(FString::Printf(TEXT("%s: and touching each other, not just the floor"), *When), SwarmPairs > 0);
+	if (Expected != Actual)
+	{
+		AddError(FString::Printf(TEXT("%s: quadtree found %d pairs, paddington found %d"), *When, Expected.Num(), Actual.Num()));
+	}
+	const JPH::AABox Box(JPH::Vec3(-5, 0, -5), JPH::Vec3(5, 3, 5));
+	TestEqual(FString::Printf(TEXT("%s: box query"), *When), Overlapping(*Paddington, Box), Overlapping(*QuadTree, Box));
+}
+END_DEFINE_SPEC(FPaddingtonTreeTests)
+void FPaddingtonTreeTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Scatter.Initialize(41);
+			QuadTree = MakeWorld(EBarrageBroadPhase::QuadTree);
+			Paddington = MakeWorld(EBarrageBroadPhase::PaddingtonTree);
+		});
+
+	AfterEach([this]()
+		{
+			Movers.Empty();
+			QuadTree.Reset();
+			Paddington.Reset();
+		});
+
+	Describe("A Paddington Tree", [this]()
+		{
+			It("should find the same pairs as the quadtree before it is ever rebuilt", [this]()
+				{
+					Populate(2000);
+					ExpectSamePairs(TEXT("pending only"));
+				});
+
+			It("should find the same pairs as the quadtree after an optimize", [this]()
+				{
+					Populate(2000);
+					QuadTree->physics_system->OptimizeBroadPhase();
+					Paddington->physics_system->OptimizeBroadPhase();
+					ExpectSamePairs(TEXT("optimized"));
+				});
+
+			It("should keep finding the same pairs as bodies move, leave, and arrive", [this]()
+				{
+					Populate(2000);
+					QuadTree->physics_system->OptimizeBroadPhase();
+					Paddington->physics_system->OptimizeBroadPhase();
+
+					//small nudges stay inside the padding, big ones escape it. both have to show up.
+					for (int32 Index = 0; Index < Movers.Num(); ++Index)
+					{
+						const float Reach = Index % 4 == 0 ? 3.f : 0.05f;
+						const JPH::RVec3 Nudge(Scatter.FRandRange(-Reach, Reach), Scatter.FRandRange(-Reach, Reach), Scatter.FRandRange(-Reach, Reach));
+						for (FWorldSimOwner* World : {QuadTree.Get(), Paddington.Get()})
+						{
+							World->body_interface->SetPosition(Movers[Index], World->body_interface->GetPosition(Movers[Index]) + Nudge, JPH::EActivation::DontActivate);
+						}
+					}
+					ExpectSamePairs(TEXT("moved"));
+
+					for (int32 Index = Movers.Num() - 1; Index >= 0; Index -= 3)
+					{
+						for (FWorldSimOwner* World : {QuadTree.Get(), Paddington.Get()})
+						{
+							World->body_interface->RemoveBody(Movers[Index]);
+							World->body_interface->DestroyBody(Movers[Index]);
+						}
+						Movers.RemoveAt(Index);
+					}
+					ExpectSamePairs(TEXT("removed"));
+
+					for (int32 Index = 0; Index < 500; ++Index)
+					{
+						AddMover();
+					}
+					ExpectSamePairs(TEXT("re-added"));
+
+					//a step runs the real UpdatePrepare/UpdateFinalize path with the old buffers held open. the solver won't
+					//see the pairs in the same order in both worlds, so line the bodies back up before comparing.
+					QuadTree->physics_system->Update(0.016f, 1, QuadTree->Allocator.Get(), QuadTree->job_system.Get());
+					Paddington->physics_system->Update(0.016f, 1, Paddington->Allocator.Get(), Paddington->job_system.Get());
+					for (const JPH::BodyID& Mover : Movers)
+					{
+						Paddington->body_interface->SetPosition(Mover, QuadTree->body_interface->GetPosition(Mover), JPH::EActivation::DontActivate);
+					}
+					ExpectSamePairs(TEXT("stepped"));
+				});
+		});
+}
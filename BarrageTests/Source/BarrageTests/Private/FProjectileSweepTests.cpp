@@ -0,0 +1,153 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "BarrageProjectileSweep.h"
+#include "CoordinateUtils.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//a crate at the origin, and bullets flying at it from a few meters out. everything is placed in jolt coordinates and
+//handed to the sweep in UE ones, the way a gun would.
+BEGIN_DEFINE_SPEC(FProjectileSweepTests, "Artillery.Barrage.Projectile Sweep Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TSharedPtr<FWorldSimOwner> Sim;
+FBarrageProjectileSweep Sweep;
+JPH::BodyID Crate;
+
+FBarrageSweptProjectileParams Aim(uint64 Key, const JPH::Vec3& From, const JPH::Vec3& Velocity, float Radius = 0.f, Layers::EJoltPhysicsLayer Layer = Layers::PROJECTILE)
+{
+	FBarrageSweptProjectileParams Params;
+	Params.Projectile = FSkeletonKey(Key);
+	Params.Origin = FVector3d(CoordinateUtils::FromJoltCoordinates(From));
+	Params.Velocity = FVector3d(CoordinateUtils::FromJoltCoordinates(Velocity));
+	Params.Radius = Radius;
+	Params.Layer = Layer;
+	return Params;
+}
+
+void Launch(uint64 Key, const JPH::Vec3& From, const JPH::Vec3& Velocity, float Radius = 0.f, Layers::EJoltPhysicsLayer Layer = Layers::PROJECTILE)
+{
+	Sweep.Launch(Aim(Key, From, Velocity, Radius, Layer));
+}
+END_DEFINE_SPEC(FProjectileSweepTests)
+void FProjectileSweepTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Sim = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+				{
+					MyWORKERIndex = threadId;
+					MyBARRAGEIndex = threadId;
+				});
+			JPH::BodyCreationSettings Settings(new JPH::BoxShape(JPH::Vec3(1, 1, 1)), JPH::RVec3::sZero(), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+			Crate = Sim->body_interface->CreateAndAddBody(Settings, JPH::EActivation::DontActivate);
+		});
+
+	AfterEach([this]()
+		{
+			Sweep.Reset();
+			Sim.Reset();
+		});
+
+	Describe("A Projectile Sweep", [this]()
+		{
+			It("should report the first thing a segment runs into, and stop that projectile", [this]()
+				{
+					//5m out at 200m/s is 3.2m a tick, so the first tick falls short and the second one gets there.
+					Launch(1, JPH::Vec3(0, 0, -5), JPH::Vec3(0, 0, 200));
+					Launch(2, JPH::Vec3(0, 0, 5), JPH::Vec3(0, 0, -200), 0.1f);
+					Sweep.Sweep(*Sim, 0.016f);
+					TestTrue("Nothing is close enough yet", Sweep.Hits().IsEmpty());
+					TestEqual("Both are still in flight", Sweep.Num(), 2);
+
+					Sweep.Sweep(*Sim, 0.016f);
+					TestEqual("Both hit", Sweep.Hits().Num(), 2);
+					TestEqual("And are done", Sweep.Num(), 0);
+					for (const FBarrageSweepHit& Hit : Sweep.Hits())
+					{
+						TestTrue("The crate is what got hit", Hit.Body == Crate.GetIndexAndSequenceNumber());
+						TestEqual("On the crate's layer", Hit.BodyLayer, Layers::NON_MOVING);
+						TestEqual("By a projectile", Hit.ProjectileLayer, Layers::PROJECTILE);
+					}
+					const FBarrageSweepHit& Ray = Sweep.Hits()[0];
+					TestTrue("Sorted by key", Ray.Projectile == FSkeletonKey(1ull));
+					//the ray starts the tick 0.8m out with 3.2m to go, so it lands a quarter of the way along, on the crate's face.
+					TestTrue("The ray lands on the face", FMath::IsNearlyEqual(Ray.Fraction, 0.25f, 0.01f));
+					TestTrue("Where the face is", Ray.Point.Equals(CoordinateUtils::FromJoltCoordinates(JPH::Vec3(0, 0, -1)), 1.f));
+				});
+
+			It("should only see what the projectile's layer collides with", [this]()
+				{
+					//player bodies are MOVING, which PROJECTILE looks straight through.
+					JPH::BodyCreationSettings Settings(new JPH::SphereShape(0.5f), JPH::RVec3(0, 0, -3), JPH::Quat::sIdentity(), JPH::EMotionType::Kinematic, Layers::MOVING);
+					const JPH::BodyID Player = Sim->body_interface->CreateAndAddBody(Settings, JPH::EActivation::DontActivate);
+					Launch(1, JPH::Vec3(0, 0, -5), JPH::Vec3(0, 0, 200));
+					Launch(2, JPH::Vec3(0, 0, -5), JPH::Vec3(0, 0, 200), 0.f, Layers::ENEMYPROJECTILE);
+					Sweep.Sweep(*Sim, 0.016f);
+					TestEqual("Only the enemy's shot hits the player", Sweep.Hits().Num(), 1);
+					if (Sweep.Hits().Num() == 1)
+					{
+						TestTrue("Which is the enemy's", Sweep.Hits()[0].Projectile == FSkeletonKey(2ull));
+						TestTrue("On the player", Sweep.Hits()[0].Body == Player.GetIndexAndSequenceNumber());
+					}
+					Sweep.Sweep(*Sim, 0.016f);
+					TestEqual("The other one carries on to the crate", Sweep.Hits().Num(), 1);
+				});
+
+			It("should drop stopped projectiles, and retire misses once they run out of time", [this]()
+				{
+					FBarrageSweptProjectileParams Miss = Aim(1, JPH::Vec3(0, 0, -5), JPH::Vec3(0, 0, -200));
+					//four and a half ticks, so the fifth is cut short.
+					Miss.MaxLifetime = 0.016f * 4.5f;
+					Sweep.Launch(Miss);
+					Launch(2, JPH::Vec3(0, 0, -5), JPH::Vec3(0, 0, 200));
+					Sweep.Stop(FSkeletonKey(2ull));
+					for (int32 Tick = 0; Tick < 4; ++Tick)
+					{
+						Sweep.Sweep(*Sim, 0.016f);
+						TestTrue("Nothing hits", Sweep.Hits().IsEmpty());
+					}
+					TestEqual("The miss is still flying", Sweep.Num(), 1);
+					Sweep.Sweep(*Sim, 0.016f);
+					TestTrue("Still nothing hits", Sweep.Hits().IsEmpty());
+					TestEqual("And the miss is retired", Sweep.Num(), 0);
+				});
+
+			It("should never hit anything past its range or lifetime", [this]()
+				{
+					//2.4m a tick, and both run out 3m along, a meter short of the crate's face. uncut, either one's second
+					//tick would hit it.
+					FBarrageSweptProjectileParams Short = Aim(1, JPH::Vec3(0, 0, -5), JPH::Vec3(0, 0, 150));
+					Short.MaxRange = CoordinateUtils::JoltToRadius(3);
+					FBarrageSweptProjectileParams Brief = Aim(2, JPH::Vec3(0, 0, 5), JPH::Vec3(0, 0, -150), 0.1f);
+					Brief.MaxLifetime = 0.02f;
+					Sweep.Launch(Short);
+					Sweep.Launch(Brief);
+					Sweep.Sweep(*Sim, 0.016f);
+					TestEqual("Both are still in flight after one tick", Sweep.Num(), 2);
+					Sweep.Sweep(*Sim, 0.016f);
+					TestTrue("Neither reaches the crate", Sweep.Hits().IsEmpty());
+					TestEqual("Both are retired", Sweep.Num(), 0);
+				});
+
+			It("should agree with itself when the rows are split across jobs", [this]()
+				{
+					//a ring of bullets all aimed at the crate, enough of them that the sweep splits into several jobs.
+					constexpr int32 Count = FBarrageProjectileSweep::ProjectilesPerJob * 8;
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						const float Angle = UE_TWO_PI * Index / Count;
+						const JPH::Vec3 From(FMath::Cos(Angle) * 5, Index % 3 * 0.5f - 0.5f, FMath::Sin(Angle) * 5);
+						Launch(Count - Index, From, -From.Normalized() * 500, Index % 2 ? 0.05f : 0.f);
+					}
+					Sweep.Sweep(*Sim, 0.016f);
+					TestEqual("Every bullet hits", Sweep.Hits().Num(), Count);
+					for (int32 Index = 1; Index < Sweep.Hits().Num(); ++Index)
+					{
+						if (!(Sweep.Hits()[Index - 1].Projectile.Obj < Sweep.Hits()[Index].Projectile.Obj))
+						{
+							AddError(FString::Printf(TEXT("Hit %d is out of order"), Index));
+							return;
+						}
+					}
+				});
+		});
+}
@@ -0,0 +1,284 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "CollisionDetectionFilters/RayPacket.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//a field of crates and balls, and beams fired into it from outside. every ray starts in the open, so there's never a
+//tie at the origin for the two paths to break differently, and the single ray CastRay is the reference.
+struct FRayField
+{
+	TSharedPtr<FWorldSimOwner> Sim;
+	FRandomStream Scatter;
+	TArray<FVector3d> From;
+	TArray<FVector3d> Directions;
+
+	void Setup()
+	{
+		Scatter.Initialize(47);
+		Sim = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+			{
+				MyWORKERIndex = threadId;
+				MyBARRAGEIndex = threadId;
+			});
+	}
+
+	void Populate(int32 Count)
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const JPH::RVec3 Where(Scatter.FRandRange(-30, 30), Scatter.FRandRange(0, 10), Scatter.FRandRange(-30, 30));
+			JPH::Ref<JPH::Shape> Shape = Index % 2
+				? static_cast<JPH::Shape*>(new JPH::BoxShape(JPH::Vec3(Scatter.FRandRange(0.2f, 2), Scatter.FRandRange(0.2f, 2), Scatter.FRandRange(0.2f, 2))))
+				: static_cast<JPH::Shape*>(new JPH::SphereShape(Scatter.FRandRange(0.2f, 2)));
+			JPH::BodyCreationSettings Settings(Shape, Where, JPH::Quat::sRotation(JPH::Vec3::sAxisY(), Scatter.FRandRange(0, UE_PI)), JPH::EMotionType::Static, Layers::NON_MOVING);
+			Sim->body_interface->CreateAndAddBody(Settings, JPH::EActivation::DontActivate);
+		}
+		Sim->OptimizeBroadPhase();
+	}
+
+	//Count beams of RaysPerBeam rays each, a little spread, starting 50m out and aimed through the field, in UE units.
+	void Beams(int32 Count, int32 RaysPerBeam)
+	{
+		From.Reset();
+		Directions.Reset();
+		for (int32 Beam = 0; Beam < Count; ++Beam)
+		{
+			const FVector3d Origin = FVector3d(Scatter.GetUnitVector().GetSafeNormal2D() * 5000) + FVector3d(0, 0, Scatter.FRandRange(0, 1000));
+			const FVector3d Aim = (FVector3d(Scatter.FRandRange(-1000, 1000), Scatter.FRandRange(-1000, 1000), Scatter.FRandRange(0, 1000)) - Origin).GetSafeNormal();
+			for (int32 Ray = 0; Ray < RaysPerBeam; ++Ray)
+			{
+				From.Add(Origin + FVector3d(Ray % 4 * 20, Ray / 4 * 20, 0));
+				Directions.Add((Aim + FVector3d(Scatter.VRand()) * 0.02).GetSafeNormal() * 10000);
+			}
+		}
+	}
+};
+
+BEGIN_DEFINE_SPEC(FRayPacketTests, "Artillery.Barrage.Ray Packet Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+FRayField Field;
+TSharedPtr<FWorldSimOwner>& Sim = Field.Sim;
+FRandomStream& Scatter = Field.Scatter;
+TArray<FVector3d>& From = Field.From;
+TArray<FVector3d>& Directions = Field.Directions;
+END_DEFINE_SPEC(FRayPacketTests)
+void FRayPacketTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Field.Setup();
+		});
+
+	AfterEach([this]()
+		{
+			Sim.Reset();
+		});
+
+	Describe("A Ray Packet", [this]()
+		{
+			It("should cull the same boxes with and without SIMD", [this]()
+				{
+					for (int32 Test = 0; Test < 5000; ++Test)
+					{
+						JPH::RRayCast Rays[RayPacket::MaxRays];
+						const int32 Count = 1 + Test % RayPacket::MaxRays;
+						for (int32 Ray = 0; Ray < Count; ++Ray)
+						{
+							//some rays run straight down an axis, which is the case the slabs have to special case.
+							JPH::Vec3 Direction(Scatter.FRandRange(-20, 20), Ray % 5 ? Scatter.FRandRange(-20, 20) : 0, Scatter.FRandRange(-20, 20));
+							if (Ray % 7 == 0)
+							{
+								Direction = JPH::Vec3(0, Direction.GetY(), 0);
+							}
+							Rays[Ray] = JPH::RRayCast(JPH::Vec3(Scatter.FRandRange(-20, 20), Scatter.FRandRange(-20, 20), Scatter.FRandRange(-20, 20)), Direction);
+						}
+						RayPacket Packet(MakeArrayView(Rays, Count));
+						Packet.ClampRay(0, 0.3f);
+						const JPH::Vec3 Center(Scatter.FRandRange(-20, 20), Scatter.FRandRange(-20, 20), Scatter.FRandRange(-20, 20));
+						const JPH::Vec3 Extent(Scatter.FRandRange(0.1f, 3), Scatter.FRandRange(0.1f, 3), Scatter.FRandRange(0.1f, 3));
+						const JPH::AABox Box(Center - Extent, Center + Extent);
+						if (Packet.Overlaps(Box) != Packet.OverlapsScalar(Box))
+						{
+							AddError(FString::Printf(TEXT("Test %d: simd and scalar disagree"), Test));
+							return;
+						}
+					}
+				});
+
+			It("should find what CastRay finds, ray for ray", [this]()
+				{
+					Field.Populate(600);
+					Field.Beams(64, RayPacket::MaxRays);
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					const JPH::BodyFilter Everything;
+					TArray<FHitResult> Packed;
+					Packed.SetNum(From.Num());
+					Sim->CastRayPacket(From, Directions, Profile.BroadPhase, Profile.Objects, Everything, Packed);
+
+					int32 Hits = 0;
+					TSharedPtr<FHitResult> Single = MakeShared<FHitResult>();
+					for (int32 Ray = 0; Ray < From.Num(); ++Ray)
+					{
+						Sim->CastRay(From[Ray], Directions[Ray], Profile.BroadPhase, Profile.Objects, Everything, Single);
+						if (Single->MyItem != Packed[Ray].MyItem)
+						{
+							AddError(FString::Printf(TEXT("Ray %d: CastRay hit %d, the packet hit %d"), Ray, Single->MyItem, Packed[Ray].MyItem));
+							return;
+						}
+						if (Single->MyItem != JPH::BodyID::cInvalidBodyID)
+						{
+							++Hits;
+							TestTrue(FString::Printf(TEXT("Ray %d: same distance"), Ray), FMath::IsNearlyEqual(Single->Distance, Packed[Ray].Distance, 0.1f));
+						}
+					}
+					TestTrue("The beams should actually hit things", Hits > From.Num() / 4);
+				});
+
+			It("should handle a ragged last packet", [this]()
+				{
+					Field.Populate(200);
+					Field.Beams(3, 7);
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					TArray<FHitResult> Packed;
+					Packed.SetNum(From.Num());
+					Sim->CastRayPacket(From, Directions, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), Packed);
+					TSharedPtr<FHitResult> Single = MakeShared<FHitResult>();
+					for (int32 Ray = 0; Ray < From.Num(); ++Ray)
+					{
+						Sim->CastRay(From[Ray], Directions[Ray], Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), Single);
+						TestEqual(FString::Printf(TEXT("Ray %d"), Ray), Packed[Ray].MyItem, Single->MyItem);
+					}
+				});
+
+			It("should wrap a diagonal beam in a box far thinner than the axis aligned one", [this]()
+				{
+					JPH::RRayCast Rays[RayPacket::MaxRays];
+					for (int32 Ray = 0; Ray < RayPacket::MaxRays; ++Ray)
+					{
+						const JPH::Vec3 Spread(Scatter.FRandRange(-0.2f, 0.2f), Scatter.FRandRange(-0.2f, 0.2f), Scatter.FRandRange(-0.2f, 0.2f));
+						Rays[Ray] = JPH::RRayCast(JPH::Vec3(Ray % 4 * 0.2f, Ray / 4 * 0.2f, 0), JPH::Vec3(100, 100, 100) + Spread);
+					}
+					RayPacket Packet(MakeArrayView(Rays, RayPacket::MaxRays));
+					const JPH::Vec3 Half = Packet.GetOrientedBounds().mHalfExtents;
+					const float Oriented = 8 * Half.GetX() * Half.GetY() * Half.GetZ();
+					TestTrue("Walks with the oriented box", Packet.IsOrientedBoundsTighter());
+					TestTrue("Which is a sliver of the axis aligned one", Oriented < Packet.GetBounds().GetVolume() / 100);
+					for (const JPH::RRayCast& Ray : Rays)
+					{
+						for (const JPH::Vec3 End : {JPH::Vec3(Ray.mOrigin), JPH::Vec3(Ray.mOrigin + Ray.mDirection)})
+						{
+							TestTrue("And still holds every segment", Packet.GetOrientedBounds().Overlaps(JPH::AABox(End - JPH::Vec3::sReplicate(0.001f), End + JPH::Vec3::sReplicate(0.001f))));
+						}
+					}
+				});
+
+			It("should find what CastRay finds when the beams come in shuffled together", [this]()
+				{
+					Field.Populate(600);
+					Field.Beams(16, RayPacket::MaxRays);
+					for (int32 Ray = From.Num() - 1; Ray > 0; --Ray)
+					{
+						const int32 Other = Scatter.RandRange(0, Ray);
+						From.Swap(Ray, Other);
+						Directions.Swap(Ray, Other);
+					}
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					TArray<FHitResult> Packed;
+					Packed.SetNum(From.Num());
+					Sim->CastRayPacket(From, Directions, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), Packed);
+					TSharedPtr<FHitResult> Single = MakeShared<FHitResult>();
+					for (int32 Ray = 0; Ray < From.Num(); ++Ray)
+					{
+						Sim->CastRay(From[Ray], Directions[Ray], Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), Single);
+						if (Single->MyItem != Packed[Ray].MyItem)
+						{
+							AddError(FString::Printf(TEXT("Ray %d: CastRay hit %d, the packet hit %d"), Ray, Single->MyItem, Packed[Ray].MyItem));
+							return;
+						}
+					}
+				});
+
+			It("should miss a ray with a NaN origin, and still cast the rest of its packet", [this]()
+				{
+					Field.Populate(200);
+					Field.Beams(2, RayPacket::MaxRays);
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					const TSet<int32> Broken = {3, RayPacket::MaxRays, RayPacket::MaxRays + 9};
+					for (int32 Ray : Broken)
+					{
+						From[Ray].Y = std::numeric_limits<double>::quiet_NaN();
+					}
+					TArray<FHitResult> Packed;
+					Packed.SetNum(From.Num());
+					//left over from some earlier cast.
+					for (FHitResult& Hit : Packed)
+					{
+						Hit.MyItem = 1;
+						Hit.bBlockingHit = true;
+					}
+					Sim->CastRayPacket(From, Directions, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), Packed);
+					TSharedPtr<FHitResult> Single = MakeShared<FHitResult>();
+					for (int32 Ray = 0; Ray < From.Num(); ++Ray)
+					{
+						if (Broken.Contains(Ray))
+						{
+							TestEqual(FString::Printf(TEXT("Ray %d is a miss"), Ray), Packed[Ray].MyItem, static_cast<int32>(JPH::BodyID::cInvalidBodyID));
+							TestFalse(FString::Printf(TEXT("Ray %d isn't blocked"), Ray), Packed[Ray].bBlockingHit);
+							continue;
+						}
+						Sim->CastRay(From[Ray], Directions[Ray], Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), Single);
+						TestEqual(FString::Printf(TEXT("Ray %d"), Ray), Packed[Ray].MyItem, Single->MyItem);
+					}
+				});
+		});
+}
+
+//timings, so it stays out of the product runs. the packet only wins when the rays are coherent, which is what beams
+//and LOS fans are.
+BEGIN_DEFINE_SPEC(FRayPacketBenchmarks, "Artillery.Barrage.Ray Packet Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+FRayField Field;
+END_DEFINE_SPEC(FRayPacketBenchmarks)
+void FRayPacketBenchmarks::Define()
+{
+	BeforeEach([this]()
+		{
+			Field.Setup();
+		});
+
+	AfterEach([this]()
+		{
+			Field.Sim.Reset();
+		});
+
+	Describe("A Ray Packet", [this]()
+		{
+			It("should benchmark against single rays", [this]()
+				{
+					Field.Populate(5000);
+					Field.Beams(256, RayPacket::MaxRays);
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					const JPH::BodyFilter Everything;
+					TArray<FHitResult> Packed;
+					Packed.SetNum(Field.From.Num());
+
+					double Start = FPlatformTime::Seconds();
+					TSharedPtr<FHitResult> Single = MakeShared<FHitResult>();
+					for (int32 Ray = 0; Ray < Field.From.Num(); ++Ray)
+					{
+						Field.Sim->CastRay(Field.From[Ray], Field.Directions[Ray], Profile.BroadPhase, Profile.Objects, Everything, Single);
+					}
+					const double SingleMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+					Start = FPlatformTime::Seconds();
+					Field.Sim->CastRayPacket(Field.From, Field.Directions, Profile.BroadPhase, Profile.Objects, Everything, Packed);
+					const double PacketMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+					//generous, since this is wall clock on whatever else the machine is doing. losing by more than this means
+					//the packets stopped culling.
+					TestTrue("Packets shouldn't be much slower than single rays", PacketMs < SingleMs * 2);
+					AddInfo(FString::Printf(TEXT("%d rays into 5000 bodies: one at a time %.3fms, in packets of %d %.3fms"),
+						Field.From.Num(), SingleMs, RayPacket::MaxRays, PacketMs));
+				});
+		});
+}
@@ -0,0 +1,252 @@
+#include "Misc/AutomationTest.h"
+#include "Algo/Count.h"
+#include "FWorldSimOwner.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+static bool Even(uint32 Body)
+{
+	return JPH::BodyID(Body).GetIndex() % 2 == 0;
+}
+
+//a crowd of small bodies on a floor-sized patch, searched the old way and the new ways. SphereSearch is the reference.
+//like SphereSearch, the radius is in jolt units and the centers are in UE ones.
+struct FCountingPatch
+{
+	TSharedPtr<FWorldSimOwner> Sim;
+	FRandomStream Scatter;
+	TArray<FVector3d> Centers;
+	static constexpr double Radius = 4;
+
+	void Setup()
+	{
+		Scatter.Initialize(48);
+		Sim = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+			{
+				MyWORKERIndex = threadId;
+				MyBARRAGEIndex = threadId;
+			});
+		Populate(4000);
+	}
+
+	void Populate(int32 Count)
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			JPH::BodyCreationSettings Settings(new JPH::SphereShape(0.4f), JPH::RVec3(Scatter.FRandRange(-40, 40), 1, Scatter.FRandRange(-40, 40)), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+			Sim->body_interface->CreateAndAddBody(Settings, JPH::EActivation::DontActivate);
+		}
+		Sim->OptimizeBroadPhase();
+	}
+
+	//a volley's worth of targets, all within a few meters of each other.
+	void Scatter_Centers(int32 Count)
+	{
+		Centers.Reset();
+		const FVector3d Middle(Scatter.FRandRange(-2000, 2000), Scatter.FRandRange(-2000, 2000), 100);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Centers.Add(Middle + FVector3d(Scatter.FRandRange(-600, 600), Scatter.FRandRange(-600, 600), 0));
+		}
+	}
+
+	uint32 Search(const FVector3d& Center, TArray<uint32>& OutFound) const
+	{
+		const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+		uint32 Count = 0;
+		OutFound.Reset();
+		Sim->SphereSearch(JPH::BodyID(), Center, Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Count, OutFound);
+		return Count;
+	}
+};
+
+BEGIN_DEFINE_SPEC(FSphereCountTests, "Artillery.Barrage.Sphere Count Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+FCountingPatch Patch;
+TSharedPtr<FWorldSimOwner>& Sim = Patch.Sim;
+TArray<FVector3d>& Centers = Patch.Centers;
+static constexpr double Radius = FCountingPatch::Radius;
+END_DEFINE_SPEC(FSphereCountTests)
+void FSphereCountTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Patch.Setup();
+		});
+
+	AfterEach([this]()
+		{
+			Sim.Reset();
+		});
+
+	Describe("A Sphere Count", [this]()
+		{
+			It("should count what SphereSearch finds, through the predicate", [this]()
+				{
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					TArray<uint32> Found;
+					int32 Total = 0;
+					for (int32 Probe = 0; Probe < 32; ++Probe)
+					{
+						Patch.Scatter_Centers(1);
+						Patch.Search(Centers[0], Found);
+						Total += Found.Num();
+						const uint32 Expected = Algo::CountIf(Found, &Even);
+						const uint32 Actual = Sim->SphereCount(Centers[0], Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even);
+						TestEqual(FString::Printf(TEXT("Probe %d"), Probe), Actual, Expected);
+					}
+					TestTrue("The probes should actually find things", Total > 0);
+				});
+
+			It("should stop as soon as it has enough, and hand back the first K", [this]()
+				{
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					TArray<uint32> Found;
+					Patch.Scatter_Centers(1);
+					while (Patch.Search(Centers[0], Found) < 6)
+					{
+						Patch.Scatter_Centers(1);
+					}
+					int32 Asked = 0;
+					TArray<uint32> First;
+					const uint32 Count = Sim->SphereCount(Centers[0], Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(),
+						[&Asked](uint32)
+						{
+							++Asked;
+							return true;
+						}, 3, &First);
+					TestEqual("Stops at three", Count, 3u);
+					TestEqual("And asks no more than it had to", Asked, 3);
+					TestEqual("The first three", First.Num(), 3);
+					for (uint32 Body : First)
+					{
+						TestTrue("Are ones SphereSearch found", Found.Contains(Body));
+					}
+				});
+
+			It("should count every center the same as one at a time, asking about each body once", [this]()
+				{
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					Patch.Scatter_Centers(64);
+					TMap<uint32, int32> Asked;
+					TArray<uint32> Counts;
+					Counts.SetNum(Centers.Num());
+					Sim->SphereCountMany(Centers, Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(),
+						[&Asked](uint32 Body)
+						{
+							++Asked.FindOrAdd(Body);
+							return Even(Body);
+						}, Counts);
+					for (const TPair<uint32, int32>& Body : Asked)
+					{
+						if (Body.Value != 1)
+						{
+							AddError(FString::Printf(TEXT("Body %u was asked about %d times"), Body.Key, Body.Value));
+							return;
+						}
+					}
+					int32 Total = 0;
+					for (int32 Index = 0; Index < Centers.Num(); ++Index)
+					{
+						Total += Counts[Index];
+						TestEqual(FString::Printf(TEXT("Center %d"), Index), Counts[Index],
+							Sim->SphereCount(Centers[Index], Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even));
+					}
+					TestTrue("The centers should actually find things", Total > 0);
+
+					Sim->SphereCountMany(Centers, Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even, Counts, 2);
+					for (int32 Index = 0; Index < Centers.Num(); ++Index)
+					{
+						TestTrue(FString::Printf(TEXT("Center %d stops at two"), Index), Counts[Index] <= 2);
+					}
+				});
+
+			It("should count 0 for a NaN center, and still count the rest", [this]()
+				{
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					Patch.Scatter_Centers(16);
+					const TArray<int32> Broken = {0, 7};
+					for (int32 Index : Broken)
+					{
+						Centers[Index].Z = std::numeric_limits<double>::quiet_NaN();
+					}
+					TArray<uint32> Counts;
+					Counts.Init(MAX_uint32, Centers.Num());
+					Sim->SphereCountMany(Centers, Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even, Counts);
+					int32 Total = 0;
+					for (int32 Index = 0; Index < Centers.Num(); ++Index)
+					{
+						if (Broken.Contains(Index))
+						{
+							TestEqual(FString::Printf(TEXT("NaN center %d"), Index), Counts[Index], 0u);
+							continue;
+						}
+						Total += Counts[Index];
+						TestEqual(FString::Printf(TEXT("Center %d"), Index), Counts[Index],
+							Sim->SphereCount(Centers[Index], Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even));
+					}
+					TestTrue("The other centers should actually find things", Total > 0);
+				});
+		});
+}
+
+//timings only, so it stays out of the product runs. this is the density probe spread fire does, for a few hundred targets.
+BEGIN_DEFINE_SPEC(FSphereCountBenchmarks, "Artillery.Barrage.Sphere Count Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+FCountingPatch Patch;
+static constexpr double Radius = FCountingPatch::Radius;
+END_DEFINE_SPEC(FSphereCountBenchmarks)
+void FSphereCountBenchmarks::Define()
+{
+	BeforeEach([this]()
+		{
+			Patch.Setup();
+		});
+
+	AfterEach([this]()
+		{
+			Patch.Sim.Reset();
+		});
+
+	Describe("A Sphere Count", [this]()
+		{
+			It("should benchmark against SphereSearch", [this]()
+				{
+					const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(Layers::CAST_QUERY);
+					Patch.Scatter_Centers(256);
+					TArray<uint32> Counts;
+					Counts.SetNum(Patch.Centers.Num());
+
+					double Start = FPlatformTime::Seconds();
+					TArray<uint32> Found;
+					uint32 SearchTotal = 0;
+					for (const FVector3d& Center : Patch.Centers)
+					{
+						Patch.Search(Center, Found);
+						SearchTotal += Algo::CountIf(Found, &Even);
+					}
+					const double SearchMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+					Start = FPlatformTime::Seconds();
+					uint32 CountTotal = 0;
+					for (const FVector3d& Center : Patch.Centers)
+					{
+						CountTotal += Patch.Sim->SphereCount(Center, Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even);
+					}
+					const double CountMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+					Start = FPlatformTime::Seconds();
+					Patch.Sim->SphereCountMany(Patch.Centers, Radius, Profile.BroadPhase, Profile.Objects, JPH::BodyFilter(), &Even, Counts);
+					const double ManyMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+					//all three have to agree, or the timings don't mean anything.
+					uint32 ManyTotal = 0;
+					for (uint32 Count : Counts)
+					{
+						ManyTotal += Count;
+					}
+					TestEqual("SphereCount agrees with SphereSearch", CountTotal, SearchTotal);
+					TestEqual("SphereCountMany agrees with SphereSearch", ManyTotal, SearchTotal);
+					AddInfo(FString::Printf(TEXT("%d probes: SphereSearch %.3fms (%u), SphereCount %.3fms (%u), SphereCountMany %.3fms"),
+						Patch.Centers.Num(), SearchMs, SearchTotal, CountMs, CountTotal, ManyMs));
+				});
+		});
+}
@@ -0,0 +1,258 @@
+#include "Misc/AutomationTest.h"
+#include "FWorldSimOwner.h"
+#include "BarrageStateHash.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+//a pile of balls dropped onto a floor, the same every time. every AwakeEvery-th ball starts awake. the rest start
+//asleep, the way most of an arena is.
+static TSharedPtr<FWorldSimOwner> MakeBallPit(int32 Count, int32 AwakeEvery, TArray<JPH::BodyID>& Balls, JPH::BodyID& Floor)
+{
+	TSharedPtr<FWorldSimOwner> Sim = MakeShared<FWorldSimOwner>(0.016f, [](int threadId)
+		{
+			MyWORKERIndex = threadId;
+			MyBARRAGEIndex = threadId;
+		});
+	FRandomStream Scatter(49);
+	JPH::BodyCreationSettings Ground(new JPH::BoxShape(JPH::Vec3(200, 1, 200)), JPH::RVec3(0, -1, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+	Floor = Sim->body_interface->CreateAndAddBody(Ground, JPH::EActivation::DontActivate);
+	Balls.Reset();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		JPH::BodyCreationSettings Ball(new JPH::SphereShape(0.5f), JPH::RVec3(Scatter.FRandRange(-150, 150), Scatter.FRandRange(1, 20), Scatter.FRandRange(-150, 150)), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
+		Balls.Add(Sim->body_interface->CreateAndAddBody(Ball, Index % AwakeEvery == 0 ? JPH::EActivation::Activate : JPH::EActivation::DontActivate));
+	}
+	return Sim;
+}
+
+//two worlds built the same way from the same seed, so anything we do to one and not the other is a desync the hash
+//should catch.
+BEGIN_DEFINE_SPEC(FStateHashTests, "Artillery.Barrage.State Hash Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+TSharedPtr<FWorldSimOwner> Ours;
+TSharedPtr<FWorldSimOwner> Theirs;
+FBarrageStateHash OurHashes;
+FBarrageStateHash TheirHashes;
+TArray<JPH::BodyID> Balls;
+JPH::BodyID Floor;
+
+TSharedPtr<FWorldSimOwner> MakeWorld(int32 Count)
+{
+	return MakeBallPit(Count, 1, Balls, Floor);
+}
+
+//steps both worlds and records both hashes for Tick, the way StepWorld does.
+void Step(uint64 Tick)
+{
+	Ours->StepSimulation();
+	Theirs->StepSimulation();
+	Ours->BodyTracker.Update();
+	Theirs->BodyTracker.Update();
+	OurHashes.Record(*Ours, Tick);
+	TheirHashes.Record(*Theirs, Tick);
+}
+
+void Exchange(uint64 Tick)
+{
+	uint64 Hash;
+	if (TheirHashes.TryGet(Tick, Hash))
+	{
+		OurHashes.ReportRemote(Tick, Hash);
+	}
+}
+END_DEFINE_SPEC(FStateHashTests)
+void FStateHashTests::Define()
+{
+	BeforeEach([this]()
+		{
+			Ours = MakeWorld(2000);
+			Theirs = MakeWorld(2000);
+		});
+
+	AfterEach([this]()
+		{
+			OurHashes.Reset();
+			TheirHashes.Reset();
+			Ours.Reset();
+			Theirs.Reset();
+		});
+
+	Describe("A State Hash", [this]()
+		{
+			It("should agree with a world that did the same things", [this]()
+				{
+					for (uint64 Tick = 1; Tick <= 30; ++Tick)
+					{
+						Step(Tick);
+						Exchange(Tick);
+					}
+					uint64 A = 0;
+					uint64 B = 0;
+					TestTrue("Both hashed the last tick", OurHashes.TryGet(30, A) && TheirHashes.TryGet(30, B));
+					TestEqual("Same world, same hash", A, B);
+					TestEqual("No desyncs", OurHashes.NumDesyncs(), 0u);
+					//the last report is compared on the next Record.
+					TestEqual("Every report but the last was compared", OurHashes.NumMatches(), 29u);
+				});
+
+			It("should catch a nudge, on the tick it happened", [this]()
+				{
+					for (uint64 Tick = 1; Tick <= 10; ++Tick)
+					{
+						Step(Tick);
+					}
+					//a centimeter, well over the grid. velocities are left alone, so only the position can give it away.
+					Theirs->body_interface->SetPosition(Balls[7], Theirs->body_interface->GetPosition(Balls[7]) + JPH::Vec3(0.01f, 0, 0), JPH::EActivation::DontActivate);
+					for (uint64 Tick = 11; Tick <= 20; ++Tick)
+					{
+						Step(Tick);
+					}
+					for (uint64 Tick = 1; Tick <= 20; ++Tick)
+					{
+						Exchange(Tick);
+					}
+					OurHashes.Record(*Ours, 21);
+					TestEqual("Found on the first tick after the nudge", OurHashes.FirstDesyncTick(), 11ull);
+					TestEqual("Nothing before it", OurHashes.NumMatches(), 10u);
+					TestTrue("And it doesn't go away", OurHashes.NumDesyncs() >= 10u);
+				});
+
+			It("should catch a change in velocity alone", [this]()
+				{
+					Step(1);
+					Theirs->body_interface->SetLinearVelocity(Balls[3], Theirs->body_interface->GetLinearVelocity(Balls[3]) + JPH::Vec3(0, 0, 0.1f));
+					//no step in between, so nothing else has had a chance to move.
+					TestNotEqual("Same bodies, same places, different velocity", OurHashes.Record(*Ours, 2), TheirHashes.Record(*Theirs, 2));
+				});
+
+			//the floor is static, so nothing wakes, and the body tracker never lists it.
+			It("should catch a change that wakes nothing, on the next tick", [this]()
+				{
+					Step(1);
+					Theirs->body_interface->SetPosition(Floor, Theirs->body_interface->GetPosition(Floor) + JPH::Vec3(0.01f, 0, 0), JPH::EActivation::DontActivate);
+					Step(2);
+					Exchange(1);
+					Exchange(2);
+					OurHashes.Record(*Ours, 3);
+					TestEqual("Nothing before it", OurHashes.NumMatches(), 1u);
+					TestEqual("Caught right away", OurHashes.FirstDesyncTick(), 2ull);
+				});
+
+			//a peer that joined late, or that hashed some other world first, has to agree with one that's been hashing
+			//this world all along. that includes changes that wake nothing, made while the late one wasn't looking.
+			It("should agree with a hasher that has a different history", [this]()
+				{
+					FBarrageStateHash Late;
+					{
+						TArray<JPH::BodyID> OtherBalls;
+						JPH::BodyID OtherFloor;
+						TSharedPtr<FWorldSimOwner> Other = MakeBallPit(300, 3, OtherBalls, OtherFloor);
+						for (uint64 Tick = 1; Tick <= 3; ++Tick)
+						{
+							Other->StepSimulation();
+							Late.Record(*Other, Tick);
+						}
+					}
+					for (uint64 Tick = 1; Tick <= 5; ++Tick)
+					{
+						Step(Tick);
+					}
+					for (FWorldSimOwner* World : {Ours.Get(), Theirs.Get()})
+					{
+						World->body_interface->SetPosition(Floor, World->body_interface->GetPosition(Floor) + JPH::Vec3(0.01f, 0, 0), JPH::EActivation::DontActivate);
+						World->body_interface->SetPosition(Balls[11], World->body_interface->GetPosition(Balls[11]) + JPH::Vec3(0, 0.01f, 0), JPH::EActivation::DontActivate);
+					}
+					for (uint64 Tick = 6; Tick <= 10; ++Tick)
+					{
+						Step(Tick);
+						uint64 Hash = 0;
+						OurHashes.TryGet(Tick, Hash);
+						TestEqual(FString::Printf(TEXT("Tick %llu"), Tick), Late.Record(*Theirs, Tick), Hash);
+					}
+				});
+
+			It("should hash the same as a fresh hasher, through adds and removes", [this]()
+				{
+					for (uint64 Tick = 1; Tick <= 5; ++Tick)
+					{
+						Step(Tick);
+					}
+					for (int32 Index = 0; Index < 100; ++Index)
+					{
+						Ours->body_interface->RemoveBody(Balls[Index]);
+						Ours->body_interface->DestroyBody(Balls[Index]);
+					}
+					//some of these land on the freed indices, the rest past the end.
+					for (int32 Index = 0; Index < 150; ++Index)
+					{
+						JPH::BodyCreationSettings Ball(new JPH::SphereShape(0.5f), JPH::RVec3(Index - 75, 10, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
+						Ours->body_interface->CreateAndAddBody(Ball, JPH::EActivation::Activate);
+					}
+					for (uint64 Tick = 6; Tick <= 8; ++Tick)
+					{
+						Step(Tick);
+					}
+					FBarrageStateHash Fresh;
+					TestEqual("History doesn't matter, only the world", OurHashes.Record(*Ours, 9), Fresh.Record(*Ours, 9));
+				});
+
+			It("should hold remote hashes from the future until it gets there, and forget its own past", [this]()
+				{
+					for (uint64 Tick = 1; Tick <= 3; ++Tick)
+					{
+						Step(Tick);
+					}
+					uint64 Hash;
+					TheirHashes.TryGet(3, Hash);
+					OurHashes.ReportRemote(3, Hash);
+					OurHashes.ReportRemote(5, 0xDEAD);
+					OurHashes.Record(*Ours, 4);
+					TestEqual("The past one is checked", OurHashes.NumMatches(), 1u);
+					TestEqual("The future one waits", OurHashes.NumDesyncs(), 0u);
+					OurHashes.Record(*Ours, 5);
+					TestEqual("Until we get there", OurHashes.NumDesyncs(), 1u);
+					TestEqual("And it's the first", OurHashes.FirstDesyncTick(), 5ull);
+
+					TestTrue("Tick 1 is still around", OurHashes.TryGet(1, Hash));
+					OurHashes.Record(*Ours, 1 + FBarrageStateHash::HistoryLength);
+					TestFalse("Until its slot is reused", OurHashes.TryGet(1, Hash));
+					OurHashes.ReportRemote(2, 0xDEAD);
+					OurHashes.Record(*Ours, 2 + FBarrageStateHash::HistoryLength);
+					TestEqual("Too old to check is not a desync", OurHashes.NumDesyncs(), 1u);
+				});
+		});
+}
+
+//timings only, so it stays out of the product runs. this runs every step and has to stay cheap enough to leave on in
+//production, so read it when you touch the hash. an arena of 20k bodies with one in forty awake.
+BEGIN_DEFINE_SPEC(FStateHashBenchmarks, "Artillery.Barrage.State Hash Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+TSharedPtr<FWorldSimOwner> Sim;
+FBarrageStateHash Hashes;
+END_DEFINE_SPEC(FStateHashBenchmarks)
+void FStateHashBenchmarks::Define()
+{
+	AfterEach([this]()
+		{
+			Hashes.Reset();
+			Sim.Reset();
+		});
+
+	Describe("A State Hash", [this]()
+		{
+			It("should benchmark hashing 20k bodies", [this]()
+				{
+					TArray<JPH::BodyID> Balls;
+					JPH::BodyID Floor;
+					Sim = MakeBallPit(20000, 40, Balls, Floor);
+					constexpr int32 Ticks = 32;
+					double HashUs = 0;
+					for (int32 Tick = 1; Tick <= Ticks; ++Tick)
+					{
+						Sim->StepSimulation();
+						const double Start = FPlatformTime::Seconds();
+						Hashes.Record(*Sim, Tick);
+						HashUs += (FPlatformTime::Seconds() - Start) * 1000000.0;
+					}
+					AddInfo(FString::Printf(TEXT("20001 bodies: %.1fus per hash"), HashUs / Ticks));
+				});
+		});
+}
@@ -3,7 +3,17 @@
 #include "FBShapeParams.h"
 #include "PhysicsFilters/FastBroadphaseLayerFilter.h"
 #include "PhysicsFilters/FastObjectLayerFilters.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
 #include "Jolt/Physics/Body/BodyFilter.h"
+#include "Jolt/Physics/Collision/ShapeFilter.h"
+#include "Conversion/BarrageCookedShapeCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Constraints/SwingTwistConstraint.h"
 
 BEGIN_DEFINE_SPEC(FWorldSimOwnerTests, "Artillery.Barrage.World Sim Owner Tests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
 TSharedPtr<FWorldSimOwner> ClassUnderTest = MakeShared<FWorldSimOwner>(0.016f, [this](int threadId)
@@ -99,6 +109,94 @@ void FWorldSimOwnerTests::Define()
 							TestTrue("There is an event in the queue", ClassUnderTest->ThreadAcc[FORCED_THREAD_INDEX].Queue->Dequeue(ActualUpdate));
 							TestEqual("The event is an add", ActualUpdate.Action, PhysicsInputType::ADD);
 						});
+
+					It("should share character shapes between characters of the same size", [this]()
+						{
+							ClassUnderTest->CharacterShapes.Prewarm(1.8f, 0.4f);
+							const FBarrageCharacterShapes::FShapes First = ClassUnderTest->CharacterShapes.Get(1.8f, 0.4f);
+							const FBarrageCharacterShapes::FShapes Second = ClassUnderTest->CharacterShapes.Get(1.8f, 0.4f);
+							const FBarrageCharacterShapes::FShapes Smaller = ClassUnderTest->CharacterShapes.Get(1.2f, 0.3f);
+							TestTrue("Same size gets the same outer shape", First.Outer == Second.Outer);
+							TestTrue("Same size gets the same inner shape", First.Inner == Second.Inner);
+							TestTrue("Outer and inner are never the same shape", First.Outer != First.Inner);
+							TestTrue("Different sizes get different shapes", First.Outer != Smaller.Outer);
+							ClassUnderTest->CharacterShapes.Reset();
+						});
+
+					It("should only let characters collide with each other when asked to", [this]()
+						{
+							//two characters a third of a meter apart, well inside each other's radius.
+							auto Touching = [this]()
+							{
+								FBCharParams Params;
+								Params.JoltRadius = 0.4f;
+								Params.JoltHalfHeightOfCylinder = 0.9f;
+								Params.speed = 0.f;
+								Params.point = FVector3d(1000, 0, 0);
+								const FBarrageKey First = ClassUnderTest->CreatePrimitive(Params, Layers::MOVING);
+								Params.point = FVector3d(1030, 0, 0);
+								const FBarrageKey Second = ClassUnderTest->CreatePrimitive(Params, Layers::MOVING);
+								ClassUnderTest->CharacterGrid.Rebuild();
+
+								const JPH::Ref<JPH::CharacterVirtual> Mover = (*ClassUnderTest->CharacterToJoltMapping->Find(First))->mCharacter;
+								const JPH::Ref<JPH::CharacterVirtual> Other = (*ClassUnderTest->CharacterToJoltMapping->Find(Second))->mCharacter;
+								Mover->RefreshContacts(JPH::BroadPhaseLayerFilter(), JPH::ObjectLayerFilter(), JPH::BodyFilter(), JPH::ShapeFilter(), *ClassUnderTest->Allocator);
+								const bool bTouching = Mover->HasCollidedWith(Other.GetPtr());
+								ClassUnderTest->FinalizeReleasePrimitive(First);
+								ClassUnderTest->FinalizeReleasePrimitive(Second);
+								return bTouching;
+							};
+
+							TestFalse("By default, characters walk through each other", Touching());
+							ClassUnderTest->bCharactersCollide = true;
+							TestTrue("Once it's turned on, they don't", Touching());
+							ClassUnderTest->bCharactersCollide = false;
+							TestEqual("Both pairs are cleaned up", ClassUnderTest->CharacterGrid.Num(), 0);
+						});
+
+					It("should import static meshes together and add them on the next step", [this]()
+						{
+							UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+							if (!TestNotNull("The engine cube should load", Cube))
+							{
+								return;
+							}
+							TArray<FBStaticImport> Imports;
+							for (int32 Index = 0; Index < 3; ++Index)
+							{
+								UStaticMeshComponent* Component = NewObject<UStaticMeshComponent>();
+								Component->SetStaticMesh(Cube);
+								Imports.Add({FBTransform(FTransform(FVector(Index * 500.0, 0, 0))), Component, FSkeletonKey(static_cast<uint64>(Index + 1))});
+							}
+
+							TArray<FBLet> Imported;
+							ClassUnderTest->ImportStaticGeometry(Imports, {}, Imported);
+							if (!TestEqual("Every mesh should have a result", Imported.Num(), Imports.Num()))
+							{
+								return;
+							}
+							TArray<JPH::BodyID> Bodies;
+							for (const FBLet& Body : Imported)
+							{
+								JPH::BodyID BodyID;
+								if (TestTrue("Every mesh should import", Body.IsValid()) && ClassUnderTest->GetBodyIDOrDefault(Body->KeyIntoBarrage, BodyID))
+								{
+									Bodies.Add(BodyID);
+								}
+							}
+							TestEqual("Every mesh should have a body", Bodies.Num(), Imports.Num());
+							for (const JPH::BodyID& BodyID : Bodies)
+							{
+								TestFalse("Bodies wait for the step to be added", ClassUnderTest->body_interface->IsAdded(BodyID));
+							}
+
+							TestTrue("The import should be waiting", ClassUnderTest->AddPendingStaticGeometry());
+							for (const JPH::BodyID& BodyID : Bodies)
+							{
+								TestTrue("Bodies should be in the world after the batch", ClassUnderTest->body_interface->IsAdded(BodyID));
+							}
+							TestFalse("Nothing should be left waiting", ClassUnderTest->AddPendingStaticGeometry());
+						});
 				});
 
 			Describe("when performing casts", [this]()
@@ -418,4 +516,137 @@ void FWorldSimOwnerTests::Define()
 					}
 				});
 		});
+
+	Describe("Layer Query Profiles", [this]()
+		{
+			It("should agree with the default filters Jolt builds from the pair filter", [this]()
+				{
+					for (uint8 Layer = 0; Layer < Layers::NUM_LAYERS; ++Layer)
+					{
+						const Layers::FQueryLayerProfile& Profile = Layers::QueryProfile(static_cast<Layers::EJoltPhysicsLayer>(Layer));
+						const JPH::DefaultBroadPhaseLayerFilter DefaultBroadPhase = ClassUnderTest->physics_system->GetDefaultBroadPhaseLayerFilter(Layer);
+						const JPH::DefaultObjectLayerFilter DefaultObjects = ClassUnderTest->physics_system->GetDefaultLayerFilter(Layer);
+						for (uint8 BroadPhase = 0; BroadPhase < JOLT::BroadPhaseLayers::NUM_LAYERS; ++BroadPhase)
+						{
+							TestEqual(FString::Printf(TEXT("Layer %d searching tree %d"), Layer, BroadPhase),
+								Profile.BroadPhase.ShouldCollide(JPH::BroadPhaseLayer(BroadPhase)), DefaultBroadPhase.ShouldCollide(JPH::BroadPhaseLayer(BroadPhase)));
+						}
+						for (uint8 Other = 0; Other < Layers::NUM_LAYERS; ++Other)
+						{
+							TestEqual(FString::Printf(TEXT("Layer %d against layer %d"), Layer, Other),
+								Profile.Objects.ShouldCollide(Other), DefaultObjects.ShouldCollide(Other));
+						}
+					}
+				});
+		});
+
+	Describe("A Cooked Shape Cache", [this]()
+		{
+			//a scratch directory, so the test neither finds shapes from earlier runs nor leaves its own behind.
+			const FString ScratchDirectory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("BarrageCookedShapes"));
+			BeforeEach([ScratchDirectory]()
+				{
+					IFileManager::Get().DeleteDirectory(*ScratchDirectory, false, true);
+					Barrage::Conversion::FCookedShapeCache::Get().Reset();
+					Barrage::Conversion::FCookedShapeCache::Get().SetCacheDirectory(ScratchDirectory);
+				});
+
+			AfterEach([ScratchDirectory]()
+				{
+					Barrage::Conversion::FCookedShapeCache::Get().Reset();
+					Barrage::Conversion::FCookedShapeCache::Get().SetCacheDirectory(FString());
+					IFileManager::Get().DeleteDirectory(*ScratchDirectory, false, true);
+				});
+
+			It("should hand out one shape per body setup, and bring it back from disk", [this, ScratchDirectory]()
+				{
+					Barrage::Conversion::FCookedShapeCache& Cache = Barrage::Conversion::FCookedShapeCache::Get();
+					UBodySetup* BodySetup = NewObject<UBodySetup>();
+					FKBoxElem Box(100.f, 200.f, 300.f);
+					BodySetup->AggGeom.BoxElems.Add(Box);
+					BodySetup->AggGeom.SphereElems.Add(FKSphereElem(50.f));
+
+					const JPH::ShapeSettings::ShapeResult First = Cache.BodySetupToJoltShape(BodySetup);
+					const JPH::ShapeSettings::ShapeResult Second = Cache.BodySetupToJoltShape(BodySetup);
+					if (!TestTrue("The body setup should convert", First.IsValid() && Second.IsValid()))
+					{
+						return;
+					}
+					TestTrue("Both instances should share the shape", First.Get() == Second.Get());
+					TArray<FString> Saved;
+					IFileManager::Get().FindFiles(Saved, *FPaths::Combine(ScratchDirectory, TEXT("*.jshape")), true, false);
+					TestEqual("It should be saved once, where we pointed the cache", Saved.Num(), 1);
+
+					// forget it in memory, so the next one has to come off disk
+					Cache.Reset();
+					const JPH::ShapeSettings::ShapeResult Restored = Cache.BodySetupToJoltShape(BodySetup);
+					if (!TestTrue("The restored shape should be valid", Restored.IsValid()))
+					{
+						return;
+					}
+					TestTrue("The restored shape should be a new one", Restored.Get() != First.Get());
+					TestTrue("The restored shape should be the same kind of shape", Restored.Get()->GetSubType() == First.Get()->GetSubType());
+					TestTrue("The restored shape should have the same bounds", Restored.Get()->GetLocalBounds().mMin.IsClose(First.Get()->GetLocalBounds().mMin)
+						&& Restored.Get()->GetLocalBounds().mMax.IsClose(First.Get()->GetLocalBounds().mMax));
+
+					BodySetup->AggGeom.BoxElems[0].X = 150.f;
+					const JPH::ShapeSettings::ShapeResult Edited = Cache.BodySetupToJoltShape(BodySetup);
+					TestTrue("An edited body setup should get its own shape", Edited.IsValid() && Edited.Get() != Restored.Get());
+				});
+		});
+
+	Describe("A Ragdoll Pool", [this]()
+		{
+			It("should hand a released ragdoll back out instead of making a new one", [this]()
+				{
+					// two boxes and a joint is all a ragdoll needs to be a ragdoll
+					JPH::Ref<JPH::Skeleton> Skeleton = new JPH::Skeleton;
+					Skeleton->AddJoint("root");
+					Skeleton->AddJoint("child", 0);
+					JPH::Ref<JPH::RagdollSettings> Settings = new JPH::RagdollSettings;
+					Settings->mSkeleton = Skeleton;
+					Settings->mParts.resize(2);
+					for (int Part = 0; Part < 2; ++Part)
+					{
+						Settings->mParts[Part].SetShape(new JPH::BoxShape(JPH::Vec3::sReplicate(0.25f)));
+						Settings->mParts[Part].mPosition = JPH::RVec3(0, 10 + Part * 0.5f, 0);
+						Settings->mParts[Part].mMotionType = JPH::EMotionType::Dynamic;
+						Settings->mParts[Part].mObjectLayer = Layers::MOVING;
+					}
+					JPH::SwingTwistConstraintSettings* Joint = new JPH::SwingTwistConstraintSettings;
+					Joint->mPosition1 = Joint->mPosition2 = JPH::RVec3(0, 10.25f, 0);
+					Settings->mParts[1].mToParent = Joint;
+					Settings->Stabilize();
+					Settings->DisableParentChildCollisions();
+
+					JPH::SkeletonPose Pose;
+					Pose.SetSkeleton(Skeleton);
+					Pose.CalculateJointMatrices();
+
+					FBarrageRagdollPool& Pool = ClassUnderTest->RagdollPool;
+					JPH::PhysicsSystem& System = *ClassUnderTest->physics_system;
+					JPH::Ref<JPH::Ragdoll> First = Pool.Acquire(System, *Settings, Pose);
+					if (!TestTrue("The ragdoll should be made", First != nullptr))
+					{
+						return;
+					}
+					const uint32 BodiesWithRagdoll = System.GetNumBodies();
+					TestTrue("The ragdoll should be in the world", First->GetBodyCount() == 2 && System.GetBodyInterface().IsAdded(First->GetBodyID(0)));
+
+					JPH::Ragdoll* Released = First.GetPtr();
+					Pool.Release(First);
+					First = nullptr;
+					TestEqual("The released ragdoll should wait in the pool", Pool.NumFree(), 1);
+					TestFalse("The released ragdoll should be out of the world", System.GetBodyInterface().IsAdded(Released->GetBodyID(0)));
+
+					JPH::Ref<JPH::Ragdoll> Second = Pool.Acquire(System, *Settings, Pose);
+					TestTrue("The same ragdoll should come back", Second.GetPtr() == Released);
+					TestEqual("The pool should be empty again", Pool.NumFree(), 0);
+					TestEqual("No new bodies should have been made", System.GetNumBodies(), BodiesWithRagdoll);
+					TestTrue("The returned ragdoll should be back in the world", System.GetBodyInterface().IsAdded(Second->GetBodyID(0)));
+
+					Second->RemoveFromPhysicsSystem();
+					Pool.Reset();
+				});
+		});
 }
\ No newline at end of file
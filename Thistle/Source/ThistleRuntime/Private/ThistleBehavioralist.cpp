@@ -29,8 +29,10 @@ bool UThistleBehavioralist::RegistrationImplementation()
 	UBarrageDispatch* Physics = MyDispatch->GetWorld()->GetSubsystem<UBarrageDispatch>();
 	if (ensure(Physics))
 	{
-		Physics->OnBarrageContactAddedDelegate.AddUObject(
-			this, &UThistleBehavioralist::OnPhysicsCollision);
+		Physics->OnBarrageContactBatchDelegate.AddUObject(
+			this, &UThistleBehavioralist::OnPhysicsCollisionBatch);
+		//OnPhysicsCollision only forwards when a side is an enemy.
+		Physics->SubscribeToContacts(Layers::ENEMY);
 		SelfPtr = this;
 		return true;
 	}
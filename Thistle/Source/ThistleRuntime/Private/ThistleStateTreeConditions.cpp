@@ -2,6 +2,7 @@
 
 #include "ArtilleryBPLibs.h"
 #include "StateTreeExecutionContext.h"
+#include "PhysicsFilters/LayerCollisionMatrix.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ThistleStateTreeConditions)
 
@@ -109,10 +110,9 @@ bool FCheckLoStoPoI::TestCondition(FStateTreeExecutionContext& Context) const
 	if ((UArtilleryLibrary::GetTotalsTickCount() % InstanceData.TicksBetweenCastRefresh) == 0 &&
 		UBarrageDispatch::SelfPtr)
 	{
-		const JPH::DefaultBroadPhaseLayerFilter default_broadphase_layer_filter = UBarrageDispatch::SelfPtr->JoltGameSim
-			->physics_system->GetDefaultBroadPhaseLayerFilter(Layers::CAST_QUERY);
-		const JPH::DefaultObjectLayerFilter default_object_layer_filter = UBarrageDispatch::SelfPtr->JoltGameSim->
-			physics_system->GetDefaultLayerFilter(Layers::CAST_QUERY);
+		const Layers::FQueryLayerProfile& CastQuery = Layers::QueryProfile(Layers::CAST_QUERY);
+		const JPH::BroadPhaseLayerFilter& default_broadphase_layer_filter = CastQuery.BroadPhase;
+		const JPH::ObjectLayerFilter& default_object_layer_filter = CastQuery.Objects;
 
 		if (InstanceData.SourceBodyKey_SetOrRegret.IsValid()
 			&& UArtilleryDispatch::SelfPtr->IsLiveKey(InstanceData.SourceBodyKey_SetOrRegret) != DEAD)
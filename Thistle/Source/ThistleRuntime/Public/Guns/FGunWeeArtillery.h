@@ -85,8 +85,14 @@ public:
 			ProjectileTags.Add(TAG_EnemyProjectile);
 			FSkeletonKey MissileKey = ProjectileDispatch->QueueProjectileInstance(
 				TEXT("Shell"), MyGunKey, StartLocation, FVector::Zero(), 1.6f, Layers::ENEMYPROJECTILE, &ProjectileTags);
-			StructureFullTL(ProjectileArc,TL_ArcingProjectile,FTArcingProjectile, MissileKey, TargetLocation, StartLocation, 180, 8000.f);
-			MyDispatch->RequestAddTicklite(ProjectileArc, Early);
+			FAnalyticArcParams Arc;
+			Arc.Projectile = MissileKey;
+			Arc.StartPosition = StartLocation;
+			Arc.TargetPosition = TargetLocation;
+			Arc.TicksToTarget = 180;
+			Arc.ApogeeHeight = 8000.0;
+			Arc.Layer = Layers::ENEMYPROJECTILE;
+			ProjectileDispatch->LaunchArc(MoveTemp(Arc));
 		}
 		
 		PostFireGun(Fired, 0, ActorInfo, ActivationInfo, false, TriggerEventData, Handle);
@@ -131,10 +131,18 @@ public:
 						const FVector3d Direction = (AimAt - fphold->GetComponentLocation()).GetSafeNormal();
 						TArray<FGameplayTag> ProjectileTags;
 						ProjectileTags.Add(TAG_EnemyProjectile);
-						ProjectileDispatch->QueueProjectileInstance(
+						const FSkeletonKey RocketKey = ProjectileDispatch->QueueProjectileInstance(
 							//a less elegant weapon for a less civilized age.
 							TEXT("Pellet"), MyGunKey, FiringPointComponent->GetComponentLocation(), Direction * 1000,
 							0.07f, Layers::ENEMYPROJECTILE, &ProjectileTags, HERTZ_OF_BARRAGE*12);
+						//homes on the point it was aimed at, spray and all. the swarm picks it up once it has a body.
+						FGuidedProjectileParams Guidance;
+						Guidance.Missile = RocketKey;
+						Guidance.TargetPosition = FVector3f(AimAt);
+						Guidance.MaxSpeed = 1000.f;
+						Guidance.LockOnTicks = HERTZ_OF_BARRAGE / 4;
+						Guidance.TicksAliveTime = HERTZ_OF_BARRAGE * 12;
+						ProjectileDispatch->GuideProjectile(MoveTemp(Guidance));
 						PostFireGun(Fired, 0, ActorInfo, ActivationInfo, false, TriggerEventData, Handle);
 				}
 			}
@@ -182,6 +182,25 @@ public:
 	UPROPERTY()
 	TObjectPtr<UArtilleryDispatch> MyDispatch;
 
+	//only the enemy partitions, so everything else costs us nothing.
+	void OnPhysicsCollisionBatch(const FBarrageContactBatch& Batch)
+	{
+		if (Batch.Type != EBarrageContactEventType::ADDED)
+		{
+			return;
+		}
+		for (const FBarrageContactPartition& Partition : Batch.Partitions)
+		{
+			if (Partition.Layer1 == Layers::ENEMY || Partition.Layer2 == Layers::ENEMY)
+			{
+				for (const BarrageContactEvent& ContactEvent : Partition.Events)
+				{
+					OnPhysicsCollision(ContactEvent);
+				}
+			}
+		}
+	}
+
 	void OnPhysicsCollision(const BarrageContactEvent& ContactEvent)
 	{
 		if (ContactEvent.ContactEntity1.MyLayer == Layers::EJoltPhysicsLayer::ENEMY